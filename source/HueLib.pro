@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += network
+QT       += network concurrent
 QT       -= gui
 
 TARGET = HueLib
@@ -23,39 +23,80 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Warnings that the review build uses; hidden virtuals are easy to miss otherwise
+CONFIG += warn_on
+gcc|clang: QMAKE_CXXFLAGS_WARN_ON += -Wextra -Woverloaded-virtual
+
 SOURCES += \
+        Models/abstractlistmodel.cpp \
         Models/abstracttreemodel.cpp \
         Models/huegroupinfotreemodel.cpp \
         Models/huegrouplistmodel.cpp \
+        Models/hueinventorytreemodel.cpp \
         Models/huelightinfotreemodel.cpp \
         Models/huelightlistmodel.cpp \
-        Models/treeitem.cpp \
+        Models/treestore.cpp \
         hueabstractobject.cpp \
+        hueanimation.cpp \
+        hueanimator.cpp \
+        huebitset.cpp \
         huebridge.cpp \
+        huechangenotifier.cpp \
+        huecolor.cpp \
+        hueeventstream.cpp \
         huegroup.cpp \
+        huejsonreader.cpp \
         huelight.cpp \
+        huelightstatetable.cpp \
+        huemembershipindex.cpp \
+        hueperceptualfilter.cpp \
         huereply.cpp \
+        huescene.cpp \
+        huesnapshot.cpp \
         huerequest.cpp \
+        huestatechange.cpp \
+        huestreamchannel.cpp \
+        huestreamreceiver.cpp \
+        huestreamtransport.cpp \
         huesynchronizer.cpp \
         huetypes.cpp \
         hueerror.cpp \
     huelib.cpp
 
 HEADERS += \
+        Models/abstractlistmodel.h \
         Models/abstracttreemodel.h \
         Models/huegroupinfotreemodel.h \
         Models/huegrouplistmodel.h \
+        Models/hueinventorytreemodel.h \
         Models/huelightinfotreemodel.h \
         Models/huelightlistmodel.h \
-        Models/treeitem.h \
+        Models/treestore.h \
         hueabstractobject.h \
+        hueanimation.h \
+        hueanimator.h \
+        huebitset.h \
         huebridge.h \
+        huechangenotifier.h \
+        huecolor.h \
+        hueconcurrent.h \
+        hueeventstream.h \
         huegroup.h \
+        huejsonreader.h \
         huelib.h \
         huelight.h \
+        huelightstatetable.h \
+        huemembershipindex.h \
         hueobjectlist.h \
+        hueperceptualfilter.h \
         huereply.h \
+        huescene.h \
+        huesnapshot.h \
         huerequest.h \
+        huestatechange.h \
+        huestreamchannel.h \
+        huestreamreceiver.h \
+        huestreamtransport.h \
         huesynchronizer.h \
         huetypes.h \
         hueerror.h
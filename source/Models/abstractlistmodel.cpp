@@ -0,0 +1,338 @@
+#include "abstractlistmodel.h"
+
+#include "../hueabstractobject.h"
+
+#include <QSet>
+#include <algorithm>
+
+AbstractListModel::AbstractListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+    connect(&HueChangeNotifier::instance(), &HueChangeNotifier::changed,
+            this, &AbstractListModel::objectsChanged);
+}
+
+AbstractListModel::~AbstractListModel()
+{
+
+}
+
+int AbstractListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return static_cast<int>(m_objects.size());
+}
+
+QVariant AbstractListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount())
+        return QVariant();
+
+    const QVector<QVariant>& values = m_values[static_cast<size_t>(index.row())];
+
+    if (role == Qt::DisplayRole)
+        return values.value(0);
+
+    if (role > Qt::UserRole && role - Qt::UserRole < values.size())
+        return values.at(role - Qt::UserRole);
+
+    return QVariant();
+}
+
+int AbstractListModel::rowOf(const int ID) const
+{
+    return m_rowOfID.value(ID, -1);
+}
+
+// Makes the rows match objects, keeping rows whose ID is still present. Rows are
+// removed and inserted a contiguous run at a time, and rows that changed order are
+// rearranged before the new ones are inserted; see arrangeRows(). The ID and object
+// indices are only rebuilt once, at the end.
+void AbstractListModel::setObjects(const ObjectList& objects)
+{
+    QHash<int, int> newIndexOfID;
+    for (size_t i = 0; i < objects.size(); i++)
+        newIndexOfID.insert(objects[i]->ID(), static_cast<int>(i));
+
+    // Remove rows that are gone, a contiguous run at a time
+    for (int row = rowCount() - 1; row >= 0;) {
+        if (newIndexOfID.contains(m_objects[static_cast<size_t>(row)]->ID())) {
+            row--;
+            continue;
+        }
+
+        int first = row;
+        while (first > 0 && !newIndexOfID.contains(m_objects[static_cast<size_t>(first - 1)]->ID()))
+            first--;
+
+        removeObjectRows(first, row - first + 1);
+        row = first - 1;
+    }
+
+    QHash<int, int> rowOfID;
+    rowOfID.reserve(rowCount());
+    for (int row = 0; row < rowCount(); row++)
+        rowOfID.insert(m_objects[static_cast<size_t>(row)]->ID(), row);
+
+    // The rows that remain, in the order of objects
+    std::vector<int> order;
+    order.reserve(m_objects.size());
+    for (const auto& object : objects) {
+        const int row = rowOfID.value(object->ID(), -1);
+        if (row >= 0)
+            order.push_back(row);
+    }
+
+    arrangeRows(order);
+
+    // The remaining rows are in order now, so the new objects go in between
+    size_t next = 0;
+    int row = 0;
+
+    while (next < objects.size()) {
+        if (!rowOfID.contains(objects[next]->ID())) {
+            // Insert a contiguous run of new objects at once
+            ObjectList added;
+            while (next < objects.size() && !rowOfID.contains(objects[next]->ID()))
+                added.push_back(objects[next++]);
+
+            insertObjects(row, added);
+            row += static_cast<int>(added.size());
+            continue;
+        }
+
+        // The same light or group may come back as a new object from discovery
+        m_objects[static_cast<size_t>(row)] = objects[next++];
+
+        refreshRow(row);
+        row++;
+    }
+
+    rebuildIndex();
+}
+
+void AbstractListModel::appendObject(std::shared_ptr<HueAbstractObject> object)
+{
+    if (object == nullptr)
+        return;
+
+    const int row = rowOf(object->ID());
+    if (row >= 0) {
+        ObjectList objects = m_objects;
+        objects[static_cast<size_t>(row)] = object;
+        setObjects(objects);
+        return;
+    }
+
+    const int newRow = rowCount();
+    insertObjects(newRow, {object});
+
+    m_rowOfID.insert(object->ID(), newRow);
+    m_rowOfObject.insert(object.get(), newRow);
+}
+
+bool AbstractListModel::removeObject(const int ID)
+{
+    const int row = rowOf(ID);
+    if (row < 0)
+        return false;
+
+    removeObjectRows(row, 1);
+    rebuildIndex();
+    return true;
+}
+
+std::shared_ptr<HueAbstractObject> AbstractListModel::objectAt(const int row) const
+{
+    if (row < 0 || row >= rowCount())
+        return nullptr;
+
+    return m_objects[static_cast<size_t>(row)];
+}
+
+// Rows are refreshed once per batch of the notifier, however often their object changed
+void AbstractListModel::objectsChanged(const HueChangeNotifier::ChangeSet& changes)
+{
+    for (const auto& change : changes) {
+        const int row = m_rowOfObject.value(change.object.data(), -1);
+        if (row >= 0)
+            refreshRow(row);
+    }
+}
+
+void AbstractListModel::insertObjects(const int row, const ObjectList& objects)
+{
+    if (objects.empty())
+        return;
+
+    std::vector<QVector<QVariant>> values;
+    values.reserve(objects.size());
+    for (const auto& object : objects)
+        values.push_back(roleValues(object.get()));
+
+    beginInsertRows(QModelIndex(), row, row + static_cast<int>(objects.size()) - 1);
+    m_objects.insert(m_objects.begin() + row, objects.begin(), objects.end());
+    m_values.insert(m_values.begin() + row, values.begin(), values.end());
+    endInsertRows();
+}
+
+void AbstractListModel::removeObjectRows(const int row, const int count)
+{
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    m_objects.erase(m_objects.begin() + row, m_objects.begin() + row + count);
+    m_values.erase(m_values.begin() + row, m_values.begin() + row + count);
+    endRemoveRows();
+}
+
+// Puts the rows in the given order, where order[i] is the current row of the object
+// that belongs at row i. Rows on a longest increasing run of order stay where they
+// are. If only a few others are out of place, they are moved one at a time, which
+// lets views animate them; each move is at most a park at the end and a move to its
+// place. Otherwise the rows are rearranged with a single layout change, since views
+// update every persistent index on each move.
+void AbstractListModel::arrangeRows(const std::vector<int>& order)
+{
+    const std::vector<bool> staying = increasingRun(order);
+    const long moving = std::count(staying.begin(), staying.end(), false);
+
+    if (moving == 0)
+        return;
+
+    if (moving > m_maxRowMoves) {
+        emit layoutAboutToBeChanged();
+
+        std::vector<int> newRow(order.size());
+        ObjectList objects;
+        std::vector<QVector<QVariant>> values;
+        objects.reserve(order.size());
+        values.reserve(order.size());
+
+        for (size_t i = 0; i < order.size(); i++) {
+            const size_t row = static_cast<size_t>(order[i]);
+            newRow[row] = static_cast<int>(i);
+            objects.push_back(std::move(m_objects[row]));
+            values.push_back(std::move(m_values[row]));
+        }
+
+        m_objects.swap(objects);
+        m_values.swap(values);
+
+        const QModelIndexList from = persistentIndexList();
+        QModelIndexList to;
+        to.reserve(from.size());
+        for (const QModelIndex& index : from)
+            to.append(this->index(newRow[static_cast<size_t>(index.row())], index.column()));
+
+        changePersistentIndexList(from, to);
+
+        emit layoutChanged();
+        return;
+    }
+
+    std::vector<const HueAbstractObject*> wanted;
+    QSet<const HueAbstractObject*> moved;
+    wanted.reserve(order.size());
+
+    for (size_t i = 0; i < order.size(); i++) {
+        const HueAbstractObject* object = m_objects[static_cast<size_t>(order[i])].get();
+        wanted.push_back(object);
+
+        if (!staying[i])
+            moved.insert(object);
+    }
+
+    const int count = rowCount();
+
+    for (int row = 0; row < count;) {
+        const HueAbstractObject* object = wanted[static_cast<size_t>(row)];
+
+        if (m_objects[static_cast<size_t>(row)].get() == object) {
+            row++;
+        }
+        else if (moved.contains(object)) {
+            // Rows before row are in place, so the object is further down
+            int from = row + 1;
+            while (m_objects[static_cast<size_t>(from)].get() != object)
+                from++;
+
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            std::rotate(m_objects.begin() + row, m_objects.begin() + from, m_objects.begin() + from + 1);
+            std::rotate(m_values.begin() + row, m_values.begin() + from, m_values.begin() + from + 1);
+            endMoveRows();
+            row++;
+        }
+        else {
+            // Another row that moves is in the way; park it at the end until its turn
+            beginMoveRows(QModelIndex(), row, row, QModelIndex(), count);
+            std::rotate(m_objects.begin() + row, m_objects.begin() + row + 1, m_objects.end());
+            std::rotate(m_values.begin() + row, m_values.begin() + row + 1, m_values.end());
+            endMoveRows();
+        }
+    }
+}
+
+// Marks the entries of values that form a longest strictly increasing subsequence
+std::vector<bool> AbstractListModel::increasingRun(const std::vector<int>& values)
+{
+    // tails[k] is the index of the smallest last value of an increasing run of length k + 1
+    std::vector<int> tails;
+    std::vector<int> previous(values.size(), -1);
+
+    for (size_t i = 0; i < values.size(); i++) {
+        auto it = std::lower_bound(tails.begin(), tails.end(), values[i],
+                                   [&values](const int index, const int value) {
+            return values[static_cast<size_t>(index)] < value;
+        });
+
+        if (it != tails.begin())
+            previous[i] = *(it - 1);
+
+        if (it == tails.end())
+            tails.push_back(static_cast<int>(i));
+        else
+            *it = static_cast<int>(i);
+    }
+
+    std::vector<bool> marked(values.size(), false);
+    for (int i = tails.empty() ? -1 : tails.back(); i >= 0; i = previous[static_cast<size_t>(i)])
+        marked[static_cast<size_t>(i)] = true;
+
+    return marked;
+}
+
+// Reports only the roles whose value differs from the cached row
+void AbstractListModel::refreshRow(const int row)
+{
+    QVector<QVariant> values = roleValues(m_objects[static_cast<size_t>(row)].get());
+    QVector<QVariant>& cached = m_values[static_cast<size_t>(row)];
+    QVector<int> roles;
+
+    for (int i = 0; i < values.size(); i++) {
+        if (i >= cached.size() || cached.at(i) != values.at(i))
+            roles.append(i == 0 ? int(Qt::DisplayRole) : Qt::UserRole + i);
+    }
+
+    if (roles.isEmpty())
+        return;
+
+    cached = values;
+
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, roles);
+}
+
+void AbstractListModel::rebuildIndex()
+{
+    m_rowOfID.clear();
+    m_rowOfObject.clear();
+    m_rowOfID.reserve(rowCount());
+    m_rowOfObject.reserve(rowCount());
+
+    for (int row = 0; row < rowCount(); row++) {
+        const HueAbstractObject* object = m_objects[static_cast<size_t>(row)].get();
+        m_rowOfID.insert(object->ID(), row);
+        m_rowOfObject.insert(object, row);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef ABSTRACTLISTMODEL_H
+#define ABSTRACTLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+#include "../huechangenotifier.h"
+
+class HueAbstractObject;
+
+class AbstractListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit AbstractListModel(QObject* parent = nullptr);
+    virtual ~AbstractListModel() override;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    int rowOf(const int ID) const;
+
+protected:
+    typedef std::vector<std::shared_ptr<HueAbstractObject>> ObjectList;
+
+    void setObjects(const ObjectList& objects);
+    void appendObject(std::shared_ptr<HueAbstractObject> object);
+    bool removeObject(const int ID);
+    std::shared_ptr<HueAbstractObject> objectAt(const int row) const;
+
+private slots:
+    void objectsChanged(const HueChangeNotifier::ChangeSet& changes);
+
+private:
+    // Values of Qt::DisplayRole followed by Qt::UserRole + 1, Qt::UserRole + 2, ...
+    virtual QVector<QVariant> roleValues(const HueAbstractObject* object) const = 0;
+
+    void insertObjects(const int row, const ObjectList& objects);
+    void removeObjectRows(const int row, const int count);
+    void arrangeRows(const std::vector<int>& order);
+    static std::vector<bool> increasingRun(const std::vector<int>& values);
+    void refreshRow(const int row);
+    void rebuildIndex();
+
+private:
+    const int m_maxRowMoves = 32;
+
+    ObjectList m_objects;
+    std::vector<QVector<QVariant>> m_values;
+    QHash<int, int> m_rowOfID;
+    QHash<const QObject*, int> m_rowOfObject;
+};
+
+#endif // ABSTRACTLISTMODEL_H
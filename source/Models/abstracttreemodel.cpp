@@ -1,17 +1,15 @@
 #include "abstracttreemodel.h"
 
-#include "treeitem.h"
-
 AbstractTreeModel::AbstractTreeModel(QObject* parent)
     : QAbstractItemModel(parent)
-    , m_rootItem(nullptr)
+    , m_store(2)
 {
 
 }
 
 AbstractTreeModel::~AbstractTreeModel()
 {
-    delete m_rootItem;
+
 }
 
 QModelIndex AbstractTreeModel::index(int row, int column, const QModelIndex &parent) const
@@ -19,16 +17,9 @@ QModelIndex AbstractTreeModel::index(int row, int column, const QModelIndex &par
     if (!hasIndex(row, column, parent))
         return QModelIndex();
 
-    TreeItem* parentItem;
-
-    if (!parent.isValid())
-        parentItem = m_rootItem;
-    else
-        parentItem = static_cast<TreeItem*>(parent.internalPointer());
-
-    TreeItem* childItem = parentItem->child(row);
-    if (childItem)
-        return createIndex(row, column, childItem);
+    const int childItem = m_store.child(itemOf(parent), row);
+    if (childItem >= 0)
+        return createIndex(row, column, static_cast<quintptr>(childItem));
 
     return QModelIndex();
 }
@@ -38,13 +29,7 @@ QModelIndex AbstractTreeModel::parent(const QModelIndex &index) const
     if (!index.isValid())
         return QModelIndex();
 
-    TreeItem* childItem = static_cast<TreeItem*>(index.internalPointer());
-    TreeItem* parentItem = childItem->parentItem();
-
-    if (parentItem == m_rootItem)
-        return QModelIndex();
-
-    return createIndex(parentItem->row(), 0, parentItem);
+    return indexOf(m_store.parent(itemOf(index)));
 }
 
 int AbstractTreeModel::rowCount(const QModelIndex& parent) const
@@ -52,21 +37,13 @@ int AbstractTreeModel::rowCount(const QModelIndex& parent) const
     if (parent.column() > 0)
         return 0;
 
-    TreeItem* parentItem;
-
-    if (!parent.isValid())
-        parentItem = m_rootItem;
-    else
-        parentItem = static_cast<TreeItem*>(parent.internalPointer());
-
-    return parentItem->childCount();
+    return m_store.childCount(itemOf(parent));
 }
 
 int AbstractTreeModel::columnCount(const QModelIndex& parent) const
 {
-    if (parent.isValid())
-        return static_cast<TreeItem*>(parent.internalPointer())->columnCount();
-    return m_rootItem->columnCount();
+    Q_UNUSED(parent);
+    return m_store.columnCount();
 }
 
 QVariant AbstractTreeModel::data(const QModelIndex& index, int role) const
@@ -76,10 +53,7 @@ QVariant AbstractTreeModel::data(const QModelIndex& index, int role) const
 
     switch (role) {
     case Qt::DisplayRole:
-    {
-        TreeItem* item = static_cast<TreeItem*>(index.internalPointer());
-        return item->data(index.column());
-    }
+        return m_store.data(itemOf(index), index.column());
     default:
         return QVariant();
     }
@@ -96,17 +70,94 @@ Qt::ItemFlags AbstractTreeModel::flags(const QModelIndex &index) const
 QVariant AbstractTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
-        return m_rootItem->data(section);
+        return m_store.data(m_store.root(), section);
 
     return QVariant();
 }
 
-void AbstractTreeModel::setRootItem(TreeItem* rootItem)
+void AbstractTreeModel::setRootItem(const QVector<QVariant>& headers)
 {
-    m_rootItem = rootItem;
+    for (int column = 0; column < headers.size(); column++)
+        m_store.setData(m_store.root(), column, headers.at(column));
+}
+
+int AbstractTreeModel::getRootItem() const
+{
+    return m_store.root();
+}
+
+// Sets the label and value of the child at row of parentItem, appending the child if
+// row is one past the last. Only cells that differ are reported by dataChanged, so
+// views keep their selection and expansion.
+int AbstractTreeModel::setItem(const int parentItem, const int row, const QVariant& label, const QVariant& value)
+{
+    const int childCount = m_store.childCount(parentItem);
+
+    if (row >= childCount) {
+        beginInsertRows(indexOf(parentItem), childCount, childCount);
+        const int item = m_store.appendChild(parentItem, {label, value});
+        endInsertRows();
+
+        return item;
+    }
+
+    const int item = m_store.child(parentItem, row);
+    const bool labelChanged = m_store.setData(item, 0, label);
+    const bool valueChanged = m_store.setData(item, 1, value);
+
+    if (labelChanged || valueChanged) {
+        const QModelIndex parentIndex = indexOf(parentItem);
+        emit dataChanged(index(row, labelChanged ? 0 : 1, parentIndex),
+                         index(row, valueChanged ? 1 : 0, parentIndex),
+                         {Qt::DisplayRole});
+    }
+
+    return item;
 }
 
-TreeItem* AbstractTreeModel::getRootItem()
+// Removes the children of parentItem from rowCount on
+void AbstractTreeModel::truncateItem(const int parentItem, const int rowCount)
 {
-    return m_rootItem;
+    const int childCount = m_store.childCount(parentItem);
+
+    if (rowCount >= childCount)
+        return;
+
+    removeItems(parentItem, rowCount, childCount - rowCount);
+}
+
+void AbstractTreeModel::removeItems(const int parentItem, const int row, const int count)
+{
+    if (row < 0 || count <= 0 || row + count > m_store.childCount(parentItem))
+        return;
+
+    beginRemoveRows(indexOf(parentItem), row, row + count - 1);
+    m_store.removeChildren(parentItem, row, count);
+    endRemoveRows();
+}
+
+TreeStore& AbstractTreeModel::store()
+{
+    return m_store;
+}
+
+const TreeStore& AbstractTreeModel::store() const
+{
+    return m_store;
+}
+
+int AbstractTreeModel::itemOf(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return m_store.root();
+
+    return static_cast<int>(index.internalId());
+}
+
+QModelIndex AbstractTreeModel::indexOf(const int item) const
+{
+    if (item < 0 || item == m_store.root())
+        return QModelIndex();
+
+    return createIndex(m_store.row(item), 0, static_cast<quintptr>(item));
 }
@@ -5,7 +5,7 @@
 #include <QHash>
 #include <memory>
 
-class TreeItem;
+#include "treestore.h"
 
 class AbstractTreeModel : public QAbstractItemModel
 {
@@ -24,15 +24,21 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
 
 protected:
-    void setRootItem(TreeItem* rootItem);
-    TreeItem* getRootItem();
-
+    void setRootItem(const QVector<QVariant>& headers);
+    int getRootItem() const;
+    int setItem(const int parentItem, const int row, const QVariant& label, const QVariant& value);
+    void truncateItem(const int parentItem, const int rowCount);
+    void removeItems(const int parentItem, const int row, const int count);
+    TreeStore& store();
+    const TreeStore& store() const;
+    int itemOf(const QModelIndex& index) const;
+    QModelIndex indexOf(const int item) const;
 
 private:
-    virtual void setupModelData(TreeItem* rootItem) = 0;
+    virtual void updateModelData(const int rootItem) = 0;
 
 private:
-    TreeItem* m_rootItem;
+    TreeStore m_store;
 };
 
 #endif // ABSTRACTTREEMODEL_H
@@ -1,18 +1,15 @@
 #include "huegroupinfotreemodel.h"
 
-#include "treeitem.h"
 #include "../huegroup.h"
 
 HueGroupInfoTreeModel::HueGroupInfoTreeModel(std::shared_ptr<HueGroup> group, QObject* parent)
     : AbstractTreeModel(parent)
     , m_group(group)
 {   
-    connect(m_group.get(), &HueGroup::synchronized,
-            this, &HueGroupInfoTreeModel::update);
-
-    connect(m_group.get(), &HueGroup::valueUpdated,
-            this, &HueGroupInfoTreeModel::update);
+    connect(&HueChangeNotifier::instance(), &HueChangeNotifier::changed,
+            this, &HueGroupInfoTreeModel::objectsChanged);
 
+    setRootItem({tr("Parameter"), tr("Value")});
     update();
 }
 
@@ -23,65 +20,68 @@ HueGroupInfoTreeModel::~HueGroupInfoTreeModel()
 
 void HueGroupInfoTreeModel::update()
 {
-    beginResetModel();
-
-    TreeItem* rootItem = getRootItem();
-    if (rootItem != nullptr)
-        delete getRootItem();
+    updateModelData(getRootItem());
+}
 
-    setRootItem(new TreeItem({tr("Parameter"), tr("Value")}));
-    setupModelData(getRootItem());
-    endResetModel();
+// The notifier reports each changed object once per batch, however many of its
+// values changed
+void HueGroupInfoTreeModel::objectsChanged(const HueChangeNotifier::ChangeSet& changes)
+{
+    for (const auto& change : changes) {
+        if (change.object.data() == m_group.get()) {
+            update();
+            return;
+        }
+    }
 }
 
-void HueGroupInfoTreeModel::setupModelData(TreeItem *rootItem)
+void HueGroupInfoTreeModel::updateModelData(const int rootItem)
 {
     int ID = m_group->ID();
     Group::Name name = m_group->name();
     Group::Type type = m_group->type();
     Group::GroupClass groupClass = m_group->groupClass();
     Group::Recycle recycle = m_group->recycle();
-    TreeItem* aboutItem = new TreeItem({tr("About"), tr("")}, rootItem);
-    aboutItem->appendChild(new TreeItem({tr("ID"),      ID},                            aboutItem));
-    aboutItem->appendChild(new TreeItem({tr("Name"),    name.getName()},                aboutItem));
-    aboutItem->appendChild(new TreeItem({tr("Type"),    type.getType()},                aboutItem));
-    aboutItem->appendChild(new TreeItem({tr("Class"),   groupClass.getGroupClass()},    aboutItem));
-    aboutItem->appendChild(new TreeItem({tr("Recycle"), recycle.getRecycle()},          aboutItem));
+    int aboutItem = setItem(rootItem, 0, tr("About"), tr(""));
+    setItem(aboutItem, 0, tr("ID"),         ID);
+    setItem(aboutItem, 1, tr("Name"),       name.getName());
+    setItem(aboutItem, 2, tr("Type"),       type.getType());
+    setItem(aboutItem, 3, tr("Class"),      groupClass.getGroupClass());
+    setItem(aboutItem, 4, tr("Recycle"),    recycle.getRecycle());
 
     Group::Action action = m_group->action();
-    TreeItem* actionItem = new TreeItem({tr("Action"), tr("")}, rootItem);
-    actionItem->appendChild(new TreeItem({tr("On"),         action.isOn()},             actionItem));
-    actionItem->appendChild(new TreeItem({tr("Brightness"), action.getBrightness()},    actionItem));
-    actionItem->appendChild(new TreeItem({tr("Hue"),        action.getHue()},           actionItem));
-    actionItem->appendChild(new TreeItem({tr("Saturation"), action.getSaturation()},    actionItem));
-    actionItem->appendChild(new TreeItem({tr("Color temp"), action.getColorTemp()},     actionItem));
-    actionItem->appendChild(new TreeItem({tr("X"),          action.getXValue()},        actionItem));
-    actionItem->appendChild(new TreeItem({tr("Y"),          action.getYValue()},        actionItem));
-    actionItem->appendChild(new TreeItem({tr("Effect"),     action.getEffect()},        actionItem));
-    actionItem->appendChild(new TreeItem({tr("Alert"),      action.getAlert()},         actionItem));
-    actionItem->appendChild(new TreeItem({tr("Colormode"),  action.getColorMode()},     actionItem));
+    int actionItem = setItem(rootItem, 1, tr("Action"), tr(""));
+    setItem(actionItem, 0, tr("On"),            action.isOn());
+    setItem(actionItem, 1, tr("Brightness"),    action.getBrightness());
+    setItem(actionItem, 2, tr("Hue"),           action.getHue());
+    setItem(actionItem, 3, tr("Saturation"),    action.getSaturation());
+    setItem(actionItem, 4, tr("Color temp"),    action.getColorTemp());
+    setItem(actionItem, 5, tr("X"),             action.getXValue());
+    setItem(actionItem, 6, tr("Y"),             action.getYValue());
+    setItem(actionItem, 7, tr("Effect"),        action.getEffect());
+    setItem(actionItem, 8, tr("Alert"),         action.getAlert());
+    setItem(actionItem, 9, tr("Colormode"),     action.getColorMode());
 
     Group::State state = m_group->state();
-    TreeItem* stateItem = new TreeItem({tr("State"), tr("")}, rootItem);
-    stateItem->appendChild(new TreeItem({tr("All on"),  state.getAllOn()},  stateItem));
-    stateItem->appendChild(new TreeItem({tr("Any on"),  state.getAnyOn()},  stateItem));
+    int stateItem = setItem(rootItem, 2, tr("State"), tr(""));
+    setItem(stateItem, 0, tr("All on"), state.getAllOn());
+    setItem(stateItem, 1, tr("Any on"), state.getAnyOn());
 
     Group::Lights lights = m_group->lights();
-    TreeItem* lightsItem = new TreeItem({tr("Lights"), tr("")}, rootItem);
+    int lightsItem = setItem(rootItem, 3, tr("Lights"), tr(""));
+    int row = 0;
 
     for(auto light : lights.getLights()) {
-        lightsItem->appendChild(new TreeItem({light, tr("")}, lightsItem));
+        setItem(lightsItem, row++, light, tr(""));
     }
+    truncateItem(lightsItem, row);
 
     Group::Sensors sensors = m_group->sensors();
-    TreeItem* sensorsItem = new TreeItem({tr("Sensors"), tr("")}, rootItem);
+    int sensorsItem = setItem(rootItem, 4, tr("Sensors"), tr(""));
+    row = 0;
+
     for(auto sensor : sensors.getSensors()) {
-        sensorsItem->appendChild(new TreeItem({sensor, tr("")}, sensorsItem));
+        setItem(sensorsItem, row++, sensor, tr(""));
     }
-
-    rootItem->appendChild(aboutItem);
-    rootItem->appendChild(actionItem);
-    rootItem->appendChild(stateItem);
-    rootItem->appendChild(lightsItem);
-    rootItem->appendChild(sensorsItem);
+    truncateItem(sensorsItem, row);
 }
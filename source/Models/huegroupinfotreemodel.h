@@ -2,6 +2,7 @@
 #define HUEGROUPMODEL_H
 
 #include "abstracttreemodel.h"
+#include "../huechangenotifier.h"
 
 class HueGroup;
 
@@ -15,8 +16,11 @@ public:
 public slots:
     void update();
 
+private slots:
+    void objectsChanged(const HueChangeNotifier::ChangeSet& changes);
+
 private:
-    void setupModelData(TreeItem* rootItem) override;
+    void updateModelData(const int rootItem) override;
 
 private:
     std::shared_ptr<HueGroup> m_group;
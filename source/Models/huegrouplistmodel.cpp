@@ -2,47 +2,91 @@
 
 #include "../huegroup.h"
 
+#include <QPointF>
+
 HueGroupListModel::HueGroupListModel(std::shared_ptr<HueGroupList> groupList, QObject* parent)
-    : QAbstractListModel(parent)
-    , m_groupList(groupList)
+    : AbstractListModel(parent)
 {
-
+    setGroupList(groupList);
 }
 
 HueGroupListModel::~HueGroupListModel()
 {
-    m_groupList.reset();
+
 }
 
-int HueGroupListModel::rowCount(const QModelIndex& parent) const
+QVariant HueGroupListModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
-    Q_UNUSED(parent);
-    return m_groupList->size();
+    Q_UNUSED(section);
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
+        return "Groups";
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> HueGroupListModel::roleNames() const
+{
+    QHash<int, QByteArray> roles = AbstractListModel::roleNames();
+    roles.insert(IDRole,            "groupID");
+    roles.insert(NameRole,          "name");
+    roles.insert(OnRole,            "on");
+    roles.insert(AllOnRole,         "allOn");
+    roles.insert(AnyOnRole,         "anyOn");
+    roles.insert(BrightnessRole,    "brightness");
+    roles.insert(HueRole,           "hue");
+    roles.insert(SaturationRole,    "saturation");
+    roles.insert(ColorTempRole,     "colorTemp");
+    roles.insert(XYRole,            "xy");
+
+    return roles;
 }
 
-QVariant HueGroupListModel::data(const QModelIndex &index, int role) const
+void HueGroupListModel::setGroupList(std::shared_ptr<HueGroupList> groupList)
 {
-    if (!index.isValid())
-        return QVariant();
+    ObjectList objects;
 
-    switch (role) {
-    case Qt::DisplayRole:
-        return m_groupList->at(index.row())->name().getName();
-    default:
-        return QVariant();
+    if (groupList != nullptr) {
+        objects.reserve(static_cast<size_t>(groupList->size()));
+        for (int i = 0; i < groupList->size(); i++)
+            objects.push_back(groupList->at(i));
     }
+
+    setObjects(objects);
 }
 
-QVariant HueGroupListModel::headerData(int section, Qt::Orientation orientation, int role) const
+void HueGroupListModel::appendGroup(std::shared_ptr<HueGroup> group)
 {
-    Q_UNUSED(section);
-    if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
-        return "Groups";
+    appendObject(group);
+}
 
-    return QVariant();
+bool HueGroupListModel::removeGroup(const int ID)
+{
+    return removeObject(ID);
 }
 
 std::shared_ptr<HueGroup> HueGroupListModel::getGroup(const QModelIndex &index) const
 {
-    return m_groupList->at(index.row());
+    return std::static_pointer_cast<HueGroup>(objectAt(index.row()));
+}
+
+QVector<QVariant> HueGroupListModel::roleValues(const HueAbstractObject* object) const
+{
+    const HueGroup* group = static_cast<const HueGroup*>(object);
+    const QString name = group->name().getName();
+    const Group::Action action = group->action();
+    const Group::State state = group->state();
+
+    return {
+        name,
+        group->ID(),
+        name,
+        action.isOn(),
+        state.getAllOn(),
+        state.getAnyOn(),
+        action.getBrightness(),
+        action.getHue(),
+        action.getSaturation(),
+        action.getColorTemp(),
+        QPointF(action.getXValue(), action.getYValue())
+    };
 }
@@ -1,26 +1,40 @@
 #ifndef HUEGROUPLISTMODEL_H
 #define HUEGROUPLISTMODEL_H
 
-#include <QAbstractListModel>
-
+#include "abstractlistmodel.h"
 #include "../hueobjectlist.h"
 
-class HueGroupListModel : public QAbstractListModel
+class HueGroupListModel : public AbstractListModel
 {
     Q_OBJECT
 public:
+    enum Role {
+        IDRole = Qt::UserRole + 1,
+        NameRole,
+        OnRole,
+        AllOnRole,
+        AnyOnRole,
+        BrightnessRole,
+        HueRole,
+        SaturationRole,
+        ColorTempRole,
+        XYRole
+    };
+
     explicit HueGroupListModel(std::shared_ptr<HueGroupList> group, QObject* parent = nullptr);
     ~HueGroupListModel() override;
 
-    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
-
-    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void setGroupList(std::shared_ptr<HueGroupList> groupList);
+    void appendGroup(std::shared_ptr<HueGroup> group);
+    bool removeGroup(const int ID);
 
     std::shared_ptr<HueGroup> getGroup(const QModelIndex& index) const;
 
 private:
-    std::shared_ptr<HueGroupList> m_groupList;
+    QVector<QVariant> roleValues(const HueAbstractObject* object) const override;
 
 };
 
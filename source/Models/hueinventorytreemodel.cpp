@@ -0,0 +1,373 @@
+#include "hueinventorytreemodel.h"
+
+#include "../huebridge.h"
+#include "../huegroup.h"
+#include "../huelight.h"
+
+// Bridges are added as rows of the root; their groups, the lights of a group and the
+// attributes of a light are only created when a view fetches them, i.e. when the row
+// is expanded. release() drops the children of a row again, e.g. when it is collapsed.
+// m_nodeInfo describes the bridge, group and light rows that exist; attribute rows
+// have no entry.
+
+HueInventoryTreeModel::HueInventoryTreeModel(QObject* parent)
+    : AbstractTreeModel(parent)
+{
+    setRootItem({tr("Name"), tr("Value")});
+
+    connect(&HueChangeNotifier::instance(), &HueChangeNotifier::changed,
+            this, &HueInventoryTreeModel::objectsChanged);
+}
+
+HueInventoryTreeModel::~HueInventoryTreeModel()
+{
+
+}
+
+bool HueInventoryTreeModel::hasChildren(const QModelIndex& parent) const
+{
+    if (!parent.isValid())
+        return !m_bridges.empty();
+
+    const int item = itemOf(parent);
+    auto it = m_nodeInfo.constFind(item);
+
+    if (it == m_nodeInfo.constEnd())
+        return false;
+
+    if (it->fetched)
+        return store().childCount(item) > 0;
+
+    if (it->kind == GroupNode)
+        return static_cast<const HueGroup*>(it->object)->lights().count() > 0;
+
+    return true;
+}
+
+bool HueInventoryTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (!parent.isValid())
+        return false;
+
+    auto it = m_nodeInfo.constFind(itemOf(parent));
+    return it != m_nodeInfo.constEnd() && !it->fetched;
+}
+
+void HueInventoryTreeModel::fetchMore(const QModelIndex& parent)
+{
+    if (!parent.isValid())
+        return;
+
+    const int item = itemOf(parent);
+    auto it = m_nodeInfo.find(item);
+
+    if (it == m_nodeInfo.end() || it->fetched)
+        return;
+
+    NodeInfo info = it.value();
+    info.fetched = true;
+    m_nodeInfo.insert(item, info);
+
+    fetchChildren(item, info);
+}
+
+void HueInventoryTreeModel::addBridge(HueBridge* bridge,
+                                      std::shared_ptr<HueGroupList> groupList,
+                                      std::shared_ptr<HueLightList> lightList)
+{
+    if (bridge == nullptr)
+        return;
+
+    removeBridge(bridge);
+
+    BridgeEntry entry;
+    entry.bridge = bridge;
+
+    HueBitset groupedIDs;
+
+    if (groupList != nullptr) {
+        for (int i = 0; i < groupList->size(); i++) {
+            entry.groups.push_back(groupList->at(i));
+
+            groupedIDs |= groupList->at(i)->lights().getMembers();
+        }
+    }
+
+    if (lightList != nullptr) {
+        for (int i = 0; i < lightList->size(); i++) {
+            std::shared_ptr<HueLight> light = lightList->at(i);
+            entry.lights.push_back(light);
+            entry.lightOfID.insert(light->ID(), light);
+
+            if (!groupedIDs.test(light->ID()))
+                entry.otherLights.push_back(light);
+        }
+    }
+
+    m_bridges.push_back(entry);
+    updateModelData(getRootItem());
+
+    const int item = store().child(getRootItem(), static_cast<int>(m_bridges.size()) - 1);
+    m_nodeInfo.insert(item, {BridgeNode, bridge, nullptr, false});
+}
+
+bool HueInventoryTreeModel::removeBridge(HueBridge* bridge)
+{
+    for (size_t row = 0; row < m_bridges.size(); row++) {
+        if (m_bridges[row].bridge != bridge)
+            continue;
+
+        const int item = store().child(getRootItem(), static_cast<int>(row));
+        forgetChildren(item);
+        m_nodeInfo.remove(item);
+
+        removeItems(getRootItem(), static_cast<int>(row), 1);
+        m_bridges.erase(m_bridges.begin() + static_cast<long>(row));
+
+        return true;
+    }
+
+    return false;
+}
+
+int HueInventoryTreeModel::bridgeCount() const
+{
+    return static_cast<int>(m_bridges.size());
+}
+
+void HueInventoryTreeModel::release(const QModelIndex& index)
+{
+    const int item = itemOf(index);
+    auto it = m_nodeInfo.find(item);
+
+    if (!index.isValid() || it == m_nodeInfo.end() || !it->fetched)
+        return;
+
+    it->fetched = false;
+
+    forgetChildren(item);
+    removeItems(item, 0, store().childCount(item));
+}
+
+std::shared_ptr<HueAbstractObject> HueInventoryTreeModel::getObject(const QModelIndex& index) const
+{
+    auto it = m_nodeInfo.constFind(itemOf(index));
+
+    if (!index.isValid() || it == m_nodeInfo.constEnd() || it->object == nullptr)
+        return nullptr;
+
+    return it->object->shared_from_this();
+}
+
+void HueInventoryTreeModel::objectsChanged(const HueChangeNotifier::ChangeSet& changes)
+{
+    for (const auto& change : changes) {
+        if (change.object.isNull())
+            continue;
+
+        // Copied, since refetching a group below changes the items of its lights
+        const QVector<int> items = m_objectItems.value(change.object.data());
+
+        for (const int item : items) {
+            auto it = m_nodeInfo.constFind(item);
+            if (it == m_nodeInfo.constEnd())
+                continue;
+
+            const NodeInfo info = it.value();
+            updateObjectItem(item, info);
+
+            if (!info.fetched)
+                continue;
+
+            if (info.kind == LightNode) {
+                updateLightAttributes(item, static_cast<const HueLight*>(info.object));
+            }
+            // The members of a group may have changed after synchronizing
+            else if (info.kind == GroupNode && change.synchronized) {
+                const BridgeEntry* entry = findBridge(info.bridge);
+                const auto lights = groupLights(*entry, static_cast<const HueGroup*>(info.object));
+                bool membersChanged = static_cast<int>(lights.size()) != store().childCount(item);
+
+                for (size_t row = 0; !membersChanged && row < lights.size(); row++) {
+                    const int lightItem = store().child(item, static_cast<int>(row));
+                    membersChanged = m_nodeInfo.value(lightItem).object != lights[row].get();
+                }
+
+                if (membersChanged) {
+                    forgetChildren(item);
+                    removeItems(item, 0, store().childCount(item));
+                    fetchChildren(item, info);
+                }
+            }
+        }
+    }
+}
+
+void HueInventoryTreeModel::updateModelData(const int rootItem)
+{
+    for (size_t row = 0; row < m_bridges.size(); row++) {
+        const BridgeEntry& entry = m_bridges[row];
+        setItem(rootItem, static_cast<int>(row), entry.bridge->getIP(),
+                tr("%1 groups, %2 lights").arg(static_cast<int>(entry.groups.size())).arg(static_cast<int>(entry.lights.size())));
+    }
+}
+
+const HueInventoryTreeModel::BridgeEntry* HueInventoryTreeModel::findBridge(const HueBridge* bridge) const
+{
+    for (const auto& entry : m_bridges) {
+        if (entry.bridge == bridge)
+            return &entry;
+    }
+
+    return nullptr;
+}
+
+std::vector<std::shared_ptr<HueLight>> HueInventoryTreeModel::groupLights(const BridgeEntry& entry, const HueGroup* group) const
+{
+    std::vector<std::shared_ptr<HueLight>> lights;
+
+    for (const int lightID : group->lights().getMembers().toVector()) {
+        std::shared_ptr<HueLight> light = entry.lightOfID.value(lightID);
+        if (light != nullptr)
+            lights.push_back(light);
+    }
+
+    return lights;
+}
+
+void HueInventoryTreeModel::fetchChildren(const int item, const NodeInfo& info)
+{
+    const BridgeEntry* entry = findBridge(info.bridge);
+    if (entry == nullptr)
+        return;
+
+    switch (info.kind) {
+    case BridgeNode:
+    {
+        std::vector<std::shared_ptr<HueAbstractObject>> groups(entry->groups.begin(), entry->groups.end());
+        appendObjectItems(item, GroupNode, info.bridge, groups);
+
+        if (!entry->otherLights.empty()) {
+            const int otherItem = setItem(item, store().childCount(item), tr("Other lights"),
+                                          static_cast<int>(entry->otherLights.size()));
+            m_nodeInfo.insert(otherItem, {OtherLightsNode, info.bridge, nullptr, false});
+        }
+        break;
+    }
+    case GroupNode:
+    {
+        const auto lights = groupLights(*entry, static_cast<const HueGroup*>(info.object));
+        appendObjectItems(item, LightNode, info.bridge,
+                          std::vector<std::shared_ptr<HueAbstractObject>>(lights.begin(), lights.end()));
+        break;
+    }
+    case OtherLightsNode:
+        appendObjectItems(item, LightNode, info.bridge,
+                          std::vector<std::shared_ptr<HueAbstractObject>>(entry->otherLights.begin(),
+                                                                          entry->otherLights.end()));
+        break;
+    case LightNode:
+        updateLightAttributes(item, static_cast<const HueLight*>(info.object));
+        break;
+    }
+}
+
+// Appends one row per object with a single insertion, as a view expects from fetchMore()
+void HueInventoryTreeModel::appendObjectItems(const int parentItem, const NodeKind kind, HueBridge* bridge,
+                                              const std::vector<std::shared_ptr<HueAbstractObject>>& objects)
+{
+    if (objects.empty())
+        return;
+
+    const int first = store().childCount(parentItem);
+
+    beginInsertRows(indexOf(parentItem), first, first + static_cast<int>(objects.size()) - 1);
+
+    for (const auto& object : objects) {
+        const int item = store().appendChild(parentItem, {});
+        const NodeInfo info = {kind, bridge, object.get(), false};
+
+        m_nodeInfo.insert(item, info);
+        m_objectItems[object.get()].append(item);
+    }
+
+    endInsertRows();
+
+    // Labels and values are filled in silently, the rows are not visible yet
+    for (int row = first; row < store().childCount(parentItem); row++) {
+        const int item = store().child(parentItem, row);
+        const NodeInfo info = m_nodeInfo.value(item);
+
+        if (kind == GroupNode) {
+            const HueGroup* group = static_cast<const HueGroup*>(info.object);
+            store().setData(item, 0, group->name().getName());
+            store().setData(item, 1, group->type().getType());
+        }
+        else {
+            const HueLight* light = static_cast<const HueLight*>(info.object);
+            store().setData(item, 0, light->name().getName());
+            store().setData(item, 1, light->state().isOn());
+        }
+    }
+
+    emit dataChanged(index(first, 0, indexOf(parentItem)),
+                     index(store().childCount(parentItem) - 1, 1, indexOf(parentItem)),
+                     {Qt::DisplayRole});
+}
+
+void HueInventoryTreeModel::updateObjectItem(const int item, const NodeInfo& info)
+{
+    const int parentItem = store().parent(item);
+    const int row = store().row(item);
+
+    if (info.kind == GroupNode) {
+        const HueGroup* group = static_cast<const HueGroup*>(info.object);
+        setItem(parentItem, row, group->name().getName(), group->type().getType());
+    }
+    else if (info.kind == LightNode) {
+        const HueLight* light = static_cast<const HueLight*>(info.object);
+        setItem(parentItem, row, light->name().getName(), light->state().isOn());
+    }
+}
+
+void HueInventoryTreeModel::updateLightAttributes(const int lightItem, const HueLight* light)
+{
+    Light::State state = light->state();
+    setItem(lightItem, 0, tr("ID"),            light->ID());
+    setItem(lightItem, 1, tr("On"),            state.isOn());
+    setItem(lightItem, 2, tr("Reachable"),     state.isReachable());
+    setItem(lightItem, 3, tr("Brightness"),    state.getBrightness());
+    setItem(lightItem, 4, tr("Hue"),           state.getHue());
+    setItem(lightItem, 5, tr("Saturation"),    state.getSaturation());
+    setItem(lightItem, 6, tr("Color temp"),    state.getColorTemp());
+    setItem(lightItem, 7, tr("X"),             state.getXValue());
+    setItem(lightItem, 8, tr("Y"),             state.getYValue());
+}
+
+// Drops the bookkeeping of all rows below item, before they are removed from the store
+void HueInventoryTreeModel::forgetChildren(const int item)
+{
+    for (int row = 0; row < store().childCount(item); row++) {
+        const int child = store().child(item, row);
+        auto it = m_nodeInfo.constFind(child);
+
+        if (it == m_nodeInfo.constEnd())
+            continue;
+
+        // Removing the grandchildren can rehash m_nodeInfo and invalidate it
+        HueAbstractObject* const object = it->object;
+
+        forgetChildren(child);
+
+        if (object != nullptr) {
+            auto objectIt = m_objectItems.find(object);
+            if (objectIt != m_objectItems.end()) {
+                objectIt->removeAll(child);
+                if (objectIt->isEmpty())
+                    m_objectItems.erase(objectIt);
+            }
+        }
+
+        m_nodeInfo.remove(child);
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef HUEINVENTORYTREEMODEL_H
+#define HUEINVENTORYTREEMODEL_H
+
+#include <QHash>
+#include <QVector>
+#include <vector>
+
+#include "abstracttreemodel.h"
+#include "../hueobjectlist.h"
+#include "../huechangenotifier.h"
+
+class HueBridge;
+
+class HueInventoryTreeModel : public AbstractTreeModel
+{
+    Q_OBJECT
+public:
+    explicit HueInventoryTreeModel(QObject* parent = nullptr);
+    ~HueInventoryTreeModel() override;
+
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    void addBridge(HueBridge* bridge,
+                   std::shared_ptr<HueGroupList> groupList,
+                   std::shared_ptr<HueLightList> lightList);
+    bool removeBridge(HueBridge* bridge);
+    int bridgeCount() const;
+
+    void release(const QModelIndex& index);
+    std::shared_ptr<HueAbstractObject> getObject(const QModelIndex& index) const;
+
+private slots:
+    void objectsChanged(const HueChangeNotifier::ChangeSet& changes);
+
+private:
+    enum NodeKind {
+        BridgeNode,
+        GroupNode,
+        OtherLightsNode,
+        LightNode
+    };
+
+    struct NodeInfo {
+        NodeKind kind;
+        HueBridge* bridge;
+        HueAbstractObject* object;
+        bool fetched;
+    };
+
+    struct BridgeEntry {
+        HueBridge* bridge;
+        std::vector<std::shared_ptr<HueGroup>> groups;
+        std::vector<std::shared_ptr<HueLight>> lights;
+        std::vector<std::shared_ptr<HueLight>> otherLights;
+        QHash<int, std::shared_ptr<HueLight>> lightOfID;
+    };
+
+    void updateModelData(const int rootItem) override;
+
+    const BridgeEntry* findBridge(const HueBridge* bridge) const;
+    std::vector<std::shared_ptr<HueLight>> groupLights(const BridgeEntry& entry, const HueGroup* group) const;
+    void fetchChildren(const int item, const NodeInfo& info);
+    void appendObjectItems(const int parentItem, const NodeKind kind, HueBridge* bridge,
+                           const std::vector<std::shared_ptr<HueAbstractObject>>& objects);
+    void updateObjectItem(const int item, const NodeInfo& info);
+    void updateLightAttributes(const int lightItem, const HueLight* light);
+    void forgetChildren(const int item);
+
+private:
+    std::vector<BridgeEntry> m_bridges;
+    QHash<int, NodeInfo> m_nodeInfo;
+    QHash<const QObject*, QVector<int>> m_objectItems;
+};
+
+#endif // HUEINVENTORYTREEMODEL_H
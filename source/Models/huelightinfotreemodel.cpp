@@ -1,18 +1,15 @@
 #include "huelightinfotreemodel.h"
 
-#include "treeitem.h"
 #include "../huelight.h"
 
 HueLightInfoTreeModel::HueLightInfoTreeModel(std::shared_ptr<HueLight> light, QObject* parent)
     : AbstractTreeModel(parent)
     , m_light(light)
 {
-    connect(m_light.get(), &HueLight::synchronized,
-            this, &HueLightInfoTreeModel::update);
-
-    connect(m_light.get(), &HueLight::valueUpdated,
-            this, &HueLightInfoTreeModel::update);
+    connect(&HueChangeNotifier::instance(), &HueChangeNotifier::changed,
+            this, &HueLightInfoTreeModel::objectsChanged);
 
+    setRootItem({tr("Parameter"), tr("Value")});
     update();
 }
 
@@ -23,72 +20,70 @@ HueLightInfoTreeModel::~HueLightInfoTreeModel()
 
 void HueLightInfoTreeModel::update()
 {
-    beginResetModel();
-
-    TreeItem* rootItem = getRootItem();
-    if (rootItem != nullptr)
-        delete getRootItem();
+    updateModelData(getRootItem());
+}
 
-    setRootItem(new TreeItem({tr("Parameter"), tr("Value")}));
-    setupModelData(getRootItem());
-    endResetModel();
+// The notifier reports each changed object once per batch, however many of its
+// values changed
+void HueLightInfoTreeModel::objectsChanged(const HueChangeNotifier::ChangeSet& changes)
+{
+    for (const auto& change : changes) {
+        if (change.object.data() == m_light.get()) {
+            update();
+            return;
+        }
+    }
 }
 
-void HueLightInfoTreeModel::setupModelData(TreeItem* rootItem)
+void HueLightInfoTreeModel::updateModelData(const int rootItem)
 {
     int ID = m_light->ID();
     Light::Name name = m_light->name();
     Light::Type type = m_light->type();
     Light::UniqueID uniqueID = m_light->uniqueID();
-    TreeItem* aboutItem = new TreeItem({tr("About"), tr("")}, rootItem);
-    aboutItem->appendChild(new TreeItem({tr("ID"),          ID},                        aboutItem));
-    aboutItem->appendChild(new TreeItem({tr("Name"),        name.getName()},            aboutItem));
-    aboutItem->appendChild(new TreeItem({tr("Type"),        type.getType()},            aboutItem));
-    aboutItem->appendChild(new TreeItem({tr("Unique ID"),   uniqueID.getUniqueID()},    aboutItem));
+    int aboutItem = setItem(rootItem, 0, tr("About"), tr(""));
+    setItem(aboutItem, 0, tr("ID"),         ID);
+    setItem(aboutItem, 1, tr("Name"),       name.getName());
+    setItem(aboutItem, 2, tr("Type"),       type.getType());
+    setItem(aboutItem, 3, tr("Unique ID"),  uniqueID.getUniqueID());
 
     Light::State state = m_light->state();
-    TreeItem* stateItem = new TreeItem({tr("State"), tr("")}, rootItem);
-    stateItem->appendChild(new TreeItem({tr("On"),          state.isOn()},          stateItem));
-    stateItem->appendChild(new TreeItem({tr("Reachable"),   state.isReachable()},   stateItem));
-    stateItem->appendChild(new TreeItem({tr("Brightness"),  state.getBrightness()}, stateItem));
-    stateItem->appendChild(new TreeItem({tr("Hue"),         state.getHue()},        stateItem));
-    stateItem->appendChild(new TreeItem({tr("Saturation"),  state.getHue()},        stateItem));
-    stateItem->appendChild(new TreeItem({tr("Color temp"),  state.getColorTemp()},  stateItem));
-    stateItem->appendChild(new TreeItem({tr("X"),           state.getXValue()},     stateItem));
-    stateItem->appendChild(new TreeItem({tr("Y"),           state.getYValue()},     stateItem));
-    stateItem->appendChild(new TreeItem({tr("Effect"),      state.getEffect()},     stateItem));
-    stateItem->appendChild(new TreeItem({tr("Alert"),       state.getAlert()},      stateItem));
-    stateItem->appendChild(new TreeItem({tr("Colormode"),   state.getColorMode()},  stateItem));
-    stateItem->appendChild(new TreeItem({tr("Mode"),        state.getMode()},       stateItem));
+    int stateItem = setItem(rootItem, 1, tr("State"), tr(""));
+    setItem(stateItem, 0,  tr("On"),            state.isOn());
+    setItem(stateItem, 1,  tr("Reachable"),     state.isReachable());
+    setItem(stateItem, 2,  tr("Brightness"),    state.getBrightness());
+    setItem(stateItem, 3,  tr("Hue"),           state.getHue());
+    setItem(stateItem, 4,  tr("Saturation"),    state.getSaturation());
+    setItem(stateItem, 5,  tr("Color temp"),    state.getColorTemp());
+    setItem(stateItem, 6,  tr("X"),             state.getXValue());
+    setItem(stateItem, 7,  tr("Y"),             state.getYValue());
+    setItem(stateItem, 8,  tr("Effect"),        state.getEffect());
+    setItem(stateItem, 9,  tr("Alert"),         state.getAlert());
+    setItem(stateItem, 10, tr("Colormode"),     state.getColorMode());
+    setItem(stateItem, 11, tr("Mode"),          state.getMode());
 
     Light::SoftwareVersion swVersion = m_light->softwareVersion();
     Light::SoftwareUpdate swUpdate = m_light->softwareUpdate();
     Light::SoftwareConfigID swConfigID = m_light->softwareConfigID();
-    TreeItem* swItem = new TreeItem({tr("Software"), tr("")}, rootItem);
-    swItem->appendChild(new TreeItem({tr("Version"),            swVersion.getSoftwareVersion()},    swItem));
-    swItem->appendChild(new TreeItem({tr("Last update"),        swUpdate.getLastInstall()},         swItem));
-    swItem->appendChild(new TreeItem({tr("Pending updates"),    swUpdate.getState()},               swItem));
-    swItem->appendChild(new TreeItem({tr("Config ID"),          swConfigID.getSoftwareConfigID()},  swItem));
+    int swItem = setItem(rootItem, 2, tr("Software"), tr(""));
+    setItem(swItem, 0, tr("Version"),           swVersion.getSoftwareVersion());
+    setItem(swItem, 1, tr("Last update"),       swUpdate.getLastInstall());
+    setItem(swItem, 2, tr("Pending updates"),   swUpdate.getState());
+    setItem(swItem, 3, tr("Config ID"),         swConfigID.getSoftwareConfigID());
 
     Light::ProductName productName = m_light->productName();
     Light::Manufacturer manufacturer = m_light->manufacturer();
     Light::ProductID productID = m_light->productID();
-    TreeItem* modelItem = new TreeItem({tr("Light model"), tr("")}, rootItem);
-    modelItem->appendChild(new TreeItem({tr("Product name"),    productName.getProductName()},      modelItem));
-    modelItem->appendChild(new TreeItem({tr("Manufacturer"),    manufacturer.getManufacturer()},    modelItem));
-    modelItem->appendChild(new TreeItem({tr("Product ID"),      productID.getProductID()},          modelItem));
+    int modelItem = setItem(rootItem, 3, tr("Light model"), tr(""));
+    setItem(modelItem, 0, tr("Product name"),   productName.getProductName());
+    setItem(modelItem, 1, tr("Manufacturer"),   manufacturer.getManufacturer());
+    setItem(modelItem, 2, tr("Product ID"),     productID.getProductID());
 
     Light::Config config = m_light->config();
-    TreeItem* configItem = new TreeItem({tr("Config"), tr("")}, rootItem);
-    configItem->appendChild(new TreeItem({tr("Archetype"),          config.getArchetype()},                 configItem));
-    configItem->appendChild(new TreeItem({tr("Function"),           config.getFunction()},                  configItem));
-    configItem->appendChild(new TreeItem({tr("Direction"),          config.getDirection()},                 configItem));
-    configItem->appendChild(new TreeItem({tr("Startup mode"),       config.getStartup().getMode()},         configItem));
-    configItem->appendChild(new TreeItem({tr("Startup configured"), config.getStartup().getConfigured()},   configItem));
-
-    rootItem->appendChild(aboutItem);
-    rootItem->appendChild(stateItem);
-    rootItem->appendChild(swItem);
-    rootItem->appendChild(modelItem);
-    rootItem->appendChild(configItem);
+    int configItem = setItem(rootItem, 4, tr("Config"), tr(""));
+    setItem(configItem, 0, tr("Archetype"),             config.getArchetype());
+    setItem(configItem, 1, tr("Function"),              config.getFunction());
+    setItem(configItem, 2, tr("Direction"),             config.getDirection());
+    setItem(configItem, 3, tr("Startup mode"),          config.getStartup().getMode());
+    setItem(configItem, 4, tr("Startup configured"),    config.getStartup().getConfigured());
 }
@@ -2,6 +2,7 @@
 #define HUELIGHTMODEL_H
 
 #include "abstracttreemodel.h"
+#include "../huechangenotifier.h"
 
 class HueLight;
 
@@ -14,9 +15,10 @@ public:
 
 private slots:
     void update();
+    void objectsChanged(const HueChangeNotifier::ChangeSet& changes);
 
 private:
-    void setupModelData(TreeItem* rootItem) override;
+    void updateModelData(const int rootItem) override;
 
 private:
     std::shared_ptr<HueLight> m_light;
@@ -2,50 +2,88 @@
 
 #include "../huelight.h"
 
+#include <QPointF>
+
 HueLightListModel::HueLightListModel(std::shared_ptr<HueLightList> lightList, QObject* parent)
-    : QAbstractListModel(parent)
-    , m_lightList(lightList)
+    : AbstractListModel(parent)
 {
-
+    setLightList(lightList);
 }
 
 HueLightListModel::~HueLightListModel()
 {
-    m_lightList.reset();
+
 }
 
-int HueLightListModel::rowCount(const QModelIndex& parent) const
+QVariant HueLightListModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
-    Q_UNUSED(parent);
-    return m_lightList->size();
+    Q_UNUSED(section);
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
+        return "Lights";
+
+    return QVariant();
 }
 
-QVariant HueLightListModel::data(const QModelIndex &index, int role) const
+QHash<int, QByteArray> HueLightListModel::roleNames() const
 {
-    if (!index.isValid())
-        return QVariant();
+    QHash<int, QByteArray> roles = AbstractListModel::roleNames();
+    roles.insert(IDRole,            "lightID");
+    roles.insert(NameRole,          "name");
+    roles.insert(OnRole,            "on");
+    roles.insert(ReachableRole,     "reachable");
+    roles.insert(BrightnessRole,    "brightness");
+    roles.insert(HueRole,           "hue");
+    roles.insert(SaturationRole,    "saturation");
+    roles.insert(ColorTempRole,     "colorTemp");
+    roles.insert(XYRole,            "xy");
 
-    switch (role) {
-    case Qt::DisplayRole:
-    {
-        auto light = m_lightList->at(index.row());
-        return QString(QString::number(light->ID()) + ": " + light->name().getName());
-    }
-    default:
-        return QVariant();
+    return roles;
+}
+
+void HueLightListModel::setLightList(std::shared_ptr<HueLightList> lightList)
+{
+    ObjectList objects;
+
+    if (lightList != nullptr) {
+        objects.reserve(static_cast<size_t>(lightList->size()));
+        for (int i = 0; i < lightList->size(); i++)
+            objects.push_back(lightList->at(i));
     }
+
+    setObjects(objects);
 }
 
-QVariant HueLightListModel::headerData(int section, Qt::Orientation orientation, int role) const
+void HueLightListModel::appendLight(std::shared_ptr<HueLight> light)
 {
-    Q_UNUSED(section);
-    if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
-        return "Lights";
+    appendObject(light);
+}
 
-    return QVariant();
+bool HueLightListModel::removeLight(const int ID)
+{
+    return removeObject(ID);
 }
 
 std::shared_ptr<HueLight> HueLightListModel::getLight(const QModelIndex &index) const
 {
-    return m_lightList->at(index.row());
+    return std::static_pointer_cast<HueLight>(objectAt(index.row()));
+}
+
+QVector<QVariant> HueLightListModel::roleValues(const HueAbstractObject* object) const
+{
+    const HueLight* light = static_cast<const HueLight*>(object);
+    const QString name = light->name().getName();
+    const Light::State state = light->state();
+
+    return {
+        QString(QString::number(light->ID()) + ": " + name),
+        light->ID(),
+        name,
+        state.isOn(),
+        state.isReachable(),
+        state.getBrightness(),
+        state.getHue(),
+        state.getSaturation(),
+        state.getColorTemp(),
+        QPointF(state.getXValue(), state.getYValue())
+    };
 }
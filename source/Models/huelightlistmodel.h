@@ -1,26 +1,39 @@
 #ifndef HUELIGHTLISTMODEL_H
 #define HUELIGHTLISTMODEL_H
 
-#include <QAbstractListModel>
-
+#include "abstractlistmodel.h"
 #include "../hueobjectlist.h"
 
-class HueLightListModel : public QAbstractListModel
+class HueLightListModel : public AbstractListModel
 {
     Q_OBJECT
 public:
+    enum Role {
+        IDRole = Qt::UserRole + 1,
+        NameRole,
+        OnRole,
+        ReachableRole,
+        BrightnessRole,
+        HueRole,
+        SaturationRole,
+        ColorTempRole,
+        XYRole
+    };
+
     explicit HueLightListModel(std::shared_ptr<HueLightList> lightList, QObject* parent = nullptr);
     ~HueLightListModel() override;
 
-    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
-
-    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void setLightList(std::shared_ptr<HueLightList> lightList);
+    void appendLight(std::shared_ptr<HueLight> light);
+    bool removeLight(const int ID);
 
     std::shared_ptr<HueLight> getLight(const QModelIndex& index) const;
 
 private:
-    std::shared_ptr<HueLightList> m_lightList;
+    QVector<QVariant> roleValues(const HueAbstractObject* object) const override;
 };
 
 #endif // HUELIGHTLISTMODEL_H
@@ -0,0 +1,145 @@
+#include "treestore.h"
+
+// Nodes live in one arena and are addressed by index; node 0 is the root and holds
+// the header data. The parent and row of every node are stored, so navigating up
+// the tree is O(1). Values are stored per column. Removed nodes are reused by
+// later appends, so their indices must not be kept.
+
+TreeStore::TreeStore(const int columnCount)
+    : m_columnCount(columnCount)
+{
+    clear();
+}
+
+void TreeStore::clear()
+{
+    m_nodes.assign(1, {-1, 0});
+    m_children.assign(1, std::vector<int>());
+    m_columns.assign(static_cast<size_t>(m_columnCount), std::vector<QVariant>(1));
+    m_freeNodes.clear();
+}
+
+void TreeStore::reserve(const int nodeCount)
+{
+    const size_t size = static_cast<size_t>(nodeCount);
+
+    m_nodes.reserve(size);
+    m_children.reserve(size);
+    for (auto& column : m_columns)
+        column.reserve(size);
+}
+
+int TreeStore::root() const
+{
+    return 0;
+}
+
+int TreeStore::appendChild(const int parent, const QVector<QVariant>& data)
+{
+    const Node node = {parent, childCount(parent)};
+    int index;
+
+    if (!m_freeNodes.empty()) {
+        index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        m_nodes[static_cast<size_t>(index)] = node;
+    }
+    else {
+        index = static_cast<int>(m_nodes.size());
+        m_nodes.push_back(node);
+        m_children.emplace_back();
+        for (auto& column : m_columns)
+            column.emplace_back();
+    }
+
+    for (int column = 0; column < m_columnCount; column++)
+        m_columns[static_cast<size_t>(column)][static_cast<size_t>(index)] = data.value(column);
+
+    m_children[static_cast<size_t>(parent)].push_back(index);
+
+    return index;
+}
+
+void TreeStore::removeChildren(const int parent, const int position, const int count)
+{
+    std::vector<int>& siblings = m_children[static_cast<size_t>(parent)];
+
+    if (position < 0 || count <= 0 || position + count > static_cast<int>(siblings.size()))
+        return;
+
+    for (int i = position; i < position + count; i++)
+        releaseNode(siblings[static_cast<size_t>(i)]);
+
+    siblings.erase(siblings.begin() + position, siblings.begin() + position + count);
+
+    for (size_t i = static_cast<size_t>(position); i < siblings.size(); i++)
+        m_nodes[static_cast<size_t>(siblings[i])].row = static_cast<int>(i);
+}
+
+int TreeStore::child(const int parent, const int row) const
+{
+    const std::vector<int>& siblings = m_children[static_cast<size_t>(parent)];
+
+    if (row < 0 || row >= static_cast<int>(siblings.size()))
+        return -1;
+
+    return siblings[static_cast<size_t>(row)];
+}
+
+int TreeStore::childCount(const int node) const
+{
+    return static_cast<int>(m_children[static_cast<size_t>(node)].size());
+}
+
+int TreeStore::parent(const int node) const
+{
+    return m_nodes[static_cast<size_t>(node)].parent;
+}
+
+int TreeStore::row(const int node) const
+{
+    return m_nodes[static_cast<size_t>(node)].row;
+}
+
+int TreeStore::nodeCount() const
+{
+    return static_cast<int>(m_nodes.size() - m_freeNodes.size());
+}
+
+int TreeStore::columnCount() const
+{
+    return m_columnCount;
+}
+
+QVariant TreeStore::data(const int node, const int column) const
+{
+    if (column < 0 || column >= m_columnCount)
+        return QVariant();
+
+    return m_columns[static_cast<size_t>(column)][static_cast<size_t>(node)];
+}
+
+bool TreeStore::setData(const int node, const int column, const QVariant& value)
+{
+    if (column < 0 || column >= m_columnCount)
+        return false;
+
+    QVariant& current = m_columns[static_cast<size_t>(column)][static_cast<size_t>(node)];
+    if (current == value)
+        return false;
+
+    current = value;
+    return true;
+}
+
+void TreeStore::releaseNode(const int node)
+{
+    for (const int child : m_children[static_cast<size_t>(node)])
+        releaseNode(child);
+
+    m_children[static_cast<size_t>(node)].clear();
+    for (auto& column : m_columns)
+        column[static_cast<size_t>(node)] = QVariant();
+
+    m_freeNodes.push_back(node);
+}
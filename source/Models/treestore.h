@@ -0,0 +1,46 @@
+#ifndef TREESTORE_H
+#define TREESTORE_H
+
+#include <QVariant>
+#include <QVector>
+#include <vector>
+
+class TreeStore
+{
+public:
+    explicit TreeStore(const int columnCount = 2);
+
+    void clear();
+    void reserve(const int nodeCount);
+
+    int root() const;
+    int appendChild(const int parent, const QVector<QVariant>& data);
+    void removeChildren(const int parent, const int position, const int count);
+
+    int child(const int parent, const int row) const;
+    int childCount(const int node) const;
+    int parent(const int node) const;
+    int row(const int node) const;
+    int nodeCount() const;
+
+    int columnCount() const;
+    QVariant data(const int node, const int column) const;
+    bool setData(const int node, const int column, const QVariant& value);
+
+private:
+    void releaseNode(const int node);
+
+private:
+    struct Node {
+        int parent;
+        int row;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<std::vector<int>> m_children;
+    std::vector<std::vector<QVariant>> m_columns;
+    std::vector<int> m_freeNodes;
+    int m_columnCount;
+};
+
+#endif // TREESTORE_H
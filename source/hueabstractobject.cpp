@@ -1,11 +1,79 @@
 #include "hueabstractobject.h"
 
 #include <QJsonArray>
+#include <algorithm>
 
 #include "huebridge.h"
 #include "huerequest.h"
 #include "huereply.h"
 #include "huesynchronizer.h"
+#include "huestatechange.h"
+#include "huechangenotifier.h"
+#include "huejsonreader.h"
+
+#include <QTimer>
+
+struct HueAbstractObject::PendingUpdate {
+    HueStateChange change;
+    HueStateChange rollback;
+};
+
+namespace {
+const int allAttributes = HueStateChange::OnAttribute
+        | HueStateChange::BrightnessAttribute
+        | HueStateChange::HueAttribute
+        | HueStateChange::SaturationAttribute
+        | HueStateChange::ColorTempAttribute
+        | HueStateChange::XYAttribute
+        | HueStateChange::AlertAttribute
+        | HueStateChange::EffectAttribute;
+
+// Returns change with only the given attributes
+HueStateChange withAttributes(HueStateChange change, const int attributes)
+{
+    for (int attribute = HueStateChange::OnAttribute; attribute & allAttributes; attribute <<= 1) {
+        if (!(attributes & attribute))
+            change.clear(static_cast<HueStateChange::Attribute>(attribute));
+    }
+
+    return change;
+}
+
+// Sets the attributes of from on into; later values replace earlier ones
+void mergeChange(HueStateChange& into, const HueStateChange& from)
+{
+    if (from.has(HueStateChange::OnAttribute))
+        into.setOn(from.isOn());
+    if (from.has(HueStateChange::BrightnessAttribute))
+        into.setBrightness(from.getBrightness());
+    if (from.has(HueStateChange::HueAttribute))
+        into.setHue(from.getHue());
+    if (from.has(HueStateChange::SaturationAttribute))
+        into.setSaturation(from.getSaturation());
+    if (from.has(HueStateChange::ColorTempAttribute))
+        into.setColorTemp(from.getColorTemp());
+    if (from.has(HueStateChange::XYAttribute))
+        into.setXY(from.getXValue(), from.getYValue());
+    if (from.has(HueStateChange::AlertAttribute))
+        into.setAlert(from.getAlert());
+    if (from.has(HueStateChange::EffectAttribute))
+        into.setEffect(from.getEffect());
+    if (from.hasTransitionTime())
+        into.setTransitionTime(from.getTransitionTime());
+}
+
+HueError errorOfReply(const HueReply& reply, const HueRequest& request)
+{
+    if (!reply.getErrors().isEmpty())
+        return reply.getErrors().first();
+
+    if (reply.containsError())
+        return reply.getError();
+
+    return HueError(-1, "/" + request.getUrlPath(),
+                    reply.timedOut() ? "request timed out" : "invalid reply");
+}
+}
 
 
 /*!
@@ -46,6 +114,17 @@
  *      Hue continuously changes value.
  */
 
+/*!
+ * \enum HueAbstractObject::HueObjectKind
+ * This enum identifies the derived class of an object, see \l objectKind().
+ *
+ * \value LightKind
+ *      The object is a \l HueLight.
+ *
+ * \value GroupKind
+ *      The object is a \l HueGroup.
+ */
+
 /*!
  * \fn HueAbstractObject::HueAbstractObject(HueBridge* bridge)
  *
@@ -58,6 +137,12 @@
 HueAbstractObject::HueAbstractObject(HueBridge* bridge)
     : QObject(nullptr)
     , m_bridge(bridge)
+    , m_perceptualFilter()
+    , m_holdNotifications(false)
+    , m_heldAttributes(0)
+    , m_optimistic(false)
+    , m_sendingUpdates(false)
+    , m_queuedUpdate()
 {
 
 }
@@ -73,17 +158,10 @@ HueAbstractObject::HueAbstractObject(HueBridge* bridge)
  */
 bool HueAbstractObject::turnOn(const bool on)
 {
-    QJsonObject json {
-        {"on", on}
-    };
-
-    HueRequest request = makePutRequest(json);
-    bool updateSuccessful = sendRequest(request);
+    HueStateChange change;
+    change.setOn(on);
 
-    if (updateSuccessful)
-        updateOn(on);
-
-    return updateSuccessful;
+    return setState(change);
 }
 
 /*!
@@ -97,17 +175,10 @@ bool HueAbstractObject::turnOn(const bool on)
  */
 bool HueAbstractObject::turnOff(const bool off)
 {
-    QJsonObject json {
-        {"on", !off}
-    };
-
-    HueRequest request = makePutRequest(json);
-    bool updateSuccessful = sendRequest(request);
+    HueStateChange change;
+    change.setOn(!off);
 
-    if (updateSuccessful)
-        updateOn(!off);
-
-    return updateSuccessful;
+    return setState(change);
 }
 
 /*!
@@ -123,17 +194,10 @@ bool HueAbstractObject::turnOff(const bool off)
  */
 bool HueAbstractObject::setHue(const int hue)
 {
-    QJsonObject json {
-        {"hue", hue}
-    };
-
-    HueRequest request = makePutRequest(json);
-    bool updateSuccessful = sendRequest(request);
+    HueStateChange change;
+    change.setHue(hue);
 
-    if (updateSuccessful)
-        updateHue(hue);
-
-    return updateSuccessful;
+    return setState(change);
 }
 
 /*!
@@ -149,17 +213,10 @@ bool HueAbstractObject::setHue(const int hue)
  */
 bool HueAbstractObject::setSaturation(const int saturation)
 {
-    QJsonObject json {
-        {"sat", saturation}
-    };
-
-    HueRequest request = makePutRequest(json);
-    bool updateSuccessful = sendRequest(request);
+    HueStateChange change;
+    change.setSaturation(saturation);
 
-    if (updateSuccessful)
-        updateSaturation(saturation);
-
-    return updateSuccessful;
+    return setState(change);
 }
 
 /*!
@@ -169,22 +226,18 @@ bool HueAbstractObject::setSaturation(const int saturation)
  *
  * Range for \a brightness is 1 - 254.
  *
- * Returns true if update was successful.
+ * Returns true if update was successful. If the perceptual filter is enabled
+ * and the change is too small to be seen, nothing is sent and \c true is returned.
+ *
+ * \sa enablePerceptualFilter()
  *
  */
 bool HueAbstractObject::setBrightness(const int brightness)
 {
-    QJsonObject json {
-        {"bri", brightness}
-    };
-
-    HueRequest request = makePutRequest(json);
-    bool updateSuccessful = sendRequest(request);
-
-    if (updateSuccessful)
-        updateBrightness(brightness);
+    HueStateChange change;
+    change.setBrightness(brightness);
 
-    return updateSuccessful;
+    return setState(change);
 }
 
 /*!
@@ -195,22 +248,18 @@ bool HueAbstractObject::setBrightness(const int brightness)
  * Range for \a colorTemp is 150 - 500 which corresponds
  * to 6500K - 2000K.
  *
- * Returns true if update was successful.
+ * Returns true if update was successful. If the perceptual filter is enabled
+ * and the change is too small to be seen, nothing is sent and \c true is returned.
+ *
+ * \sa enablePerceptualFilter()
  *
  */
 bool HueAbstractObject::setColorTemp(const int colorTemp)
 {
-    QJsonObject json {
-        {"ct", colorTemp}
-    };
-
-    HueRequest request = makePutRequest(json);
-    bool updateSuccessful = sendRequest(request);
-
-    if (updateSuccessful)
-        updateColorTemp(colorTemp);
+    HueStateChange change;
+    change.setColorTemp(colorTemp);
 
-    return updateSuccessful;
+    return setState(change);
 }
 
 /*!
@@ -221,23 +270,18 @@ bool HueAbstractObject::setColorTemp(const int colorTemp)
  *
  * Range for \a x and \a y is 0.0 - 1.0.
  *
- * Returns true if update was successful.
+ * Returns true if update was successful. If the perceptual filter is enabled
+ * and the change is too small to be seen, nothing is sent and \c true is returned.
+ *
+ * \sa enablePerceptualFilter()
  *
  */
 bool HueAbstractObject::setXY(const double x, const double y)
 {
-    QJsonArray xy = {x, y};
-    QJsonObject json {
-        {"ct", xy}
-    };
-
-    HueRequest request = makePutRequest(json);
-    bool updateSuccessful = sendRequest(request);
-
-    if (updateSuccessful)
-        updateXY(x, y);
+    HueStateChange change;
+    change.setXY(x, y);
 
-    return updateSuccessful;
+    return setState(change);
 }
 
 /*!
@@ -252,32 +296,10 @@ bool HueAbstractObject::setXY(const double x, const double y)
  */
 bool HueAbstractObject::setAlert(const HueAlert alert)
 {
-    QJsonObject json;
-    switch (alert) {
-    case NoAlert:
-        json = {
-            {"alert", "none"}
-        };
-        break;
-    case BreatheSingle:
-        json = {
-            {"alert", "select"}
-        };
-        break;
-    case Breathe15Sec:
-        json = {
-            {"alert", "lselect"}
-        };
-        break;
-    }
-
-    HueRequest request = makePutRequest(json);
-    bool updateSuccessful = sendRequest(request);
+    HueStateChange change;
+    change.setAlert(alert);
 
-    if (updateSuccessful)
-        updateAlert(alert);
-
-    return updateSuccessful;
+    return setState(change);
 }
 
 /*!
@@ -292,35 +314,92 @@ bool HueAbstractObject::setAlert(const HueAlert alert)
  */
 bool HueAbstractObject::setEffect(const HueEffect effect)
 {
-    QJsonObject json;
-    switch (effect) {
-    case NoEffect:
-        json = {
-            {"effect", "none"}
-        };
-        break;
-    case ColorLoop:
-        json = {
-            {"effect", "colorloop"}
-        };
-        break;
+    HueStateChange change;
+    change.setEffect(effect);
+
+    return setState(change);
+}
+
+/*!
+ * \fn bool HueAbstractObject::setState(const HueStateChange& state)
+ *
+ * Changes all attributes contained in \a state with a single request to the bridge.
+ * If \a state has a transition time, the bridge fades to the new state over that time.
+ *
+ * Values are first clamped or converted by \l constrainState() to what the object
+ * can show. If none of the attributes in \a state can be shown, no request is made
+ * and \c false is returned.
+ *
+ * When the perceptual filter is enabled, brightness, color temperature and \e xy
+ * changes that are too small to be seen are removed from the request. If nothing
+ * is left to send, no request is made and \c true is returned.
+ *
+ * Only the values the bridge accepts are applied to the object. If the bridge
+ * rejects some of them, or the request fails, \l updateFailed() is emitted.
+ *
+ * With optimistic updates enabled, the change is applied right away and the
+ * request is sent from the event loop; \c true is returned without waiting for
+ * the bridge.
+ *
+ * Returns true if the bridge applied the change, or some of its values.
+ *
+ * \sa HueStateChange, constrainState(), enablePerceptualFilter(), enableOptimisticUpdates()
+ *
+ */
+bool HueAbstractObject::setState(const HueStateChange& state)
+{
+    HueStateChange change = constrainState(state);
+
+    // Nothing in the change can be shown by the object
+    if (change.isEmpty() && !state.isEmpty())
+        return false;
+
+    if (change.has(HueStateChange::BrightnessAttribute)
+            && !m_perceptualFilter.acceptBrightness(change.getBrightness()))
+        change.clear(HueStateChange::BrightnessAttribute);
+
+    if (change.has(HueStateChange::ColorTempAttribute)
+            && !m_perceptualFilter.acceptColorTemp(change.getColorTemp()))
+        change.clear(HueStateChange::ColorTempAttribute);
+
+    if (change.has(HueStateChange::XYAttribute)
+            && !m_perceptualFilter.acceptXY(change.getXValue(), change.getYValue()))
+        change.clear(HueStateChange::XYAttribute);
+
+    if (change.isEmpty())
+        return true;
+
+    if (m_optimistic) {
+        queueUpdate(change);
+        return true;
     }
 
-    HueRequest request = makePutRequest(json);
-    bool updateSuccessful = sendRequest(request);
+    HueRequest request = makePutRequest(change.toJson());
+    HueReply reply;
+    sendRequest(request, reply);
+
+    // The bridge can apply some of the values and reject the rest
+    const int failed = reply.rejectedAttributes(change);
+    const HueStateChange accepted = withAttributes(change, change.attributes() & ~failed);
+
+    if (!accepted.isEmpty()) {
+        applyStateChange(accepted);
+        propagateStateChange(accepted);
+    }
 
-    if (updateSuccessful)
-        updateEffect(effect);
+    if (failed != 0)
+        emit updateFailed(errorOfReply(reply, request));
 
-    return updateSuccessful;
+    return !accepted.isEmpty();
 }
 
 /*!
  * \fn void HueAbstractObject::enablePeriodicSync(const bool periodicSyncOn)
  *
  * Enables or disables periodic synchronization with bridge as specified by
- * \a periodicSyncOn. The synchronization interval can be set by the static
- * function \l HueSynchronizer::setSyncInterval().
+ * \a periodicSyncOn. Objects are synchronized by the \l HueSynchronizer of their
+ * bridge, which adapts the interval of each object to how often it changes.
+ * The base interval can be set by the static function \l HueSynchronizer::setSyncInterval().
  *
  * \sa HueSynchronizer
  *
@@ -331,41 +410,213 @@ void HueAbstractObject::enablePeriodicSync(const bool periodicSyncOn)
         return;
 
     if (periodicSyncOn) {
-        m_synchronizer->instance().addHueObject(shared_from_this());
+        HueSynchronizer::forBridge(m_bridge).addHueObject(shared_from_this());
     }
     else {
-        m_synchronizer->instance().removeHueObject(shared_from_this());
+        HueSynchronizer::forBridge(m_bridge).removeHueObject(shared_from_this());
+    }
+}
+
+/*!
+ * \fn void HueAbstractObject::enablePerceptualFilter(const bool filterOn)
+ *
+ * Enables or disables the perceptual filter as specified by \a filterOn.
+ *
+ * When enabled, \l setBrightness(), \l setColorTemp() and \l setXY() compare
+ * the requested value with the last value sent to the bridge, and drop changes
+ * that are too small to be seen. This frees bridge throughput for visible changes,
+ * e.g. during animations.
+ *
+ * \sa setPerceptualThreshold(), HuePerceptualFilter
+ *
+ */
+void HueAbstractObject::enablePerceptualFilter(const bool filterOn)
+{
+    m_perceptualFilter.setEnabled(filterOn);
+}
+
+/*!
+ * \fn void HueAbstractObject::setPerceptualThreshold(const double deltaE, const int colorTempMired)
+ *
+ * Sets the thresholds used by the perceptual filter. Changes to \e xy or brightness
+ * below \a deltaE (CIE76 \e {Delta E}) and changes to color temperature below
+ * \a colorTempMired are dropped.
+ *
+ * \sa enablePerceptualFilter(), HuePerceptualFilter
+ *
+ */
+void HueAbstractObject::setPerceptualThreshold(const double deltaE, const int colorTempMired)
+{
+    m_perceptualFilter.setColorThreshold(deltaE);
+    m_perceptualFilter.setColorTempThreshold(colorTempMired);
+}
+
+/*!
+ * \fn void HueAbstractObject::enableOptimisticUpdates(const bool optimisticOn)
+ *
+ * Enables or disables optimistic updates as specified by \a optimisticOn.
+ *
+ * When enabled, the \e set functions apply the change to the object and emit
+ * \l valueUpdated() right away, and the request is sent when control returns to
+ * the event loop. Changes made before the request is sent are merged into it.
+ * If the bridge rejects the request, or some of its values, or does not reply in
+ * time, those values are set back to what they were and \l updateFailed() is
+ * emitted. Alerts and effects are not set back; the next synchronization
+ * corrects them.
+ *
+ * Disabling optimistic updates sends any queued change before returning.
+ *
+ * \sa hasPendingUpdates(), updateFailed()
+ *
+ */
+void HueAbstractObject::enableOptimisticUpdates(const bool optimisticOn)
+{
+    m_optimistic = optimisticOn;
+
+    if (!m_optimistic && m_queuedUpdate != nullptr)
+        sendPendingUpdates();
+}
+
+/*!
+ * \fn bool HueAbstractObject::isOptimistic() const
+ *
+ * Returns \c true if optimistic updates are enabled.
+ *
+ * \sa enableOptimisticUpdates()
+ *
+ */
+bool HueAbstractObject::isOptimistic() const
+{
+    return m_optimistic;
+}
+
+/*!
+ * \fn bool HueAbstractObject::hasPendingUpdates() const
+ *
+ * Returns \c true if an optimistic change has been applied to the object but
+ * not yet confirmed by the bridge. \l HueSynchronizer does not synchronize the
+ * object until it has been.
+ *
+ * \sa enableOptimisticUpdates()
+ *
+ */
+bool HueAbstractObject::hasPendingUpdates() const
+{
+    return m_queuedUpdate != nullptr || m_sendingUpdates;
+}
+
+// Applies change right away and queues the request, remembering the previous
+// values of its attributes in case the bridge rejects it
+void HueAbstractObject::queueUpdate(const HueStateChange& change)
+{
+    const HueStateChange rollback = withAttributes(currentState(), change.attributes());
+    applyStateChange(change);
+
+    if (m_queuedUpdate != nullptr) {
+        // Attributes that are already queued keep their oldest value
+        mergeChange(m_queuedUpdate->rollback,
+                    withAttributes(rollback, rollback.attributes() & ~m_queuedUpdate->change.attributes()));
+        mergeChange(m_queuedUpdate->change, change);
+        return;
+    }
+
+    m_queuedUpdate = std::make_shared<PendingUpdate>();
+    m_queuedUpdate->change = change;
+    m_queuedUpdate->rollback = rollback;
+
+    if (!m_sendingUpdates)
+        QTimer::singleShot(0, this, &HueAbstractObject::sendPendingUpdates);
+}
+
+void HueAbstractObject::sendPendingUpdates()
+{
+    // Sending blocks in a local event loop, in which more changes can be queued;
+    // they are sent by the loop below
+    if (m_sendingUpdates)
+        return;
+
+    m_sendingUpdates = true;
+
+    while (m_queuedUpdate != nullptr) {
+        const std::shared_ptr<PendingUpdate> update = m_queuedUpdate;
+        m_queuedUpdate.reset();
+
+        HueRequest request = makePutRequest(update->change.toJson());
+        HueReply reply;
+        sendRequest(request, reply);
+
+        const int failed = reply.rejectedAttributes(update->change);
+        const HueStateChange accepted = withAttributes(update->change, update->change.attributes() & ~failed);
+
+        if (!accepted.isEmpty())
+            propagateStateChange(accepted);
+
+        if (failed == 0)
+            continue;
+
+        HueStateChange rollback = withAttributes(update->rollback, failed);
+
+        // Values changed again since are left alone, but set back if that change fails too
+        if (m_queuedUpdate != nullptr) {
+            const int overwritten = rollback.attributes() & m_queuedUpdate->change.attributes();
+            mergeChange(m_queuedUpdate->rollback, withAttributes(rollback, overwritten));
+            rollback = withAttributes(rollback, rollback.attributes() & ~overwritten);
+        }
+
+        if (!rollback.isEmpty())
+            applyStateChange(rollback);
+
+        emit updateFailed(errorOfReply(reply, request));
     }
+
+    m_sendingUpdates = false;
 }
 
 /*!
- * \fn QMap<int, QJsonObject> HueAbstractObject::parseJson(QJsonObject json)
+ * \fn std::vector<HueAbstractObject::JsonEntry> HueAbstractObject::parseJson(const QByteArray& json)
  *
- * Parses the JSON specified by \a json received when calling \e discover functions
+ * Parses the raw JSON specified by \a json received when calling \e discover functions
  * implemented on the derived classes.
  *
- * Returns a \e QMap where the key is an \c int with the ID and the value
- * is a \e QJsonObject containing the JSON for the object with the corresponding
- * ID.
+ * Returns a table of \e JsonEntry sorted by ID, where each entry holds the ID and
+ * the offset and length in \a json of the object with that ID. The objects themselves
+ * are skipped, not parsed, so they can be read independently of each other. IDs do not
+ * have to be consecutive (e.g. 1, 2 and 5 after lights 3 and 4 were deleted). Keys
+ * that are not numeric IDs are skipped. An empty table is returned if \a json is not
+ * a valid JSON object.
  *
  * \note should not be called explicitly.
  *
  * \sa HueLight::discoverLights(), HueGroup::discoverGroups()
  *
  */
-QMap<int, QJsonObject> HueAbstractObject::parseJson(QJsonObject json)
+std::vector<HueAbstractObject::JsonEntry> HueAbstractObject::parseJson(const QByteArray& json)
 {
-    QMap<int, QJsonObject> map;
+    std::vector<JsonEntry> table;
+    HueJsonReader reader(json);
+
+    if (!reader.beginObject())
+        return table;
 
-    int id = 1;
-    QJsonValue jsonVal;
+    while (reader.readNextKey()) {
+        bool isID = false;
+        const int ID = reader.keyToInt(&isID);
+        const int offset = reader.offset();
 
-    while ((jsonVal = json.value(QString::number(id))) != QJsonValue::Undefined) {
-        map.insert(id, jsonVal.toObject());
-        id++;
+        reader.skipValue();
+
+        if (isID && reader.tokenType() == HueJsonReader::EndObject)
+            table.push_back(JsonEntry{ID, offset, reader.offset() - offset});
     }
 
-    return map;
+    if (reader.hasError())
+        return std::vector<JsonEntry>();
+
+    // Keys are not necessarily ordered by ID ("10" before "2")
+    std::sort(table.begin(), table.end(),
+              [](const JsonEntry& lhs, const JsonEntry& rhs) { return lhs.ID < rhs.ID; });
+
+    return table;
 }
 
 /*!
@@ -439,6 +690,159 @@ HueBridge* HueAbstractObject::getBridge() const
     return m_bridge;
 }
 
+/*!
+ * \fn void HueAbstractObject::applyStateChange(const HueStateChange& change)
+ *
+ * Updates the local state of the object with the attributes in \a change
+ * by calling the corresponding \e update functions. \l valueUpdated() is emitted
+ * once for the whole change.
+ *
+ * \note should not be called explicitly.
+ *
+ */
+void HueAbstractObject::applyStateChange(const HueStateChange& change)
+{
+    m_holdNotifications = true;
+
+    if (change.has(HueStateChange::OnAttribute))
+        updateOn(change.isOn());
+
+    if (change.has(HueStateChange::BrightnessAttribute)) {
+        m_perceptualFilter.commitBrightness(change.getBrightness());
+        updateBrightness(change.getBrightness());
+    }
+
+    // The bridge gives xy priority over ct, and ct over hue and saturation
+    if (change.has(HueStateChange::HueAttribute) || change.has(HueStateChange::SaturationAttribute))
+        m_perceptualFilter.commitHueSaturation();
+
+    if (change.has(HueStateChange::HueAttribute))
+        updateHue(change.getHue());
+
+    if (change.has(HueStateChange::SaturationAttribute))
+        updateSaturation(change.getSaturation());
+
+    if (change.has(HueStateChange::ColorTempAttribute)) {
+        m_perceptualFilter.commitColorTemp(change.getColorTemp());
+        updateColorTemp(change.getColorTemp());
+    }
+
+    if (change.has(HueStateChange::XYAttribute)) {
+        m_perceptualFilter.commitXY(change.getXValue(), change.getYValue());
+        updateXY(change.getXValue(), change.getYValue());
+    }
+
+    if (change.has(HueStateChange::AlertAttribute))
+        updateAlert(change.getAlert());
+
+    if (change.has(HueStateChange::EffectAttribute))
+        updateEffect(change.getEffect());
+
+    m_holdNotifications = false;
+
+    if (m_heldAttributes != 0) {
+        const int attributes = m_heldAttributes;
+        m_heldAttributes = 0;
+        notifyUpdated(attributes);
+    }
+}
+
+/*!
+ * \fn void HueAbstractObject::propagateStateChange(const HueStateChange& change)
+ *
+ * Called by \l setState() after \a change has been sent to the bridge and applied
+ * to the object. Derived classes can reimplement it to update the local state of
+ * other objects the change affects; \l HueGroup updates its member lights.
+ * The default implementation does nothing.
+ *
+ */
+void HueAbstractObject::propagateStateChange(const HueStateChange& change)
+{
+    Q_UNUSED(change)
+}
+
+/*!
+ * \fn void HueAbstractObject::notifyUpdated(const int attributes)
+ *
+ * Emits \l valueUpdated() and records the changed \a attributes (a combination of
+ * \l HueStateChange::Attribute values) with \l HueChangeNotifier. Must be called
+ * by the \e update functions of derived classes.
+ *
+ * \note should not be called explicitly.
+ *
+ */
+void HueAbstractObject::notifyUpdated(const int attributes)
+{
+    if (m_holdNotifications) {
+        m_heldAttributes |= attributes;
+        return;
+    }
+
+    HueChangeNotifier::instance().markChanged(this, attributes, false);
+    emit valueUpdated();
+}
+
+/*!
+ * \fn void HueAbstractObject::notifySynchronized()
+ *
+ * Emits \l synchronized() and records the synchronization with \l HueChangeNotifier.
+ * Must be called by \l synchronize() of derived classes.
+ *
+ * \note should not be called explicitly.
+ *
+ */
+void HueAbstractObject::notifySynchronized()
+{
+    HueChangeNotifier::instance().markChanged(this, 0, true);
+    emit synchronized();
+}
+
+/*!
+ * \fn void HueAbstractObject::resetPerceptualFilter()
+ *
+ * Forgets the values last sent through the perceptual filter. Should be called
+ * after the object has been synchronized, since the bridge state may have been
+ * changed by someone else.
+ *
+ * \note should not be called explicitly.
+ *
+ */
+void HueAbstractObject::resetPerceptualFilter()
+{
+    m_perceptualFilter.reset();
+}
+
+/*!
+ * \fn HueStateChange HueAbstractObject::constrainState(const HueStateChange& change) const
+ *
+ * Returns \a change with every value clamped to the range accepted by the bridge.
+ * Called by \l setState() before a change is sent. Reimplemented by \l HueLight
+ * to also account for the \l Light::Capabilities of the light.
+ *
+ */
+HueStateChange HueAbstractObject::constrainState(const HueStateChange& change) const
+{
+    HueStateChange constrained = change;
+
+    if (constrained.has(HueStateChange::BrightnessAttribute))
+        constrained.setBrightness(qBound(1, constrained.getBrightness(), 254));
+
+    if (constrained.has(HueStateChange::HueAttribute))
+        constrained.setHue(qBound(0, constrained.getHue(), 65535));
+
+    if (constrained.has(HueStateChange::SaturationAttribute))
+        constrained.setSaturation(qBound(0, constrained.getSaturation(), 254));
+
+    if (constrained.has(HueStateChange::ColorTempAttribute))
+        constrained.setColorTemp(qBound(153, constrained.getColorTemp(), 500));
+
+    if (constrained.has(HueStateChange::XYAttribute))
+        constrained.setXY(qBound(0.0, constrained.getXValue(), 1.0),
+                          qBound(0.0, constrained.getYValue(), 1.0));
+
+    return constrained;
+}
+
 /*!
  * \fn virtual ~HueAbstractObject()
  *
@@ -494,6 +898,16 @@ HueBridge* HueAbstractObject::getBridge() const
  *
  */
 
+/*!
+ * \fn virtual HueObjectKind HueAbstractObject::objectKind() const
+ *
+ * Pure virtual function. Must be overloaded.
+ *
+ * Should return the kind of the object. Allows telling lights and groups apart
+ * without \c dynamic_cast.
+ *
+ */
+
 /*!
  * \fn virtual bool HueAbstractObject::synchronize()
  *
@@ -505,6 +919,28 @@ HueBridge* HueAbstractObject::getBridge() const
  *
  */
 
+/*!
+ * \fn virtual HueStateChange HueAbstractObject::currentState() const
+ *
+ * Pure virtual function. Must be overloaded.
+ *
+ * Should return the last known state of the object as a \l HueStateChange.
+ * Used by \l HueAnimation::fade() as the starting point of a fade.
+ *
+ */
+
+/*!
+ * \fn bool HueAbstractObject::isReachable() const
+ *
+ * Returns true if the bridge can reach the object. Objects without a reachable
+ * state, such as groups, are always reachable.
+ *
+ */
+bool HueAbstractObject::isReachable() const
+{
+    return true;
+}
+
 /*!
  * \fn virtual void HueAbstractObject::updateOn(const bool on)
  *
@@ -519,7 +955,8 @@ HueBridge* HueAbstractObject::getBridge() const
  *
  * Pure virtual function. Must be overloaded.
  *
- * Should set \e hue property of object as specified by \a hue.
+ * Should set \e hue property of object as specified by \a hue, and the color
+ * mode to hue and saturation.
  *
  */
 
@@ -528,7 +965,8 @@ HueBridge* HueAbstractObject::getBridge() const
  *
  * Pure virtual function. Must be overloaded.
  *
- * Should set \e saturation property of object as specified by \a saturation.
+ * Should set \e saturation property of object as specified by \a saturation,
+ * and the color mode to hue and saturation.
  *
  */
 
@@ -546,7 +984,8 @@ HueBridge* HueAbstractObject::getBridge() const
  *
  * Pure virtual function. Must be overloaded.
  *
- * Should set \e colorTemp property of object as specified by \a colorTemp.
+ * Should set \e colorTemp property of object as specified by \a colorTemp, and
+ * the color mode to color temperature.
  *
  */
 
@@ -555,7 +994,8 @@ HueBridge* HueAbstractObject::getBridge() const
  *
  * Pure virtual function. Must be overloaded.
  *
- * Should set \e x and \e y properties of object as specified by \a x and \a y.
+ * Should set \e x and \e y properties of object as specified by \a x and \a y,
+ * and the color mode to \e xy.
  *
  */
 
@@ -581,7 +1021,7 @@ HueBridge* HueAbstractObject::getBridge() const
  * \fn void HueAbstractObject::synchronized()
  *
  * Signal should be emitted from object of derived class after object has been
- * successfully synchronized.
+ * successfully synchronized, through \l notifySynchronized().
  *
  * \sa HueLight::synchronize(), HueGroup::synchronize()
  *
@@ -591,6 +1031,22 @@ HueBridge* HueAbstractObject::getBridge() const
  * \fn void HueAbstractObject::valueUpdated()
  *
  * Signal should be emitted from object of derived class after object has been
- * updated.
+ * updated, through \l notifyUpdated().
+ *
+ * To handle the changes of many objects at once, connect to
+ * \l HueChangeNotifier::changed() instead.
+ *
+ */
+
+/*!
+ * \fn void HueAbstractObject::updateFailed(const HueError& error)
+ *
+ * This signal is emitted when the bridge rejects a change made by a \e set
+ * function, or some of its values, or does not reply in time. \a error is the
+ * first error in the reply; for a missing or invalid reply its type is -1.
+ * With optimistic updates enabled, the rejected values have been set back when
+ * the signal is emitted.
+ *
+ * \sa enableOptimisticUpdates()
  *
  */
@@ -2,18 +2,26 @@
 #define HUEABSTRACTOBJECT_H
 
 #include <QObject>
+#include <QJsonObject>
 #include <memory>
+#include <vector>
+
+#include "hueperceptualfilter.h"
+#include "hueerror.h"
 
 class HueBridge;
 class HueRequest;
 class HueReply;
 class HueSynchronizer;
+class HueStateChange;
 
 class HueAbstractObject
         : public QObject
         , public std::enable_shared_from_this<HueAbstractObject>
 {
     Q_OBJECT
+    friend class HueEventStream;
+
 public:
     enum HueAlert {
         NoAlert,
@@ -24,6 +32,10 @@ public:
         NoEffect,
         ColorLoop
     };
+    enum HueObjectKind {
+        LightKind,
+        GroupKind
+    };
     explicit HueAbstractObject(HueBridge* bridge);
     virtual ~HueAbstractObject() {}
 
@@ -36,25 +48,46 @@ public:
     bool setXY(const double x, const double y);
     bool setAlert(const HueAlert alert);
     bool setEffect(const HueEffect effect);
+    bool setState(const HueStateChange& state);
 
     void enablePeriodicSync(const bool periodicSyncOn = true);
+    void enablePerceptualFilter(const bool filterOn = true);
+    void setPerceptualThreshold(const double deltaE, const int colorTempMired);
+    void enableOptimisticUpdates(const bool optimisticOn = true);
+    bool isOptimistic() const;
+    bool hasPendingUpdates() const;
 
     virtual bool hasValidConstructor() const = 0;
     virtual bool isValid() const = 0;
     virtual int ID() const = 0;
+    virtual HueObjectKind objectKind() const = 0;
     virtual bool synchronize() = 0;
+    virtual HueStateChange currentState() const = 0;
+    virtual bool isReachable() const;
 
 protected:
     void setBridge(HueBridge* bridge);
     HueBridge* getBridge() const;
+    void resetPerceptualFilter();
+    void applyStateChange(const HueStateChange& change);
+    void notifyUpdated(const int attributes);
+    void notifySynchronized();
+
+    struct JsonEntry {
+        int ID;
+        int offset;
+        int length;
+    };
 
-    static QMap<int, QJsonObject> parseJson(QJsonObject json);
+    static std::vector<JsonEntry> parseJson(const QByteArray& json);
 
     bool sendRequest(HueRequest request);
     bool sendRequest(HueRequest request, HueReply& reply);
 
     virtual HueRequest makePutRequest(QJsonObject json) = 0;
     virtual HueRequest makeGetRequest() = 0;
+    virtual HueStateChange constrainState(const HueStateChange& change) const;
+    virtual void propagateStateChange(const HueStateChange& change);
 
     virtual void updateOn(const bool on) = 0;
     virtual void updateHue(const int hue) = 0;
@@ -68,10 +101,22 @@ protected:
 signals:
     void synchronized();
     void valueUpdated();
+    void updateFailed(const HueError& error);
+
+private:
+    struct PendingUpdate;
+
+    void queueUpdate(const HueStateChange& change);
+    void sendPendingUpdates();
 
 private:
     HueBridge* m_bridge;
-    HueSynchronizer* m_synchronizer;
+    HuePerceptualFilter m_perceptualFilter;
+    bool m_holdNotifications;
+    int m_heldAttributes;
+    bool m_optimistic;
+    bool m_sendingUpdates;
+    std::shared_ptr<PendingUpdate> m_queuedUpdate;
 
 };
 
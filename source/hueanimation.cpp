@@ -0,0 +1,533 @@
+#include "hueanimation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "hueabstractobject.h"
+
+/*!
+ * \class HueAnimation
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief A keyframe timeline for a single \l HueLight or \l HueGroup.
+ *
+ * HueAnimation holds a list of keyframes, each a \l HueStateChange at a point in time
+ * (in milliseconds from the start of the animation). Between two keyframes, brightness,
+ * hue, saturation, color temperature and \e xy are interpolated linearly. Hue is
+ * interpolated along the shortest way around the color wheel. \e on switches at the
+ * keyframe. Alert and effect are not animated.
+ *
+ * An attribute missing from a keyframe keeps the value of the previous keyframe.
+ *
+ * HueAnimation only describes the animation. It is played by \l HueAnimator.
+ *
+ * By default an animation is sampled: \l HueAnimator sends the interpolated state
+ * on every tick. For smooth fades, the bridge can interpolate by itself using
+ * \e transitiontime, so far fewer commands are needed. \l fade() creates an animation
+ * with \l KeyframePlayback, where only the keyframes are sent, each with a transition
+ * time that reaches the next keyframe. It picks the fewest keyframes that approximate
+ * the requested \l Curve within an error bound. A linear fade is a single command,
+ * regardless of its length.
+ *
+ * \code
+ *  HueStateChange target;
+ *  target.setBrightness(254);
+ *
+ *  // Fade light 1 to full brightness over 10 minutes with an ease-in-out curve
+ *  animator->play(HueAnimation::fade(lights.fetch(1), target, 600000, HueAnimation::EaseInOut));
+ * \endcode
+ *
+ * \code
+ *  HueAnimation pulse(lights.fetch(1));
+ *  HueStateChange dim, bright;
+ *  dim.setBrightness(20);
+ *  bright.setBrightness(254);
+ *
+ *  pulse.addKeyframe(0, dim);
+ *  pulse.addKeyframe(1000, bright);
+ *  pulse.addKeyframe(2000, dim);
+ *  pulse.setLooping(true);
+ *
+ *  HueAnimator* animator = new HueAnimator();
+ *  animator->play(pulse);
+ * \endcode
+ *
+ * \sa HueAnimator, HueStateChange
+ */
+
+/*!
+ * \enum HueAnimation::Playback
+ * This enum defines how \l HueAnimator plays an animation.
+ *
+ * \value SampledPlayback
+ *      The interpolated state is sent on every tick.
+ *
+ * \value KeyframePlayback
+ *      Only keyframes are sent. Each keyframe is sent when the previous one is
+ *      reached (the first one at the start), with a transition time that ends at
+ *      the time of the keyframe. The bridge interpolates in between.
+ */
+
+/*!
+ * \enum HueAnimation::Curve
+ * This enum defines the progress curves available to \l fade().
+ *
+ * \value Linear
+ *      Constant rate of change.
+ *
+ * \value EaseIn
+ *      Starts slowly and speeds up (quadratic).
+ *
+ * \value EaseOut
+ *      Starts quickly and slows down (quadratic).
+ *
+ * \value EaseInOut
+ *      Starts and ends slowly (quadratic).
+ */
+
+namespace {
+
+const int hueRange = 65536;
+
+// transitiontime is sent in multiples of 100 ms and is limited to 16 bits
+const int transitionStep = 100;
+const int maxTransitionSteps = 65535;
+
+// Number of points checked inside a segment when fitting a curve
+const int segmentSamples = 32;
+
+int interpolate(const int from, const int to, const double fraction)
+{
+    return static_cast<int>(std::lround(from + (to - from) * fraction));
+}
+
+double interpolate(const double from, const double to, const double fraction)
+{
+    return from + (to - from) * fraction;
+}
+
+int interpolateHue(const int from, const int to, const double fraction)
+{
+    int difference = to - from;
+
+    if (difference > hueRange / 2)
+        difference -= hueRange;
+    else if (difference < -hueRange / 2)
+        difference += hueRange;
+
+    int hue = static_cast<int>(std::lround(from + difference * fraction));
+    hue %= hueRange;
+    if (hue < 0)
+        hue += hueRange;
+
+    return hue;
+}
+
+}
+
+/*!
+ * \fn HueAnimation::HueAnimation()
+ *
+ * Constructs an empty HueAnimation without a target.
+ *
+ */
+HueAnimation::HueAnimation()
+    : m_target()
+    , m_keyframes()
+    , m_looping(false)
+    , m_playback(SampledPlayback)
+{
+
+}
+
+/*!
+ * \fn HueAnimation::HueAnimation(std::shared_ptr<HueAbstractObject> target)
+ *
+ * Constructs an empty HueAnimation that animates \a target.
+ *
+ */
+HueAnimation::HueAnimation(std::shared_ptr<HueAbstractObject> target)
+    : m_target(target)
+    , m_keyframes()
+    , m_looping(false)
+    , m_playback(SampledPlayback)
+{
+
+}
+
+/*!
+ * \fn std::shared_ptr<HueAbstractObject> HueAnimation::target() const
+ *
+ * Returns the object animated by the animation.
+ *
+ */
+std::shared_ptr<HueAbstractObject> HueAnimation::target() const
+{
+    return m_target;
+}
+
+/*!
+ * \fn bool HueAnimation::isValid() const
+ *
+ * Returns \c true if the animation has a valid target and at least one keyframe.
+ *
+ */
+bool HueAnimation::isValid() const
+{
+    return m_target != nullptr && m_target->isValid() && !m_keyframes.empty();
+}
+
+/*!
+ * \fn void HueAnimation::addKeyframe(const int timeMilliseconds, const HueStateChange& state)
+ *
+ * Adds a keyframe with \a state at \a timeMilliseconds from the start of the
+ * animation. A keyframe at the same time as an existing one replaces it.
+ *
+ */
+void HueAnimation::addKeyframe(const int timeMilliseconds, const HueStateChange& state)
+{
+    const int time = timeMilliseconds < 0 ? 0 : timeMilliseconds;
+
+    auto position = std::lower_bound(m_keyframes.begin(), m_keyframes.end(), time,
+                                     [](const Keyframe& keyframe, const int t)
+    {
+        return keyframe.time < t;
+    });
+
+    if (position != m_keyframes.end() && position->time == time)
+        position->state = state;
+    else
+        m_keyframes.insert(position, Keyframe{time, state});
+}
+
+/*!
+ * \fn int HueAnimation::keyframeCount() const
+ *
+ * Returns the number of keyframes.
+ *
+ */
+int HueAnimation::keyframeCount() const
+{
+    return static_cast<int>(m_keyframes.size());
+}
+
+/*!
+ * \fn int HueAnimation::keyframeTime(const int index) const
+ *
+ * Returns the time in milliseconds of the keyframe at \a index, or -1 if \a index is out of range.
+ *
+ */
+int HueAnimation::keyframeTime(const int index) const
+{
+    if (index < 0 || index >= keyframeCount())
+        return -1;
+
+    return m_keyframes[static_cast<size_t>(index)].time;
+}
+
+/*!
+ * \fn HueStateChange HueAnimation::keyframeState(const int index) const
+ *
+ * Returns the state of the keyframe at \a index, or an empty state if \a index is out of range.
+ *
+ */
+HueStateChange HueAnimation::keyframeState(const int index) const
+{
+    if (index < 0 || index >= keyframeCount())
+        return HueStateChange();
+
+    return m_keyframes[static_cast<size_t>(index)].state;
+}
+
+/*!
+ * \fn int HueAnimation::duration() const
+ *
+ * Returns the duration of the animation in milliseconds, i.e. the time of the last keyframe.
+ *
+ */
+int HueAnimation::duration() const
+{
+    if (m_keyframes.empty())
+        return 0;
+
+    return m_keyframes.back().time;
+}
+
+/*!
+ * \fn HueAnimation::Playback HueAnimation::playback() const
+ *
+ * Returns how the animation is played.
+ *
+ */
+HueAnimation::Playback HueAnimation::playback() const
+{
+    return m_playback;
+}
+
+/*!
+ * \fn void HueAnimation::setPlayback(const Playback playback)
+ *
+ * Sets how the animation is played to \a playback.
+ *
+ */
+void HueAnimation::setPlayback(const Playback playback)
+{
+    m_playback = playback;
+}
+
+/*!
+ * \fn bool HueAnimation::isLooping() const
+ *
+ * Returns \c true if the animation restarts when it reaches the end.
+ *
+ */
+bool HueAnimation::isLooping() const
+{
+    return m_looping;
+}
+
+/*!
+ * \fn void HueAnimation::setLooping(const bool looping)
+ *
+ * Makes the animation restart when it reaches the end if \a looping is \c true.
+ *
+ */
+void HueAnimation::setLooping(const bool looping)
+{
+    m_looping = looping;
+}
+
+/*!
+ * \fn HueStateChange HueAnimation::stateAt(const int timeMilliseconds) const
+ *
+ * Returns the interpolated state at \a timeMilliseconds from the start of the animation.
+ * The returned state has no transition time.
+ *
+ */
+HueStateChange HueAnimation::stateAt(const int timeMilliseconds) const
+{
+    if (m_keyframes.empty())
+        return HueStateChange();
+
+    int time = timeMilliseconds < 0 ? 0 : timeMilliseconds;
+    const int length = duration();
+
+    if (m_looping && length > 0)
+        time %= length;
+
+    auto next = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), time,
+                                 [](const int t, const Keyframe& keyframe)
+    {
+        return t < keyframe.time;
+    });
+
+    // Before the first keyframe or after the last one, hold the nearest keyframe.
+    // Attributes are accumulated so that values set in earlier keyframes are carried forward.
+    const auto accumulateEnd = next == m_keyframes.begin() ? next + 1 : next;
+
+    HueStateChange from;
+    for (auto iter = m_keyframes.begin(); iter != accumulateEnd; ++iter) {
+        const HueStateChange& state = iter->state;
+
+        if (state.has(HueStateChange::OnAttribute))
+            from.setOn(state.isOn());
+        if (state.has(HueStateChange::BrightnessAttribute))
+            from.setBrightness(state.getBrightness());
+        if (state.has(HueStateChange::HueAttribute))
+            from.setHue(state.getHue());
+        if (state.has(HueStateChange::SaturationAttribute))
+            from.setSaturation(state.getSaturation());
+        if (state.has(HueStateChange::ColorTempAttribute))
+            from.setColorTemp(state.getColorTemp());
+        if (state.has(HueStateChange::XYAttribute))
+            from.setXY(state.getXValue(), state.getYValue());
+    }
+
+    if (next == m_keyframes.begin() || next == m_keyframes.end())
+        return from;
+
+    const Keyframe& previous = *(next - 1);
+    const HueStateChange& to = next->state;
+    const double fraction = static_cast<double>(time - previous.time) / (next->time - previous.time);
+
+    return interpolateState(from, to, fraction);
+}
+
+/*!
+ * \fn HueAnimation HueAnimation::fade(std::shared_ptr<HueAbstractObject> target, const HueStateChange& to, const int durationMilliseconds, const Curve curve, const double maxError)
+ *
+ * Returns an animation with \l KeyframePlayback that fades \a target from its current
+ * state to \a to over \a durationMilliseconds, following \a curve.
+ *
+ * The bridge interpolates linearly between commands, so the curve is approximated by
+ * straight segments. Segments are made as long as possible while the approximated
+ * progress stays within \a maxError (a fraction of the whole fade, e.g. 0.02 for 2%)
+ * of the curve. Segment boundaries fall on 100 ms steps, the resolution of
+ * \e transitiontime.
+ *
+ * Only the attributes contained in \a to are faded. If \a to turns the light on,
+ * every command turns it on; if it turns the light off, only the last one does.
+ *
+ */
+HueAnimation HueAnimation::fade(std::shared_ptr<HueAbstractObject> target,
+                                const HueStateChange& to, const int durationMilliseconds,
+                                const Curve curve, const double maxError)
+{
+    HueAnimation animation(target);
+    animation.setPlayback(KeyframePlayback);
+
+    if (target == nullptr || to.isEmpty())
+        return animation;
+
+    // Start from the current values of the attributes being faded
+    const HueStateChange current = target->currentState();
+    HueStateChange from = to;
+
+    if (current.has(HueStateChange::BrightnessAttribute))
+        from.setBrightness(current.getBrightness());
+    if (current.has(HueStateChange::HueAttribute))
+        from.setHue(current.getHue());
+    if (current.has(HueStateChange::SaturationAttribute))
+        from.setSaturation(current.getSaturation());
+    if (current.has(HueStateChange::ColorTempAttribute))
+        from.setColorTemp(current.getColorTemp());
+    if (current.has(HueStateChange::XYAttribute))
+        from.setXY(current.getXValue(), current.getYValue());
+
+    from.clear(HueStateChange::OnAttribute);
+    from.clear(HueStateChange::AlertAttribute);
+    from.clear(HueStateChange::EffectAttribute);
+    from.clearTransitionTime();
+
+    HueStateChange end = to;
+    end.clear(HueStateChange::OnAttribute);
+    end.clear(HueStateChange::AlertAttribute);
+    end.clear(HueStateChange::EffectAttribute);
+    end.clearTransitionTime();
+
+    const bool turnOn = to.has(HueStateChange::OnAttribute) && to.isOn();
+    const bool turnOff = to.has(HueStateChange::OnAttribute) && !to.isOn();
+
+    const int duration = durationMilliseconds > 0 ? durationMilliseconds : 1;
+    const int steps = (duration + transitionStep - 1) / transitionStep;
+    const double error = maxError > 0.0 ? maxError : 0.0;
+
+    auto timeAt = [duration](const int step)
+    {
+        const int time = step * transitionStep;
+        return time < duration ? time : duration;
+    };
+
+    auto fractionAt = [duration, &timeAt](const int step)
+    {
+        return static_cast<double>(timeAt(step)) / duration;
+    };
+
+    int start = 0;
+    while (start < steps) {
+        // Grow the segment exponentially while it fits, then narrow down the
+        // longest fitting length with a binary search.
+        int reach = 1;
+        while (reach < maxTransitionSteps && start + reach < steps) {
+            int next = reach * 2;
+            if (next > maxTransitionSteps)
+                next = maxTransitionSteps;
+            if (start + next > steps)
+                next = steps - start;
+
+            if (!segmentFits(curve, fractionAt(start), fractionAt(start + next), error)) {
+                int low = reach;
+                int high = next;
+                while (high - low > 1) {
+                    const int middle = (low + high) / 2;
+                    if (segmentFits(curve, fractionAt(start), fractionAt(start + middle), error))
+                        low = middle;
+                    else
+                        high = middle;
+                }
+                reach = low;
+                break;
+            }
+
+            reach = next;
+        }
+
+        const int stop = start + reach;
+        HueStateChange state = interpolateState(from, end, curveValue(curve, fractionAt(stop)));
+
+        if (turnOn)
+            state.setOn(true);
+        else if (turnOff && stop == steps)
+            state.setOn(false);
+
+        animation.addKeyframe(timeAt(stop), state);
+        start = stop;
+    }
+
+    return animation;
+}
+
+/*!
+ * \fn double HueAnimation::curveValue(const Curve curve, const double progress)
+ *
+ * Returns the progress of \a curve (0.0 - 1.0) at \a progress in time (0.0 - 1.0).
+ *
+ */
+double HueAnimation::curveValue(const Curve curve, const double progress)
+{
+    const double t = progress < 0.0 ? 0.0 : (progress > 1.0 ? 1.0 : progress);
+
+    switch (curve) {
+    case Linear:
+        return t;
+    case EaseIn:
+        return t * t;
+    case EaseOut:
+        return 1.0 - (1.0 - t) * (1.0 - t);
+    case EaseInOut:
+        return t < 0.5 ? 2.0 * t * t : 1.0 - 2.0 * (1.0 - t) * (1.0 - t);
+    }
+
+    return t;
+}
+
+HueStateChange HueAnimation::interpolateState(const HueStateChange& from, const HueStateChange& to,
+                                              const double fraction)
+{
+    HueStateChange state = from;
+
+    if (from.has(HueStateChange::BrightnessAttribute) && to.has(HueStateChange::BrightnessAttribute))
+        state.setBrightness(interpolate(from.getBrightness(), to.getBrightness(), fraction));
+
+    if (from.has(HueStateChange::HueAttribute) && to.has(HueStateChange::HueAttribute))
+        state.setHue(interpolateHue(from.getHue(), to.getHue(), fraction));
+
+    if (from.has(HueStateChange::SaturationAttribute) && to.has(HueStateChange::SaturationAttribute))
+        state.setSaturation(interpolate(from.getSaturation(), to.getSaturation(), fraction));
+
+    if (from.has(HueStateChange::ColorTempAttribute) && to.has(HueStateChange::ColorTempAttribute))
+        state.setColorTemp(interpolate(from.getColorTemp(), to.getColorTemp(), fraction));
+
+    if (from.has(HueStateChange::XYAttribute) && to.has(HueStateChange::XYAttribute))
+        state.setXY(interpolate(from.getXValue(), to.getXValue(), fraction),
+                    interpolate(from.getYValue(), to.getYValue(), fraction));
+
+    return state;
+}
+
+bool HueAnimation::segmentFits(const Curve curve, const double start, const double end,
+                               const double maxError)
+{
+    const double startValue = curveValue(curve, start);
+    const double endValue = curveValue(curve, end);
+
+    for (int i = 1; i < segmentSamples; i++) {
+        const double t = start + (end - start) * i / segmentSamples;
+        const double linear = startValue + (endValue - startValue) * i / segmentSamples;
+
+        if (std::abs(curveValue(curve, t) - linear) > maxError)
+            return false;
+    }
+
+    return true;
+}
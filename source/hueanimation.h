@@ -0,0 +1,68 @@
+#ifndef HUEANIMATION_H
+#define HUEANIMATION_H
+
+#include <memory>
+#include <vector>
+
+#include "huestatechange.h"
+
+class HueAbstractObject;
+
+class HueAnimation
+{
+public:
+    enum Playback {
+        SampledPlayback,
+        KeyframePlayback
+    };
+    enum Curve {
+        Linear,
+        EaseIn,
+        EaseOut,
+        EaseInOut
+    };
+
+    HueAnimation();
+    explicit HueAnimation(std::shared_ptr<HueAbstractObject> target);
+
+    std::shared_ptr<HueAbstractObject> target() const;
+    bool isValid() const;
+
+    void addKeyframe(const int timeMilliseconds, const HueStateChange& state);
+    int keyframeCount() const;
+    int keyframeTime(const int index) const;
+    HueStateChange keyframeState(const int index) const;
+    int duration() const;
+
+    Playback playback() const;
+    void setPlayback(const Playback playback);
+
+    bool isLooping() const;
+    void setLooping(const bool looping);
+
+    HueStateChange stateAt(const int timeMilliseconds) const;
+
+    static HueAnimation fade(std::shared_ptr<HueAbstractObject> target,
+                             const HueStateChange& to, const int durationMilliseconds,
+                             const Curve curve = Linear, const double maxError = 0.02);
+    static double curveValue(const Curve curve, const double progress);
+
+private:
+    static HueStateChange interpolateState(const HueStateChange& from, const HueStateChange& to,
+                                           const double fraction);
+    static bool segmentFits(const Curve curve, const double start, const double end,
+                            const double maxError);
+
+private:
+    struct Keyframe {
+        int time;
+        HueStateChange state;
+    };
+
+    std::shared_ptr<HueAbstractObject> m_target;
+    std::vector<Keyframe> m_keyframes;
+    bool m_looping;
+    Playback m_playback;
+};
+
+#endif // HUEANIMATION_H
@@ -0,0 +1,376 @@
+#include "hueanimator.h"
+
+#include "hueabstractobject.h"
+
+/*!
+ * \class HueAnimator
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Plays \l HueAnimation timelines on lights and groups.
+ *
+ * HueAnimator samples all running animations at a fixed tick (100 ms by default)
+ * and sends one \l HueStateChange per animation and tick through
+ * \l HueAbstractObject::setState(), so every frame passes the block times of
+ * \l HueBridge like any other command.
+ *
+ * Each frame targets the state the animation will have when the bridge finishes
+ * the transition, and carries a \e transitiontime equal to the time since the
+ * previous frame of that animation. The bridge then fades smoothly between the
+ * frames that are actually sent.
+ *
+ * Sending is blocking, so with many animations a tick can take longer than the tick
+ * interval. Frames that can no longer be sent before the next tick is due are
+ * dropped instead of being queued, so animations never fall behind the clock.
+ * The order in which animations are served rotates every tick, so drops are spread
+ * evenly. \l framesSent() and \l framesDropped() report the totals.
+ *
+ * Animations with \l HueAnimation::KeyframePlayback are not sampled. Each keyframe
+ * is sent once, when the previous keyframe is reached, with a transition time that
+ * ends at the time of the keyframe. A keyframe that cannot be sent in time, or
+ * that the bridge rejects, is sent again on the next tick rather than dropped, and
+ * keyframes that are already due by then are skipped. The first keyframe of each
+ * loop is never skipped.
+ *
+ * \sa HueAnimation
+ */
+
+/*!
+ * \fn HueAnimator::HueAnimator(QObject* parent)
+ *
+ * Constructs a HueAnimator without animations. A \e QObject parent
+ * can be set by \a parent.
+ *
+ */
+HueAnimator::HueAnimator(QObject* parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_clock()
+    , m_animations()
+    , m_nextID(0)
+    , m_firstSlot(0)
+    , m_ticking(false)
+    , m_framesSent(0)
+    , m_framesDropped(0)
+{
+    m_timer->setSingleShot(false);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(m_defaultTickInterval);
+
+    connect(m_timer, &QTimer::timeout,
+            this, &HueAnimator::tick);
+
+    m_clock.start();
+}
+
+/*!
+ * \fn int HueAnimator::play(const HueAnimation& animation)
+ *
+ * Starts playing \a animation. The first frame is sent on the next tick.
+ *
+ * Returns an ID that can be passed to \l stop(), or -1 if \a animation is not valid.
+ *
+ * \sa stop(), finished()
+ *
+ */
+int HueAnimator::play(const HueAnimation& animation)
+{
+    if (!animation.isValid())
+        return -1;
+
+    const int ID = m_nextID++;
+    m_animations.push_back(RunningAnimation{ID, animation, m_clock.elapsed(), -1, 0, false, false});
+
+    if (!m_timer->isActive())
+        m_timer->start();
+
+    return ID;
+}
+
+/*!
+ * \fn bool HueAnimator::stop(const int animationID)
+ *
+ * Stops the animation with ID \a animationID. The light keeps its current state.
+ *
+ * Returns \c true if the animation was running.
+ *
+ * \sa stopAll()
+ *
+ */
+bool HueAnimator::stop(const int animationID)
+{
+    bool animationWasStopped = false;
+
+    for (auto& running : m_animations) {
+        if (running.ID == animationID && !running.stopped && !running.finished) {
+            running.stopped = true;
+            animationWasStopped = true;
+        }
+    }
+
+    if (!m_ticking)
+        removeInactive();
+
+    return animationWasStopped;
+}
+
+/*!
+ * \fn void HueAnimator::stopAll()
+ *
+ * Stops all animations.
+ *
+ * \sa stop()
+ *
+ */
+void HueAnimator::stopAll()
+{
+    for (auto& running : m_animations)
+        running.stopped = true;
+
+    if (!m_ticking)
+        removeInactive();
+}
+
+/*!
+ * \fn bool HueAnimator::isActive() const
+ *
+ * Returns \c true if any animation is running.
+ *
+ */
+bool HueAnimator::isActive() const
+{
+    return m_timer->isActive();
+}
+
+/*!
+ * \fn int HueAnimator::animationCount() const
+ *
+ * Returns the number of running animations.
+ *
+ */
+int HueAnimator::animationCount() const
+{
+    return static_cast<int>(m_animations.size());
+}
+
+/*!
+ * \fn int HueAnimator::getTickInterval() const
+ *
+ * Returns the tick interval in milliseconds.
+ *
+ */
+int HueAnimator::getTickInterval() const
+{
+    return m_timer->interval();
+}
+
+/*!
+ * \fn void HueAnimator::setTickInterval(const int milliseconds)
+ *
+ * Sets the tick interval to \a milliseconds. A shorter interval gives smoother
+ * animations only as long as the bridge can keep up; otherwise more frames are dropped.
+ * Transition times are sent in multiples of 100 ms, so intervals below 100 ms
+ * are rarely useful.
+ *
+ */
+void HueAnimator::setTickInterval(const int milliseconds)
+{
+    if (milliseconds > 0)
+        m_timer->setInterval(milliseconds);
+    else
+        m_timer->setInterval(m_defaultTickInterval);
+}
+
+/*!
+ * \fn int HueAnimator::framesSent() const
+ *
+ * Returns the number of frames sent to the bridge.
+ *
+ * \sa framesDropped()
+ *
+ */
+int HueAnimator::framesSent() const
+{
+    return m_framesSent;
+}
+
+/*!
+ * \fn int HueAnimator::framesDropped() const
+ *
+ * Returns the number of frames that were dropped because they would have
+ * arrived late, or because the bridge rejected them.
+ *
+ * \sa framesSent()
+ *
+ */
+int HueAnimator::framesDropped() const
+{
+    return m_framesDropped;
+}
+
+void HueAnimator::tick()
+{
+    // Sending is blocking and runs a local event loop, so the timer can fire
+    // while the previous tick is still sending. That tick is already late.
+    if (m_ticking) {
+        for (const auto& running : m_animations) {
+            if (running.animation.playback() == HueAnimation::SampledPlayback)
+                m_framesDropped++;
+        }
+        return;
+    }
+
+    m_ticking = true;
+
+    const qint64 tickStart = m_clock.elapsed();
+    const qint64 interval = m_timer->interval();
+    const int count = animationCount();
+
+    for (int i = 0; i < count; i++) {
+        const int slot = (m_firstSlot + i) % count;
+
+        if (m_animations[slot].stopped || m_animations[slot].finished)
+            continue;
+
+        const qint64 now = m_clock.elapsed();
+        const bool keyframePlayback =
+                m_animations[slot].animation.playback() == HueAnimation::KeyframePlayback;
+
+        // The next tick is already due - drop the frame rather than queue it.
+        // Keyframes are sent only once, so they are deferred instead.
+        if (now - tickStart >= interval) {
+            if (!keyframePlayback)
+                m_framesDropped++;
+            continue;
+        }
+
+        // m_animations may grow while sending, so everything needed is copied
+        // out of the vector before the request is made.
+        RunningAnimation& running = m_animations[slot];
+        HueStateChange state;
+        int keyframe = -1;
+
+        if (keyframePlayback) {
+            keyframe = nextKeyframeFrame(running, now, state);
+            if (keyframe < 0)
+                continue;
+        }
+        else {
+            nextSampledFrame(running, now, interval, state);
+        }
+
+        running.lastFrameTime = now;
+
+        std::shared_ptr<HueAbstractObject> target = running.animation.target();
+
+        if (target->setState(state)) {
+            m_framesSent++;
+
+            // A keyframe only counts as played once it has been handed to the target
+            if (keyframePlayback)
+                keyframeSent(m_animations[slot], keyframe);
+        }
+        else {
+            m_framesDropped++;
+        }
+    }
+
+    m_firstSlot = count > 0 ? (m_firstSlot + 1) % count : 0;
+    m_ticking = false;
+
+    removeInactive();
+}
+
+void HueAnimator::nextSampledFrame(RunningAnimation& running, const qint64 now,
+                                   const qint64 interval, HueStateChange& state)
+{
+    const qint64 elapsed = now - running.startTime;
+
+    qint64 transition = interval;
+    if (running.lastFrameTime >= 0)
+        transition = qBound(interval, now - running.lastFrameTime, interval * m_maxTransitionTicks);
+
+    const int duration = running.animation.duration();
+    const bool lastFrame = !running.animation.isLooping() && elapsed + transition >= duration;
+
+    if (lastFrame) {
+        state = running.animation.stateAt(duration);
+        transition = duration > elapsed ? duration - elapsed : 0;
+        running.finished = true;
+    }
+    else {
+        state = running.animation.stateAt(static_cast<int>(elapsed + transition));
+    }
+
+    state.setTransitionTime(static_cast<int>((transition + 50) / 100));
+}
+
+int HueAnimator::nextKeyframeFrame(const RunningAnimation& running, const qint64 now,
+                                  HueStateChange& state) const
+{
+    const HueAnimation& animation = running.animation;
+    const int count = animation.keyframeCount();
+    const qint64 elapsed = now - running.startTime;
+    int keyframe = running.nextKeyframe;
+
+    // Each keyframe is sent once the previous one has been reached. When a loop
+    // wraps, the start time moves to the end of the loop, so the first keyframe
+    // of the next loop waits until the transition to the last one has finished
+    const qint64 previousTime = keyframe > 0 ? animation.keyframeTime(keyframe - 1) : 0;
+    if (elapsed < previousTime)
+        return -1;
+
+    // Skip keyframes that are already due; the bridge could only jump to them.
+    // The first keyframe starts the loop and is always sent, even at time 0
+    if (keyframe > 0) {
+        while (keyframe < count - 1 && animation.keyframeTime(keyframe) <= elapsed)
+            keyframe++;
+    }
+
+    const qint64 keyframeTime = animation.keyframeTime(keyframe);
+    const qint64 transition = keyframeTime > elapsed ? keyframeTime - elapsed : 0;
+
+    state = animation.keyframeState(keyframe);
+    state.setTransitionTime(static_cast<int>((transition + 50) / 100));
+
+    return keyframe;
+}
+
+void HueAnimator::keyframeSent(RunningAnimation& running, const int keyframe)
+{
+    const HueAnimation& animation = running.animation;
+    running.nextKeyframe = keyframe + 1;
+
+    if (running.nextKeyframe >= animation.keyframeCount()) {
+        if (animation.isLooping()) {
+            running.nextKeyframe = 0;
+            running.startTime += animation.duration();
+        }
+        else {
+            running.finished = true;
+        }
+    }
+}
+
+void HueAnimator::removeInactive()
+{
+    std::vector<int> finishedIDs;
+    std::vector<RunningAnimation> active;
+    active.reserve(m_animations.size());
+
+    for (auto& running : m_animations) {
+        if (running.finished && !running.stopped)
+            finishedIDs.push_back(running.ID);
+        else if (!running.finished && !running.stopped)
+            active.push_back(std::move(running));
+    }
+
+    m_animations.swap(active);
+
+    if (m_animations.empty()) {
+        m_timer->stop();
+        m_firstSlot = 0;
+    }
+
+    for (int ID : finishedIDs)
+        emit finished(ID);
+}
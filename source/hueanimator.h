@@ -0,0 +1,68 @@
+#ifndef HUEANIMATOR_H
+#define HUEANIMATOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <vector>
+
+#include "hueanimation.h"
+
+class HueAnimator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HueAnimator(QObject* parent = nullptr);
+
+    int play(const HueAnimation& animation);
+    bool stop(const int animationID);
+    void stopAll();
+
+    bool isActive() const;
+    int animationCount() const;
+
+    int getTickInterval() const;
+    void setTickInterval(const int milliseconds);
+
+    int framesSent() const;
+    int framesDropped() const;
+
+signals:
+    void finished(int animationID);
+
+private slots:
+    void tick();
+
+private:
+    struct RunningAnimation {
+        int ID;
+        HueAnimation animation;
+        qint64 startTime;
+        qint64 lastFrameTime;
+        int nextKeyframe;
+        bool finished;
+        bool stopped;
+    };
+
+    void nextSampledFrame(RunningAnimation& running, const qint64 now,
+                          const qint64 interval, HueStateChange& state);
+    int nextKeyframeFrame(const RunningAnimation& running, const qint64 now,
+                          HueStateChange& state) const;
+    void keyframeSent(RunningAnimation& running, const int keyframe);
+    void removeInactive();
+
+private:
+    const int m_defaultTickInterval = 100;
+    const int m_maxTransitionTicks = 4;
+
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+    std::vector<RunningAnimation> m_animations;
+    int m_nextID;
+    int m_firstSlot;
+    bool m_ticking;
+    int m_framesSent;
+    int m_framesDropped;
+};
+
+#endif // HUEANIMATOR_H
@@ -0,0 +1,357 @@
+#include "huebitset.h"
+
+#include <QtAlgorithms>
+#include <algorithm>
+
+/*!
+ * \class HueBitset
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief A set of light or group IDs stored as bits.
+ *
+ * HueBitset stores non-negative IDs as bits in 64-bit words, so that membership
+ * tests take constant time and unions, intersections and subset tests take time
+ * proportional to the number of words rather than the number of IDs. Bridge IDs
+ * are small integers, so a set of all lights of a bridge fits in a few words.
+ *
+ * It is used by \l Group::Lights to store the members of a group and by
+ * \l HueMembershipIndex to relate lights and groups.
+ *
+ * \code
+ *  HueBitset kitchen = kitchenGroup->lights().getMembers();
+ *  if (kitchen.test(light->ID()))
+ *      qDebug() << "Light is in the kitchen";
+ * \endcode
+ *
+ */
+
+namespace {
+const int bitsPerWord = 64;
+}
+
+/*!
+ * \fn HueBitset::HueBitset()
+ *
+ * Constructs an empty set.
+ *
+ */
+HueBitset::HueBitset()
+    : m_words()
+{
+
+}
+
+/*!
+ * \fn HueBitset::HueBitset(std::initializer_list<int> IDs)
+ *
+ * Constructs a set containing \a IDs.
+ *
+ */
+HueBitset::HueBitset(std::initializer_list<int> IDs)
+    : m_words()
+{
+    for (const int ID : IDs)
+        set(ID);
+}
+
+/*!
+ * \fn HueBitset::HueBitset(const std::vector<int>& IDs)
+ *
+ * Constructs a set containing \a IDs.
+ *
+ */
+HueBitset::HueBitset(const std::vector<int>& IDs)
+    : m_words()
+{
+    for (const int ID : IDs)
+        set(ID);
+}
+
+/*!
+ * \fn void HueBitset::set(const int ID)
+ *
+ * Adds \a ID to the set. Negative IDs are ignored.
+ *
+ */
+void HueBitset::set(const int ID)
+{
+    if (ID < 0)
+        return;
+
+    const size_t word = static_cast<size_t>(ID / bitsPerWord);
+    if (word >= m_words.size())
+        m_words.resize(word + 1, 0);
+
+    m_words[word] |= quint64(1) << (ID % bitsPerWord);
+}
+
+/*!
+ * \fn void HueBitset::reset(const int ID)
+ *
+ * Removes \a ID from the set.
+ *
+ */
+void HueBitset::reset(const int ID)
+{
+    if (!test(ID))
+        return;
+
+    m_words[static_cast<size_t>(ID / bitsPerWord)] &= ~(quint64(1) << (ID % bitsPerWord));
+    trim();
+}
+
+/*!
+ * \fn bool HueBitset::test(const int ID) const
+ *
+ * Returns \c true if \a ID is in the set.
+ *
+ */
+bool HueBitset::test(const int ID) const
+{
+    if (ID < 0)
+        return false;
+
+    const size_t word = static_cast<size_t>(ID / bitsPerWord);
+    return word < m_words.size() && (m_words[word] >> (ID % bitsPerWord)) & 1;
+}
+
+/*!
+ * \fn void HueBitset::clear()
+ *
+ * Removes all IDs from the set.
+ *
+ */
+void HueBitset::clear()
+{
+    m_words.clear();
+}
+
+/*!
+ * \fn int HueBitset::count() const
+ *
+ * Returns the number of IDs in the set.
+ *
+ */
+int HueBitset::count() const
+{
+    int count = 0;
+    for (const quint64 word : m_words)
+        count += static_cast<int>(qPopulationCount(word));
+
+    return count;
+}
+
+/*!
+ * \fn bool HueBitset::isEmpty() const
+ *
+ * Returns \c true if the set contains no IDs.
+ *
+ */
+bool HueBitset::isEmpty() const
+{
+    return m_words.empty();
+}
+
+/*!
+ * \fn int HueBitset::wordCount() const
+ *
+ * Returns the number of 64-bit words used by the set.
+ *
+ */
+int HueBitset::wordCount() const
+{
+    return static_cast<int>(m_words.size());
+}
+
+/*!
+ * \fn std::vector<int> HueBitset::toVector() const
+ *
+ * Returns the IDs in the set in ascending order.
+ *
+ */
+std::vector<int> HueBitset::toVector() const
+{
+    std::vector<int> IDs;
+    IDs.reserve(static_cast<size_t>(count()));
+
+    for (size_t i = 0; i < m_words.size(); i++) {
+        quint64 word = m_words[i];
+        while (word != 0) {
+            IDs.push_back(static_cast<int>(i) * bitsPerWord + static_cast<int>(qCountTrailingZeroBits(word)));
+            word &= word - 1;
+        }
+    }
+
+    return IDs;
+}
+
+/*!
+ * \fn bool HueBitset::intersects(const HueBitset& rhs) const
+ *
+ * Returns \c true if the set and \a rhs have at least one ID in common.
+ *
+ */
+bool HueBitset::intersects(const HueBitset& rhs) const
+{
+    const size_t words = std::min(m_words.size(), rhs.m_words.size());
+    for (size_t i = 0; i < words; i++) {
+        if (m_words[i] & rhs.m_words[i])
+            return true;
+    }
+
+    return false;
+}
+
+/*!
+ * \fn bool HueBitset::isSubsetOf(const HueBitset& rhs) const
+ *
+ * Returns \c true if every ID in the set is also in \a rhs.
+ *
+ */
+bool HueBitset::isSubsetOf(const HueBitset& rhs) const
+{
+    if (m_words.size() > rhs.m_words.size())
+        return false;
+
+    for (size_t i = 0; i < m_words.size(); i++) {
+        if (m_words[i] & ~rhs.m_words[i])
+            return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \fn int HueBitset::intersectionCount(const HueBitset& rhs) const
+ *
+ * Returns the number of IDs the set and \a rhs have in common.
+ *
+ */
+int HueBitset::intersectionCount(const HueBitset& rhs) const
+{
+    int count = 0;
+    const size_t words = std::min(m_words.size(), rhs.m_words.size());
+    for (size_t i = 0; i < words; i++)
+        count += static_cast<int>(qPopulationCount(m_words[i] & rhs.m_words[i]));
+
+    return count;
+}
+
+/*!
+ * \fn HueBitset& HueBitset::operator&=(const HueBitset& rhs)
+ *
+ * Keeps only the IDs that are also in \a rhs.
+ *
+ */
+HueBitset& HueBitset::operator&=(const HueBitset& rhs)
+{
+    if (m_words.size() > rhs.m_words.size())
+        m_words.resize(rhs.m_words.size());
+
+    for (size_t i = 0; i < m_words.size(); i++)
+        m_words[i] &= rhs.m_words[i];
+
+    trim();
+    return *this;
+}
+
+/*!
+ * \fn HueBitset& HueBitset::operator|=(const HueBitset& rhs)
+ *
+ * Adds the IDs in \a rhs.
+ *
+ */
+HueBitset& HueBitset::operator|=(const HueBitset& rhs)
+{
+    if (m_words.size() < rhs.m_words.size())
+        m_words.resize(rhs.m_words.size(), 0);
+
+    for (size_t i = 0; i < rhs.m_words.size(); i++)
+        m_words[i] |= rhs.m_words[i];
+
+    return *this;
+}
+
+/*!
+ * \fn HueBitset& HueBitset::operator-=(const HueBitset& rhs)
+ *
+ * Removes the IDs in \a rhs.
+ *
+ */
+HueBitset& HueBitset::operator-=(const HueBitset& rhs)
+{
+    const size_t words = std::min(m_words.size(), rhs.m_words.size());
+    for (size_t i = 0; i < words; i++)
+        m_words[i] &= ~rhs.m_words[i];
+
+    trim();
+    return *this;
+}
+
+/*!
+ * \fn HueBitset HueBitset::operator&(const HueBitset& rhs) const
+ *
+ * Returns the IDs that are in both the set and \a rhs.
+ *
+ */
+HueBitset HueBitset::operator&(const HueBitset& rhs) const
+{
+    HueBitset result = *this;
+    result &= rhs;
+    return result;
+}
+
+/*!
+ * \fn HueBitset HueBitset::operator|(const HueBitset& rhs) const
+ *
+ * Returns the IDs that are in the set, in \a rhs or in both.
+ *
+ */
+HueBitset HueBitset::operator|(const HueBitset& rhs) const
+{
+    HueBitset result = *this;
+    result |= rhs;
+    return result;
+}
+
+/*!
+ * \fn HueBitset HueBitset::operator-(const HueBitset& rhs) const
+ *
+ * Returns the IDs that are in the set but not in \a rhs.
+ *
+ */
+HueBitset HueBitset::operator-(const HueBitset& rhs) const
+{
+    HueBitset result = *this;
+    result -= rhs;
+    return result;
+}
+
+/*!
+ * \fn bool HueBitset::operator==(const HueBitset& rhs) const
+ *
+ * Returns \c true if the set and \a rhs contain the same IDs.
+ *
+ */
+bool HueBitset::operator==(const HueBitset& rhs) const
+{
+    return m_words == rhs.m_words;
+}
+
+/*!
+ * \fn bool HueBitset::operator!=(const HueBitset& rhs) const
+ *
+ * Returns \c true if the set and \a rhs do not contain the same IDs.
+ *
+ */
+bool HueBitset::operator!=(const HueBitset& rhs) const
+{
+    return m_words != rhs.m_words;
+}
+
+// Trailing zero words are dropped, so that equal sets have equal words
+void HueBitset::trim()
+{
+    while (!m_words.empty() && m_words.back() == 0)
+        m_words.pop_back();
+}
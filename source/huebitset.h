@@ -0,0 +1,45 @@
+#ifndef HUEBITSET_H
+#define HUEBITSET_H
+
+#include <QtGlobal>
+#include <initializer_list>
+#include <vector>
+
+class HueBitset
+{
+public:
+    HueBitset();
+    HueBitset(std::initializer_list<int> IDs);
+    explicit HueBitset(const std::vector<int>& IDs);
+
+    void set(const int ID);
+    void reset(const int ID);
+    bool test(const int ID) const;
+    void clear();
+
+    int count() const;
+    bool isEmpty() const;
+    int wordCount() const;
+    std::vector<int> toVector() const;
+
+    bool intersects(const HueBitset& rhs) const;
+    bool isSubsetOf(const HueBitset& rhs) const;
+    int intersectionCount(const HueBitset& rhs) const;
+
+    HueBitset& operator&=(const HueBitset& rhs);
+    HueBitset& operator|=(const HueBitset& rhs);
+    HueBitset& operator-=(const HueBitset& rhs);
+    HueBitset operator&(const HueBitset& rhs) const;
+    HueBitset operator|(const HueBitset& rhs) const;
+    HueBitset operator-(const HueBitset& rhs) const;
+    bool operator==(const HueBitset& rhs) const;
+    bool operator!=(const HueBitset& rhs) const;
+
+private:
+    void trim();
+
+private:
+    std::vector<quint64> m_words;
+};
+
+#endif // HUEBITSET_H
@@ -5,6 +5,8 @@
 #include <QJsonArray>
 #include <QEventLoop>
 #include <QDir>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 #include "huerequest.h"
 #include "hueerror.h"
@@ -261,6 +263,19 @@ QString HueBridge::getUsername() const
     return m_username;
 }
 
+/*!
+ * \fn QNetworkAccessManager* HueBridge::getNetworkAccessManager() const
+ *
+ * Returns the \e QNetworkAccessManager used by the HueBridge.
+ *
+ * \sa setNetworkAccessManager()
+ *
+ */
+QNetworkAccessManager* HueBridge::getNetworkAccessManager() const
+{
+    return m_nam;
+}
+
 /*!
  * \fn HueReply HueBridge::getLastReply() const
  *
@@ -396,7 +411,11 @@ HueReply HueBridge::sendRequest(const HueRequest request, HueAbstractObject* sen
         url = "http://" + m_ip + "/api/" + m_username + "/" + urlPath;
         break;
     case HueRequest::Post:
-        url = "http://" + m_ip + "/api";
+        // Without a path, a new user is created; otherwise a resource, e.g. a scene
+        if (urlPath.isEmpty())
+            url = "http://" + m_ip + "/api";
+        else
+            url = "http://" + m_ip + "/api/" + m_username + "/" + urlPath;
         break;
     }
 
@@ -411,7 +430,11 @@ HueReply HueBridge::sendRequest(const HueRequest request, HueAbstractObject* sen
 
     QEventLoop eventLoop;
     QTimer eventTimer;
+    QFutureWatcher<HueReply> parseWatcher;
+    bool replyReceived = false;
+
     connect(&eventTimer, &QTimer::timeout, &eventLoop, &QEventLoop::quit);
+    connect(&parseWatcher, &QFutureWatcher<HueReply>::finished, &eventLoop, &QEventLoop::quit);
 
     QNetworkReply* networkReply;
     switch (method) {
@@ -426,28 +449,46 @@ HueReply HueBridge::sendRequest(const HueRequest request, HueAbstractObject* sen
         break;
     }
 
+    // Large replies (e.g. discovery) are parsed on the thread pool while the event
+    // loop keeps running, so the calling thread is not stalled by the parsing.
     connect(networkReply, &QNetworkReply::finished,
-            this, [this, &reply]()
+            this, [this, &request, &reply, &replyReceived, &eventTimer, &eventLoop, &parseWatcher]()
     {
         QNetworkReply* networkReply = qobject_cast<QNetworkReply*>(sender());
-        evaluateReply(networkReply, reply);
+        const int httpStatus = networkReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        const QByteArray replyBytes = networkReply->readAll();
+
+        replyReceived = true;
+        eventTimer.stop();
+
+        const bool rawObject = request.isRawReply();
+
+        if (rawObject || replyBytes.size() < m_offThreadParseThreshold) {
+            reply = parseReply(httpStatus, replyBytes, rawObject);
+            eventLoop.quit();
+        }
+        else {
+            parseWatcher.setFuture(QtConcurrent::run(&HueBridge::parseReply, httpStatus, replyBytes, false));
+        }
     },
     Qt::DirectConnection);
-    connect(networkReply, &QNetworkReply::finished,  &eventLoop, &QEventLoop::quit, Qt::DirectConnection);
 
     eventTimer.setSingleShot(true);
     eventTimer.start(m_networkRequestTimeout);
 
     eventLoop.exec();
 
-    if (eventTimer.isActive()) {
-        eventTimer.stop();
-    }
-    else {
+    if (!replyReceived) {
+        disconnect(networkReply, nullptr, this, nullptr);
         networkReply->abort();
         reply.timedOut(true);
         reply.isValid(false);
     }
+    else if (parseWatcher.future().resultCount() > 0) {
+        reply = parseWatcher.result();
+    }
+
+    m_lastReply = reply;
 
     // Block further bridge calls based on the type of command being sent
     // HueGroup commands have lower throughput than HueLight commands
@@ -590,35 +631,30 @@ QString HueBridge::createNewUser(QString name, HueReply reply)
     return username;
 }
 
-void HueBridge::evaluateReply(QNetworkReply* networkReply, HueReply& reply)
+HueReply HueBridge::parseReply(const int httpStatus, const QByteArray replyBytes, const bool rawObject)
 {
-    int statusCode = networkReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    reply.setHttpStatus(statusCode);
+    HueReply reply;
+    reply.timedOut(false);
+    reply.setHttpStatus(httpStatus);
 
-    QByteArray replyBytes = networkReply->readAll();
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(replyBytes);
+    // Objects are left to the caller to stream; errors always arrive as arrays
+    if (rawObject) {
+        int first = 0;
+        while (first < replyBytes.size() && QChar::isSpace(replyBytes.at(first)))
+            first++;
 
-    if (jsonDoc.isArray()) {
-        QJsonArray jsonArray = jsonDoc.array();
-        QJsonObject jsonRootObject = jsonArray[0].toObject();
-        if (jsonRootObject.contains("error")) {
-            QJsonObject jsonError = jsonRootObject["error"].toObject();
-
-            HueError error;
-            error.setType(jsonError["type"].toInt());
-            error.setAddress(jsonError["address"].toString());
-            error.setDescription(jsonError["description"].toString());
-
-            reply.setError(error);
-            reply.isValid(false);
-            reply.setJson(jsonError);
-        }
-        else if (jsonRootObject.contains("success")) {
-            QJsonObject jsonSuccess = jsonRootObject["success"].toObject();
+        if (first < replyBytes.size() && replyBytes.at(first) == '{') {
+            reply.setRawJson(replyBytes);
             reply.isValid(true);
-            reply.setJson(jsonSuccess);
+            return reply;
         }
     }
+
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(replyBytes);
+
+    if (jsonDoc.isArray()) {
+        reply.setResults(jsonDoc.array());
+    }
     else if (!jsonDoc.isEmpty()){
         QJsonObject jsonContent = jsonDoc.object();
         reply.setJson(jsonContent);
@@ -628,7 +664,7 @@ void HueBridge::evaluateReply(QNetworkReply* networkReply, HueReply& reply)
         reply.isValid(false);
     }
 
-    m_lastReply = reply;
+    return reply;
 }
 
 void HueBridge::block(const int sleepTimeMilliseconds)
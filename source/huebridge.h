@@ -34,6 +34,7 @@ public:
 
     QString getIP() const;
     QString getUsername() const;
+    QNetworkAccessManager* getNetworkAccessManager() const;
     HueReply getLastReply() const;
     HueError getLastError() const;
 
@@ -47,7 +48,7 @@ public:
 
 private:
     QString createNewUser(QString name, HueReply reply);
-    void evaluateReply(QNetworkReply* networkReply, HueReply& reply);
+    static HueReply parseReply(const int httpStatus, const QByteArray replyBytes, const bool rawObject);
     void block(const int sleepTimeMilliseconds);
 
 private:
@@ -55,6 +56,8 @@ private:
     const int m_defaultGroupCommandBlockTime = 100;
     const int m_defaultBridgeCommandBlockTime = 200;
     const int m_defaultNetworkRequestTimeout = 200;
+    // Smaller replies are parsed on the calling thread; handing them off costs more than parsing
+    const int m_offThreadParseThreshold = 16 * 1024;
 
     QNetworkAccessManager* m_nam;
     QString m_ip;
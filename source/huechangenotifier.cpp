@@ -0,0 +1,201 @@
+#include "huechangenotifier.h"
+
+#include <algorithm>
+
+/*!
+ * \class HueChangeNotifier
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Collects changes of lights and groups and reports them in batches.
+ *
+ * Every change to the local state of a \l HueAbstractObject, whether made by a
+ * \e set function, by \l HueEventStream or by synchronization, is recorded by the
+ * notifier. Changes are merged per object and reported by a single \l changed()
+ * signal, at most \l getMaxRate() times per second. Consumers such as models and
+ * views can connect to \l changed() instead of \l HueAbstractObject::valueUpdated()
+ * of every object, and redraw once per batch.
+ *
+ * A synchronization pass of \l HueSynchronizer is one batch: the objects it
+ * synchronizes are reported together when the pass is done.
+ *
+ * \code
+ *  connect(&HueChangeNotifier::instance(), &HueChangeNotifier::changed,
+ *          [](const HueChangeNotifier::ChangeSet& changes) {
+ *      for (const auto& change : changes) {
+ *          if (change.object && change.attributes & HueStateChange::BrightnessAttribute)
+ *              redrawBrightness(change.object->ID());
+ *      }
+ *  });
+ * \endcode
+ *
+ * \sa HueAbstractObject::valueUpdated()
+ *
+ */
+
+/*!
+ * \class HueChangeNotifier::Change
+ * \inmodule HueLib
+ * \brief Describes the changes of one object since the last batch.
+ *
+ * \c object is the changed object, or null if it has been deleted since.
+ * \c attributes holds the changed \l HueStateChange::Attribute values, and
+ * \c synchronized is \c true if the object was synchronized, in which case any
+ * attribute may have changed.
+ *
+ */
+
+HueChangeNotifier::HueChangeNotifier(QObject* parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_minInterval(1000 / defaultMaxRate)
+    , m_batchDepth(0)
+{
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &HueChangeNotifier::flush);
+    m_sinceFlush.start();
+}
+
+/*!
+ * \fn HueChangeNotifier& HueChangeNotifier::instance()
+ *
+ * Returns the notifier shared by all lights and groups.
+ *
+ */
+HueChangeNotifier& HueChangeNotifier::instance()
+{
+    static HueChangeNotifier singleton;
+    return singleton;
+}
+
+/*!
+ * \fn int HueChangeNotifier::getMaxRate() const
+ *
+ * Returns the maximum number of batches reported per second. Default is 60.
+ *
+ */
+int HueChangeNotifier::getMaxRate() const
+{
+    return 1000 / std::max(m_minInterval, 1);
+}
+
+/*!
+ * \fn void HueChangeNotifier::setMaxRate(const int flushesPerSecond)
+ *
+ * Sets the maximum number of batches reported per second as specified by
+ * \a flushesPerSecond (1 - 1000).
+ *
+ */
+void HueChangeNotifier::setMaxRate(const int flushesPerSecond)
+{
+    m_minInterval = 1000 / qBound(1, flushesPerSecond, 1000);
+}
+
+/*!
+ * \fn void HueChangeNotifier::beginBatch()
+ *
+ * Holds back \l changed() until the matching \l endBatch(). Calls can be nested.
+ *
+ */
+void HueChangeNotifier::beginBatch()
+{
+    m_batchDepth++;
+}
+
+/*!
+ * \fn void HueChangeNotifier::endBatch()
+ *
+ * Ends a batch started by \l beginBatch(). When the outermost batch ends, the
+ * collected changes are reported, subject to \l getMaxRate().
+ *
+ */
+void HueChangeNotifier::endBatch()
+{
+    if (m_batchDepth == 0)
+        return;
+
+    m_batchDepth--;
+
+    if (m_batchDepth == 0 && !m_pending.empty())
+        scheduleFlush();
+}
+
+/*!
+ * \fn bool HueChangeNotifier::isBatching() const
+ *
+ * Returns \c true between \l beginBatch() and the matching \l endBatch().
+ *
+ */
+bool HueChangeNotifier::isBatching() const
+{
+    return m_batchDepth > 0;
+}
+
+/*!
+ * \fn int HueChangeNotifier::pendingCount() const
+ *
+ * Returns the number of objects with changes that have not been reported yet.
+ *
+ */
+int HueChangeNotifier::pendingCount() const
+{
+    return static_cast<int>(m_pending.size());
+}
+
+/*!
+ * \fn void HueChangeNotifier::flush()
+ *
+ * Reports the collected changes right away with \l changed(), if there are any.
+ *
+ */
+void HueChangeNotifier::flush()
+{
+    m_timer->stop();
+
+    if (m_pending.empty())
+        return;
+
+    // Changes made by receivers go into the next batch
+    ChangeSet changes;
+    changes.swap(m_pending);
+    m_index.clear();
+    m_sinceFlush.restart();
+
+    emit changed(changes);
+}
+
+/*!
+ * \fn void HueChangeNotifier::changed(const HueChangeNotifier::ChangeSet& changes)
+ *
+ * This signal is emitted with the \a changes collected since the last batch,
+ * one \l Change per object.
+ *
+ */
+
+void HueChangeNotifier::markChanged(HueAbstractObject* object, const int attributes, const bool synchronized)
+{
+    auto it = m_index.constFind(object);
+
+    if (it != m_index.constEnd()) {
+        Change& change = m_pending[static_cast<size_t>(it.value())];
+        change.attributes |= attributes;
+        change.synchronized |= synchronized;
+    }
+    else {
+        m_index.insert(object, static_cast<int>(m_pending.size()));
+        m_pending.push_back({object, attributes, synchronized});
+    }
+
+    if (m_batchDepth == 0)
+        scheduleFlush();
+}
+
+// The first change after an idle period is reported on the next pass of the event
+// loop; later changes wait until the minimum interval has passed
+void HueChangeNotifier::scheduleFlush()
+{
+    if (m_timer->isActive())
+        return;
+
+    const qint64 elapsed = m_sinceFlush.elapsed();
+    m_timer->start(static_cast<int>(std::max<qint64>(0, m_minInterval - elapsed)));
+}
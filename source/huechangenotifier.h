@@ -0,0 +1,61 @@
+#ifndef HUECHANGENOTIFIER_H
+#define HUECHANGENOTIFIER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <vector>
+
+#include "hueabstractobject.h"
+
+class HueChangeNotifier : public QObject
+{
+    Q_OBJECT
+    friend class HueAbstractObject;
+
+public:
+    struct Change {
+        QPointer<HueAbstractObject> object;
+        int attributes;
+        bool synchronized;
+    };
+
+    typedef std::vector<Change> ChangeSet;
+
+    static HueChangeNotifier& instance();
+
+    int getMaxRate() const;
+    void setMaxRate(const int flushesPerSecond);
+
+    void beginBatch();
+    void endBatch();
+    bool isBatching() const;
+
+    int pendingCount() const;
+    void flush();
+
+signals:
+    void changed(const HueChangeNotifier::ChangeSet& changes);
+
+private:
+    explicit HueChangeNotifier(QObject* parent = nullptr);
+    HueChangeNotifier(const HueChangeNotifier& rhs) = delete;
+    HueChangeNotifier& operator=(HueChangeNotifier& rhs) = delete;
+
+    void markChanged(HueAbstractObject* object, const int attributes, const bool synchronized);
+    void scheduleFlush();
+
+private:
+    const int defaultMaxRate = 60;
+
+    QTimer* m_timer;
+    QElapsedTimer m_sinceFlush;
+    ChangeSet m_pending;
+    QHash<const HueAbstractObject*, int> m_index;
+    int m_minInterval;
+    int m_batchDepth;
+};
+
+#endif // HUECHANGENOTIFIER_H
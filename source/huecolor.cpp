@@ -0,0 +1,727 @@
+#include "huecolor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HUECOLOR_SSE2
+#endif
+
+/*!
+ * \class HueColor
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Converts colors to and from CIE xy coordinates in batches.
+ *
+ * HueColor converts sRGB, HSV and color temperatures (in mired) to the CIE \e xy
+ * coordinates used by \l HueAbstractObject::setXY(), and back. Coordinates can be
+ * clamped into the color gamut of a light, so the color that is sent is the closest
+ * color the light can actually show.
+ *
+ * All functions work on arrays of \c float, one array per component, and convert
+ * \e count colors per call. This suits e.g. ambient lighting, where thousands of
+ * sampled pixels are converted per frame. The arithmetic runs on AVX or SSE2 vectors
+ * when the library is built for them, and on plain floats otherwise; the results
+ * only differ in rounding. The sRGB transfer function is applied per value, and
+ * through a lookup table for 8-bit input.
+ *
+ * HueColor does not depend on Qt.
+ *
+ * \code
+ *  // Average color of each screen zone, as interleaved 8-bit RGB
+ *  std::vector<unsigned char> zones = sampleZones();
+ *  const int count = static_cast<int>(zones.size() / 3);
+ *
+ *  std::vector<float> x(count), y(count), luminance(count);
+ *  HueColor::rgb8ToXY(zones.data(), x.data(), y.data(), luminance.data(), count);
+ *  HueColor::clampToGamut(HueColor::GamutC, x.data(), y.data(), count);
+ * \endcode
+ *
+ */
+
+/*!
+ * \enum HueColor::Gamut
+ * This enum describes the color gamuts of Hue lights. Each gamut is a triangle in
+ * CIE \e xy space.
+ *
+ * \value GamutA
+ *      Gamut of older LivingColors and Lightstrips.
+ * \value GamutB
+ *      Gamut of the first generation of Hue bulbs.
+ * \value GamutC
+ *      Gamut of current Hue bulbs and Lightstrips Plus.
+ *
+ */
+
+/*!
+ * \class HueColor::Triangle
+ * \inmodule HueLib
+ * \brief The corners of a color gamut in CIE \e xy space, in the order red, green, blue.
+ *
+ */
+
+namespace {
+
+// Number of colors converted per chunk; temporary arrays live on the stack
+const int chunkSize = 256;
+
+// D65 white point, used for black where the chromaticity is undefined
+const float whiteX = 0.3127f;
+const float whiteY = 0.3290f;
+
+typedef HueColor::Triangle Triangle;
+
+const Triangle gamutTriangles[] = {
+    {0.704f, 0.296f, 0.2151f, 0.7106f, 0.138f, 0.08f},
+    {0.675f, 0.322f, 0.409f, 0.518f, 0.167f, 0.04f},
+    {0.6915f, 0.3083f, 0.17f, 0.7f, 0.1532f, 0.0475f}
+};
+
+struct ScalarOps {
+    typedef float V;
+    typedef bool M;
+    static const int width = 1;
+
+    static V load(const float* p) { return *p; }
+    static void store(float* p, const V v) { *p = v; }
+    static V set(const float f) { return f; }
+    static V add(const V a, const V b) { return a + b; }
+    static V sub(const V a, const V b) { return a - b; }
+    static V mul(const V a, const V b) { return a * b; }
+    static V div(const V a, const V b) { return a / b; }
+    static V min(const V a, const V b) { return a < b ? a : b; }
+    static V max(const V a, const V b) { return a > b ? a : b; }
+    static M less(const V a, const V b) { return a < b; }
+    static M lessEqual(const V a, const V b) { return a <= b; }
+    static M andMask(const M a, const M b) { return a && b; }
+    static V select(const M m, const V a, const V b) { return m ? a : b; }
+};
+
+#if defined(__AVX__)
+struct VectorOps {
+    typedef __m256 V;
+    typedef __m256 M;
+    static const int width = 8;
+
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, const V v) { _mm256_storeu_ps(p, v); }
+    static V set(const float f) { return _mm256_set1_ps(f); }
+    static V add(const V a, const V b) { return _mm256_add_ps(a, b); }
+    static V sub(const V a, const V b) { return _mm256_sub_ps(a, b); }
+    static V mul(const V a, const V b) { return _mm256_mul_ps(a, b); }
+    static V div(const V a, const V b) { return _mm256_div_ps(a, b); }
+    static V min(const V a, const V b) { return _mm256_min_ps(a, b); }
+    static V max(const V a, const V b) { return _mm256_max_ps(a, b); }
+    static M less(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static M lessEqual(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static M andMask(const M a, const M b) { return _mm256_and_ps(a, b); }
+    static V select(const M m, const V a, const V b) { return _mm256_blendv_ps(b, a, m); }
+};
+const char* const vectorInstructionSet = "AVX";
+#elif defined(HUECOLOR_SSE2)
+struct VectorOps {
+    typedef __m128 V;
+    typedef __m128 M;
+    static const int width = 4;
+
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, const V v) { _mm_storeu_ps(p, v); }
+    static V set(const float f) { return _mm_set1_ps(f); }
+    static V add(const V a, const V b) { return _mm_add_ps(a, b); }
+    static V sub(const V a, const V b) { return _mm_sub_ps(a, b); }
+    static V mul(const V a, const V b) { return _mm_mul_ps(a, b); }
+    static V div(const V a, const V b) { return _mm_div_ps(a, b); }
+    static V min(const V a, const V b) { return _mm_min_ps(a, b); }
+    static V max(const V a, const V b) { return _mm_max_ps(a, b); }
+    static M less(const V a, const V b) { return _mm_cmplt_ps(a, b); }
+    static M lessEqual(const V a, const V b) { return _mm_cmple_ps(a, b); }
+    static M andMask(const M a, const M b) { return _mm_and_ps(a, b); }
+    static V select(const M m, const V a, const V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+};
+const char* const vectorInstructionSet = "SSE2";
+#else
+typedef ScalarOps VectorOps;
+const char* const vectorInstructionSet = "scalar";
+#endif
+
+// Each kernel converts as many whole vectors as fit into count and returns the number
+// of colors converted; the caller converts the rest with ScalarOps.
+
+template<typename Ops>
+int linearRgbToXYKernel(const float* r, const float* g, const float* b,
+                        float* x, float* y, float* luminance, const int count)
+{
+    typedef typename Ops::V V;
+    typedef typename Ops::M M;
+
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        const V red = Ops::load(r + i);
+        const V green = Ops::load(g + i);
+        const V blue = Ops::load(b + i);
+
+        // sRGB primaries, D65 white point
+        const V X = Ops::add(Ops::add(Ops::mul(red, Ops::set(0.4124f)),
+                                      Ops::mul(green, Ops::set(0.3576f))),
+                             Ops::mul(blue, Ops::set(0.1805f)));
+        const V Y = Ops::add(Ops::add(Ops::mul(red, Ops::set(0.2126f)),
+                                      Ops::mul(green, Ops::set(0.7152f))),
+                             Ops::mul(blue, Ops::set(0.0722f)));
+        const V Z = Ops::add(Ops::add(Ops::mul(red, Ops::set(0.0193f)),
+                                      Ops::mul(green, Ops::set(0.1192f))),
+                             Ops::mul(blue, Ops::set(0.9505f)));
+
+        const V sum = Ops::add(Ops::add(X, Y), Z);
+        const M black = Ops::lessEqual(sum, Ops::set(1e-6f));
+        const V safeSum = Ops::select(black, Ops::set(1.0f), sum);
+
+        Ops::store(x + i, Ops::select(black, Ops::set(whiteX), Ops::div(X, safeSum)));
+        Ops::store(y + i, Ops::select(black, Ops::set(whiteY), Ops::div(Y, safeSum)));
+        Ops::store(luminance + i, Y);
+    }
+
+    return i;
+}
+
+template<typename Ops>
+int xyToLinearRgbKernel(const float* x, const float* y, const float* luminance,
+                        float* r, float* g, float* b, const int count)
+{
+    typedef typename Ops::V V;
+
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        const V vx = Ops::load(x + i);
+        const V vy = Ops::max(Ops::load(y + i), Ops::set(1e-6f));
+        const V Y = Ops::load(luminance + i);
+
+        const V scale = Ops::div(Y, vy);
+        const V X = Ops::mul(vx, scale);
+        const V Z = Ops::mul(Ops::sub(Ops::sub(Ops::set(1.0f), vx), vy), scale);
+
+        V red = Ops::add(Ops::add(Ops::mul(X, Ops::set(3.2406f)),
+                                  Ops::mul(Y, Ops::set(-1.5372f))),
+                         Ops::mul(Z, Ops::set(-0.4986f)));
+        V green = Ops::add(Ops::add(Ops::mul(X, Ops::set(-0.9689f)),
+                                    Ops::mul(Y, Ops::set(1.8758f))),
+                           Ops::mul(Z, Ops::set(0.0415f)));
+        V blue = Ops::add(Ops::add(Ops::mul(X, Ops::set(0.0557f)),
+                                   Ops::mul(Y, Ops::set(-0.2040f))),
+                          Ops::mul(Z, Ops::set(1.0570f)));
+
+        red = Ops::max(red, Ops::set(0.0f));
+        green = Ops::max(green, Ops::set(0.0f));
+        blue = Ops::max(blue, Ops::set(0.0f));
+
+        // Colors outside of sRGB are scaled down rather than clipped, keeping the hue
+        const V largest = Ops::max(Ops::max(Ops::max(red, green), blue), Ops::set(1.0f));
+
+        Ops::store(r + i, Ops::div(red, largest));
+        Ops::store(g + i, Ops::div(green, largest));
+        Ops::store(b + i, Ops::div(blue, largest));
+    }
+
+    return i;
+}
+
+template<typename Ops>
+int hsvToRgbKernel(const float* h, const float* s, const float* v,
+                   float* r, float* g, float* b, const int count)
+{
+    typedef typename Ops::V V;
+
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        const V hue = Ops::mul(Ops::min(Ops::max(Ops::load(h + i), Ops::set(0.0f)), Ops::set(1.0f)),
+                               Ops::set(6.0f));
+        const V saturation = Ops::min(Ops::max(Ops::load(s + i), Ops::set(0.0f)), Ops::set(1.0f));
+        const V value = Ops::min(Ops::max(Ops::load(v + i), Ops::set(0.0f)), Ops::set(1.0f));
+        const V chroma = Ops::mul(value, saturation);
+
+        // channel = v - c * clamp(min(k, 4 - k), 0, 1), with k = (n + 6h) mod 6
+        float* channels[] = {r, g, b};
+        const float offsets[] = {5.0f, 3.0f, 1.0f};
+
+        for (int c = 0; c < 3; c++) {
+            V k = Ops::add(hue, Ops::set(offsets[c]));
+            k = Ops::select(Ops::less(k, Ops::set(6.0f)), k, Ops::sub(k, Ops::set(6.0f)));
+
+            const V ramp = Ops::min(Ops::max(Ops::min(k, Ops::sub(Ops::set(4.0f), k)), Ops::set(0.0f)),
+                                    Ops::set(1.0f));
+
+            Ops::store(channels[c] + i, Ops::sub(value, Ops::mul(chroma, ramp)));
+        }
+    }
+
+    return i;
+}
+
+template<typename Ops>
+int miredToXYKernel(const float* mired, float* x, float* y, const int count)
+{
+    typedef typename Ops::V V;
+    typedef typename Ops::M M;
+
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        // Kim et al. cubic spline of the Planckian locus, valid for 1667 K - 25000 K
+        const V m = Ops::min(Ops::max(Ops::load(mired + i), Ops::set(40.0f)), Ops::set(600.0f));
+        const V u = Ops::mul(m, Ops::set(1e-6f));
+        const V u2 = Ops::mul(u, u);
+        const V u3 = Ops::mul(u2, u);
+
+        const V warmX = Ops::add(Ops::add(Ops::add(Ops::mul(u3, Ops::set(-0.2661239e9f)),
+                                                   Ops::mul(u2, Ops::set(-0.2343589e6f))),
+                                          Ops::mul(u, Ops::set(0.8776956e3f))),
+                                 Ops::set(0.179910f));
+        const V coldX = Ops::add(Ops::add(Ops::add(Ops::mul(u3, Ops::set(-3.0258469e9f)),
+                                                   Ops::mul(u2, Ops::set(2.1070379e6f))),
+                                          Ops::mul(u, Ops::set(0.2226347e3f))),
+                                 Ops::set(0.240390f));
+
+        // Below 4000 K
+        const M warm = Ops::lessEqual(Ops::set(250.0f), m);
+        // Below 2222 K
+        const M veryWarm = Ops::lessEqual(Ops::set(450.0f), m);
+
+        const V vx = Ops::select(warm, warmX, coldX);
+        const V x2 = Ops::mul(vx, vx);
+        const V x3 = Ops::mul(x2, vx);
+
+        const V veryWarmY = Ops::add(Ops::add(Ops::add(Ops::mul(x3, Ops::set(-1.1063814f)),
+                                                       Ops::mul(x2, Ops::set(-1.34811020f))),
+                                              Ops::mul(vx, Ops::set(2.18555832f))),
+                                     Ops::set(-0.20219683f));
+        const V warmY = Ops::add(Ops::add(Ops::add(Ops::mul(x3, Ops::set(-0.9549476f)),
+                                                   Ops::mul(x2, Ops::set(-1.37418593f))),
+                                          Ops::mul(vx, Ops::set(2.09137015f))),
+                                 Ops::set(-0.16748867f));
+        const V coldY = Ops::add(Ops::add(Ops::add(Ops::mul(x3, Ops::set(3.0817580f)),
+                                                   Ops::mul(x2, Ops::set(-5.87338670f))),
+                                          Ops::mul(vx, Ops::set(3.75112997f))),
+                                 Ops::set(-0.37001483f));
+
+        Ops::store(x + i, vx);
+        Ops::store(y + i, Ops::select(veryWarm, veryWarmY, Ops::select(warm, warmY, coldY)));
+    }
+
+    return i;
+}
+
+template<typename Ops>
+int xyToMiredKernel(const float* x, const float* y, float* mired, const int count)
+{
+    typedef typename Ops::V V;
+
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        // McCamy's approximation of the correlated color temperature
+        const V n = Ops::div(Ops::sub(Ops::load(x + i), Ops::set(0.3320f)),
+                             Ops::sub(Ops::set(0.1858f), Ops::load(y + i)));
+        V cct = Ops::add(Ops::mul(n, Ops::set(449.0f)), Ops::set(3525.0f));
+        cct = Ops::add(Ops::mul(cct, n), Ops::set(6823.3f));
+        cct = Ops::add(Ops::mul(cct, n), Ops::set(5520.33f));
+        cct = Ops::max(cct, Ops::set(1000.0f));
+
+        const V m = Ops::div(Ops::set(1e6f), cct);
+        Ops::store(mired + i, Ops::min(Ops::max(m, Ops::set(153.0f)), Ops::set(500.0f)));
+    }
+
+    return i;
+}
+
+template<typename Ops>
+void closestOnEdge(const typename Ops::V px, const typename Ops::V py,
+                   const float ax, const float ay, const float bx, const float by,
+                   typename Ops::V& cx, typename Ops::V& cy, typename Ops::V& distance)
+{
+    typedef typename Ops::V V;
+
+    const float dx = bx - ax;
+    const float dy = by - ay;
+    const float inverseLength = 1.0f / (dx * dx + dy * dy);
+
+    V t = Ops::mul(Ops::add(Ops::mul(Ops::sub(px, Ops::set(ax)), Ops::set(dx)),
+                            Ops::mul(Ops::sub(py, Ops::set(ay)), Ops::set(dy))),
+                   Ops::set(inverseLength));
+    t = Ops::min(Ops::max(t, Ops::set(0.0f)), Ops::set(1.0f));
+
+    cx = Ops::add(Ops::set(ax), Ops::mul(t, Ops::set(dx)));
+    cy = Ops::add(Ops::set(ay), Ops::mul(t, Ops::set(dy)));
+
+    const V ex = Ops::sub(px, cx);
+    const V ey = Ops::sub(py, cy);
+    distance = Ops::add(Ops::mul(ex, ex), Ops::mul(ey, ey));
+}
+
+template<typename Ops>
+typename Ops::V edgeSide(const typename Ops::V px, const typename Ops::V py,
+                         const float ax, const float ay, const float bx, const float by)
+{
+    return Ops::sub(Ops::mul(Ops::set(bx - ax), Ops::sub(py, Ops::set(ay))),
+                    Ops::mul(Ops::set(by - ay), Ops::sub(px, Ops::set(ax))));
+}
+
+template<typename Ops>
+int clampToGamutKernel(const Triangle& t, float* x, float* y, const int count)
+{
+    typedef typename Ops::V V;
+    typedef typename Ops::M M;
+
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        const V px = Ops::load(x + i);
+        const V py = Ops::load(y + i);
+
+        // The triangles run counter-clockwise from red to green to blue
+        const M inside = Ops::andMask(
+                    Ops::andMask(Ops::lessEqual(Ops::set(0.0f), edgeSide<Ops>(px, py, t.redX, t.redY, t.greenX, t.greenY)),
+                                 Ops::lessEqual(Ops::set(0.0f), edgeSide<Ops>(px, py, t.greenX, t.greenY, t.blueX, t.blueY))),
+                    Ops::lessEqual(Ops::set(0.0f), edgeSide<Ops>(px, py, t.blueX, t.blueY, t.redX, t.redY)));
+
+        V bestX, bestY, bestDistance;
+        closestOnEdge<Ops>(px, py, t.redX, t.redY, t.greenX, t.greenY, bestX, bestY, bestDistance);
+
+        V cx, cy, distance;
+        closestOnEdge<Ops>(px, py, t.greenX, t.greenY, t.blueX, t.blueY, cx, cy, distance);
+        M closer = Ops::less(distance, bestDistance);
+        bestX = Ops::select(closer, cx, bestX);
+        bestY = Ops::select(closer, cy, bestY);
+        bestDistance = Ops::select(closer, distance, bestDistance);
+
+        closestOnEdge<Ops>(px, py, t.blueX, t.blueY, t.redX, t.redY, cx, cy, distance);
+        closer = Ops::less(distance, bestDistance);
+        bestX = Ops::select(closer, cx, bestX);
+        bestY = Ops::select(closer, cy, bestY);
+
+        Ops::store(x + i, Ops::select(inside, px, bestX));
+        Ops::store(y + i, Ops::select(inside, py, bestY));
+    }
+
+    return i;
+}
+
+float srgbToLinear(const float value)
+{
+    const float c = std::min(std::max(value, 0.0f), 1.0f);
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(const float value)
+{
+    const float c = std::min(std::max(value, 0.0f), 1.0f);
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+void rgbToHsv(const float r, const float g, const float b, float& h, float& s, float& v)
+{
+    const float largest = std::max(std::max(r, g), b);
+    const float smallest = std::min(std::min(r, g), b);
+    const float chroma = largest - smallest;
+
+    v = largest;
+    s = largest > 0.0f ? chroma / largest : 0.0f;
+
+    if (chroma <= 0.0f)
+        h = 0.0f;
+    else if (largest == r)
+        h = (g - b) / chroma;
+    else if (largest == g)
+        h = (b - r) / chroma + 2.0f;
+    else
+        h = (r - g) / chroma + 4.0f;
+
+    h /= 6.0f;
+    if (h < 0.0f)
+        h += 1.0f;
+}
+
+// Returns the triangle with its corners in counter-clockwise order, as the kernels expect
+Triangle counterClockwise(const Triangle& t)
+{
+    const float cross = (t.greenX - t.redX) * (t.blueY - t.redY) - (t.greenY - t.redY) * (t.blueX - t.redX);
+
+    if (cross >= 0.0f)
+        return t;
+
+    Triangle flipped = t;
+    std::swap(flipped.greenX, flipped.blueX);
+    std::swap(flipped.greenY, flipped.blueY);
+    return flipped;
+}
+
+// Converts linear RGB to xy, vectors first and the remainder one by one
+void linearRgbToXY(const float* r, const float* g, const float* b,
+                   float* x, float* y, float* luminance, const int count)
+{
+    const int done = linearRgbToXYKernel<VectorOps>(r, g, b, x, y, luminance, count);
+    linearRgbToXYKernel<ScalarOps>(r + done, g + done, b + done,
+                                   x + done, y + done, luminance + done, count - done);
+}
+
+}
+
+/*!
+ * \fn void HueColor::rgbToXY(const float* r, const float* g, const float* b, float* x, float* y, float* luminance, const int count)
+ *
+ * Converts \a count sRGB colors, given by \a r, \a g and \a b (0.0 - 1.0), to CIE
+ * coordinates stored in \a x and \a y, and relative luminance (0.0 - 1.0) stored
+ * in \a luminance. Black is converted to the D65 white point.
+ *
+ * The luminance can be used as brightness; scale it by 254 for \l HueAbstractObject::setBrightness().
+ *
+ */
+void HueColor::rgbToXY(const float* r, const float* g, const float* b,
+                       float* x, float* y, float* luminance, const int count)
+{
+    float red[chunkSize];
+    float green[chunkSize];
+    float blue[chunkSize];
+
+    for (int start = 0; start < count; start += chunkSize) {
+        const int size = std::min(chunkSize, count - start);
+
+        for (int i = 0; i < size; i++) {
+            red[i] = srgbToLinear(r[start + i]);
+            green[i] = srgbToLinear(g[start + i]);
+            blue[i] = srgbToLinear(b[start + i]);
+        }
+
+        linearRgbToXY(red, green, blue, x + start, y + start, luminance + start, size);
+    }
+}
+
+/*!
+ * \fn void HueColor::rgb8ToXY(const unsigned char* rgb, float* x, float* y, float* luminance, const int count)
+ *
+ * Converts \a count sRGB colors, given as interleaved 8-bit values in \a rgb
+ * (i.e. 3 * \a count bytes), to CIE coordinates stored in \a x and \a y, and relative
+ * luminance (0.0 - 1.0) stored in \a luminance.
+ *
+ * \sa rgbToXY()
+ *
+ */
+void HueColor::rgb8ToXY(const unsigned char* rgb, float* x, float* y, float* luminance, const int count)
+{
+    static const struct LinearTable {
+        LinearTable()
+        {
+            for (int i = 0; i < 256; i++)
+                values[i] = srgbToLinear(i / 255.0f);
+        }
+        float values[256];
+    } table;
+
+    float red[chunkSize];
+    float green[chunkSize];
+    float blue[chunkSize];
+
+    for (int start = 0; start < count; start += chunkSize) {
+        const int size = std::min(chunkSize, count - start);
+        const unsigned char* pixel = rgb + 3 * start;
+
+        for (int i = 0; i < size; i++) {
+            red[i] = table.values[pixel[3 * i]];
+            green[i] = table.values[pixel[3 * i + 1]];
+            blue[i] = table.values[pixel[3 * i + 2]];
+        }
+
+        linearRgbToXY(red, green, blue, x + start, y + start, luminance + start, size);
+    }
+}
+
+/*!
+ * \fn void HueColor::xyToRgb(const float* x, const float* y, const float* luminance, float* r, float* g, float* b, const int count)
+ *
+ * Converts \a count colors, given as CIE coordinates \a x and \a y and relative
+ * luminance \a luminance, to sRGB colors (0.0 - 1.0) stored in \a r, \a g and \a b.
+ * Colors outside of sRGB are scaled down until they fit, which keeps their hue.
+ *
+ */
+void HueColor::xyToRgb(const float* x, const float* y, const float* luminance,
+                       float* r, float* g, float* b, const int count)
+{
+    const int done = xyToLinearRgbKernel<VectorOps>(x, y, luminance, r, g, b, count);
+    xyToLinearRgbKernel<ScalarOps>(x + done, y + done, luminance + done,
+                                   r + done, g + done, b + done, count - done);
+
+    for (int i = 0; i < count; i++) {
+        r[i] = linearToSrgb(r[i]);
+        g[i] = linearToSrgb(g[i]);
+        b[i] = linearToSrgb(b[i]);
+    }
+}
+
+/*!
+ * \fn void HueColor::hsvToXY(const float* h, const float* s, const float* v, float* x, float* y, float* luminance, const int count)
+ *
+ * Converts \a count colors in HSV, given by \a h, \a s and \a v (all 0.0 - 1.0, where
+ * a hue of 1.0 is a full turn), to CIE coordinates stored in \a x and \a y, and
+ * relative luminance stored in \a luminance. HSV is taken to be based on sRGB.
+ *
+ */
+void HueColor::hsvToXY(const float* h, const float* s, const float* v,
+                       float* x, float* y, float* luminance, const int count)
+{
+    float red[chunkSize];
+    float green[chunkSize];
+    float blue[chunkSize];
+
+    for (int start = 0; start < count; start += chunkSize) {
+        const int size = std::min(chunkSize, count - start);
+
+        const int done = hsvToRgbKernel<VectorOps>(h + start, s + start, v + start, red, green, blue, size);
+        hsvToRgbKernel<ScalarOps>(h + start + done, s + start + done, v + start + done,
+                                  red + done, green + done, blue + done, size - done);
+
+        for (int i = 0; i < size; i++) {
+            red[i] = srgbToLinear(red[i]);
+            green[i] = srgbToLinear(green[i]);
+            blue[i] = srgbToLinear(blue[i]);
+        }
+
+        linearRgbToXY(red, green, blue, x + start, y + start, luminance + start, size);
+    }
+}
+
+/*!
+ * \fn void HueColor::xyToHsv(const float* x, const float* y, const float* luminance, float* h, float* s, float* v, const int count)
+ *
+ * Converts \a count colors, given as CIE coordinates \a x and \a y and relative
+ * luminance \a luminance, to HSV stored in \a h, \a s and \a v (all 0.0 - 1.0).
+ *
+ * \sa xyToRgb()
+ *
+ */
+void HueColor::xyToHsv(const float* x, const float* y, const float* luminance,
+                       float* h, float* s, float* v, const int count)
+{
+    float red[chunkSize];
+    float green[chunkSize];
+    float blue[chunkSize];
+
+    for (int start = 0; start < count; start += chunkSize) {
+        const int size = std::min(chunkSize, count - start);
+
+        xyToRgb(x + start, y + start, luminance + start, red, green, blue, size);
+
+        for (int i = 0; i < size; i++)
+            rgbToHsv(red[i], green[i], blue[i], h[start + i], s[start + i], v[start + i]);
+    }
+}
+
+/*!
+ * \fn void HueColor::miredToXY(const float* mired, float* x, float* y, const int count)
+ *
+ * Converts \a count color temperatures in \a mired to the CIE coordinates on the
+ * Planckian locus, stored in \a x and \a y. Temperatures are clamped to 40 - 600 mired
+ * (25000 K - 1667 K), the range of the approximation.
+ *
+ */
+void HueColor::miredToXY(const float* mired, float* x, float* y, const int count)
+{
+    const int done = miredToXYKernel<VectorOps>(mired, x, y, count);
+    miredToXYKernel<ScalarOps>(mired + done, x + done, y + done, count - done);
+}
+
+/*!
+ * \fn void HueColor::xyToMired(const float* x, const float* y, float* mired, const int count)
+ *
+ * Converts \a count CIE coordinates \a x and \a y to the correlated color temperature,
+ * stored in \a mired. The results are clamped to 153 - 500 mired, the range of
+ * \l HueAbstractObject::setColorTemp(). Coordinates far from the Planckian locus do
+ * not have a meaningful color temperature.
+ *
+ */
+void HueColor::xyToMired(const float* x, const float* y, float* mired, const int count)
+{
+    const int done = xyToMiredKernel<VectorOps>(x, y, mired, count);
+    xyToMiredKernel<ScalarOps>(x + done, y + done, mired + done, count - done);
+}
+
+/*!
+ * \fn HueColor::Triangle HueColor::gamutTriangle(const Gamut gamut)
+ *
+ * Returns the corners of \a gamut in CIE \e xy space.
+ *
+ */
+HueColor::Triangle HueColor::gamutTriangle(const Gamut gamut)
+{
+    return gamutTriangles[gamut];
+}
+
+/*!
+ * \fn void HueColor::clampToGamut(const Gamut gamut, float* x, float* y, const int count)
+ *
+ * Moves each of the \a count CIE coordinates in \a x and \a y that lies outside of
+ * \a gamut to the closest point on the edge of the gamut. Coordinates inside the
+ * gamut are not changed.
+ *
+ * \sa isInGamut(), clampToTriangle()
+ *
+ */
+void HueColor::clampToGamut(const Gamut gamut, float* x, float* y, const int count)
+{
+    clampToTriangle(gamutTriangles[gamut], x, y, count);
+}
+
+/*!
+ * \fn bool HueColor::isInGamut(const Gamut gamut, const double x, const double y)
+ *
+ * Returns \c true if the CIE coordinates \a x and \a y lie inside \a gamut.
+ *
+ */
+bool HueColor::isInGamut(const Gamut gamut, const double x, const double y)
+{
+    return isInTriangle(gamutTriangles[gamut], x, y);
+}
+
+/*!
+ * \fn void HueColor::clampToTriangle(const Triangle& triangle, float* x, float* y, const int count)
+ *
+ * Moves each of the \a count CIE coordinates in \a x and \a y that lies outside of
+ * \a triangle to the closest point on its edge. Used for gamuts reported by a light
+ * that do not match one of the \l Gamut values.
+ *
+ * \sa clampToGamut()
+ *
+ */
+void HueColor::clampToTriangle(const Triangle& triangle, float* x, float* y, const int count)
+{
+    const Triangle t = counterClockwise(triangle);
+
+    const int done = clampToGamutKernel<VectorOps>(t, x, y, count);
+    clampToGamutKernel<ScalarOps>(t, x + done, y + done, count - done);
+}
+
+/*!
+ * \fn bool HueColor::isInTriangle(const Triangle& triangle, const double x, const double y)
+ *
+ * Returns \c true if the CIE coordinates \a x and \a y lie inside \a triangle.
+ *
+ */
+bool HueColor::isInTriangle(const Triangle& triangle, const double x, const double y)
+{
+    const Triangle t = counterClockwise(triangle);
+    const float px = static_cast<float>(x);
+    const float py = static_cast<float>(y);
+
+    return edgeSide<ScalarOps>(px, py, t.redX, t.redY, t.greenX, t.greenY) >= 0.0f
+            && edgeSide<ScalarOps>(px, py, t.greenX, t.greenY, t.blueX, t.blueY) >= 0.0f
+            && edgeSide<ScalarOps>(px, py, t.blueX, t.blueY, t.redX, t.redY) >= 0.0f;
+}
+
+/*!
+ * \fn const char* HueColor::instructionSet()
+ *
+ * Returns the instruction set the conversions were built for: \e "AVX", \e "SSE2"
+ * or \e "scalar".
+ *
+ */
+const char* HueColor::instructionSet()
+{
+    return vectorInstructionSet;
+}
@@ -0,0 +1,44 @@
+#ifndef HUECOLOR_H
+#define HUECOLOR_H
+
+class HueColor
+{
+public:
+    enum Gamut {
+        GamutA,
+        GamutB,
+        GamutC
+    };
+
+    struct Triangle {
+        float redX, redY;
+        float greenX, greenY;
+        float blueX, blueY;
+    };
+
+    static Triangle gamutTriangle(const Gamut gamut);
+
+    static void rgbToXY(const float* r, const float* g, const float* b,
+                        float* x, float* y, float* luminance, const int count);
+    static void rgb8ToXY(const unsigned char* rgb,
+                         float* x, float* y, float* luminance, const int count);
+    static void xyToRgb(const float* x, const float* y, const float* luminance,
+                        float* r, float* g, float* b, const int count);
+
+    static void hsvToXY(const float* h, const float* s, const float* v,
+                        float* x, float* y, float* luminance, const int count);
+    static void xyToHsv(const float* x, const float* y, const float* luminance,
+                        float* h, float* s, float* v, const int count);
+
+    static void miredToXY(const float* mired, float* x, float* y, const int count);
+    static void xyToMired(const float* x, const float* y, float* mired, const int count);
+
+    static void clampToGamut(const Gamut gamut, float* x, float* y, const int count);
+    static bool isInGamut(const Gamut gamut, const double x, const double y);
+    static void clampToTriangle(const Triangle& triangle, float* x, float* y, const int count);
+    static bool isInTriangle(const Triangle& triangle, const double x, const double y);
+
+    static const char* instructionSet();
+};
+
+#endif // HUECOLOR_H
@@ -0,0 +1,46 @@
+#ifndef HUECONCURRENT_H
+#define HUECONCURRENT_H
+
+#include <QEventLoop>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <numeric>
+#include <vector>
+
+namespace HueConcurrent {
+
+// Waits for future while processing events, like the blocking calls to HueBridge,
+// so the calling (usually GUI) thread is not stalled while the work runs on the pool.
+template<typename T>
+T await(const QFuture<T>& future)
+{
+    QFutureWatcher<T> watcher;
+    QEventLoop eventLoop;
+
+    QObject::connect(&watcher, &QFutureWatcher<T>::finished,
+                     &eventLoop, &QEventLoop::quit);
+
+    watcher.setFuture(future);
+
+    if (!watcher.isFinished())
+        eventLoop.exec();
+
+    return watcher.result();
+}
+
+// Calls function(index) for every index in [0, count) on the thread pool and returns
+// when all calls have finished. The calling thread takes part in the work, so this can
+// also be used from a task that already runs on the pool.
+template<typename Function>
+void parallelFor(const int count, Function function)
+{
+    std::vector<int> indices(static_cast<size_t>(count));
+    std::iota(indices.begin(), indices.end(), 0);
+
+    QtConcurrent::blockingMap(indices, [&function](const int index) { function(index); });
+}
+
+}
+
+#endif // HUECONCURRENT_H
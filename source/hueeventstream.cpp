@@ -0,0 +1,674 @@
+#include "hueeventstream.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <vector>
+
+#include "hueabstractobject.h"
+#include "huebridge.h"
+#include "huestatechange.h"
+#include "huechangenotifier.h"
+
+/*!
+ * \class HueEventStream
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Applies changes pushed by the bridge over its event stream.
+ *
+ * Periodic synchronization (\l HueSynchronizer) polls every object at a fixed interval,
+ * so changes made elsewhere show up late and every poll costs a request. Bridges with
+ * API v2 instead push changes as server-sent events over one long-lived HTTPS connection
+ * (\e /eventstream/clip/v2).
+ *
+ * HueEventStream keeps that connection open and parses events as they arrive. Each
+ * resource update is matched to a registered \l HueLight or \l HueGroup through its
+ * \e id_v1 (e.g. \e /lights/3), and the changes to \e on, brightness, color temperature
+ * and \e xy are applied in place. The object emits \l HueAbstractObject::valueUpdated()
+ * as it does after a successful command.
+ *
+ * Polling is only the fallback. While the stream is down, registered objects are
+ * synchronized every \l getFallbackPollInterval() milliseconds, and the stream is
+ * reconnected with exponential backoff (1 - 30 seconds). After a reconnect, all objects
+ * are synchronized once, since events may have been missed.
+ *
+ * \code
+ *  HueEventStream* eventStream = new HueEventStream(bridge, this);
+ *
+ *  for (auto light : lights)
+ *      eventStream->addHueObject(light);
+ *
+ *  eventStream->start();
+ * \endcode
+ *
+ * Objects registered with HueEventStream should not also use
+ * \l HueAbstractObject::enablePeriodicSync(). \l setUrl() can point the stream to a
+ * local server, e.g. in tests.
+ *
+ * The bridge uses a self-signed certificate, which fails the normal certificate checks.
+ * Since every request carries the application key, the stream is only opened if the
+ * certificate of the bridge matches the one set by \l setPinnedCertificate(). Otherwise
+ * \l sslErrors() is emitted with the certificate the bridge presented, which the
+ * application can verify (e.g. once, on first use) and pin for the next reconnect.
+ * \l setInsecureConnectionAllowed() turns the check off.
+ *
+ * \sa HueSynchronizer
+ */
+
+namespace {
+
+// A stream that never completes an event is not a valid event stream
+const int maxBufferSize = 1024 * 1024;
+
+QByteArray fieldValue(const QByteArray& line, const int nameSize)
+{
+    QByteArray value = line.mid(nameSize);
+
+    if (value.startsWith(' '))
+        value.remove(0, 1);
+
+    return value;
+}
+
+bool isPinnableError(const QSslError::SslError error)
+{
+    switch (error) {
+    case QSslError::SelfSignedCertificate:
+    case QSslError::SelfSignedCertificateInChain:
+    case QSslError::UnableToGetLocalIssuerCertificate:
+    case QSslError::UnableToVerifyFirstCertificate:
+    case QSslError::CertificateUntrusted:
+    case QSslError::HostNameMismatch:
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+
+/*!
+ * \fn HueEventStream::HueEventStream(HueBridge* bridge, QObject* parent)
+ *
+ * Constructs a HueEventStream for \a bridge without any objects. A \e QObject parent
+ * can be set by \a parent.
+ *
+ */
+HueEventStream::HueEventStream(HueBridge* bridge, QObject* parent)
+    : QObject(parent)
+    , m_bridge(bridge)
+    , m_url()
+    , m_pinnedCertificate()
+    , m_insecureConnectionAllowed(false)
+    , m_reply()
+    , m_buffer()
+    , m_lastEventID()
+    , m_hueObjects()
+    , m_reconnectTimer(new QTimer(this))
+    , m_pollTimer(new QTimer(this))
+    , m_reconnectDelay(m_minReconnectDelay)
+    , m_isActive(false)
+    , m_isConnected(false)
+    , m_needsResync(false)
+    , m_eventsReceived(0)
+    , m_eventsApplied(0)
+{
+    m_reconnectTimer->setSingleShot(true);
+    m_pollTimer->setSingleShot(false);
+    m_pollTimer->setInterval(m_defaultFallbackPollInterval);
+
+    connect(m_reconnectTimer, &QTimer::timeout,
+            this, &HueEventStream::connectStream);
+    connect(m_pollTimer, &QTimer::timeout,
+            this, &HueEventStream::pollObjects);
+}
+
+HueEventStream::~HueEventStream()
+{
+    if (m_reply) {
+        QNetworkReply* reply = m_reply.data();
+
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
+/*!
+ * \fn QUrl HueEventStream::getUrl() const
+ *
+ * Returns the URL of the event stream. Unless set by \l setUrl(), this is
+ * \e https://<bridge IP>/eventstream/clip/v2.
+ *
+ */
+QUrl HueEventStream::getUrl() const
+{
+    if (m_url.isValid())
+        return m_url;
+
+    return QUrl("https://" + m_bridge->getIP() + "/eventstream/clip/v2");
+}
+
+/*!
+ * \fn void HueEventStream::setUrl(const QUrl& url)
+ *
+ * Sets the URL of the event stream to \a url. Takes effect on the next connection.
+ *
+ */
+void HueEventStream::setUrl(const QUrl& url)
+{
+    m_url = url;
+}
+
+/*!
+ * \fn int HueEventStream::getFallbackPollInterval() const
+ *
+ * Returns the interval in milliseconds at which objects are polled while the
+ * stream is disconnected.
+ *
+ */
+int HueEventStream::getFallbackPollInterval() const
+{
+    return m_pollTimer->interval();
+}
+
+/*!
+ * \fn void HueEventStream::setFallbackPollInterval(const int milliseconds)
+ *
+ * Sets the interval at which objects are polled while the stream is disconnected
+ * to \a milliseconds.
+ *
+ */
+void HueEventStream::setFallbackPollInterval(const int milliseconds)
+{
+    if (milliseconds > 0)
+        m_pollTimer->setInterval(milliseconds);
+    else
+        m_pollTimer->setInterval(m_defaultFallbackPollInterval);
+}
+
+/*!
+ * \fn QSslCertificate HueEventStream::getPinnedCertificate() const
+ *
+ * Returns the certificate the bridge must present, or a null certificate if none is set.
+ *
+ */
+QSslCertificate HueEventStream::getPinnedCertificate() const
+{
+    return m_pinnedCertificate;
+}
+
+/*!
+ * \fn void HueEventStream::setPinnedCertificate(const QSslCertificate& certificate)
+ *
+ * Sets the certificate the bridge must present to \a certificate. Errors caused by the
+ * certificate being self-signed or issued for another host name are accepted for this
+ * certificate only. Takes effect on the next connection.
+ *
+ * \sa sslErrors()
+ */
+void HueEventStream::setPinnedCertificate(const QSslCertificate& certificate)
+{
+    m_pinnedCertificate = certificate;
+}
+
+/*!
+ * \fn bool HueEventStream::isInsecureConnectionAllowed() const
+ *
+ * Returns \c true if SSL errors on the stream are ignored.
+ *
+ */
+bool HueEventStream::isInsecureConnectionAllowed() const
+{
+    return m_insecureConnectionAllowed;
+}
+
+/*!
+ * \fn void HueEventStream::setInsecureConnectionAllowed(const bool allowed)
+ *
+ * Ignores all SSL errors on the stream if \a allowed is \c true. Anyone able to
+ * intercept the connection then receives the application key, so this should only
+ * be used on trusted networks. Disabled by default.
+ *
+ */
+void HueEventStream::setInsecureConnectionAllowed(const bool allowed)
+{
+    m_insecureConnectionAllowed = allowed;
+}
+
+/*!
+ * \fn bool HueEventStream::addHueObject(std::shared_ptr<HueAbstractObject> object)
+ *
+ * Registers \a object, a \l HueLight or \l HueGroup, to receive changes from the stream.
+ *
+ * Returns false if \a object is not valid or already registered.
+ *
+ */
+bool HueEventStream::addHueObject(std::shared_ptr<HueAbstractObject> object)
+{
+    if (object == nullptr || !object->isValid())
+        return false;
+
+    const QString path = resourcePath(object.get());
+
+    if (path.isEmpty() || m_hueObjects.contains(path))
+        return false;
+
+    m_hueObjects.insert(path, object);
+    return true;
+}
+
+/*!
+ * \fn bool HueEventStream::removeHueObject(std::shared_ptr<HueAbstractObject> object)
+ *
+ * Unregisters \a object. Returns false if \a object was not registered.
+ *
+ */
+bool HueEventStream::removeHueObject(std::shared_ptr<HueAbstractObject> object)
+{
+    if (object == nullptr)
+        return false;
+
+    auto it = m_hueObjects.find(resourcePath(object.get()));
+
+    if (it == m_hueObjects.end() || it.value() != object)
+        return false;
+
+    m_hueObjects.erase(it);
+    return true;
+}
+
+/*!
+ * \fn int HueEventStream::objectCount() const
+ *
+ * Returns the number of registered objects.
+ *
+ */
+int HueEventStream::objectCount() const
+{
+    return m_hueObjects.size();
+}
+
+/*!
+ * \fn void HueEventStream::start()
+ *
+ * Connects to the event stream. Registered objects are polled until the connection
+ * is established.
+ *
+ */
+void HueEventStream::start()
+{
+    if (m_isActive)
+        return;
+
+    m_isActive = true;
+    m_reconnectDelay = m_minReconnectDelay;
+    m_pollTimer->start();
+
+    connectStream();
+}
+
+/*!
+ * \fn void HueEventStream::stop()
+ *
+ * Closes the event stream and stops polling.
+ *
+ */
+void HueEventStream::stop()
+{
+    m_isActive = false;
+    m_reconnectTimer->stop();
+    m_pollTimer->stop();
+
+    if (m_reply) {
+        QNetworkReply* reply = m_reply;
+        m_reply = nullptr;
+
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        reply->deleteLater();
+    }
+
+    m_buffer.clear();
+    setConnected(false);
+}
+
+/*!
+ * \fn bool HueEventStream::isActive() const
+ *
+ * Returns true if the stream has been started.
+ *
+ */
+bool HueEventStream::isActive() const
+{
+    return m_isActive;
+}
+
+/*!
+ * \fn bool HueEventStream::isConnected() const
+ *
+ * Returns true if the event stream is connected.
+ *
+ */
+bool HueEventStream::isConnected() const
+{
+    return m_isConnected;
+}
+
+/*!
+ * \fn int HueEventStream::eventsReceived() const
+ *
+ * Returns the number of resource updates received.
+ *
+ */
+int HueEventStream::eventsReceived() const
+{
+    return m_eventsReceived;
+}
+
+/*!
+ * \fn int HueEventStream::eventsApplied() const
+ *
+ * Returns the number of resource updates applied to a registered object.
+ *
+ */
+int HueEventStream::eventsApplied() const
+{
+    return m_eventsApplied;
+}
+
+/*!
+ * \fn void HueEventStream::connected()
+ *
+ * This signal is emitted when the event stream is connected.
+ *
+ */
+
+/*!
+ * \fn void HueEventStream::disconnected()
+ *
+ * This signal is emitted when the event stream is lost or closed.
+ *
+ */
+
+/*!
+ * \fn void HueEventStream::sslErrors(const QList<QSslError>& errors)
+ *
+ * This signal is emitted when the stream is not opened because of SSL \a errors,
+ * e.g. since the certificate of the bridge is not pinned. The certificate the bridge
+ * presented is available from \e QSslError::certificate(). Objects are polled until
+ * a later reconnect succeeds.
+ *
+ * \sa setPinnedCertificate()
+ */
+
+void HueEventStream::connectStream()
+{
+    if (!m_isActive || m_reply)
+        return;
+
+    QNetworkRequest request(getUrl());
+    request.setRawHeader("Accept", "text/event-stream");
+    request.setRawHeader("hue-application-key", m_bridge->getUsername().toUtf8());
+
+    if (!m_lastEventID.isEmpty())
+        request.setRawHeader("Last-Event-ID", m_lastEventID);
+
+    m_buffer.clear();
+    QNetworkReply* reply = m_bridge->getNetworkAccessManager()->get(request);
+    m_reply = reply;
+
+    connect(reply, &QNetworkReply::readyRead,
+            this, &HueEventStream::readStream);
+    connect(reply, &QNetworkReply::finished,
+            this, &HueEventStream::streamFinished);
+    connect(reply, &QNetworkReply::sslErrors,
+            this, &HueEventStream::handleSslErrors);
+}
+
+void HueEventStream::readStream()
+{
+    if (!m_reply)
+        return;
+
+    if (!m_isConnected) {
+        // Error bodies are not events; the reply finishing triggers a reconnect
+        if (m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200)
+            return;
+
+        setConnected(true);
+    }
+
+    const QByteArray data = m_reply->readAll();
+    m_buffer.reserve(m_buffer.size() + data.size());
+
+    for (const char character : data) {
+        if (character != '\r')
+            m_buffer.append(character);
+    }
+
+    if (m_buffer.size() > maxBufferSize) {
+        m_reply->abort();
+        return;
+    }
+
+    parseBuffer();
+}
+
+void HueEventStream::streamFinished()
+{
+    if (m_reply) {
+        m_reply->deleteLater();
+        m_reply = nullptr;
+    }
+
+    m_buffer.clear();
+    setConnected(false);
+
+    if (!m_isActive)
+        return;
+
+    // Changes made while disconnected are only picked up by polling
+    m_needsResync = true;
+
+    if (!m_pollTimer->isActive())
+        m_pollTimer->start();
+
+    m_reconnectTimer->start(m_reconnectDelay);
+    m_reconnectDelay = qMin(m_reconnectDelay * 2, m_maxReconnectDelay);
+}
+
+void HueEventStream::handleSslErrors(const QList<QSslError>& errors)
+{
+    if (!m_reply)
+        return;
+
+    if (m_insecureConnectionAllowed) {
+        m_reply->ignoreSslErrors(errors);
+        return;
+    }
+
+    // A pinned certificate identifies the bridge, so only the checks of the issuer and
+    // host name that a self-signed bridge certificate fails are skipped
+    if (!m_pinnedCertificate.isNull()
+            && m_reply->sslConfiguration().peerCertificate() == m_pinnedCertificate) {
+        bool pinnedErrorsOnly = true;
+
+        for (const QSslError& error : errors) {
+            if (!isPinnableError(error.error()))
+                pinnedErrorsOnly = false;
+        }
+
+        if (pinnedErrorsOnly) {
+            m_reply->ignoreSslErrors(errors);
+            return;
+        }
+    }
+
+    emit sslErrors(errors);
+}
+
+void HueEventStream::pollObjects()
+{
+    // synchronize() blocks in a local event loop, during which objects can be removed
+    std::vector<std::shared_ptr<HueAbstractObject>> hueObjects;
+    hueObjects.reserve(static_cast<size_t>(m_hueObjects.size()));
+
+    for (auto it = m_hueObjects.constBegin(); it != m_hueObjects.constEnd(); ++it)
+        hueObjects.push_back(it.value());
+
+    for (auto& object : hueObjects)
+        object->synchronize();
+}
+
+void HueEventStream::setConnected(const bool isConnected)
+{
+    if (m_isConnected == isConnected)
+        return;
+
+    m_isConnected = isConnected;
+
+    if (isConnected) {
+        m_reconnectDelay = m_minReconnectDelay;
+        m_pollTimer->stop();
+
+        if (m_needsResync) {
+            m_needsResync = false;
+            QTimer::singleShot(0, this, &HueEventStream::pollObjects);
+        }
+
+        emit connected();
+    }
+    else {
+        emit disconnected();
+    }
+}
+
+void HueEventStream::parseBuffer()
+{
+    int eventEnd = m_buffer.indexOf("\n\n");
+
+    // Events that arrive together are reported as one batch
+    HueChangeNotifier::instance().beginBatch();
+
+    while (eventEnd >= 0) {
+        const QByteArray block = m_buffer.left(eventEnd);
+        m_buffer.remove(0, eventEnd + 2);
+
+        QByteArray data;
+        int lineStart = 0;
+
+        while (lineStart <= block.size()) {
+            int lineEnd = block.indexOf('\n', lineStart);
+            if (lineEnd < 0)
+                lineEnd = block.size();
+
+            const QByteArray line = block.mid(lineStart, lineEnd - lineStart);
+
+            // Lines starting with ':' are comments, used as keep-alives
+            if (line.startsWith("data:")) {
+                if (!data.isEmpty())
+                    data.append('\n');
+                data.append(fieldValue(line, 5));
+            }
+            else if (line.startsWith("id:")) {
+                m_lastEventID = fieldValue(line, 3);
+            }
+
+            lineStart = lineEnd + 1;
+        }
+
+        if (!data.isEmpty())
+            parseEvent(data);
+
+        eventEnd = m_buffer.indexOf("\n\n");
+    }
+
+    HueChangeNotifier::instance().endBatch();
+}
+
+void HueEventStream::parseEvent(const QByteArray& data)
+{
+    const QJsonDocument document = QJsonDocument::fromJson(data);
+
+    if (!document.isArray())
+        return;
+
+    const QJsonArray events = document.array();
+
+    for (int i = 0; i < events.size(); i++) {
+        const QJsonObject event = events.at(i).toObject();
+
+        if (event.value("type").toString() != "update")
+            continue;
+
+        const QJsonArray resources = event.value("data").toArray();
+
+        for (int j = 0; j < resources.size(); j++)
+            applyResource(resources.at(j).toObject());
+    }
+}
+
+void HueEventStream::applyResource(const QJsonObject& resource)
+{
+    m_eventsReceived++;
+
+    auto it = m_hueObjects.find(resource.value("id_v1").toString());
+
+    if (it == m_hueObjects.end())
+        return;
+
+    const HueStateChange change = toStateChange(resource);
+
+    if (change.isEmpty())
+        return;
+
+    it.value()->applyStateChange(change);
+    m_eventsApplied++;
+}
+
+QString HueEventStream::resourcePath(HueAbstractObject* object)
+{
+    switch (object->objectKind()) {
+    case HueAbstractObject::LightKind:
+        return "/lights/" + QString::number(object->ID());
+    case HueAbstractObject::GroupKind:
+        return "/groups/" + QString::number(object->ID());
+    }
+
+    return QString();
+}
+
+HueStateChange HueEventStream::toStateChange(const QJsonObject& resource)
+{
+    HueStateChange change;
+
+    if (resource.contains("on")) {
+        const QJsonValue on = resource.value("on").toObject().value("on");
+        if (on.isBool())
+            change.setOn(on.toBool());
+    }
+
+    // API v2 reports brightness in percent
+    if (resource.contains("dimming")) {
+        const QJsonValue brightness = resource.value("dimming").toObject().value("brightness");
+        if (brightness.isDouble())
+            change.setBrightness(qBound(1, qRound(brightness.toDouble() * 254.0 / 100.0), 254));
+    }
+
+    if (resource.contains("color_temperature")) {
+        const QJsonValue mirek = resource.value("color_temperature").toObject().value("mirek");
+        if (mirek.isDouble())
+            change.setColorTemp(mirek.toInt());
+    }
+
+    if (resource.contains("color")) {
+        const QJsonObject xy = resource.value("color").toObject().value("xy").toObject();
+        if (xy.contains("x") && xy.contains("y"))
+            change.setXY(xy.value("x").toDouble(), xy.value("y").toDouble());
+    }
+
+    return change;
+}
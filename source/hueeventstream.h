@@ -0,0 +1,92 @@
+#ifndef HUEEVENTSTREAM_H
+#define HUEEVENTSTREAM_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMap>
+#include <QPointer>
+#include <QSslCertificate>
+#include <QSslError>
+#include <QTimer>
+#include <QUrl>
+#include <memory>
+
+class HueBridge;
+class HueAbstractObject;
+class HueStateChange;
+class QNetworkReply;
+
+class HueEventStream : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HueEventStream(HueBridge* bridge, QObject* parent = nullptr);
+    ~HueEventStream();
+
+    QUrl getUrl() const;
+    void setUrl(const QUrl& url);
+    int getFallbackPollInterval() const;
+    void setFallbackPollInterval(const int milliseconds);
+    QSslCertificate getPinnedCertificate() const;
+    void setPinnedCertificate(const QSslCertificate& certificate);
+    bool isInsecureConnectionAllowed() const;
+    void setInsecureConnectionAllowed(const bool allowed);
+
+    bool addHueObject(std::shared_ptr<HueAbstractObject> object);
+    bool removeHueObject(std::shared_ptr<HueAbstractObject> object);
+    int objectCount() const;
+
+    void start();
+    void stop();
+    bool isActive() const;
+    bool isConnected() const;
+
+    int eventsReceived() const;
+    int eventsApplied() const;
+
+signals:
+    void connected();
+    void disconnected();
+    void sslErrors(const QList<QSslError>& errors);
+
+private slots:
+    void connectStream();
+    void readStream();
+    void streamFinished();
+    void handleSslErrors(const QList<QSslError>& errors);
+    void pollObjects();
+
+private:
+    void setConnected(const bool isConnected);
+    void parseBuffer();
+    void parseEvent(const QByteArray& data);
+    void applyResource(const QJsonObject& resource);
+
+    static QString resourcePath(HueAbstractObject* object);
+    static HueStateChange toStateChange(const QJsonObject& resource);
+
+private:
+    const int m_defaultFallbackPollInterval = 5000;
+    const int m_minReconnectDelay = 1000;
+    const int m_maxReconnectDelay = 30000;
+
+    HueBridge* m_bridge;
+    QUrl m_url;
+    QSslCertificate m_pinnedCertificate;
+    bool m_insecureConnectionAllowed;
+    QPointer<QNetworkReply> m_reply;
+    QByteArray m_buffer;
+    QByteArray m_lastEventID;
+    QMap<QString, std::shared_ptr<HueAbstractObject>> m_hueObjects;
+    QTimer* m_reconnectTimer;
+    QTimer* m_pollTimer;
+    int m_reconnectDelay;
+    bool m_isActive;
+    bool m_isConnected;
+    bool m_needsResync;
+    int m_eventsReceived;
+    int m_eventsApplied;
+};
+
+#endif // HUEEVENTSTREAM_H
@@ -3,7 +3,14 @@
 #include "huebridge.h"
 #include "huerequest.h"
 #include "huereply.h"
+#include "huestatechange.h"
+#include "hueconcurrent.h"
+#include "huejsonreader.h"
+
+#include <QtConcurrent>
 #include "huelight.h"
+#include "huechangenotifier.h"
+#include "huescene.h"
 
 
 /*!
@@ -103,6 +110,12 @@
  *
  * \endtable
  *
+ * When a \e set function succeeds, the change is also applied to the local state of
+ * the member lights returned by \l HueLight::discoverLights() for the same bridge,
+ * as far as each light can show it, and \l Group::State is updated to match. The
+ * lights therefore do not have to be synchronized after a group command; the next
+ * synchronization replaces the local state with that of the bridge.
+ *
  * Data can be retreved from HueGroup by calling the functions in the table below.
  * \note The data follows the convension of the Hue API, where some data is nested
  * and some is not. For consistency, all data functions return an object of a data
@@ -312,6 +325,7 @@ HueGroupList HueGroup::discoverGroups(HueBridge *bridge)
     std::shared_ptr<GroupVector> groups = std::make_shared<GroupVector>();
 
     HueRequest request("groups", QJsonObject(), HueRequest::Get);
+    request.setRawReply(true);
     HueReply reply = bridge->sendRequest(request, nullptr);
 
     if (!reply.isValid() || reply.timedOut() || reply.containsError()) {
@@ -319,22 +333,23 @@ HueGroupList HueGroup::discoverGroups(HueBridge *bridge)
         return HueGroupList();
     }
 
-    QJsonObject json = reply.getJson();
-    auto parsedJsonWithIDs = HueAbstractObject::parseJson(json);
+    // Parsing a large reply is slow enough to stall the GUI, so it runs on the
+    // thread pool. The records are read straight from the reply bytes, without
+    // building a QJsonDocument, and the groups are read in parallel. Only the finished
+    // records come back to this thread.
+    const QByteArray json = reply.getRawJson();
+    const std::vector<Group::Record> records =
+            HueConcurrent::await(QtConcurrent::run(&HueGroup::parseHueGroups, json));
 
-    if (parsedJsonWithIDs.isEmpty())
+    if (records.empty())
         return HueGroupList();
 
-    for (auto iter = parsedJsonWithIDs.begin(); iter != parsedJsonWithIDs.end(); ++iter) {
-        int ID = iter.key();
-        QJsonObject json = iter.value();
-
-        std::shared_ptr<HueGroup> group = std::make_shared<HueGroup>(bridge);
+    // QObjects belong to the thread that creates them, so the groups are
+    // created here, in one pass over the records.
+    groups->reserve(records.size());
 
-        if (HueGroup::constructHueGroup(ID, json, group))
-            groups.get()->push_back(std::move(group));
-
-    }
+    for (const Group::Record& record : records)
+        groups->push_back(HueGroup::createHueGroup(bridge, record));
 
     return HueGroupList(std::move(groups));
 }
@@ -345,7 +360,8 @@ HueGroupList HueGroup::discoverGroups(HueBridge *bridge)
  * Returns a \l HueLightList of \l HueLight objects associated with the
  * HueGroup. \l HueLight::discoverLights() must be called prior to calling
  * this function, and the \l HueLightList returned must be passed specified by
- * \a lights.
+ * \a lights. The lights are returned in the order of \a lights, and members
+ * that are not in \a lights are left out.
  *
  * \code
  *  // Create HueBridge
@@ -385,15 +401,52 @@ HueGroupList HueGroup::discoverGroups(HueBridge *bridge)
  */
 HueLightList HueGroup::getLights(const HueLightList& lights) const
 {
+    // One pass over the lights with a constant time membership test per light
+    const HueBitset members = m_lights.getMembers();
+
     LightVector foundLights;
-    for (auto lightIDs : m_lights.getLights()) {
-        int lightID = lightIDs.toInt();
-        foundLights.push_back(lights.fetch(lightID));
+    foundLights.reserve(static_cast<size_t>(members.count()));
+    for (int i = 0; i < lights.size(); i++) {
+        if (members.test(lights.at(i)->ID()))
+            foundLights.push_back(lights.at(i));
     }
 
     return HueLightList(std::make_shared<LightVector>(foundLights));
 }
 
+/*!
+ * \fn bool HueGroup::recallScene(const HueScene& scene)
+ *
+ * Sets the lights that are in both \a scene and the group to their states in
+ * \a scene with a single group command, storing the scene on the bridge first if
+ * it has not been stored before. The local state of the member lights returned
+ * by \l HueLight::discoverLights() is updated as for the \e set functions.
+ *
+ * Returns \c true if the scene was recalled.
+ *
+ * \sa HueScene
+ *
+ */
+bool HueGroup::recallScene(const HueScene& scene)
+{
+    if (!isValid() || !scene.sendRecall(getBridge(), m_ID, this))
+        return false;
+
+    const HueBitset members = m_lights.getMembers();
+    const std::vector<HueLight*> lights = HueLight::knownLights(getBridge(), members & scene.getLights());
+
+    HueChangeNotifier::instance().beginBatch();
+
+    for (HueLight* light : lights)
+        applyToLight(light, scene.getLightState(light->ID()));
+
+    updateStateFromLights(HueLight::knownLights(getBridge(), members));
+
+    HueChangeNotifier::instance().endBatch();
+
+    return true;
+}
+
 /*!
  * \fn Group::Action HueGroup::action() const
  *
@@ -518,6 +571,17 @@ int HueGroup::ID() const
     return m_ID;
 }
 
+/*!
+ * \fn HueAbstractObject::HueObjectKind HueGroup::objectKind() const
+ *
+ * Returns \l HueAbstractObject::GroupKind.
+ *
+ */
+HueAbstractObject::HueObjectKind HueGroup::objectKind() const
+{
+    return GroupKind;
+}
+
 /*!
  * \fn bool HueGroup::synchronize()
  *
@@ -544,8 +608,9 @@ bool HueGroup::synchronize()
         if (constructHueGroup(m_ID, json, synchronizedGroup)) {
             if (synchronizedGroup->hasValidConstructor()) {
                 *this = *synchronizedGroup.get();
+                resetPerceptualFilter();
 
-                emit synchronized();
+                notifySynchronized();
                 return true;
             }
         }
@@ -554,7 +619,58 @@ bool HueGroup::synchronize()
     return false;
 }
 
+/*!
+ * \fn HueStateChange HueGroup::currentState() const
+ *
+ * Returns the last known state of the group (\l Group::Action) as a \l HueStateChange
+ * with \e on, brightness, hue, saturation, color temperature and \e xy set.
+ *
+ */
+HueStateChange HueGroup::currentState() const
+{
+    HueStateChange state;
+    state.setOn(m_action.isOn());
+    state.setBrightness(m_action.getBrightness());
+    state.setHue(m_action.getHue());
+    state.setSaturation(m_action.getSaturation());
+    state.setColorTemp(m_action.getColorTemp());
+    state.setXY(m_action.getXValue(), m_action.getYValue());
+
+    return state;
+}
+
 bool HueGroup::constructHueGroup(int ID, QJsonObject json, std::shared_ptr<HueGroup>& group)
+{
+    Group::Record record;
+
+    if (!parseHueGroup(ID, json, record))
+        return false;
+
+    constructHueGroup(record, group);
+
+    return true;
+}
+
+void HueGroup::constructHueGroup(const Group::Record& record, std::shared_ptr<HueGroup>& group)
+{
+    group = createHueGroup(group->getBridge(), record);
+}
+
+std::shared_ptr<HueGroup> HueGroup::createHueGroup(HueBridge* bridge, const Group::Record& record)
+{
+    return std::shared_ptr<HueGroup>(new HueGroup(bridge,
+                                                  record.ID,
+                                                  record.action,
+                                                  record.lights,
+                                                  record.sensors,
+                                                  record.state,
+                                                  record.name,
+                                                  record.type,
+                                                  record.groupClass,
+                                                  record.recycle));
+}
+
+bool HueGroup::parseHueGroup(int ID, const QJsonObject& json, Group::Record& record)
 {
     bool jsonIsValid =
             json.contains("name")       &
@@ -569,31 +685,75 @@ bool HueGroup::constructHueGroup(int ID, QJsonObject json, std::shared_ptr<HueGr
     if(!jsonIsValid)
         return false;
 
-    Group::Action action(json["action"]);
-    Group::Lights lights(json["lights"]);
-    Group::Sensors sensors(json["sensors"]);
-    Group::State state(json["state"]);
-    Group::Name name(json["name"]);
-    Group::Type type(json["type"]);
-    Group::GroupClass groupClass(json["class"]);
-    Group::Recycle recycle(json["recycle"]);
-
-    HueGroup* newGroup = new HueGroup(group->getBridge(),
-                                      ID,
-                                      action,
-                                      lights,
-                                      sensors,
-                                      state,
-                                      name,
-                                      type,
-                                      groupClass,
-                                      recycle);
-
-    group.reset(newGroup);
+    record.ID = ID;
+    record.action = Group::Action(json["action"]);
+    record.lights = Group::Lights(json["lights"]);
+    record.sensors = Group::Sensors(json["sensors"]);
+    record.state = Group::State(json["state"]);
+    record.name = Group::Name(json["name"]);
+    record.type = Group::Type(json["type"]);
+    record.groupClass = Group::GroupClass(json["class"]);
+    record.recycle = Group::Recycle(json["recycle"]);
+
+    return true;
+}
+
+bool HueGroup::readHueGroup(int ID, HueJsonReader& reader, Group::Record& record)
+{
+    int keys = 0;
+
+    if (!reader.beginObject())
+        return false;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("name"))           { record.name.setName(reader.readString());             keys |= 1 << 0; }
+        else if (reader.keyEquals("lights"))    { record.lights = Group::Lights(reader);                keys |= 1 << 1; }
+        else if (reader.keyEquals("sensors"))   { record.sensors = Group::Sensors(reader);              keys |= 1 << 2; }
+        else if (reader.keyEquals("type"))      { record.type.setType(reader.readString());             keys |= 1 << 3; }
+        else if (reader.keyEquals("state"))     { record.state = Group::State(reader);                  keys |= 1 << 4; }
+        else if (reader.keyEquals("recycle"))   { record.recycle.setRecycle(reader.readBool());         keys |= 1 << 5; }
+        else if (reader.keyEquals("class"))     { record.groupClass.setGroupClass(reader.readString()); keys |= 1 << 6; }
+        else if (reader.keyEquals("action"))    { record.action = Group::Action(reader);                keys |= 1 << 7; }
+        else
+            reader.skipValue();
+    }
+
+    // The same keys are required as by parseHueGroup()
+    if (keys != (1 << 8) - 1 || reader.hasError())
+        return false;
 
+    record.ID = ID;
     return true;
 }
 
+std::vector<Group::Record> HueGroup::parseHueGroups(const QByteArray& json)
+{
+    const std::vector<JsonEntry> table = HueAbstractObject::parseJson(json);
+    const int count = static_cast<int>(table.size());
+
+    // Each record only reads its own slice of the reply, so they are read in
+    // parallel. Results are written by index, which keeps the order by ID.
+    std::vector<Group::Record> parsed(table.size());
+    std::vector<char> accepted(table.size(), false);
+
+    HueConcurrent::parallelFor(count, [&json, &table, &parsed, &accepted](const int index) {
+        const JsonEntry& entry = table[static_cast<size_t>(index)];
+        HueJsonReader reader(QByteArray::fromRawData(json.constData() + entry.offset, entry.length));
+
+        accepted[static_cast<size_t>(index)] = readHueGroup(entry.ID, reader, parsed[static_cast<size_t>(index)]);
+    });
+
+    std::vector<Group::Record> records;
+    records.reserve(table.size());
+
+    for (size_t i = 0; i < parsed.size(); i++) {
+        if (accepted[i])
+            records.push_back(std::move(parsed[i]));
+    }
+
+    return records;
+}
+
 HueRequest HueGroup::makePutRequest(QJsonObject json)
 {
     QString urlPath = "groups/" + QString::number(m_ID) + "/action";
@@ -610,41 +770,109 @@ HueRequest HueGroup::makeGetRequest()
     return HueRequest(urlPath, QJsonObject(), method);
 }
 
+// The bridge applies a group command to every member, so the same change is
+// applied locally to the member lights known from discovery
+void HueGroup::propagateStateChange(const HueStateChange& change)
+{
+    const std::vector<HueLight*> lights = HueLight::knownLights(getBridge(), m_lights.getMembers());
+
+    HueChangeNotifier::instance().beginBatch();
+
+    for (HueLight* light : lights)
+        applyToLight(light, change);
+
+    if (!updateStateFromLights(lights) && change.has(HueStateChange::OnAttribute)) {
+        m_state.setAllOn(change.isOn());
+        m_state.setAnyOn(change.isOn());
+    }
+
+    HueChangeNotifier::instance().endBatch();
+}
+
+void HueGroup::applyToLight(HueLight* light, const HueStateChange& change)
+{
+    // The bridge cannot reach these, and keeps reporting their last state
+    if (!light->isReachable())
+        return;
+
+    HueStateChange lightChange = light->constrainState(change);
+
+    // Lights that are off and are not turned on ignore everything but on/off
+    const bool turnedOn = change.has(HueStateChange::OnAttribute) && change.isOn();
+    if (!light->state().isOn() && !turnedOn) {
+        lightChange = HueStateChange();
+        if (change.has(HueStateChange::OnAttribute))
+            lightChange.setOn(false);
+    }
+
+    if (!lightChange.isEmpty())
+        light->applyStateChange(lightChange);
+}
+
+// With every member known, allOn and anyOn follow from the lights
+bool HueGroup::updateStateFromLights(const std::vector<HueLight*>& lights)
+{
+    const HueBitset members = m_lights.getMembers();
+
+    HueBitset knownIDs;
+    for (HueLight* light : lights)
+        knownIDs.set(light->ID());
+
+    if (members.isEmpty() || !members.isSubsetOf(knownIDs))
+        return false;
+
+    bool allOn = true;
+    bool anyOn = false;
+    for (HueLight* light : lights) {
+        allOn &= light->state().isOn();
+        anyOn |= light->state().isOn();
+    }
+
+    m_state.setAllOn(allOn);
+    m_state.setAnyOn(anyOn);
+
+    return true;
+}
+
 void HueGroup::updateOn(const bool on)
 {
     m_action.setOn(on);
-    emit valueUpdated();
+    notifyUpdated(HueStateChange::OnAttribute);
 }
 
 void HueGroup::updateHue(const int hue)
 {
     m_action.setHue(hue);
-    emit valueUpdated();
+    m_action.setColorMode("hs");
+    notifyUpdated(HueStateChange::HueAttribute);
 }
 
 void HueGroup::updateSaturation(const int saturation)
 {
     m_action.setSaturation(saturation);
-    emit valueUpdated();
+    m_action.setColorMode("hs");
+    notifyUpdated(HueStateChange::SaturationAttribute);
 }
 
 void HueGroup::updateBrightness(const int brightness)
 {
     m_action.setBrightness(brightness);
-    emit valueUpdated();
+    notifyUpdated(HueStateChange::BrightnessAttribute);
 }
 
 void HueGroup::updateColorTemp(const int colorTemp)
 {
     m_action.setColorTemp(colorTemp);
-    emit valueUpdated();
+    m_action.setColorMode("ct");
+    notifyUpdated(HueStateChange::ColorTempAttribute);
 }
 
 void HueGroup::updateXY(const double x, const double y)
 {
     m_action.setXValue(x);
     m_action.setYValue(y);
-    emit valueUpdated();
+    m_action.setColorMode("xy");
+    notifyUpdated(HueStateChange::XYAttribute);
 }
 
 void HueGroup::updateAlert(const HueAlert alert)
@@ -662,7 +890,7 @@ void HueGroup::updateAlert(const HueAlert alert)
         break;
     }
     m_action.setAlert(alertString);
-    emit valueUpdated();
+    notifyUpdated(HueStateChange::AlertAttribute);
 }
 
 void HueGroup::updateEffect(const HueEffect effect)
@@ -677,7 +905,7 @@ void HueGroup::updateEffect(const HueEffect effect)
         break;
     }
     m_action.setEffect(effectString);
-    emit valueUpdated();
+    notifyUpdated(HueStateChange::EffectAttribute);
 }
 
 
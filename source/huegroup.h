@@ -2,14 +2,19 @@
 #define HUEGROUP_H
 
 #include <memory>
+#include <vector>
 
 #include "hueabstractobject.h"
 #include "huetypes.h"
 #include "hueobjectlist.h"
 
+class HueScene;
+
 class HueGroup : public HueAbstractObject
 {
     Q_OBJECT
+    friend class HueSnapshot;
+
 public:
     HueGroup();
     HueGroup(HueBridge* bridge);
@@ -17,6 +22,7 @@ public:
     static HueGroupList discoverGroups(HueBridge* bridge);
 
     HueLightList getLights(const HueLightList& lights) const;
+    bool recallScene(const HueScene& scene);
 
     Group::Action action() const;
     Group::Lights lights() const;
@@ -30,7 +36,9 @@ public:
     bool hasValidConstructor() const override;
     bool isValid() const override;
     int ID() const override;
+    HueObjectKind objectKind() const override;
     bool synchronize() override;
+    HueStateChange currentState() const override;
 
 private:
     HueGroup(HueBridge* bridge,
@@ -43,9 +51,17 @@ private:
     HueGroup operator=(const HueGroup& rhs);
 
     static bool constructHueGroup(int ID, QJsonObject json, std::shared_ptr<HueGroup>& group);
+    static void constructHueGroup(const Group::Record& record, std::shared_ptr<HueGroup>& group);
+    static std::shared_ptr<HueGroup> createHueGroup(HueBridge* bridge, const Group::Record& record);
+    static bool parseHueGroup(int ID, const QJsonObject& json, Group::Record& record);
+    static bool readHueGroup(int ID, HueJsonReader& reader, Group::Record& record);
+    static std::vector<Group::Record> parseHueGroups(const QByteArray& json);
 
     HueRequest makePutRequest(QJsonObject json) override;
     HueRequest makeGetRequest() override;
+    void propagateStateChange(const HueStateChange& change) override;
+    static void applyToLight(HueLight* light, const HueStateChange& change);
+    bool updateStateFromLights(const std::vector<HueLight*>& lights);
 
     void updateOn(const bool on) override;
     void updateHue(const int hue) override;
@@ -0,0 +1,574 @@
+#include "huejsonreader.h"
+
+#include <cstring>
+
+/*!
+ * \class HueJsonReader
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Reads JSON from a byte buffer one token at a time.
+ *
+ * HueJsonReader is a pull parser in the style of \e QXmlStreamReader. Instead of
+ * building a document in memory, it reports the JSON as a sequence of tokens, and
+ * values can be read directly into the types of \l Light and \l Group. This is used
+ * to parse large replies from the bridge, such as the full list of lights or groups,
+ * without first building a \e QJsonDocument.
+ *
+ * Keys and strings are not copied until they are read, and keys can be compared
+ * against the expected key with \l keyEquals() without creating a \e QString.
+ *
+ * \code
+ *  HueJsonReader reader(bytes);
+ *
+ *  if (reader.beginObject()) {
+ *      while (reader.readNextKey()) {
+ *          if (reader.keyEquals("on"))
+ *              on = reader.readBool();
+ *          else
+ *              reader.skipValue();
+ *      }
+ *  }
+ * \endcode
+ *
+ * The reader is lenient: separators are not validated, and a string followed by a
+ * colon is always reported as a key. Input that cannot be tokenized, such as
+ * truncated replies or unbalanced brackets, sets \l hasError(), after which every
+ * read returns \l Invalid.
+ *
+ */
+
+/*!
+ * \enum HueJsonReader::TokenType
+ * This enum describes the token the reader is positioned at.
+ *
+ * \value NoToken
+ *      Nothing has been read yet.
+ * \value Invalid
+ *      The input is not valid JSON. See \l hasError().
+ * \value BeginObject
+ *      The start of an object (\c {).
+ * \value EndObject
+ *      The end of an object (\c }).
+ * \value BeginArray
+ *      The start of an array (\c [).
+ * \value EndArray
+ *      The end of an array (\c ]).
+ * \value Key
+ *      The key of an object member. The value follows as the next token.
+ * \value String
+ *      A string value.
+ * \value Number
+ *      A number value.
+ * \value Bool
+ *      \c true or \c false.
+ * \value Null
+ *      \c null.
+ * \value EndDocument
+ *      The complete document has been read.
+ *
+ */
+
+/*!
+ * \fn HueJsonReader::HueJsonReader(const QByteArray& json)
+ *
+ * Constructs a HueJsonReader that reads from \a json. The data of \a json is shared,
+ * not copied.
+ *
+ */
+HueJsonReader::HueJsonReader(const QByteArray& json)
+    : m_json(json)
+    , m_data(m_json.constData())
+    , m_size(m_json.size())
+    , m_pos(0)
+    , m_depth(0)
+    , m_tokenType(NoToken)
+    , m_tokenStart(0)
+    , m_tokenLength(0)
+    , m_tokenEscaped(false)
+    , m_boolValue(false)
+{
+
+}
+
+/*!
+ * \fn HueJsonReader::TokenType HueJsonReader::readNext()
+ *
+ * Reads the next token and returns its type.
+ *
+ */
+HueJsonReader::TokenType HueJsonReader::readNext()
+{
+    if (m_tokenType == Invalid || m_tokenType == EndDocument)
+        return m_tokenType;
+
+    skipSeparators();
+
+    if (m_pos >= m_size) {
+        if (m_depth == 0 && m_tokenType != NoToken)
+            return m_tokenType = EndDocument;
+
+        return raiseError();
+    }
+
+    switch (m_data[m_pos]) {
+    case '{':
+        m_pos++;
+        m_depth++;
+        return m_tokenType = BeginObject;
+    case '}':
+        m_pos++;
+        if (--m_depth < 0)
+            return raiseError();
+        return m_tokenType = EndObject;
+    case '[':
+        m_pos++;
+        m_depth++;
+        return m_tokenType = BeginArray;
+    case ']':
+        m_pos++;
+        if (--m_depth < 0)
+            return raiseError();
+        return m_tokenType = EndArray;
+    case '"':
+        return readStringToken();
+    case 't':
+        m_boolValue = true;
+        return readLiteralToken("true", 4, Bool);
+    case 'f':
+        m_boolValue = false;
+        return readLiteralToken("false", 5, Bool);
+    case 'n':
+        return readLiteralToken("null", 4, Null);
+    default:
+        return readNumberToken();
+    }
+}
+
+/*!
+ * \fn HueJsonReader::TokenType HueJsonReader::tokenType() const
+ *
+ * Returns the type of the current token.
+ *
+ */
+HueJsonReader::TokenType HueJsonReader::tokenType() const
+{
+    return m_tokenType;
+}
+
+/*!
+ * \fn bool HueJsonReader::atEnd() const
+ *
+ * Returns \c true if the whole document has been read, or if an error occurred.
+ *
+ */
+bool HueJsonReader::atEnd() const
+{
+    return m_tokenType == EndDocument || m_tokenType == Invalid;
+}
+
+/*!
+ * \fn bool HueJsonReader::hasError() const
+ *
+ * Returns \c true if the input could not be read as JSON.
+ *
+ */
+bool HueJsonReader::hasError() const
+{
+    return m_tokenType == Invalid;
+}
+
+/*!
+ * \fn int HueJsonReader::offset() const
+ *
+ * Returns the offset in bytes just past the current token. Together with
+ * \l skipValue(), this can be used to find the bytes of a value without reading it.
+ *
+ */
+int HueJsonReader::offset() const
+{
+    return m_pos;
+}
+
+/*!
+ * \fn bool HueJsonReader::beginObject()
+ *
+ * Reads the next value and returns \c true if it is an object. Members can then be
+ * read with \l readNextKey(). Any other value is skipped.
+ *
+ */
+bool HueJsonReader::beginObject()
+{
+    if (readNext() == BeginObject)
+        return true;
+
+    skipCurrent();
+    return false;
+}
+
+/*!
+ * \fn bool HueJsonReader::beginArray()
+ *
+ * Reads the next value and returns \c true if it is an array. Elements can then be
+ * read with \l readNextElement(). Any other value is skipped.
+ *
+ */
+bool HueJsonReader::beginArray()
+{
+    if (readNext() == BeginArray)
+        return true;
+
+    skipCurrent();
+    return false;
+}
+
+/*!
+ * \fn bool HueJsonReader::readNextKey()
+ *
+ * Reads the next key of the current object. Returns \c false when the end of the
+ * object has been reached. The value of the key must be read or skipped before
+ * the next key is read.
+ *
+ * \sa keyEquals(), skipValue()
+ *
+ */
+bool HueJsonReader::readNextKey()
+{
+    const TokenType type = readNext();
+
+    if (type == Key)
+        return true;
+
+    if (type != EndObject)
+        raiseError();
+
+    return false;
+}
+
+/*!
+ * \fn bool HueJsonReader::readNextElement()
+ *
+ * Returns \c true if the current array has another element, which can then be read
+ * with one of the \e read functions. Returns \c false when the end of the array has
+ * been reached.
+ *
+ */
+bool HueJsonReader::readNextElement()
+{
+    if (m_tokenType == Invalid)
+        return false;
+
+    skipSeparators();
+
+    if (m_pos >= m_size) {
+        raiseError();
+        return false;
+    }
+
+    if (m_data[m_pos] == ']') {
+        m_pos++;
+        m_depth--;
+        m_tokenType = EndArray;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \fn bool HueJsonReader::keyEquals(const char* key) const
+ *
+ * Returns \c true if the current token is a key equal to \a key. The key is
+ * compared byte by byte, without decoding escape sequences.
+ *
+ */
+bool HueJsonReader::keyEquals(const char* key) const
+{
+    const int length = static_cast<int>(std::strlen(key));
+
+    return m_tokenType == Key
+            && m_tokenLength == length
+            && std::memcmp(m_data + m_tokenStart, key, static_cast<size_t>(length)) == 0;
+}
+
+/*!
+ * \fn int HueJsonReader::keyToInt(bool* ok) const
+ *
+ * Returns the current key converted to an \c int. If \a ok is not \c nullptr, it is
+ * set to \c false if the current token is not a key or is not a number.
+ *
+ */
+int HueJsonReader::keyToInt(bool* ok) const
+{
+    if (m_tokenType != Key) {
+        if (ok != nullptr)
+            *ok = false;
+        return 0;
+    }
+
+    return QByteArray::fromRawData(m_data + m_tokenStart, m_tokenLength).toInt(ok);
+}
+
+/*!
+ * \fn bool HueJsonReader::readBool()
+ *
+ * Reads the next value as a \c bool. Returns \c false if the value is not
+ * \c true or \c false.
+ *
+ */
+bool HueJsonReader::readBool()
+{
+    if (readNext() == Bool)
+        return m_boolValue;
+
+    skipCurrent();
+    return false;
+}
+
+/*!
+ * \fn int HueJsonReader::readInt()
+ *
+ * Reads the next value as an \c int. Fractions are truncated. Returns 0 if the
+ * value is not a number.
+ *
+ */
+int HueJsonReader::readInt()
+{
+    if (readNext() != Number) {
+        skipCurrent();
+        return 0;
+    }
+
+    const QByteArray number = QByteArray::fromRawData(m_data + m_tokenStart, m_tokenLength);
+
+    bool isInt = false;
+    const int value = number.toInt(&isInt);
+
+    return isInt ? value : static_cast<int>(number.toDouble());
+}
+
+/*!
+ * \fn double HueJsonReader::readDouble()
+ *
+ * Reads the next value as a \c double. Returns 0 if the value is not a number.
+ *
+ */
+double HueJsonReader::readDouble()
+{
+    if (readNext() != Number) {
+        skipCurrent();
+        return 0;
+    }
+
+    return QByteArray::fromRawData(m_data + m_tokenStart, m_tokenLength).toDouble();
+}
+
+/*!
+ * \fn QString HueJsonReader::readString()
+ *
+ * Reads the next value as a \e QString. Returns an empty string if the value is
+ * not a string.
+ *
+ */
+QString HueJsonReader::readString()
+{
+    if (readNext() == String)
+        return decodeString();
+
+    skipCurrent();
+    return QString();
+}
+
+/*!
+ * \fn QList<QString> HueJsonReader::readStringArray()
+ *
+ * Reads the next value as an array of strings. Elements that are not strings are
+ * read as empty strings. Returns an empty list if the value is not an array.
+ *
+ */
+QList<QString> HueJsonReader::readStringArray()
+{
+    QList<QString> strings;
+
+    if (!beginArray())
+        return strings;
+
+    while (readNextElement())
+        strings.append(readString());
+
+    return strings;
+}
+
+/*!
+ * \fn void HueJsonReader::skipValue()
+ *
+ * Reads past the next value, including any nested objects and arrays.
+ *
+ */
+void HueJsonReader::skipValue()
+{
+    readNext();
+    skipCurrent();
+}
+
+void HueJsonReader::skipWhitespace()
+{
+    while (m_pos < m_size) {
+        const char c = m_data[m_pos];
+
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+            return;
+
+        m_pos++;
+    }
+}
+
+void HueJsonReader::skipSeparators()
+{
+    skipWhitespace();
+
+    while (m_pos < m_size && m_data[m_pos] == ',') {
+        m_pos++;
+        skipWhitespace();
+    }
+}
+
+HueJsonReader::TokenType HueJsonReader::readStringToken()
+{
+    // m_pos is at the opening quote
+    m_tokenStart = ++m_pos;
+    m_tokenEscaped = false;
+
+    while (m_pos < m_size && m_data[m_pos] != '"') {
+        if (m_data[m_pos] == '\\') {
+            m_tokenEscaped = true;
+            m_pos++;
+        }
+        m_pos++;
+    }
+
+    if (m_pos >= m_size)
+        return raiseError();
+
+    m_tokenLength = m_pos - m_tokenStart;
+    m_pos++;
+
+    // A string followed by a colon is the key of an object member
+    skipWhitespace();
+    if (m_pos < m_size && m_data[m_pos] == ':') {
+        m_pos++;
+        return m_tokenType = Key;
+    }
+
+    return m_tokenType = String;
+}
+
+HueJsonReader::TokenType HueJsonReader::readNumberToken()
+{
+    m_tokenStart = m_pos;
+
+    while (m_pos < m_size) {
+        const char c = m_data[m_pos];
+
+        if ((c < '0' || c > '9') && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E')
+            break;
+
+        m_pos++;
+    }
+
+    m_tokenLength = m_pos - m_tokenStart;
+
+    if (m_tokenLength == 0)
+        return raiseError();
+
+    return m_tokenType = Number;
+}
+
+HueJsonReader::TokenType HueJsonReader::readLiteralToken(const char* literal, const int length,
+                                                         const TokenType type)
+{
+    if (m_size - m_pos < length || std::memcmp(m_data + m_pos, literal, static_cast<size_t>(length)) != 0)
+        return raiseError();
+
+    m_pos += length;
+    return m_tokenType = type;
+}
+
+void HueJsonReader::skipCurrent()
+{
+    if (m_tokenType != BeginObject && m_tokenType != BeginArray)
+        return;
+
+    const int depth = m_depth - 1;
+
+    while (m_depth > depth) {
+        if (atEnd() || readNext() == Invalid)
+            return;
+    }
+}
+
+QString HueJsonReader::decodeString() const
+{
+    const char* data = m_data + m_tokenStart;
+
+    if (!m_tokenEscaped)
+        return QString::fromUtf8(data, m_tokenLength);
+
+    QString string;
+    string.reserve(m_tokenLength);
+
+    int runStart = 0;
+    int i = 0;
+
+    while (i < m_tokenLength) {
+        if (data[i] != '\\') {
+            i++;
+            continue;
+        }
+
+        string.append(QString::fromUtf8(data + runStart, i - runStart));
+
+        const char escaped = i + 1 < m_tokenLength ? data[i + 1] : '\\';
+        i += 2;
+
+        switch (escaped) {
+        case 'b':
+            string.append(QChar('\b'));
+            break;
+        case 'f':
+            string.append(QChar('\f'));
+            break;
+        case 'n':
+            string.append(QChar('\n'));
+            break;
+        case 'r':
+            string.append(QChar('\r'));
+            break;
+        case 't':
+            string.append(QChar('\t'));
+            break;
+        case 'u':
+            // Surrogate pairs arrive as two escapes and form a valid UTF-16 pair
+            if (i + 4 <= m_tokenLength) {
+                const ushort code = QByteArray::fromRawData(data + i, 4).toUShort(nullptr, 16);
+                string.append(QChar(code));
+                i += 4;
+            }
+            break;
+        default:
+            string.append(QChar(escaped));
+            break;
+        }
+
+        runStart = i;
+    }
+
+    if (runStart < m_tokenLength)
+        string.append(QString::fromUtf8(data + runStart, m_tokenLength - runStart));
+
+    return string;
+}
+
+HueJsonReader::TokenType HueJsonReader::raiseError()
+{
+    return m_tokenType = Invalid;
+}
@@ -0,0 +1,73 @@
+#ifndef HUEJSONREADER_H
+#define HUEJSONREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QList>
+
+class HueJsonReader
+{
+public:
+    enum TokenType {
+        NoToken,
+        Invalid,
+        BeginObject,
+        EndObject,
+        BeginArray,
+        EndArray,
+        Key,
+        String,
+        Number,
+        Bool,
+        Null,
+        EndDocument
+    };
+
+    explicit HueJsonReader(const QByteArray& json);
+
+    TokenType readNext();
+    TokenType tokenType() const;
+    bool atEnd() const;
+    bool hasError() const;
+    int offset() const;
+
+    bool beginObject();
+    bool beginArray();
+    bool readNextKey();
+    bool readNextElement();
+
+    bool keyEquals(const char* key) const;
+    int keyToInt(bool* ok = nullptr) const;
+
+    bool readBool();
+    int readInt();
+    double readDouble();
+    QString readString();
+    QList<QString> readStringArray();
+    void skipValue();
+
+private:
+    void skipWhitespace();
+    void skipSeparators();
+    TokenType readStringToken();
+    TokenType readNumberToken();
+    TokenType readLiteralToken(const char* literal, const int length, const TokenType type);
+    void skipCurrent();
+    QString decodeString() const;
+    TokenType raiseError();
+
+private:
+    QByteArray m_json;
+    const char* m_data;
+    int m_size;
+    int m_pos;
+    int m_depth;
+
+    TokenType m_tokenType;
+    int m_tokenStart;
+    int m_tokenLength;
+    bool m_tokenEscaped;
+    bool m_boolValue;
+};
+
+#endif // HUEJSONREADER_H
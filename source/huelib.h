@@ -3,13 +3,28 @@
 
 #include "huebridge.h"
 #include "huelight.h"
+#include "huelightstatetable.h"
 #include "huegroup.h"
+#include "huemembershipindex.h"
+#include "huescene.h"
+#include "huesnapshot.h"
+#include "huejsonreader.h"
 #include "huesynchronizer.h"
+#include "huechangenotifier.h"
+#include "hueeventstream.h"
+#include "huestatechange.h"
+#include "huebitset.h"
+#include "huecolor.h"
+#include "hueanimator.h"
+#include "huestreamchannel.h"
+#include "huestreamreceiver.h"
+#include "huestreamtransport.h"
 
 #include "Models/huelightlistmodel.h"
 #include "Models/huegrouplistmodel.h"
 
 #include "Models/huelightinfotreemodel.h"
 #include "Models/huegroupinfotreemodel.h"
+#include "Models/hueinventorytreemodel.h"
 
 #endif // HUELIB_H
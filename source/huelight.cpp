@@ -3,6 +3,32 @@
 #include "huebridge.h"
 #include "huerequest.h"
 #include "huereply.h"
+#include "huestatechange.h"
+#include "hueconcurrent.h"
+#include "huejsonreader.h"
+
+#include <QtConcurrent>
+#include <QMutex>
+#include <QHash>
+#include <algorithm>
+
+namespace {
+QMutex& registryMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+// Rediscovery can create a second object for a light while the first one is
+// still alive, so an ID can have several lights
+typedef QHash<int, std::vector<HueLight*>> LightsOfID;
+
+QHash<HueBridge*, LightsOfID>& lightRegistry()
+{
+    static QHash<HueBridge*, LightsOfID> registry;
+    return registry;
+}
+}
 
 /*!
  * \class HueLight
@@ -233,7 +259,10 @@ HueLight::HueLight()
     , m_manufacturer()
     , m_productID()
     , m_config()
+    , m_capabilities()
     , m_validConstructor(false)
+    , m_registeredBridge(nullptr)
+    , m_registeredID(-1)
 {
 
 }
@@ -263,7 +292,10 @@ HueLight::HueLight(HueBridge* bridge)
     , m_manufacturer()
     , m_productID()
     , m_config()
+    , m_capabilities()
     , m_validConstructor(false)
+    , m_registeredBridge(nullptr)
+    , m_registeredID(-1)
 {
 
 }
@@ -278,7 +310,8 @@ HueLight::HueLight(HueBridge* bridge,
                    Light::ProductName productName,
                    Light::Manufacturer manufacturer,
                    Light::ProductID productID,
-                   Light::Config config)
+                   Light::Config config,
+                   Light::Capabilities capabilities)
     : HueAbstractObject(bridge)
     , m_ID(ID)
     , m_state(state)
@@ -292,7 +325,10 @@ HueLight::HueLight(HueBridge* bridge,
     , m_manufacturer(manufacturer)
     , m_productID(productID)
     , m_config(config)
+    , m_capabilities(capabilities)
     , m_validConstructor(true)
+    , m_registeredBridge(nullptr)
+    , m_registeredID(-1)
 {
 
 }
@@ -311,11 +347,37 @@ HueLight::HueLight(const HueLight& rhs)
     , m_manufacturer(rhs.m_manufacturer)
     , m_productID(rhs.m_productID)
     , m_config(rhs.m_config)
+    , m_capabilities(rhs.m_capabilities)
     , m_validConstructor(rhs.m_validConstructor)
+    , m_registeredBridge(nullptr)
+    , m_registeredID(-1)
 {
 
 }
 
+HueLight::~HueLight()
+{
+    if (m_registeredBridge == nullptr)
+        return;
+
+    QMutexLocker locker(&registryMutex());
+    auto bridgeIt = lightRegistry().find(m_registeredBridge);
+    if (bridgeIt == lightRegistry().end())
+        return;
+
+    auto lightsIt = bridgeIt->find(m_registeredID);
+    if (lightsIt != bridgeIt->end()) {
+        std::vector<HueLight*>& lights = lightsIt.value();
+        lights.erase(std::remove(lights.begin(), lights.end(), this), lights.end());
+
+        if (lights.empty())
+            bridgeIt->erase(lightsIt);
+    }
+
+    if (bridgeIt->isEmpty())
+        lightRegistry().erase(bridgeIt);
+}
+
 HueLight HueLight::operator=(const HueLight &rhs)
 {
     if (&rhs == this)
@@ -335,6 +397,7 @@ HueLight HueLight::operator=(const HueLight &rhs)
     m_manufacturer = rhs.m_manufacturer;
     m_productID = rhs.m_productID;
     m_config = rhs.m_config;
+    m_capabilities = rhs.m_capabilities;
     m_validConstructor = rhs.m_validConstructor;
 
     return *this;
@@ -356,6 +419,7 @@ HueLightList HueLight::discoverLights(HueBridge* bridge)
     std::shared_ptr<LightVector> lights = std::make_shared<LightVector>();
 
     HueRequest request("lights", QJsonObject(), HueRequest::Get);
+    request.setRawReply(true);
     HueReply reply = bridge->sendRequest(request, nullptr);
 
     if (!reply.isValid() || reply.timedOut() || reply.containsError()) {
@@ -363,20 +427,24 @@ HueLightList HueLight::discoverLights(HueBridge* bridge)
         return HueLightList();
     }
 
-    QJsonObject json = reply.getJson();
-    auto parsedJsonWithIDs = HueAbstractObject::parseJson(json);
+    // Parsing a large reply is slow enough to stall the GUI, so it runs on the
+    // thread pool. The records are read straight from the reply bytes, without
+    // building a QJsonDocument, and the lights are read in parallel. Only the finished
+    // records come back to this thread.
+    const QByteArray json = reply.getRawJson();
+    const std::vector<Light::Record> records =
+            HueConcurrent::await(QtConcurrent::run(&HueLight::parseHueLights, json));
 
-    if (parsedJsonWithIDs.isEmpty())
+    if (records.empty())
         return HueLightList();
 
-    for (auto iter = parsedJsonWithIDs.begin(); iter != parsedJsonWithIDs.end(); ++iter) {
-        int ID = iter.key();
-        QJsonObject json = iter.value();
+    // QObjects belong to the thread that creates them, so the lights are
+    // created here, in one pass over the records.
+    lights->reserve(records.size());
 
-        std::shared_ptr<HueLight> light = std::make_shared<HueLight>(bridge);
-
-        if (HueLight::constructHueLight(ID, json, light))
-            lights.get()->push_back(std::move(light));
+    for (const Light::Record& record : records) {
+        lights->push_back(HueLight::createHueLight(bridge, record));
+        registerLight(lights->back().get());
     }
 
     return HueLightList(std::move(lights));
@@ -503,6 +571,17 @@ Light::Config HueLight::config() const
     return m_config;
 }
 
+/*!
+ * \fn Light::Capabilities HueLight::capabilities() const
+ *
+ * Returns a \l Light::Capabilities object.
+ *
+ */
+Light::Capabilities HueLight::capabilities() const
+{
+    return m_capabilities;
+}
+
 /*!
  * \fn bool HueLight::hasValidConstructor() const
  *
@@ -538,6 +617,17 @@ int HueLight::ID() const
     return m_ID;
 }
 
+/*!
+ * \fn HueAbstractObject::HueObjectKind HueLight::objectKind() const
+ *
+ * Returns \l HueAbstractObject::LightKind.
+ *
+ */
+HueAbstractObject::HueObjectKind HueLight::objectKind() const
+{
+    return LightKind;
+}
+
 /*!
  * \fn bool HueLight::synchronize()
  *
@@ -564,8 +654,9 @@ bool HueLight::synchronize()
         if (constructHueLight(m_ID, json, synchronizedLight)) {
             if (synchronizedLight->hasValidConstructor()) {
                 *this = *synchronizedLight.get();
+                resetPerceptualFilter();
 
-                emit synchronized();
+                notifySynchronized();
                 return true;
             }
         }
@@ -574,7 +665,106 @@ bool HueLight::synchronize()
     return false;
 }
 
+/*!
+ * \fn HueStateChange HueLight::currentState() const
+ *
+ * Returns the last known state of the light (\l Light::State) as a \l HueStateChange
+ * with \e on, brightness, hue, saturation, color temperature and \e xy set.
+ *
+ */
+HueStateChange HueLight::currentState() const
+{
+    HueStateChange state;
+    state.setOn(m_state.isOn());
+    state.setBrightness(m_state.getBrightness());
+    state.setHue(m_state.getHue());
+    state.setSaturation(m_state.getSaturation());
+    state.setColorTemp(m_state.getColorTemp());
+    state.setXY(m_state.getXValue(), m_state.getYValue());
+
+    return state;
+}
+
+/*!
+ * \fn bool HueLight::isReachable() const
+ *
+ * Returns the reachable state of the light, as last reported by the bridge.
+ *
+ */
+bool HueLight::isReachable() const
+{
+    return m_state.isReachable();
+}
+
 bool HueLight::constructHueLight(int ID, QJsonObject json, std::shared_ptr<HueLight>& light)
+{
+    Light::Record record;
+
+    if (!parseHueLight(ID, json, record))
+        return false;
+
+    constructHueLight(record, light);
+
+    return true;
+}
+
+void HueLight::constructHueLight(const Light::Record& record, std::shared_ptr<HueLight>& light)
+{
+    light = createHueLight(light->getBridge(), record);
+}
+
+std::shared_ptr<HueLight> HueLight::createHueLight(HueBridge* bridge, const Light::Record& record)
+{
+    return std::shared_ptr<HueLight>(new HueLight(bridge,
+                                                  record.ID,
+                                                  record.state,
+                                                  record.name,
+                                                  record.type,
+                                                  record.uniqueID,
+                                                  record.softwareVersion,
+                                                  record.softwareUpdate,
+                                                  record.softwareConfigID,
+                                                  record.productName,
+                                                  record.manufacturer,
+                                                  record.productID,
+                                                  record.config,
+                                                  record.capabilities));
+}
+
+// Discovered lights are registered by bridge and ID, so that a HueGroup can update
+// the local state of its members after a group command. The key is kept, since
+// assignment can change the bridge and ID of a light.
+void HueLight::registerLight(HueLight* light)
+{
+    QMutexLocker locker(&registryMutex());
+    lightRegistry()[light->getBridge()][light->m_ID].push_back(light);
+    light->m_registeredBridge = light->getBridge();
+    light->m_registeredID = light->m_ID;
+}
+
+// The lights are not owned by the registry and may be destroyed once the lock is
+// released, e.g. when the last HueLightList holding them is dropped. The pointers
+// are therefore only valid until control returns to the caller, and must only be
+// used on the thread that owns the lights.
+std::vector<HueLight*> HueLight::knownLights(HueBridge* bridge, const HueBitset& IDs)
+{
+    std::vector<HueLight*> lights;
+
+    QMutexLocker locker(&registryMutex());
+    auto bridgeIt = lightRegistry().constFind(bridge);
+    if (bridgeIt == lightRegistry().constEnd())
+        return lights;
+
+    for (const int ID : IDs.toVector()) {
+        auto lightsIt = bridgeIt->constFind(ID);
+        if (lightsIt != bridgeIt->constEnd())
+            lights.insert(lights.end(), lightsIt->begin(), lightsIt->end());
+    }
+
+    return lights;
+}
+
+bool HueLight::parseHueLight(int ID, const QJsonObject& json, Light::Record& record)
 {
     bool jsonIsValid =
             json.contains("state")              &
@@ -594,37 +784,86 @@ bool HueLight::constructHueLight(int ID, QJsonObject json, std::shared_ptr<HueLi
     if(!jsonIsValid)
         return false;
 
-    Light::State state(json["state"]);
-    Light::Name name(json["name"]);
-    Light::Type type(json["type"]);
-    Light::UniqueID uniqueID(json["uniqueid"]);
-    Light::SoftwareVersion softwareVersion(json["swversion"]);
-    Light::SoftwareUpdate softwareUpdate(json["swupdate"]);
-    Light::SoftwareConfigID softwareConfigID(json["swconfigid"]);
-    Light::ProductName productName(json["productname"]);
-    Light::Manufacturer manufacturer(json["manufacturername"]);
-    Light::ProductID productID(json["productid"]);
-    Light::Config config(json["config"]);
-
-    HueLight* newLight = new HueLight(light->getBridge(),
-                                      ID,
-                                      state,
-                                      name,
-                                      type,
-                                      uniqueID,
-                                      softwareVersion,
-                                      softwareUpdate,
-                                      softwareConfigID,
-                                      productName,
-                                      manufacturer,
-                                      productID,
-                                      config);
-
-    light.reset(newLight);
+    record.ID = ID;
+    record.state = Light::State(json["state"]);
+    record.name = Light::Name(json["name"]);
+    record.type = Light::Type(json["type"]);
+    record.uniqueID = Light::UniqueID(json["uniqueid"]);
+    record.softwareVersion = Light::SoftwareVersion(json["swversion"]);
+    record.softwareUpdate = Light::SoftwareUpdate(json["swupdate"]);
+    record.softwareConfigID = Light::SoftwareConfigID(json["swconfigid"]);
+    record.productName = Light::ProductName(json["productname"]);
+    record.manufacturer = Light::Manufacturer(json["manufacturername"]);
+    record.productID = Light::ProductID(json["productid"]);
+    record.config = Light::Config(json["config"]);
+    record.capabilities = Light::Capabilities(json["capabilities"]);
+    record.capabilities.setControlType(Light::Capabilities::controlTypeFromType(record.type.getType()));
 
     return true;
 }
 
+bool HueLight::readHueLight(int ID, HueJsonReader& reader, Light::Record& record)
+{
+    int keys = 0;
+
+    if (!reader.beginObject())
+        return false;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("state"))                  { record.state = Light::State(reader);                          keys |= 1 << 0; }
+        else if (reader.keyEquals("swupdate"))          { record.softwareUpdate = Light::SoftwareUpdate(reader);        keys |= 1 << 1; }
+        else if (reader.keyEquals("type"))              { record.type.setType(reader.readString());                     keys |= 1 << 2; }
+        else if (reader.keyEquals("name"))              { record.name.setName(reader.readString());                     keys |= 1 << 3; }
+        else if (reader.keyEquals("modelid"))           { reader.skipValue();                                           keys |= 1 << 4; }
+        else if (reader.keyEquals("manufacturername"))  { record.manufacturer.setManufacturer(reader.readString());      keys |= 1 << 5; }
+        else if (reader.keyEquals("productname"))       { record.productName.setProductName(reader.readString());       keys |= 1 << 6; }
+        else if (reader.keyEquals("capabilities"))      { record.capabilities = Light::Capabilities(reader);            keys |= 1 << 7; }
+        else if (reader.keyEquals("config"))            { record.config = Light::Config(reader);                        keys |= 1 << 8; }
+        else if (reader.keyEquals("uniqueid"))          { record.uniqueID.setUniqueID(reader.readString());             keys |= 1 << 9; }
+        else if (reader.keyEquals("swversion"))         { record.softwareVersion.setSoftwareVersion(reader.readString()); keys |= 1 << 10; }
+        else if (reader.keyEquals("swconfigid"))        { record.softwareConfigID.setSoftwareConfigID(reader.readString()); keys |= 1 << 11; }
+        else if (reader.keyEquals("productid"))         { record.productID.setProductID(reader.readString());           keys |= 1 << 12; }
+        else
+            reader.skipValue();
+    }
+
+    // The same keys are required as by parseHueLight()
+    if (keys != (1 << 13) - 1 || reader.hasError())
+        return false;
+
+    record.ID = ID;
+    record.capabilities.setControlType(Light::Capabilities::controlTypeFromType(record.type.getType()));
+    return true;
+}
+
+std::vector<Light::Record> HueLight::parseHueLights(const QByteArray& json)
+{
+    const std::vector<JsonEntry> table = HueAbstractObject::parseJson(json);
+    const int count = static_cast<int>(table.size());
+
+    // Each record only reads its own slice of the reply, so they are read in
+    // parallel. Results are written by index, which keeps the order by ID.
+    std::vector<Light::Record> parsed(table.size());
+    std::vector<char> accepted(table.size(), false);
+
+    HueConcurrent::parallelFor(count, [&json, &table, &parsed, &accepted](const int index) {
+        const JsonEntry& entry = table[static_cast<size_t>(index)];
+        HueJsonReader reader(QByteArray::fromRawData(json.constData() + entry.offset, entry.length));
+
+        accepted[static_cast<size_t>(index)] = readHueLight(entry.ID, reader, parsed[static_cast<size_t>(index)]);
+    });
+
+    std::vector<Light::Record> records;
+    records.reserve(table.size());
+
+    for (size_t i = 0; i < parsed.size(); i++) {
+        if (accepted[i])
+            records.push_back(std::move(parsed[i]));
+    }
+
+    return records;
+}
+
 HueRequest HueLight::makePutRequest(QJsonObject json)
 {
     QString urlPath = "lights/" + QString::number(m_ID) + "/state";
@@ -641,72 +880,140 @@ HueRequest HueLight::makeGetRequest()
     return HueRequest(urlPath, QJsonObject(), method);
 }
 
+HueStateChange HueLight::constrainState(const HueStateChange& change) const
+{
+    HueStateChange constrained = HueAbstractObject::constrainState(change);
+
+    if (!m_capabilities.supportsDimming())
+        constrained.clear(HueStateChange::BrightnessAttribute);
+
+    // A color temperature is shown as the matching xy on lights without ct
+    if (constrained.has(HueStateChange::ColorTempAttribute)) {
+        if (m_capabilities.supportsColorTemp()) {
+            constrained.setColorTemp(qBound(m_capabilities.getColorTempMin(),
+                                            constrained.getColorTemp(),
+                                            m_capabilities.getColorTempMax()));
+        }
+        else {
+            if (m_capabilities.supportsColor() && !constrained.has(HueStateChange::XYAttribute)) {
+                const float mired = static_cast<float>(constrained.getColorTemp());
+                float x = 0.0f;
+                float y = 0.0f;
+
+                HueColor::miredToXY(&mired, &x, &y, 1);
+                constrained.setXY(static_cast<double>(x), static_cast<double>(y));
+            }
+
+            constrained.clear(HueStateChange::ColorTempAttribute);
+        }
+    }
+
+    // ... and xy as the closest color temperature on white lights
+    if (constrained.has(HueStateChange::XYAttribute)) {
+        if (m_capabilities.supportsColor()) {
+            if (m_capabilities.hasColorGamut()
+                    && !HueColor::isInTriangle(m_capabilities.getColorGamut(),
+                                               constrained.getXValue(), constrained.getYValue())) {
+                float x = static_cast<float>(constrained.getXValue());
+                float y = static_cast<float>(constrained.getYValue());
+
+                HueColor::clampToTriangle(m_capabilities.getColorGamut(), &x, &y, 1);
+                constrained.setXY(static_cast<double>(x), static_cast<double>(y));
+            }
+        }
+        else {
+            if (m_capabilities.supportsColorTemp() && !constrained.has(HueStateChange::ColorTempAttribute)) {
+                const float x = static_cast<float>(constrained.getXValue());
+                const float y = static_cast<float>(constrained.getYValue());
+                float mired = 0.0f;
+
+                HueColor::xyToMired(&x, &y, &mired, 1);
+                constrained.setColorTemp(qBound(m_capabilities.getColorTempMin(),
+                                                qRound(mired),
+                                                m_capabilities.getColorTempMax()));
+            }
+
+            constrained.clear(HueStateChange::XYAttribute);
+        }
+    }
+
+    if (!m_capabilities.supportsColor()) {
+        constrained.clear(HueStateChange::HueAttribute);
+        constrained.clear(HueStateChange::SaturationAttribute);
+
+        if (constrained.has(HueStateChange::EffectAttribute) && constrained.getEffect() == ColorLoop)
+            constrained.clear(HueStateChange::EffectAttribute);
+    }
+
+    return constrained;
+}
+
 void HueLight::updateOn(const bool on)
 {
     m_state.setOn(on);
-    emit valueUpdated();
+    notifyUpdated(HueStateChange::OnAttribute);
 }
 
 void HueLight::updateHue(const int hue)
 {
     m_state.setHue(hue);
-    emit valueUpdated();
+    m_state.setColorMode(Light::State::HueSatColorMode);
+    notifyUpdated(HueStateChange::HueAttribute);
 }
 
 void HueLight::updateSaturation(const int saturation)
 {
     m_state.setSaturation(saturation);
-    emit valueUpdated();
+    m_state.setColorMode(Light::State::HueSatColorMode);
+    notifyUpdated(HueStateChange::SaturationAttribute);
 }
 
 void HueLight::updateBrightness(const int brightness)
 {
     m_state.setBrightness(brightness);
-    emit valueUpdated();
+    notifyUpdated(HueStateChange::BrightnessAttribute);
 }
 
 void HueLight::updateColorTemp(const int colorTemp)
 {
     m_state.setColorTemp(colorTemp);
-    emit valueUpdated();
+    m_state.setColorMode(Light::State::ColorTempColorMode);
+    notifyUpdated(HueStateChange::ColorTempAttribute);
 }
 
 void HueLight::updateXY(const double x, const double y)
 {
     m_state.setXValue(x);
     m_state.setYValue(y);
-    emit valueUpdated();
+    m_state.setColorMode(Light::State::XYColorMode);
+    notifyUpdated(HueStateChange::XYAttribute);
 }
 
 void HueLight::updateAlert(const HueAlert alert)
 {
-    QString alertString;
     switch (alert) {
     case HueAlert::NoAlert:
-        alertString = "none";
+        m_state.setAlert(Light::State::NoAlert);
         break;
     case HueAlert::BreatheSingle:
-        alertString = "select";
+        m_state.setAlert(Light::State::SelectAlert);
         break;
     case HueAlert::Breathe15Sec:
-        alertString = "lselect";
+        m_state.setAlert(Light::State::LSelectAlert);
         break;
     }
-    m_state.setAlert(alertString);
-    emit valueUpdated();
+    notifyUpdated(HueStateChange::AlertAttribute);
 }
 
 void HueLight::updateEffect(const HueEffect effect)
 {
-    QString effectString;
     switch (effect) {
     case HueEffect::NoEffect:
-        effectString = "none";
+        m_state.setEffect(Light::State::NoEffect);
         break;
     case HueEffect::ColorLoop:
-        effectString = "colorloop";
+        m_state.setEffect(Light::State::ColorLoopEffect);
         break;
     }
-    m_state.setEffect(effectString);
-    emit valueUpdated();
+    notifyUpdated(HueStateChange::EffectAttribute);
 }
@@ -2,6 +2,7 @@
 #define HUELIGHT_H
 
 #include <memory>
+#include <vector>
 
 #include "hueabstractobject.h"
 #include "huetypes.h"
@@ -10,9 +11,13 @@
 class HueLight : public HueAbstractObject
 {
     Q_OBJECT
+    friend class HueGroup;
+    friend class HueSnapshot;
+
 public:
     HueLight();
     HueLight(HueBridge* bridge);
+    ~HueLight() override;
 
     static HueLightList discoverLights(HueBridge* bridge);
 
@@ -27,11 +32,15 @@ public:
     Light::Manufacturer manufacturer() const;
     Light::ProductID productID() const;
     Light::Config config() const;
+    Light::Capabilities capabilities() const;
 
     bool hasValidConstructor() const override;
     bool isValid() const override;
     int ID() const override;
+    HueObjectKind objectKind() const override;
     bool synchronize() override;
+    HueStateChange currentState() const override;
+    bool isReachable() const override;
 
 private:
     HueLight(HueBridge* bridge,
@@ -44,14 +53,23 @@ private:
              Light::ProductName productName,
              Light::Manufacturer manufacturer,
              Light::ProductID productID,
-             Light::Config config);
+             Light::Config config,
+             Light::Capabilities capabilities);
     HueLight(const HueLight& rhs);
     HueLight operator=(const HueLight& rhs);
 
     static bool constructHueLight(int ID, QJsonObject json, std::shared_ptr<HueLight>& light);
+    static void constructHueLight(const Light::Record& record, std::shared_ptr<HueLight>& light);
+    static std::shared_ptr<HueLight> createHueLight(HueBridge* bridge, const Light::Record& record);
+    static bool parseHueLight(int ID, const QJsonObject& json, Light::Record& record);
+    static bool readHueLight(int ID, HueJsonReader& reader, Light::Record& record);
+    static std::vector<Light::Record> parseHueLights(const QByteArray& json);
+    static void registerLight(HueLight* light);
+    static std::vector<HueLight*> knownLights(HueBridge* bridge, const HueBitset& IDs);
 
     HueRequest makePutRequest(QJsonObject json) override;
     HueRequest makeGetRequest() override;
+    HueStateChange constrainState(const HueStateChange& change) const override;
 
     void updateOn(const bool on) override;
     void updateHue(const int hue) override;
@@ -75,7 +93,10 @@ private:
     Light::Manufacturer m_manufacturer;
     Light::ProductID m_productID;
     Light::Config m_config;
+    Light::Capabilities m_capabilities;
     bool m_validConstructor;
+    HueBridge* m_registeredBridge;
+    int m_registeredID;
 
 };
 
@@ -0,0 +1,614 @@
+#include "huelightstatetable.h"
+
+#include <QtMath>
+
+/*!
+ * \class HueLightStateTable
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Holds the state of many lights in columns for bulk queries and changes.
+ *
+ * HueLightStateTable copies the state of every light in a \l HueLightList into
+ * contiguous arrays, one per value: \e on and \e reachable as bitsets, and brightness,
+ * hue, saturation, color temperature and the CIE coordinates as arrays of fixed-width
+ * numbers. Each light is a row, in the order of the list. Queries and transforms then
+ * run over the arrays instead of dereferencing one \l HueLight per light, which lets
+ * the compiler vectorize the loops. The arrays can also be read directly, e.g. by
+ * \l brightnessData().
+ *
+ * The table is kept in sync with the lights: a row is updated whenever its light emits
+ * \l HueAbstractObject::valueUpdated() or \l HueAbstractObject::synchronized(), e.g.
+ * when a command is sent or when \l HueSynchronizer or \l HueEventStream refresh it.
+ *
+ * Queries return the rows that match, and transforms return a \l ChangeSet holding one
+ * \l HueStateChange per row that would change. Nothing is sent to the bridge until the
+ * change set is passed to \l apply().
+ *
+ * \code
+ *  HueLightStateTable table(lights);
+ *
+ *  // Dim all reachable lights that are on by 10%, over one second
+ *  const std::vector<int> rows = table.select(HueLightStateTable::OnFilter
+ *                                             | HueLightStateTable::ReachableFilter);
+ *  table.apply(table.scaleBrightness(rows, 0.9), 10);
+ *
+ *  // Lights with a red hue
+ *  const std::vector<int> red = table.select(HueLightStateTable::HueColumn, 63000, 2500);
+ * \endcode
+ *
+ */
+
+/*!
+ * \enum HueLightStateTable::Column
+ * This enum selects the column compared by \l select().
+ *
+ * \value BrightnessColumn
+ *      Brightness (0 - 254).
+ * \value HueColumn
+ *      Hue (0 - 65535).
+ * \value SaturationColumn
+ *      Saturation (0 - 254).
+ * \value ColorTempColumn
+ *      Color temperature (153 - 500).
+ *
+ */
+
+/*!
+ * \enum HueLightStateTable::Filter
+ * This enum describes filters that can be combined and passed to \l select().
+ *
+ * \value NoFilter
+ *      All rows.
+ * \value OnFilter
+ *      Only lights that are on.
+ * \value OffFilter
+ *      Only lights that are off.
+ * \value ReachableFilter
+ *      Only lights that are reachable.
+ *
+ */
+
+/*!
+ * \typedef HueLightStateTable::ChangeSet
+ *
+ * A list of rows and the \l HueStateChange to send to the light in each row.
+ *
+ */
+
+template<typename T>
+static void rangeMask(const std::vector<T>& column, const int minValue, const int maxValue,
+                      std::vector<quint8>& mask)
+{
+    const size_t count = column.size();
+    const T* values = column.data();
+    quint8* selected = mask.data();
+
+    if (minValue <= maxValue) {
+        for (size_t i = 0; i < count; i++)
+            selected[i] = (values[i] >= minValue) & (values[i] <= maxValue);
+    }
+    else {
+        // The range wraps around, e.g. hues on both sides of red
+        for (size_t i = 0; i < count; i++)
+            selected[i] = (values[i] >= minValue) | (values[i] <= maxValue);
+    }
+}
+
+/*!
+ * \fn HueLightStateTable::HueLightStateTable(QObject* parent)
+ *
+ * Constructs an empty HueLightStateTable. A \e QObject parent can be set by \a parent.
+ *
+ * \sa setLights()
+ *
+ */
+HueLightStateTable::HueLightStateTable(QObject* parent)
+    : QObject(parent)
+    , m_lights()
+    , m_rowOfID()
+    , m_on()
+    , m_reachable()
+    , m_brightness()
+    , m_hue()
+    , m_saturation()
+    , m_colorTemp()
+    , m_x()
+    , m_y()
+{
+
+}
+
+/*!
+ * \fn HueLightStateTable::HueLightStateTable(const HueLightList& lights, QObject* parent)
+ *
+ * Constructs a HueLightStateTable with one row per light in \a lights. A \e QObject
+ * parent can be set by \a parent.
+ *
+ */
+HueLightStateTable::HueLightStateTable(const HueLightList& lights, QObject* parent)
+    : HueLightStateTable(parent)
+{
+    setLights(lights);
+}
+
+/*!
+ * \fn void HueLightStateTable::setLights(const HueLightList& lights)
+ *
+ * Replaces the rows of the table with one row per light in \a lights.
+ *
+ */
+void HueLightStateTable::setLights(const HueLightList& lights)
+{
+    for (const auto& light : m_lights)
+        disconnect(light.get(), nullptr, this, nullptr);
+
+    const int count = lights.size();
+    const size_t rows = static_cast<size_t>(count);
+    const size_t words = (rows + 63) / 64;
+
+    m_lights.clear();
+    m_lights.reserve(rows);
+    m_rowOfID.clear();
+    m_rowOfID.reserve(count);
+
+    m_on.assign(words, 0);
+    m_reachable.assign(words, 0);
+    m_brightness.assign(rows, 0);
+    m_hue.assign(rows, 0);
+    m_saturation.assign(rows, 0);
+    m_colorTemp.assign(rows, 0);
+    m_x.assign(rows, 0);
+    m_y.assign(rows, 0);
+
+    for (int row = 0; row < count; row++) {
+        std::shared_ptr<HueLight> light = lights.at(row);
+        m_lights.push_back(light);
+
+        // The first row wins if the list holds a light twice
+        if (!m_rowOfID.contains(light->ID()))
+            m_rowOfID.insert(light->ID(), row);
+
+        connect(light.get(), &HueAbstractObject::valueUpdated,
+                this, [this, row]() { updateRow(row); });
+        connect(light.get(), &HueAbstractObject::synchronized,
+                this, [this, row]() { updateRow(row); });
+
+        updateRow(row);
+    }
+}
+
+/*!
+ * \fn int HueLightStateTable::rowCount() const
+ *
+ * Returns the number of rows.
+ *
+ */
+int HueLightStateTable::rowCount() const
+{
+    return static_cast<int>(m_lights.size());
+}
+
+/*!
+ * \fn int HueLightStateTable::rowOf(const int lightID) const
+ *
+ * Returns the row of the light with ID \a lightID, or -1 if the light is not in the table.
+ *
+ */
+int HueLightStateTable::rowOf(const int lightID) const
+{
+    return m_rowOfID.value(lightID, -1);
+}
+
+/*!
+ * \fn std::shared_ptr<HueLight> HueLightStateTable::light(const int row) const
+ *
+ * Returns the light in \a row.
+ *
+ */
+std::shared_ptr<HueLight> HueLightStateTable::light(const int row) const
+{
+    return m_lights[static_cast<size_t>(row)];
+}
+
+/*!
+ * \fn bool HueLightStateTable::isOn(const int row) const
+ *
+ * Returns \c true if the light in \a row is on.
+ *
+ */
+bool HueLightStateTable::isOn(const int row) const
+{
+    return testBit(m_on, row);
+}
+
+/*!
+ * \fn bool HueLightStateTable::isReachable(const int row) const
+ *
+ * Returns \c true if the light in \a row is reachable.
+ *
+ */
+bool HueLightStateTable::isReachable(const int row) const
+{
+    return testBit(m_reachable, row);
+}
+
+/*!
+ * \fn int HueLightStateTable::getBrightness(const int row) const
+ *
+ * Returns the brightness of the light in \a row.
+ *
+ */
+int HueLightStateTable::getBrightness(const int row) const
+{
+    return m_brightness[static_cast<size_t>(row)];
+}
+
+/*!
+ * \fn int HueLightStateTable::getHue(const int row) const
+ *
+ * Returns the hue of the light in \a row.
+ *
+ */
+int HueLightStateTable::getHue(const int row) const
+{
+    return m_hue[static_cast<size_t>(row)];
+}
+
+/*!
+ * \fn int HueLightStateTable::getSaturation(const int row) const
+ *
+ * Returns the saturation of the light in \a row.
+ *
+ */
+int HueLightStateTable::getSaturation(const int row) const
+{
+    return m_saturation[static_cast<size_t>(row)];
+}
+
+/*!
+ * \fn int HueLightStateTable::getColorTemp(const int row) const
+ *
+ * Returns the color temperature of the light in \a row.
+ *
+ */
+int HueLightStateTable::getColorTemp(const int row) const
+{
+    return m_colorTemp[static_cast<size_t>(row)];
+}
+
+/*!
+ * \fn double HueLightStateTable::getXValue(const int row) const
+ *
+ * Returns the X coordinate in CIE color space of the light in \a row.
+ *
+ */
+double HueLightStateTable::getXValue(const int row) const
+{
+    return static_cast<double>(m_x[static_cast<size_t>(row)]);
+}
+
+/*!
+ * \fn double HueLightStateTable::getYValue(const int row) const
+ *
+ * Returns the Y coordinate in CIE color space of the light in \a row.
+ *
+ */
+double HueLightStateTable::getYValue(const int row) const
+{
+    return static_cast<double>(m_y[static_cast<size_t>(row)]);
+}
+
+/*!
+ * \fn const quint8* HueLightStateTable::brightnessData() const
+ *
+ * Returns the brightness column, with \l rowCount() values. The pointer is
+ * invalidated by \l setLights().
+ *
+ */
+const quint8* HueLightStateTable::brightnessData() const
+{
+    return m_brightness.data();
+}
+
+/*!
+ * \fn const quint16* HueLightStateTable::hueData() const
+ *
+ * Returns the hue column, with \l rowCount() values. The pointer is
+ * invalidated by \l setLights().
+ *
+ */
+const quint16* HueLightStateTable::hueData() const
+{
+    return m_hue.data();
+}
+
+/*!
+ * \fn const quint8* HueLightStateTable::saturationData() const
+ *
+ * Returns the saturation column, with \l rowCount() values. The pointer is
+ * invalidated by \l setLights().
+ *
+ */
+const quint8* HueLightStateTable::saturationData() const
+{
+    return m_saturation.data();
+}
+
+/*!
+ * \fn const quint16* HueLightStateTable::colorTempData() const
+ *
+ * Returns the color temperature column, with \l rowCount() values. The pointer is
+ * invalidated by \l setLights().
+ *
+ */
+const quint16* HueLightStateTable::colorTempData() const
+{
+    return m_colorTemp.data();
+}
+
+/*!
+ * \fn const float* HueLightStateTable::xData() const
+ *
+ * Returns the column of X coordinates, with \l rowCount() values. The pointer is
+ * invalidated by \l setLights().
+ *
+ */
+const float* HueLightStateTable::xData() const
+{
+    return m_x.data();
+}
+
+/*!
+ * \fn const float* HueLightStateTable::yData() const
+ *
+ * Returns the column of Y coordinates, with \l rowCount() values. The pointer is
+ * invalidated by \l setLights().
+ *
+ */
+const float* HueLightStateTable::yData() const
+{
+    return m_y.data();
+}
+
+/*!
+ * \fn std::vector<int> HueLightStateTable::select(const int filter) const
+ *
+ * Returns the rows that pass \a filter, a combination of \l Filter values, in
+ * ascending order.
+ *
+ */
+std::vector<int> HueLightStateTable::select(const int filter) const
+{
+    std::vector<quint8> mask(m_lights.size(), 1);
+    applyFilter(mask, filter);
+
+    return maskToRows(mask);
+}
+
+/*!
+ * \fn std::vector<int> HueLightStateTable::select(const Column column, const int minValue, const int maxValue, const int filter) const
+ *
+ * Returns the rows where \a column is between \a minValue and \a maxValue (inclusive)
+ * and that pass \a filter, in ascending order. If \a minValue is larger than
+ * \a maxValue, the range wraps around, which is useful for hues around red.
+ *
+ */
+std::vector<int> HueLightStateTable::select(const Column column, const int minValue, const int maxValue,
+                                            const int filter) const
+{
+    std::vector<quint8> mask(m_lights.size(), 0);
+
+    switch (column) {
+    case BrightnessColumn:
+        rangeMask(m_brightness, minValue, maxValue, mask);
+        break;
+    case HueColumn:
+        rangeMask(m_hue, minValue, maxValue, mask);
+        break;
+    case SaturationColumn:
+        rangeMask(m_saturation, minValue, maxValue, mask);
+        break;
+    case ColorTempColumn:
+        rangeMask(m_colorTemp, minValue, maxValue, mask);
+        break;
+    }
+
+    applyFilter(mask, filter);
+
+    return maskToRows(mask);
+}
+
+/*!
+ * \fn HueLightStateTable::ChangeSet HueLightStateTable::setOn(const std::vector<int>& rows, const bool on) const
+ *
+ * Returns changes that turn the lights in \a rows on or off, as specified by \a on.
+ * Lights that are already on or off are left out.
+ *
+ */
+HueLightStateTable::ChangeSet HueLightStateTable::setOn(const std::vector<int>& rows, const bool on) const
+{
+    ChangeSet changes;
+
+    for (const int row : rows) {
+        if (testBit(m_on, row) == on)
+            continue;
+
+        HueStateChange change;
+        change.setOn(on);
+        changes.emplace_back(row, change);
+    }
+
+    return changes;
+}
+
+/*!
+ * \fn HueLightStateTable::ChangeSet HueLightStateTable::scaleBrightness(const std::vector<int>& rows, const double factor) const
+ *
+ * Returns changes that multiply the brightness of the lights in \a rows by \a factor,
+ * clamped to 1 - 254. Lights that are off, or whose brightness would not change,
+ * are left out.
+ *
+ */
+HueLightStateTable::ChangeSet HueLightStateTable::scaleBrightness(const std::vector<int>& rows,
+                                                                  const double factor) const
+{
+    ChangeSet changes;
+
+    for (const int row : rows) {
+        const int brightness = m_brightness[static_cast<size_t>(row)];
+        const int scaled = qBound(1, qRound(brightness * factor), 254);
+
+        if (!testBit(m_on, row) || scaled == brightness)
+            continue;
+
+        HueStateChange change;
+        change.setBrightness(scaled);
+        changes.emplace_back(row, change);
+    }
+
+    return changes;
+}
+
+/*!
+ * \fn HueLightStateTable::ChangeSet HueLightStateTable::shiftHue(const std::vector<int>& rows, const int delta) const
+ *
+ * Returns changes that add \a delta to the hue of the lights in \a rows, wrapping
+ * around at 65535. Lights that are off are left out.
+ *
+ */
+HueLightStateTable::ChangeSet HueLightStateTable::shiftHue(const std::vector<int>& rows, const int delta) const
+{
+    ChangeSet changes;
+
+    if (delta % 65536 == 0)
+        return changes;
+
+    for (const int row : rows) {
+        if (!testBit(m_on, row))
+            continue;
+
+        const int hue = ((m_hue[static_cast<size_t>(row)] + delta) % 65536 + 65536) % 65536;
+
+        HueStateChange change;
+        change.setHue(hue);
+        changes.emplace_back(row, change);
+    }
+
+    return changes;
+}
+
+/*!
+ * \fn HueLightStateTable::ChangeSet HueLightStateTable::setColorTemp(const std::vector<int>& rows, const int colorTemp) const
+ *
+ * Returns changes that set the color temperature of the lights in \a rows to
+ * \a colorTemp. Lights that are off, or that already have that color temperature,
+ * are left out.
+ *
+ */
+HueLightStateTable::ChangeSet HueLightStateTable::setColorTemp(const std::vector<int>& rows,
+                                                               const int colorTemp) const
+{
+    ChangeSet changes;
+
+    for (const int row : rows) {
+        if (!testBit(m_on, row) || m_colorTemp[static_cast<size_t>(row)] == colorTemp)
+            continue;
+
+        HueStateChange change;
+        change.setColorTemp(colorTemp);
+        changes.emplace_back(row, change);
+    }
+
+    return changes;
+}
+
+/*!
+ * \fn int HueLightStateTable::apply(const ChangeSet& changes, const int transitionTime) const
+ *
+ * Sends \a changes to the lights through \l HueAbstractObject::setState(), one request
+ * per light. If \a transitionTime is not negative, it is used as the transition time
+ * of every change, in multiples of 100 ms. The table is updated as the lights are.
+ *
+ * Returns the number of changes that were accepted by the bridge.
+ *
+ */
+int HueLightStateTable::apply(const ChangeSet& changes, const int transitionTime) const
+{
+    int applied = 0;
+
+    for (const auto& rowChange : changes) {
+        HueStateChange change = rowChange.second;
+
+        if (transitionTime >= 0)
+            change.setTransitionTime(transitionTime);
+
+        if (m_lights[static_cast<size_t>(rowChange.first)]->setState(change))
+            applied++;
+    }
+
+    return applied;
+}
+
+void HueLightStateTable::updateRow(const int row)
+{
+    const size_t index = static_cast<size_t>(row);
+    const Light::State state = m_lights[index]->state();
+
+    assignBit(m_on, row, state.isOn());
+    assignBit(m_reachable, row, state.isReachable());
+    m_brightness[index] = static_cast<quint8>(state.getBrightness());
+    m_hue[index] = static_cast<quint16>(state.getHue());
+    m_saturation[index] = static_cast<quint8>(state.getSaturation());
+    m_colorTemp[index] = static_cast<quint16>(state.getColorTemp());
+    m_x[index] = static_cast<float>(state.getXValue());
+    m_y[index] = static_cast<float>(state.getYValue());
+
+    emit rowUpdated(row);
+}
+
+bool HueLightStateTable::testBit(const std::vector<quint64>& bits, const int row) const
+{
+    return (bits[static_cast<size_t>(row) / 64] >> (row % 64)) & 1;
+}
+
+void HueLightStateTable::assignBit(std::vector<quint64>& bits, const int row, const bool value)
+{
+    const quint64 bit = quint64(1) << (row % 64);
+
+    if (value)
+        bits[static_cast<size_t>(row) / 64] |= bit;
+    else
+        bits[static_cast<size_t>(row) / 64] &= ~bit;
+}
+
+void HueLightStateTable::applyFilter(std::vector<quint8>& mask, const int filter) const
+{
+    if (filter == NoFilter)
+        return;
+
+    const size_t count = mask.size();
+
+    for (size_t row = 0; row < count; row++) {
+        const quint64 on = (m_on[row / 64] >> (row % 64)) & 1;
+        const quint64 reachable = (m_reachable[row / 64] >> (row % 64)) & 1;
+
+        if ((filter & OnFilter) && !on)
+            mask[row] = 0;
+        if ((filter & OffFilter) && on)
+            mask[row] = 0;
+        if ((filter & ReachableFilter) && !reachable)
+            mask[row] = 0;
+    }
+}
+
+std::vector<int> HueLightStateTable::maskToRows(const std::vector<quint8>& mask) const
+{
+    std::vector<int> rows;
+
+    for (size_t row = 0; row < mask.size(); row++) {
+        if (mask[row])
+            rows.push_back(static_cast<int>(row));
+    }
+
+    return rows;
+}
@@ -0,0 +1,91 @@
+#ifndef HUELIGHTSTATETABLE_H
+#define HUELIGHTSTATETABLE_H
+
+#include <QObject>
+#include <QHash>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "huelight.h"
+#include "huestatechange.h"
+
+class HueLightStateTable : public QObject
+{
+    Q_OBJECT
+public:
+    enum Column {
+        BrightnessColumn,
+        HueColumn,
+        SaturationColumn,
+        ColorTempColumn
+    };
+    enum Filter {
+        NoFilter        = 0x0,
+        OnFilter        = 0x1,
+        OffFilter       = 0x2,
+        ReachableFilter = 0x4
+    };
+
+    typedef std::vector<std::pair<int, HueStateChange>> ChangeSet;
+
+    explicit HueLightStateTable(QObject* parent = nullptr);
+    explicit HueLightStateTable(const HueLightList& lights, QObject* parent = nullptr);
+
+    void setLights(const HueLightList& lights);
+    int rowCount() const;
+    int rowOf(const int lightID) const;
+    std::shared_ptr<HueLight> light(const int row) const;
+
+    bool isOn(const int row) const;
+    bool isReachable(const int row) const;
+    int getBrightness(const int row) const;
+    int getHue(const int row) const;
+    int getSaturation(const int row) const;
+    int getColorTemp(const int row) const;
+    double getXValue(const int row) const;
+    double getYValue(const int row) const;
+
+    const quint8* brightnessData() const;
+    const quint16* hueData() const;
+    const quint8* saturationData() const;
+    const quint16* colorTempData() const;
+    const float* xData() const;
+    const float* yData() const;
+
+    std::vector<int> select(const int filter) const;
+    std::vector<int> select(const Column column, const int minValue, const int maxValue,
+                            const int filter = NoFilter) const;
+
+    ChangeSet setOn(const std::vector<int>& rows, const bool on) const;
+    ChangeSet scaleBrightness(const std::vector<int>& rows, const double factor) const;
+    ChangeSet shiftHue(const std::vector<int>& rows, const int delta) const;
+    ChangeSet setColorTemp(const std::vector<int>& rows, const int colorTemp) const;
+
+    int apply(const ChangeSet& changes, const int transitionTime = -1) const;
+
+signals:
+    void rowUpdated(int row);
+
+private:
+    void updateRow(const int row);
+    bool testBit(const std::vector<quint64>& bits, const int row) const;
+    void assignBit(std::vector<quint64>& bits, const int row, const bool value);
+    void applyFilter(std::vector<quint8>& mask, const int filter) const;
+    std::vector<int> maskToRows(const std::vector<quint8>& mask) const;
+
+private:
+    std::vector<std::shared_ptr<HueLight>> m_lights;
+    QHash<int, int> m_rowOfID;
+
+    std::vector<quint64> m_on;
+    std::vector<quint64> m_reachable;
+    std::vector<quint8> m_brightness;
+    std::vector<quint16> m_hue;
+    std::vector<quint8> m_saturation;
+    std::vector<quint16> m_colorTemp;
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+};
+
+#endif // HUELIGHTSTATETABLE_H
@@ -0,0 +1,352 @@
+#include "huemembershipindex.h"
+#include "huegroup.h"
+
+/*!
+ * \class HueMembershipIndex
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Relates lights to the groups they are members of.
+ *
+ * HueMembershipIndex keeps the members of every group and the groups of every
+ * light as \l HueBitset objects, so that questions such as "which groups contain
+ * light 17" or "which groups consist only of these lights" are answered with a few
+ * word operations instead of a scan of every group's member list.
+ *
+ * The index follows the groups passed to \l setGroups(): when a group is
+ * synchronized and its members have changed, only that group's entries are
+ * updated and \l membershipChanged() is emitted.
+ *
+ * \code
+ *  HueMembershipIndex* index = new HueMembershipIndex(HueGroup::discoverGroups(bridge));
+ *
+ *  // Groups that light 17 is a member of
+ *  for (int groupID : index->groupsOf(17).toVector())
+ *      qDebug() << "Light 17 is in group" << groupID;
+ *
+ *  // Fewest groups that make up exactly lights 1, 2, 3 and 5
+ *  HueBitset rest;
+ *  std::vector<int> groups = index->cover({1, 2, 3, 5}, &rest);
+ * \endcode
+ *
+ * \sa Group::Lights::getMembers()
+ *
+ */
+
+/*!
+ * \fn HueMembershipIndex::HueMembershipIndex(QObject* parent)
+ *
+ * Constructs an empty index with parent \a parent.
+ *
+ */
+HueMembershipIndex::HueMembershipIndex(QObject* parent)
+    : QObject(parent)
+    , m_groups()
+    , m_lightsOfGroup()
+    , m_groupsOfLight()
+    , m_groupOfObject()
+{
+    connect(&HueChangeNotifier::instance(), &HueChangeNotifier::changed,
+            this, &HueMembershipIndex::objectsChanged);
+}
+
+/*!
+ * \fn HueMembershipIndex::HueMembershipIndex(const HueGroupList& groups, QObject* parent)
+ *
+ * Constructs an index of \a groups with parent \a parent.
+ *
+ */
+HueMembershipIndex::HueMembershipIndex(const HueGroupList& groups, QObject* parent)
+    : HueMembershipIndex(parent)
+{
+    setGroups(groups);
+}
+
+/*!
+ * \fn void HueMembershipIndex::setGroups(const HueGroupList& groups)
+ *
+ * Replaces the indexed groups with \a groups.
+ *
+ */
+void HueMembershipIndex::setGroups(const HueGroupList& groups)
+{
+    clear();
+
+    for (int i = 0; i < groups.size(); i++)
+        addGroup(groups.at(i).get());
+}
+
+/*!
+ * \fn void HueMembershipIndex::updateGroup(const HueGroup* group)
+ *
+ * Updates the members of \a group, adding the group to the index if it is not
+ * indexed yet. This is done automatically when an indexed group is synchronized.
+ *
+ */
+void HueMembershipIndex::updateGroup(const HueGroup* group)
+{
+    if (group == nullptr)
+        return;
+
+    if (!m_groupOfObject.contains(group)) {
+        addGroup(group);
+        return;
+    }
+
+    if (setMembers(group->ID(), group->lights().getMembers()))
+        emit membershipChanged(group->ID());
+}
+
+/*!
+ * \fn void HueMembershipIndex::removeGroup(const int groupID)
+ *
+ * Removes the group with ID \a groupID from the index.
+ *
+ */
+void HueMembershipIndex::removeGroup(const int groupID)
+{
+    if (!m_groups.test(groupID))
+        return;
+
+    setMembers(groupID, HueBitset());
+    m_groups.reset(groupID);
+    m_lightsOfGroup.remove(groupID);
+
+    for (auto it = m_groupOfObject.begin(); it != m_groupOfObject.end(); ) {
+        if (it.value() == groupID)
+            it = m_groupOfObject.erase(it);
+        else
+            ++it;
+    }
+
+    emit membershipChanged(groupID);
+}
+
+/*!
+ * \fn void HueMembershipIndex::clear()
+ *
+ * Removes all groups from the index.
+ *
+ */
+void HueMembershipIndex::clear()
+{
+    for (auto it = m_groupOfObject.constBegin(); it != m_groupOfObject.constEnd(); ++it)
+        disconnect(it.key(), nullptr, this, nullptr);
+
+    m_groups.clear();
+    m_lightsOfGroup.clear();
+    m_groupsOfLight.clear();
+    m_groupOfObject.clear();
+}
+
+/*!
+ * \fn HueBitset HueMembershipIndex::getGroups() const
+ *
+ * Returns the IDs of the indexed groups.
+ *
+ */
+HueBitset HueMembershipIndex::getGroups() const
+{
+    return m_groups;
+}
+
+/*!
+ * \fn HueBitset HueMembershipIndex::lightsOf(const int groupID) const
+ *
+ * Returns the IDs of the lights in the group with ID \a groupID.
+ *
+ */
+HueBitset HueMembershipIndex::lightsOf(const int groupID) const
+{
+    return m_lightsOfGroup.value(groupID);
+}
+
+/*!
+ * \fn HueBitset HueMembershipIndex::groupsOf(const int lightID) const
+ *
+ * Returns the IDs of the groups that the light with ID \a lightID is a member of.
+ *
+ */
+HueBitset HueMembershipIndex::groupsOf(const int lightID) const
+{
+    return m_groupsOfLight.value(lightID);
+}
+
+/*!
+ * \fn bool HueMembershipIndex::contains(const int groupID, const int lightID) const
+ *
+ * Returns \c true if the light with ID \a lightID is a member of the group
+ * with ID \a groupID.
+ *
+ */
+bool HueMembershipIndex::contains(const int groupID, const int lightID) const
+{
+    auto it = m_lightsOfGroup.constFind(groupID);
+    return it != m_lightsOfGroup.constEnd() && it->test(lightID);
+}
+
+/*!
+ * \fn HueBitset HueMembershipIndex::groupsContaining(const HueBitset& lights) const
+ *
+ * Returns the IDs of the groups that contain all of \a lights. If \a lights is
+ * empty, all indexed groups are returned.
+ *
+ */
+HueBitset HueMembershipIndex::groupsContaining(const HueBitset& lights) const
+{
+    HueBitset groups = m_groups;
+
+    for (const int lightID : lights.toVector()) {
+        groups &= groupsOf(lightID);
+        if (groups.isEmpty())
+            break;
+    }
+
+    return groups;
+}
+
+/*!
+ * \fn HueBitset HueMembershipIndex::groupsWithin(const HueBitset& lights) const
+ *
+ * Returns the IDs of the non-empty groups whose lights are all in \a lights.
+ * Commands sent to these groups only reach lights in \a lights.
+ *
+ */
+HueBitset HueMembershipIndex::groupsWithin(const HueBitset& lights) const
+{
+    HueBitset groups;
+
+    for (auto it = m_lightsOfGroup.constBegin(); it != m_lightsOfGroup.constEnd(); ++it) {
+        if (!it->isEmpty() && it->isSubsetOf(lights))
+            groups.set(it.key());
+    }
+
+    return groups;
+}
+
+/*!
+ * \fn int HueMembershipIndex::exactGroup(const HueBitset& lights) const
+ *
+ * Returns the lowest ID of a group that consists of exactly \a lights, or \c -1
+ * if there is no such group.
+ *
+ */
+int HueMembershipIndex::exactGroup(const HueBitset& lights) const
+{
+    if (lights.isEmpty())
+        return -1;
+
+    for (const int groupID : groupsContaining(lights).toVector()) {
+        if (m_lightsOfGroup.value(groupID) == lights)
+            return groupID;
+    }
+
+    return -1;
+}
+
+/*!
+ * \fn std::vector<int> HueMembershipIndex::cover(const HueBitset& lights, HueBitset* uncovered) const
+ *
+ * Returns IDs of groups that together contain \a lights and no other lights,
+ * choosing the group that contains the most remaining lights first. Lights that
+ * no such group contains are stored in \a uncovered if it is not null, and have to
+ * be addressed individually.
+ *
+ * A group consisting of exactly \a lights is always returned on its own.
+ *
+ */
+std::vector<int> HueMembershipIndex::cover(const HueBitset& lights, HueBitset* uncovered) const
+{
+    std::vector<int> groups;
+    HueBitset remaining = lights;
+
+    const int exact = exactGroup(lights);
+    if (exact != -1) {
+        groups.push_back(exact);
+        remaining.clear();
+    }
+
+    const std::vector<int> candidates = groupsWithin(lights).toVector();
+
+    while (!remaining.isEmpty()) {
+        int bestGroup = -1;
+        int bestCount = 0;
+
+        for (const int groupID : candidates) {
+            const int count = m_lightsOfGroup.value(groupID).intersectionCount(remaining);
+            if (count > bestCount) {
+                bestGroup = groupID;
+                bestCount = count;
+            }
+        }
+
+        if (bestGroup == -1)
+            break;
+
+        groups.push_back(bestGroup);
+        remaining -= m_lightsOfGroup.value(bestGroup);
+    }
+
+    if (uncovered != nullptr)
+        *uncovered = remaining;
+
+    return groups;
+}
+
+/*!
+ * \fn void HueMembershipIndex::membershipChanged(const int groupID)
+ *
+ * This signal is emitted when the lights of the group with ID \a groupID
+ * have changed, or when the group has been removed from the index.
+ *
+ */
+
+void HueMembershipIndex::objectsChanged(const HueChangeNotifier::ChangeSet& changes)
+{
+    for (const auto& change : changes) {
+        if (!change.synchronized || change.object.isNull())
+            continue;
+
+        if (m_groupOfObject.contains(change.object.data()))
+            updateGroup(static_cast<const HueGroup*>(change.object.data()));
+    }
+}
+
+void HueMembershipIndex::addGroup(const HueGroup* group)
+{
+    if (group == nullptr)
+        return;
+
+    const int groupID = group->ID();
+
+    m_groups.set(groupID);
+    m_groupOfObject.insert(group, groupID);
+    setMembers(groupID, group->lights().getMembers());
+
+    // The object may go away while its ID stays indexed
+    connect(group, &QObject::destroyed, this, [this](QObject* object) {
+        m_groupOfObject.remove(object);
+    });
+}
+
+// Updates only the lights that joined or left the group; returns true if any did
+bool HueMembershipIndex::setMembers(const int groupID, const HueBitset& lights)
+{
+    const HueBitset previous = m_lightsOfGroup.value(groupID);
+
+    if (previous == lights && m_lightsOfGroup.contains(groupID))
+        return false;
+
+    for (const int lightID : (previous - lights).toVector()) {
+        auto it = m_groupsOfLight.find(lightID);
+        it->reset(groupID);
+        if (it->isEmpty())
+            m_groupsOfLight.erase(it);
+    }
+
+    for (const int lightID : (lights - previous).toVector())
+        m_groupsOfLight[lightID].set(groupID);
+
+    m_lightsOfGroup.insert(groupID, lights);
+
+    return previous != lights;
+}
@@ -0,0 +1,51 @@
+#ifndef HUEMEMBERSHIPINDEX_H
+#define HUEMEMBERSHIPINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <vector>
+
+#include "huebitset.h"
+#include "hueobjectlist.h"
+#include "huechangenotifier.h"
+
+class HueMembershipIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HueMembershipIndex(QObject* parent = nullptr);
+    HueMembershipIndex(const HueGroupList& groups, QObject* parent = nullptr);
+
+    void setGroups(const HueGroupList& groups);
+    void updateGroup(const HueGroup* group);
+    void removeGroup(const int groupID);
+    void clear();
+
+    HueBitset getGroups() const;
+    HueBitset lightsOf(const int groupID) const;
+    HueBitset groupsOf(const int lightID) const;
+    bool contains(const int groupID, const int lightID) const;
+
+    HueBitset groupsContaining(const HueBitset& lights) const;
+    HueBitset groupsWithin(const HueBitset& lights) const;
+    int exactGroup(const HueBitset& lights) const;
+    std::vector<int> cover(const HueBitset& lights, HueBitset* uncovered = nullptr) const;
+
+signals:
+    void membershipChanged(const int groupID);
+
+private slots:
+    void objectsChanged(const HueChangeNotifier::ChangeSet& changes);
+
+private:
+    void addGroup(const HueGroup* group);
+    bool setMembers(const int groupID, const HueBitset& lights);
+
+private:
+    HueBitset m_groups;
+    QHash<int, HueBitset> m_lightsOfGroup;
+    QHash<int, HueBitset> m_groupsOfLight;
+    QHash<const QObject*, int> m_groupOfObject;
+};
+
+#endif // HUEMEMBERSHIPINDEX_H
@@ -0,0 +1,324 @@
+#include "hueperceptualfilter.h"
+
+#include <cmath>
+#include <cstdlib>
+
+/*!
+ * \class HuePerceptualFilter
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Suppresses color and brightness changes that are too small to be seen.
+ *
+ * HuePerceptualFilter sits in front of the \e set functions of \l HueAbstractObject.
+ * It remembers the last brightness, color temperature and \e xy color that was sent
+ * to the bridge, and rejects new values whose perceptual distance to the last sent
+ * value is below a configurable threshold. Rejected values are dropped and never
+ * reach the bridge, which leaves more of the bridge throughput for visible changes.
+ *
+ * Color and brightness distance is measured as \e {Delta E} (CIE76) in CIELAB,
+ * computed from \e xy and brightness (treated as relative luminance) against the
+ * D65 white point. Color temperature distance is measured in mired.
+ *
+ * The filter is disabled by default. It is enabled per object through
+ * \l HueAbstractObject::enablePerceptualFilter().
+ *
+ * \code
+ *  HueLight* light = lights.fetchRaw(1);
+ *  light->enablePerceptualFilter(true);
+ *  light->setPerceptualThreshold(2.0, 5);
+ *
+ *  light->setBrightness(200);  // Sent
+ *  light->setBrightness(201);  // Dropped - not visible
+ * \endcode
+ *
+ * \sa HueAbstractObject::enablePerceptualFilter(), HueAbstractObject::setPerceptualThreshold()
+ */
+
+namespace {
+
+// D65 reference white in XYZ
+const double whiteX = 0.95047;
+const double whiteY = 1.00000;
+const double whiteZ = 1.08883;
+
+// D65 reference white in CIE xy, used when no color has been sent yet
+const double whiteXValue = 0.3127;
+const double whiteYValue = 0.3290;
+
+const double maxBrightness = 254.0;
+
+const double defaultColorThreshold = 1.0;
+const int defaultColorTempThreshold = 3;
+
+double labCompand(const double t)
+{
+    const double delta = 6.0 / 29.0;
+
+    if (t > delta * delta * delta)
+        return std::cbrt(t);
+
+    return t / (3.0 * delta * delta) + 4.0 / 29.0;
+}
+
+void xyBrightnessToLab(const double x, const double y, const int brightness,
+                       double& L, double& a, double& b)
+{
+    const double Y = brightness / maxBrightness;
+    const double safeY = y > 0.0 ? y : 1e-6;
+    const double X = x * Y / safeY;
+    const double Z = (1.0 - x - y) * Y / safeY;
+
+    const double fx = labCompand(X / whiteX);
+    const double fy = labCompand(Y / whiteY);
+    const double fz = labCompand(Z / whiteZ);
+
+    L = 116.0 * fy - 16.0;
+    a = 500.0 * (fx - fy);
+    b = 200.0 * (fy - fz);
+}
+
+}
+
+/*!
+ * \fn HuePerceptualFilter::HuePerceptualFilter()
+ *
+ * Constructs a disabled HuePerceptualFilter with default thresholds
+ * (\e {Delta E} of 1.0 and 3 mired) and no previously sent values.
+ *
+ */
+HuePerceptualFilter::HuePerceptualFilter()
+    : m_enabled(false)
+    , m_colorThreshold(defaultColorThreshold)
+    , m_colorTempThreshold(defaultColorTempThreshold)
+    , m_hasBrightness(false)
+    , m_hasColorTemp(false)
+    , m_hasXY(false)
+    , m_brightness(0)
+    , m_colorTemp(0)
+    , m_xValue(0)
+    , m_yValue(0)
+{
+
+}
+
+/*!
+ * \fn bool HuePerceptualFilter::isEnabled() const
+ *
+ * Returns \c true if the filter is enabled.
+ *
+ */
+bool HuePerceptualFilter::isEnabled() const
+{
+    return m_enabled;
+}
+
+/*!
+ * \fn double HuePerceptualFilter::getColorThreshold() const
+ *
+ * Returns the \e {Delta E} threshold used for \e xy and brightness changes.
+ *
+ */
+double HuePerceptualFilter::getColorThreshold() const
+{
+    return m_colorThreshold;
+}
+
+/*!
+ * \fn int HuePerceptualFilter::getColorTempThreshold() const
+ *
+ * Returns the threshold (in mired) used for color temperature changes.
+ *
+ */
+int HuePerceptualFilter::getColorTempThreshold() const
+{
+    return m_colorTempThreshold;
+}
+
+/*!
+ * \fn void HuePerceptualFilter::setEnabled(const bool enabled)
+ *
+ * Enables or disables the filter as specified by \a enabled. A disabled
+ * filter accepts all values.
+ *
+ */
+void HuePerceptualFilter::setEnabled(const bool enabled)
+{
+    m_enabled = enabled;
+}
+
+/*!
+ * \fn void HuePerceptualFilter::setColorThreshold(const double deltaE)
+ *
+ * Sets the \e {Delta E} threshold for \e xy and brightness changes to \a deltaE.
+ * A \e {Delta E} of about 1 is close to the smallest difference most people can see.
+ * Negative values restore the default.
+ *
+ */
+void HuePerceptualFilter::setColorThreshold(const double deltaE)
+{
+    if (deltaE >= 0.0)
+        m_colorThreshold = deltaE;
+    else
+        m_colorThreshold = defaultColorThreshold;
+}
+
+/*!
+ * \fn void HuePerceptualFilter::setColorTempThreshold(const int mired)
+ *
+ * Sets the threshold for color temperature changes to \a mired.
+ * Negative values restore the default.
+ *
+ */
+void HuePerceptualFilter::setColorTempThreshold(const int mired)
+{
+    if (mired >= 0)
+        m_colorTempThreshold = mired;
+    else
+        m_colorTempThreshold = defaultColorTempThreshold;
+}
+
+/*!
+ * \fn bool HuePerceptualFilter::acceptBrightness(const int brightness) const
+ *
+ * Returns \c true if \a brightness differs visibly from the last sent
+ * brightness, if no brightness has been sent yet, or if the filter is disabled.
+ *
+ */
+bool HuePerceptualFilter::acceptBrightness(const int brightness) const
+{
+    if (!m_enabled || !m_hasBrightness)
+        return true;
+
+    const double x = m_hasXY ? m_xValue : whiteXValue;
+    const double y = m_hasXY ? m_yValue : whiteYValue;
+
+    return deltaE(x, y, m_brightness, x, y, brightness) >= m_colorThreshold;
+}
+
+/*!
+ * \fn bool HuePerceptualFilter::acceptColorTemp(const int colorTemp) const
+ *
+ * Returns \c true if \a colorTemp differs from the last sent color temperature
+ * by at least the color temperature threshold, if no color temperature has been
+ * sent yet, or if the filter is disabled.
+ *
+ */
+bool HuePerceptualFilter::acceptColorTemp(const int colorTemp) const
+{
+    if (!m_enabled || !m_hasColorTemp)
+        return true;
+
+    return std::abs(colorTemp - m_colorTemp) >= m_colorTempThreshold;
+}
+
+/*!
+ * \fn bool HuePerceptualFilter::acceptXY(const double x, const double y) const
+ *
+ * Returns \c true if the color specified by \a x and \a y differs visibly from
+ * the last sent color, if no color has been sent yet, or if the filter is disabled.
+ * The last sent brightness is used for both colors (full brightness if none was sent).
+ *
+ */
+bool HuePerceptualFilter::acceptXY(const double x, const double y) const
+{
+    if (!m_enabled || !m_hasXY)
+        return true;
+
+    const int brightness = m_hasBrightness ? m_brightness : static_cast<int>(maxBrightness);
+
+    return deltaE(m_xValue, m_yValue, brightness, x, y, brightness) >= m_colorThreshold;
+}
+
+/*!
+ * \fn void HuePerceptualFilter::commitBrightness(const int brightness)
+ *
+ * Records \a brightness as the last value sent to the bridge.
+ *
+ */
+void HuePerceptualFilter::commitBrightness(const int brightness)
+{
+    m_brightness = brightness;
+    m_hasBrightness = true;
+}
+
+/*!
+ * \fn void HuePerceptualFilter::commitColorTemp(const int colorTemp)
+ *
+ * Records \a colorTemp as the last value sent to the bridge. The light is now in
+ * color temperature mode, so the last sent \e xy color is forgotten.
+ *
+ */
+void HuePerceptualFilter::commitColorTemp(const int colorTemp)
+{
+    m_colorTemp = colorTemp;
+    m_hasColorTemp = true;
+    m_hasXY = false;
+}
+
+/*!
+ * \fn void HuePerceptualFilter::commitXY(const double x, const double y)
+ *
+ * Records \a x and \a y as the last color sent to the bridge. The light is now in
+ * \e xy mode, so the last sent color temperature is forgotten.
+ *
+ */
+void HuePerceptualFilter::commitXY(const double x, const double y)
+{
+    m_xValue = x;
+    m_yValue = y;
+    m_hasXY = true;
+    m_hasColorTemp = false;
+}
+
+/*!
+ * \fn void HuePerceptualFilter::commitHueSaturation()
+ *
+ * Records that a hue or saturation was sent to the bridge. The light is now in
+ * hue and saturation mode, so the last sent color temperature and \e xy color
+ * are forgotten and the next value of either is always accepted.
+ *
+ */
+void HuePerceptualFilter::commitHueSaturation()
+{
+    m_hasColorTemp = false;
+    m_hasXY = false;
+}
+
+/*!
+ * \fn void HuePerceptualFilter::reset()
+ *
+ * Forgets all previously sent values, so the next value of each kind is
+ * always accepted. Called when the object is synchronized, since the bridge
+ * state may have been changed by someone else.
+ *
+ */
+void HuePerceptualFilter::reset()
+{
+    m_hasBrightness = false;
+    m_hasColorTemp = false;
+    m_hasXY = false;
+}
+
+/*!
+ * \fn double HuePerceptualFilter::deltaE(const double x1, const double y1, const int brightness1, const double x2, const double y2, const int brightness2)
+ *
+ * Returns the CIE76 color difference between the color specified by \a x1, \a y1
+ * and \a brightness1 and the color specified by \a x2, \a y2 and \a brightness2.
+ * Brightness (1 - 254) is treated as relative luminance.
+ *
+ */
+double HuePerceptualFilter::deltaE(const double x1, const double y1, const int brightness1,
+                                   const double x2, const double y2, const int brightness2)
+{
+    double L1, a1, b1;
+    double L2, a2, b2;
+
+    xyBrightnessToLab(x1, y1, brightness1, L1, a1, b1);
+    xyBrightnessToLab(x2, y2, brightness2, L2, a2, b2);
+
+    const double dL = L1 - L2;
+    const double da = a1 - a2;
+    const double db = b1 - b2;
+
+    return std::sqrt(dL * dL + da * da + db * db);
+}
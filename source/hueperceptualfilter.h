@@ -0,0 +1,44 @@
+#ifndef HUEPERCEPTUALFILTER_H
+#define HUEPERCEPTUALFILTER_H
+
+class HuePerceptualFilter
+{
+public:
+    HuePerceptualFilter();
+
+    bool isEnabled() const;
+    double getColorThreshold() const;
+    int getColorTempThreshold() const;
+
+    void setEnabled(const bool enabled);
+    void setColorThreshold(const double deltaE);
+    void setColorTempThreshold(const int mired);
+
+    bool acceptBrightness(const int brightness) const;
+    bool acceptColorTemp(const int colorTemp) const;
+    bool acceptXY(const double x, const double y) const;
+
+    void commitBrightness(const int brightness);
+    void commitColorTemp(const int colorTemp);
+    void commitXY(const double x, const double y);
+    void commitHueSaturation();
+    void reset();
+
+    static double deltaE(const double x1, const double y1, const int brightness1,
+                         const double x2, const double y2, const int brightness2);
+
+private:
+    bool m_enabled;
+    double m_colorThreshold;
+    int m_colorTempThreshold;
+
+    bool m_hasBrightness;
+    bool m_hasColorTemp;
+    bool m_hasXY;
+    int m_brightness;
+    int m_colorTemp;
+    double m_xValue;
+    double m_yValue;
+};
+
+#endif // HUEPERCEPTUALFILTER_H
@@ -1,5 +1,7 @@
 #include "huereply.h"
 
+#include "huestatechange.h"
+
 /*!
  * \class HueReply
  * \ingroup HueLib
@@ -23,6 +25,25 @@
  *
  */
 
+namespace {
+// Maps the last part of an error address, e.g. "/lights/1/state/bri", to an attribute
+int attributeOfAddress(const QString& address)
+{
+    const QString key = address.mid(address.lastIndexOf('/') + 1);
+
+    if (key == "on")        return HueStateChange::OnAttribute;
+    if (key == "bri")       return HueStateChange::BrightnessAttribute;
+    if (key == "hue")       return HueStateChange::HueAttribute;
+    if (key == "sat")       return HueStateChange::SaturationAttribute;
+    if (key == "ct")        return HueStateChange::ColorTempAttribute;
+    if (key == "xy")        return HueStateChange::XYAttribute;
+    if (key == "alert")     return HueStateChange::AlertAttribute;
+    if (key == "effect")    return HueStateChange::EffectAttribute;
+
+    return HueStateChange::NoAttribute;
+}
+}
+
 /*!
  * \fn HueReply::HueReply()
  *
@@ -33,8 +54,10 @@ HueReply::HueReply()
     : m_replyValid(false)
     , m_timedOut(false)
     , m_json()
+    , m_rawJson()
     , m_httpStatus(0)
     , m_error()
+    , m_errors()
 {
 
 }
@@ -50,8 +73,10 @@ HueReply::HueReply(bool replyValid, bool timedOut, QJsonObject json,
     : m_replyValid(replyValid)
     , m_timedOut(timedOut)
     , m_json(json)
+    , m_rawJson()
     , m_httpStatus(httpStatus)
     , m_error(error)
+    , m_errors()
 {
 
 }
@@ -66,8 +91,10 @@ HueReply::HueReply(const HueReply& rhs)
     : m_replyValid(rhs.m_replyValid)
     , m_timedOut(rhs.m_timedOut)
     , m_json(rhs.m_json)
+    , m_rawJson(rhs.m_rawJson)
     , m_httpStatus(rhs.m_httpStatus)
     , m_error(rhs.m_error)
+    , m_errors(rhs.m_errors)
 {
 
 }
@@ -86,8 +113,10 @@ HueReply HueReply::operator=(const HueReply& rhs)
     m_replyValid = rhs.m_replyValid;
     m_timedOut = rhs.m_timedOut;
     m_json = rhs.m_json;
+    m_rawJson = rhs.m_rawJson;
     m_httpStatus = rhs.m_httpStatus;
     m_error = rhs.m_error;
+    m_errors = rhs.m_errors;
 
     return *this;
 }
@@ -122,7 +151,8 @@ bool HueReply::timedOut() const
 /*!
  * \fn bool HueReply::containsError() const
  *
- * Returns \c true if reply contains an error.
+ * Returns \c true if reply contains an error. A request that changes several
+ * values only contains an error if none of them were applied; see \l getErrors().
  *
  * \sa timedOut(), containsError()
  *
@@ -145,6 +175,21 @@ QJsonObject HueReply::getJson() const
     return m_json;
 }
 
+/*!
+ * \fn QByteArray HueReply::getRawJson() const
+ *
+ * Returns the unparsed JSON object from the reply as a \e QByteArray. It is only
+ * set if the request was sent with \l HueRequest::setRawReply(), in which case
+ * \l getJson() returns an empty object.
+ *
+ * \sa getJson()
+ *
+ */
+QByteArray HueReply::getRawJson() const
+{
+    return m_rawJson;
+}
+
 /*!
  * \fn int HueReply::getHttpStatus() const
  *
@@ -171,6 +216,51 @@ HueError HueReply::getError() const
     return m_error;
 }
 
+/*!
+ * \fn QList<HueError> HueReply::getErrors() const
+ *
+ * Returns all errors in the reply. A request that changes several values gets one
+ * result per value, so the reply can be valid and still hold errors for some of
+ * them; those are only returned here.
+ *
+ * \sa getError()
+ *
+ */
+QList<HueError> HueReply::getErrors() const
+{
+    return m_errors;
+}
+
+/*!
+ * \fn int HueReply::rejectedAttributes(const HueStateChange& change) const
+ *
+ * Returns the attributes of \a change (a combination of \l HueStateChange::Attribute
+ * values) that the bridge did not apply, given that this is the reply to \a change.
+ *
+ * Each attribute is decided by the error for its own address. Errors that do not
+ * name an attribute, e.g. for an unknown resource, reject all of them. If the reply
+ * is not valid, i.e. no result is a success, or timed out, all attributes are rejected.
+ *
+ */
+int HueReply::rejectedAttributes(const HueStateChange& change) const
+{
+    if (m_timedOut || !m_replyValid)
+        return change.attributes();
+
+    int rejected = 0;
+    for (const HueError& error : m_errors) {
+        const QString address = error.getAddress();
+
+        if (address.endsWith("/transitiontime"))
+            continue;
+
+        const int attribute = attributeOfAddress(address);
+        rejected |= attribute != HueStateChange::NoAttribute ? attribute : change.attributes();
+    }
+
+    return rejected & change.attributes();
+}
+
 /*!
  * \fn void HueReply::isValid(const bool replyValid)
  *
@@ -210,6 +300,19 @@ void HueReply::setJson(const QJsonObject json)
     m_json = json;
 }
 
+/*!
+ * \fn void HueReply::setRawJson(const QByteArray rawJson)
+ *
+ * Sets the unparsed JSON of the reply as specified by \a rawJson.
+ *
+ * \note should not be called explicitly.
+ *
+ */
+void HueReply::setRawJson(const QByteArray rawJson)
+{
+    m_rawJson = rawJson;
+}
+
 /*!
  * \fn void HueReply::setHttpStatus(const int httpStatus)
  *
@@ -236,6 +339,70 @@ void HueReply::setError(const HueError error)
     m_error = error;
 }
 
+/*!
+ * \fn void HueReply::setErrors(const QList<HueError> errors)
+ *
+ * Sets all errors of the reply as specified by \a errors.
+ *
+ * \note should not be called explicitly.
+ *
+ */
+void HueReply::setErrors(const QList<HueError> errors)
+{
+    m_errors = errors;
+}
+
+/*!
+ * \fn void HueReply::setResults(const QJsonArray& results)
+ *
+ * Sets the reply from the \e success and \e error \a results returned by the bridge.
+ * A request that changes several values gets one result per value. All errors are
+ * kept by \l getErrors(). The reply is only valid if at least one of the results is
+ * a success, so an empty array is not valid either.
+ *
+ * \note should not be called explicitly.
+ *
+ */
+void HueReply::setResults(const QJsonArray& results)
+{
+    QList<HueError> errors;
+    QJsonObject firstError;
+    QJsonObject firstSuccess;
+    bool hasSuccess = false;
+
+    for (auto iter = results.begin(); iter != results.end(); ++iter) {
+        const QJsonObject result = iter->toObject();
+
+        if (result.contains("error")) {
+            const QJsonObject jsonError = result["error"].toObject();
+            if (errors.isEmpty())
+                firstError = jsonError;
+
+            errors.append(HueError(jsonError["type"].toInt(),
+                                   jsonError["address"].toString(),
+                                   jsonError["description"].toString()));
+        }
+        else if (result.contains("success") && !hasSuccess) {
+            firstSuccess = result["success"].toObject();
+            hasSuccess = true;
+        }
+    }
+
+    m_errors = errors;
+
+    // The bridge confirmed nothing unless at least one result is a success
+    if (!hasSuccess) {
+        m_error = errors.isEmpty() ? HueError() : errors.first();
+        m_replyValid = false;
+        m_json = firstError;
+    }
+    else {
+        m_error = HueError();
+        m_replyValid = true;
+        m_json = firstSuccess;
+    }
+}
+
 /*!
  * \fn HueReply::operator QString() const
  *
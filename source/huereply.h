@@ -2,10 +2,15 @@
 #define HUEREPLY_H
 
 #include <QJsonObject>
+#include <QJsonArray>
+#include <QByteArray>
 #include <QVariant>
+#include <QList>
 
 #include "hueerror.h"
 
+class HueStateChange;
+
 class HueReply
 {
 public:
@@ -19,14 +24,20 @@ public:
     bool timedOut() const;
     bool containsError() const;
     QJsonObject getJson() const;
+    QByteArray getRawJson() const;
     int getHttpStatus() const;
     HueError getError() const;
+    QList<HueError> getErrors() const;
+    int rejectedAttributes(const HueStateChange& change) const;
 
     void isValid(const bool replyValid);
     void timedOut(const bool timedOut);
     void setJson(const QJsonObject json);
+    void setRawJson(const QByteArray rawJson);
     void setHttpStatus(const int httpStatus);
     void setError(const HueError error);
+    void setErrors(const QList<HueError> errors);
+    void setResults(const QJsonArray& results);
 
     operator QString() const;
 
@@ -34,8 +45,10 @@ private:
     bool m_replyValid;
     bool m_timedOut;
     QJsonObject m_json;
+    QByteArray m_rawJson;
     int m_httpStatus;
     HueError m_error;
+    QList<HueError> m_errors;
 };
 
 #endif // HUEREPLY_H
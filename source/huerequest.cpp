@@ -47,6 +47,7 @@ HueRequest::HueRequest(QString urlPath, QJsonObject json, Method method)
     : m_urlPath(urlPath)
     , m_json(json)
     , m_method(method)
+    , m_rawReply(false)
 {
 
 }
@@ -61,6 +62,7 @@ HueRequest::HueRequest(const HueRequest& rhs)
     : m_urlPath(rhs.m_urlPath)
     , m_json(rhs.m_json)
     , m_method(rhs.m_method)
+    , m_rawReply(rhs.m_rawReply)
 {
 
 }
@@ -79,6 +81,7 @@ HueRequest HueRequest::operator=(const HueRequest &rhs)
     m_urlPath = rhs.m_urlPath;
     m_json = rhs.m_json;
     m_method = rhs.m_method;
+    m_rawReply = rhs.m_rawReply;
 
     return *this;
 }
@@ -122,3 +125,32 @@ HueRequest::Method HueRequest::getMethod() const
 {
     return m_method;
 }
+
+/*!
+ * \fn bool HueRequest::isRawReply() const
+ *
+ * Returns \c true if the reply to the request should keep the raw JSON.
+ *
+ * \sa setRawReply()
+ *
+ */
+bool HueRequest::isRawReply() const
+{
+    return m_rawReply;
+}
+
+/*!
+ * \fn void HueRequest::setRawReply(const bool rawReply)
+ *
+ * If \a rawReply is \c true, a JSON object returned by the bridge is not parsed by
+ * \l HueBridge::sendRequest(). Instead, the bytes are kept in the reply and can be
+ * retrieved with \l HueReply::getRawJson(), e.g. to read them with \l HueJsonReader.
+ * Errors are parsed as usual. The default is \c false.
+ *
+ * \sa HueReply::getRawJson()
+ *
+ */
+void HueRequest::setRawReply(const bool rawReply)
+{
+    m_rawReply = rawReply;
+}
@@ -20,11 +20,15 @@ public:
     QString getUrlPath() const;
     QJsonObject getJson() const;
     Method getMethod() const;
+    bool isRawReply() const;
+
+    void setRawReply(const bool rawReply);
 
 private:
     QString m_urlPath;
     QJsonObject m_json;
     Method m_method;
+    bool m_rawReply;
 };
 
 #endif // HUEREQUEST_H
@@ -0,0 +1,378 @@
+#include "huescene.h"
+
+#include <QCryptographicHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QHash>
+#include <QMutex>
+#include <QDebug>
+
+#include "huebridge.h"
+#include "huerequest.h"
+#include "huereply.h"
+
+/*!
+ * \class HueScene
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Sets many lights to different states with a single request.
+ *
+ * Each light command takes the bridge some time, so changing 30 lights to 30
+ * different states one light at a time takes seconds. A HueScene holds a target
+ * state per light. \l store() saves it on the bridge as a scene, and \l recall()
+ * or \l HueGroup::recallScene() applies it with a single group command.
+ *
+ * Scenes are stored once per bridge: the scene ID is cached by \l contentHash(),
+ * so recalling the same light states again only sends the recall. Scenes are
+ * stored as recyclable, so the bridge can delete them when it runs out of room;
+ * a recall of a deleted scene stores it again.
+ *
+ * \code
+ *  HueScene scene("Evening");
+ *
+ *  for (auto light : *lights) {
+ *      HueStateChange state;
+ *      state.setOn(true);
+ *      state.setHue(light->ID() * 2000);
+ *      state.setSaturation(254);
+ *      scene.setLightState(light->ID(), state);
+ *  }
+ *
+ *  // One request to store the scene the first time, and one to recall it
+ *  livingRoom->recallScene(scene);
+ * \endcode
+ *
+ * Alerts are not part of scenes and are left out.
+ *
+ * \sa HueGroup::recallScene(), HueStateChange
+ *
+ */
+
+namespace {
+// Error type of the bridge for a resource, e.g. a scene, that does not exist
+const int resourceNotAvailable = 3;
+const int maxNameLength = 32;
+
+QMutex& cacheMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+// Scene IDs on each bridge by content hash
+QHash<HueBridge*, QHash<QByteArray, QString>>& sceneCache()
+{
+    static QHash<HueBridge*, QHash<QByteArray, QString>> cache;
+    return cache;
+}
+}
+
+/*!
+ * \fn HueScene::HueScene()
+ *
+ * Constructs an empty scene.
+ *
+ */
+HueScene::HueScene()
+    : m_name()
+    , m_lightStates()
+{
+
+}
+
+/*!
+ * \fn HueScene::HueScene(const QString name)
+ *
+ * Constructs an empty scene with the name specified by \a name.
+ *
+ */
+HueScene::HueScene(const QString name)
+    : m_name(name)
+    , m_lightStates()
+{
+
+}
+
+/*!
+ * \fn QString HueScene::getName() const
+ *
+ * Returns the name of the scene.
+ *
+ */
+QString HueScene::getName() const
+{
+    return m_name;
+}
+
+/*!
+ * \fn void HueScene::setName(const QString name)
+ *
+ * Sets the name of the scene as specified by \a name. The bridge keeps the first
+ * 32 characters. The name is not part of \l contentHash().
+ *
+ */
+void HueScene::setName(const QString name)
+{
+    m_name = name;
+}
+
+/*!
+ * \fn void HueScene::setLightState(const int lightID, const HueStateChange& state)
+ *
+ * Sets the target state of the light with ID \a lightID as specified by \a state,
+ * replacing any earlier state of that light.
+ *
+ */
+void HueScene::setLightState(const int lightID, const HueStateChange& state)
+{
+    m_lightStates.insert(lightID, state);
+}
+
+/*!
+ * \fn void HueScene::removeLight(const int lightID)
+ *
+ * Removes the light with ID \a lightID from the scene.
+ *
+ */
+void HueScene::removeLight(const int lightID)
+{
+    m_lightStates.remove(lightID);
+}
+
+/*!
+ * \fn void HueScene::clear()
+ *
+ * Removes all lights from the scene.
+ *
+ */
+void HueScene::clear()
+{
+    m_lightStates.clear();
+}
+
+/*!
+ * \fn HueStateChange HueScene::getLightState(const int lightID) const
+ *
+ * Returns the target state of the light with ID \a lightID, or an empty
+ * \l HueStateChange if the light is not in the scene.
+ *
+ */
+HueStateChange HueScene::getLightState(const int lightID) const
+{
+    return m_lightStates.value(lightID);
+}
+
+/*!
+ * \fn HueBitset HueScene::getLights() const
+ *
+ * Returns the IDs of the lights in the scene.
+ *
+ */
+HueBitset HueScene::getLights() const
+{
+    HueBitset lights;
+    for (auto it = m_lightStates.constBegin(); it != m_lightStates.constEnd(); ++it)
+        lights.set(it.key());
+
+    return lights;
+}
+
+/*!
+ * \fn int HueScene::lightCount() const
+ *
+ * Returns the number of lights in the scene.
+ *
+ */
+int HueScene::lightCount() const
+{
+    return m_lightStates.size();
+}
+
+/*!
+ * \fn bool HueScene::isEmpty() const
+ *
+ * Returns \c true if the scene has no lights.
+ *
+ */
+bool HueScene::isEmpty() const
+{
+    return m_lightStates.isEmpty();
+}
+
+/*!
+ * \fn QByteArray HueScene::contentHash() const
+ *
+ * Returns a SHA-1 hash of the lights and their states. Scenes with the same
+ * hash set the lights to the same states, and are stored on a bridge only once.
+ *
+ */
+QByteArray HueScene::contentHash() const
+{
+    // Keys of a QJsonObject are sorted, so equal scenes give equal bytes
+    const QByteArray content = QJsonDocument(lightStatesJson()).toJson(QJsonDocument::Compact);
+    return QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+}
+
+/*!
+ * \fn QJsonObject HueScene::toJson() const
+ *
+ * Returns the JSON used to store the scene on the bridge.
+ *
+ */
+QJsonObject HueScene::toJson() const
+{
+    QJsonArray lights;
+    for (auto it = m_lightStates.constBegin(); it != m_lightStates.constEnd(); ++it)
+        lights.append(QString::number(it.key()));
+
+    QString name = m_name;
+    if (name.isEmpty())
+        name = "HueLib " + QString::fromLatin1(contentHash().toHex().left(8));
+
+    QJsonObject json;
+    json.insert("name", name.left(maxNameLength));
+    json.insert("lights", lights);
+    json.insert("recycle", true);
+    json.insert("lightstates", lightStatesJson());
+
+    return json;
+}
+
+/*!
+ * \fn QString HueScene::store(HueBridge* bridge) const
+ *
+ * Stores the scene on \a bridge, unless a scene with the same \l contentHash()
+ * has been stored there before.
+ *
+ * Returns the ID of the scene on the bridge, or an empty string if the scene is
+ * empty or could not be stored.
+ *
+ */
+QString HueScene::store(HueBridge* bridge) const
+{
+    if (bridge == nullptr || isEmpty())
+        return QString();
+
+    const QByteArray hash = contentHash();
+
+    {
+        QMutexLocker locker(&cacheMutex());
+        const QString sceneID = sceneCache().value(bridge).value(hash);
+        if (!sceneID.isEmpty())
+            return sceneID;
+    }
+
+    HueRequest request("scenes", toJson(), HueRequest::Post);
+    HueReply reply = bridge->sendRequest(request, nullptr);
+
+    if (!reply.isValid() || reply.timedOut() || reply.containsError()) {
+        qDebug().noquote() << reply;
+        return QString();
+    }
+
+    const QString sceneID = reply.getJson()["id"].toString();
+    if (sceneID.isEmpty())
+        return QString();
+
+    QMutexLocker locker(&cacheMutex());
+    sceneCache()[bridge].insert(hash, sceneID);
+
+    return sceneID;
+}
+
+/*!
+ * \fn bool HueScene::recall(HueBridge* bridge, const int groupID) const
+ *
+ * Sets the lights of the scene to their states with a single command to the group
+ * with ID \a groupID on \a bridge, storing the scene first if needed. Group 0
+ * contains all lights. Only lights that are in both the scene and the group change.
+ *
+ * The local state of \l HueLight objects is not updated; use
+ * \l HueGroup::recallScene() for that.
+ *
+ * Returns \c true if the scene was recalled.
+ *
+ */
+bool HueScene::recall(HueBridge* bridge, const int groupID) const
+{
+    return sendRecall(bridge, groupID, nullptr);
+}
+
+/*!
+ * \fn void HueScene::forget(HueBridge* bridge, const QString sceneID)
+ *
+ * Removes the scene with ID \a sceneID on \a bridge from the cache, e.g. after it
+ * has been deleted from the bridge. Scenes with its content are stored again
+ * when they are recalled next.
+ *
+ */
+void HueScene::forget(HueBridge* bridge, const QString sceneID)
+{
+    QMutexLocker locker(&cacheMutex());
+
+    auto bridgeIt = sceneCache().find(bridge);
+    if (bridgeIt == sceneCache().end())
+        return;
+
+    for (auto it = bridgeIt->begin(); it != bridgeIt->end(); ) {
+        if (it.value() == sceneID)
+            it = bridgeIt->erase(it);
+        else
+            ++it;
+    }
+}
+
+/*!
+ * \fn void HueScene::clearCache(HueBridge* bridge)
+ *
+ * Forgets the scenes stored on \a bridge, or on all bridges if \a bridge is
+ * \c nullptr.
+ *
+ */
+void HueScene::clearCache(HueBridge* bridge)
+{
+    QMutexLocker locker(&cacheMutex());
+
+    if (bridge == nullptr)
+        sceneCache().clear();
+    else
+        sceneCache().remove(bridge);
+}
+
+QJsonObject HueScene::lightStatesJson() const
+{
+    QJsonObject json;
+    for (auto it = m_lightStates.constBegin(); it != m_lightStates.constEnd(); ++it) {
+        QJsonObject state = it.value().toJson();
+        state.remove("alert");
+        json.insert(QString::number(it.key()), state);
+    }
+
+    return json;
+}
+
+bool HueScene::sendRecall(HueBridge* bridge, const int groupID, HueAbstractObject* sender) const
+{
+    // A cached scene may have been recycled by the bridge; it is stored again once
+    for (int attempt = 0; attempt < 2; attempt++) {
+        const QString sceneID = store(bridge);
+        if (sceneID.isEmpty())
+            return false;
+
+        QString urlPath = "groups/" + QString::number(groupID) + "/action";
+        HueRequest request(urlPath, QJsonObject{{"scene", sceneID}}, HueRequest::Put);
+        HueReply reply = bridge->sendRequest(request, sender);
+
+        if (reply.isValid() && !reply.timedOut() && !reply.containsError())
+            return true;
+
+        qDebug().noquote() << reply;
+
+        if (reply.getError().getType() != resourceNotAvailable)
+            return false;
+
+        forget(bridge, sceneID);
+    }
+
+    return false;
+}
@@ -0,0 +1,52 @@
+#ifndef HUESCENE_H
+#define HUESCENE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMap>
+
+#include "huebitset.h"
+#include "huestatechange.h"
+
+class HueBridge;
+
+class HueScene
+{
+    friend class HueGroup;
+
+public:
+    HueScene();
+    explicit HueScene(const QString name);
+
+    QString getName() const;
+    void setName(const QString name);
+
+    void setLightState(const int lightID, const HueStateChange& state);
+    void removeLight(const int lightID);
+    void clear();
+
+    HueStateChange getLightState(const int lightID) const;
+    HueBitset getLights() const;
+    int lightCount() const;
+    bool isEmpty() const;
+
+    QByteArray contentHash() const;
+    QJsonObject toJson() const;
+
+    QString store(HueBridge* bridge) const;
+    bool recall(HueBridge* bridge, const int groupID = 0) const;
+
+    static void forget(HueBridge* bridge, const QString sceneID);
+    static void clearCache(HueBridge* bridge = nullptr);
+
+private:
+    QJsonObject lightStatesJson() const;
+    bool sendRecall(HueBridge* bridge, const int groupID, HueAbstractObject* sender) const;
+
+private:
+    QString m_name;
+    QMap<int, HueStateChange> m_lightStates;
+};
+
+#endif // HUESCENE_H
@@ -0,0 +1,458 @@
+#include "huesnapshot.h"
+
+#include <QHash>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "huelight.h"
+#include "huegroup.h"
+#include "huescene.h"
+#include "huemembershipindex.h"
+#include "huechangenotifier.h"
+
+/*!
+ * \class HueSnapshot
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Captures the state of lights and restores it later with few requests.
+ *
+ * A HueSnapshot records the on/off state, brightness and color of each light, e.g.
+ * before an alert, so that the previous look can be restored afterwards. Only the
+ * 16-byte \l Light::State of each light is kept.
+ *
+ * \l restore() compares the snapshot with the current local state of the lights and
+ * only sends the attributes that differ. Lights that need the same change are set
+ * through a group command when a group in the \l HueGroupList passed to
+ * \l restore() consists of only such lights. When at least \l getSceneThreshold()
+ * lights are left, they are restored together with a single \l HueScene recall;
+ * the rest are set one light at a time.
+ *
+ * \code
+ *  HueSnapshot snapshot(*lights);
+ *
+ *  for (auto light : *lights)
+ *      light->setAlert(HueAbstractObject::Breathe15Sec);
+ *
+ *  // Later
+ *  snapshot.restore(*lights, *groups);
+ * \endcode
+ *
+ * The comparison uses the local state, so lights that may have been changed by
+ * other apps should be synchronized before calling \l restore().
+ *
+ * Lights and groups of several bridges can be captured and restored together; they
+ * are matched by bridge and ID, and each bridge gets its own commands.
+ *
+ * \sa HueScene, HueMembershipIndex
+ *
+ */
+
+namespace {
+const int defaultSceneThreshold = 4;
+const double xyTolerance = 0.0001;
+}
+
+/*!
+ * \fn HueSnapshot::HueSnapshot()
+ *
+ * Constructs an empty snapshot.
+ *
+ */
+HueSnapshot::HueSnapshot()
+    : m_entries()
+    , m_sceneThreshold(defaultSceneThreshold)
+{
+
+}
+
+/*!
+ * \fn HueSnapshot::HueSnapshot(const HueLightList& lights)
+ *
+ * Constructs a snapshot of \a lights.
+ *
+ */
+HueSnapshot::HueSnapshot(const HueLightList& lights)
+    : HueSnapshot()
+{
+    capture(lights);
+}
+
+/*!
+ * \fn HueSnapshot::HueSnapshot(const HueGroupList& groups, const HueLightList& lights)
+ *
+ * Constructs a snapshot of the lights in \a lights that are members of \a groups.
+ *
+ */
+HueSnapshot::HueSnapshot(const HueGroupList& groups, const HueLightList& lights)
+    : HueSnapshot()
+{
+    capture(groups, lights);
+}
+
+/*!
+ * \fn void HueSnapshot::capture(const HueLightList& lights)
+ *
+ * Replaces the snapshot with the current local state of \a lights.
+ *
+ */
+void HueSnapshot::capture(const HueLightList& lights)
+{
+    m_entries.clear();
+    m_entries.reserve(static_cast<size_t>(lights.size()));
+
+    for (int i = 0; i < lights.size(); i++)
+        addEntry(lights.at(i).get());
+
+    sortEntries();
+}
+
+/*!
+ * \fn void HueSnapshot::capture(const HueGroupList& groups, const HueLightList& lights)
+ *
+ * Replaces the snapshot with the current local state of the lights in \a lights
+ * that are members of a group in \a groups on the same bridge.
+ *
+ */
+void HueSnapshot::capture(const HueGroupList& groups, const HueLightList& lights)
+{
+    QHash<HueBridge*, HueBitset> members;
+    for (int i = 0; i < groups.size(); i++)
+        members[groups.at(i)->getBridge()] |= groups.at(i)->lights().getMembers();
+
+    m_entries.clear();
+
+    for (int i = 0; i < lights.size(); i++) {
+        HueLight* light = lights.at(i).get();
+        if (members.value(light->getBridge()).test(light->ID()))
+            addEntry(light);
+    }
+
+    sortEntries();
+}
+
+/*!
+ * \fn void HueSnapshot::clear()
+ *
+ * Removes all lights from the snapshot.
+ *
+ */
+void HueSnapshot::clear()
+{
+    m_entries.clear();
+}
+
+/*!
+ * \fn int HueSnapshot::lightCount() const
+ *
+ * Returns the number of lights in the snapshot.
+ *
+ */
+int HueSnapshot::lightCount() const
+{
+    return static_cast<int>(m_entries.size());
+}
+
+/*!
+ * \fn bool HueSnapshot::isEmpty() const
+ *
+ * Returns \c true if the snapshot has no lights.
+ *
+ */
+bool HueSnapshot::isEmpty() const
+{
+    return m_entries.empty();
+}
+
+/*!
+ * \fn bool HueSnapshot::contains(const HueLight* light) const
+ *
+ * Returns \c true if \a light is in the snapshot.
+ *
+ */
+bool HueSnapshot::contains(const HueLight* light) const
+{
+    return findEntry(light) != nullptr;
+}
+
+/*!
+ * \fn HueStateChange HueSnapshot::targetState(const HueLight* light) const
+ *
+ * Returns the state \l restore() sets \a light to: \e on, and if the light was on,
+ * its brightness and the color of its color mode. An empty \l HueStateChange is
+ * returned if the light is not in the snapshot.
+ *
+ */
+HueStateChange HueSnapshot::targetState(const HueLight* light) const
+{
+    const Entry* entry = findEntry(light);
+    return entry != nullptr ? stateOf(entry->state) : HueStateChange();
+}
+
+/*!
+ * \fn HueStateChange HueSnapshot::difference(const HueLight* light) const
+ *
+ * Returns the attributes of \l targetState() that differ from the current local
+ * state of \a light. An empty \l HueStateChange is returned if the light is not
+ * in the snapshot or already has its captured state.
+ *
+ */
+HueStateChange HueSnapshot::difference(const HueLight* light) const
+{
+    const Entry* entry = findEntry(light);
+    if (entry == nullptr)
+        return HueStateChange();
+
+    const HueStateChange target = stateOf(entry->state);
+    const Light::State current = light->state();
+    HueStateChange change;
+
+    if (target.isOn() != current.isOn())
+        change.setOn(target.isOn());
+
+    if (!target.isOn())
+        return change;
+
+    if (target.has(HueStateChange::BrightnessAttribute) && target.getBrightness() != current.getBrightness())
+        change.setBrightness(target.getBrightness());
+
+    // A different color mode means the color has to be set again in full
+    const bool sameMode = entry->state.colorMode() == current.colorMode();
+
+    if (target.has(HueStateChange::HueAttribute)) {
+        if (!sameMode || target.getHue() != current.getHue())
+            change.setHue(target.getHue());
+        if (!sameMode || target.getSaturation() != current.getSaturation())
+            change.setSaturation(target.getSaturation());
+    }
+
+    if (target.has(HueStateChange::ColorTempAttribute)
+            && (!sameMode || target.getColorTemp() != current.getColorTemp()))
+        change.setColorTemp(target.getColorTemp());
+
+    if (target.has(HueStateChange::XYAttribute)
+            && (!sameMode
+                || std::abs(target.getXValue() - current.getXValue()) > xyTolerance
+                || std::abs(target.getYValue() - current.getYValue()) > xyTolerance))
+        change.setXY(target.getXValue(), target.getYValue());
+
+    return change;
+}
+
+/*!
+ * \fn int HueSnapshot::getSceneThreshold() const
+ *
+ * Returns the least number of lights that \l restore() sets with a scene instead
+ * of one request per light. Default is 4.
+ *
+ */
+int HueSnapshot::getSceneThreshold() const
+{
+    return m_sceneThreshold;
+}
+
+/*!
+ * \fn void HueSnapshot::setSceneThreshold(const int lights)
+ *
+ * Sets the least number of lights that \l restore() sets with a scene as specified
+ * by \a lights. A value of 0 disables scenes.
+ *
+ */
+void HueSnapshot::setSceneThreshold(const int lights)
+{
+    m_sceneThreshold = std::max(0, lights);
+}
+
+/*!
+ * \fn int HueSnapshot::restore(const HueLightList& lights, const HueGroupList& groups, const int transitionTime) const
+ *
+ * Sets the lights in \a lights that are in the snapshot back to their captured
+ * state, sending only the attributes that differ from their local state.
+ * Unreachable lights are skipped.
+ *
+ * Lights that need the same change are set with one command per group in
+ * \a groups that consists of two or more such lights. If at least
+ * \l getSceneThreshold() lights on a bridge are left, they are set with one
+ * \l HueScene recall, which stores the scene on the bridge the first time.
+ * Remaining lights are set one at a time. If \a transitionTime is not negative,
+ * the lights fade to their states over that time in deciseconds.
+ *
+ * Returns the number of commands sent.
+ *
+ */
+int HueSnapshot::restore(const HueLightList& lights, const HueGroupList& groups, const int transitionTime) const
+{
+    // IDs are only unique on one bridge
+    QHash<HueBridge*, std::vector<HueLight*>> lightsOfBridge;
+    for (int i = 0; i < lights.size(); i++)
+        lightsOfBridge[lights.at(i)->getBridge()].push_back(lights.at(i).get());
+
+    QHash<HueBridge*, std::vector<HueGroup*>> groupsOfBridge;
+    for (int i = 0; i < groups.size(); i++)
+        groupsOfBridge[groups.at(i)->getBridge()].push_back(groups.at(i).get());
+
+    int commands = 0;
+    HueChangeNotifier::instance().beginBatch();
+
+    for (auto it = lightsOfBridge.constBegin(); it != lightsOfBridge.constEnd(); ++it)
+        commands += restoreBridge(it.value(), groupsOfBridge.value(it.key()), transitionTime);
+
+    HueChangeNotifier::instance().endBatch();
+
+    return commands;
+}
+
+void HueSnapshot::addEntry(HueLight* light)
+{
+    m_entries.push_back({light->getBridge(), light->ID(), light->state()});
+}
+
+void HueSnapshot::sortEntries()
+{
+    std::sort(m_entries.begin(), m_entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.bridge != rhs.bridge ? std::less<HueBridge*>()(lhs.bridge, rhs.bridge) : lhs.ID < rhs.ID;
+    });
+}
+
+const HueSnapshot::Entry* HueSnapshot::findEntry(const HueLight* light) const
+{
+    HueBridge* const bridge = light->getBridge();
+    const int lightID = light->ID();
+
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), lightID, [bridge](const Entry& entry, const int ID) {
+        return entry.bridge != bridge ? std::less<HueBridge*>()(entry.bridge, bridge) : entry.ID < ID;
+    });
+
+    return it != m_entries.end() && it->bridge == bridge && it->ID == lightID ? &*it : nullptr;
+}
+
+int HueSnapshot::restoreBridge(const std::vector<HueLight*>& lights, const std::vector<HueGroup*>& groups,
+                               const int transitionTime) const
+{
+    // Lights grouped by the change they need, in order of first appearance
+    std::vector<HueStateChange> changes;
+    std::vector<HueBitset> lightsOfChange;
+    QHash<int, HueLight*> lightOfID;
+
+    for (HueLight* light : lights) {
+        if (!light->isReachable())
+            continue;
+
+        HueStateChange change = difference(light);
+        if (change.isEmpty())
+            continue;
+
+        if (transitionTime >= 0)
+            change.setTransitionTime(transitionTime);
+
+        lightOfID.insert(light->ID(), light);
+
+        auto it = std::find(changes.begin(), changes.end(), change);
+        if (it == changes.end()) {
+            changes.push_back(change);
+            lightsOfChange.push_back(HueBitset{light->ID()});
+        }
+        else {
+            lightsOfChange[static_cast<size_t>(it - changes.begin())].set(light->ID());
+        }
+    }
+
+    if (changes.empty())
+        return 0;
+
+    int commands = 0;
+
+    // Group commands for groups that consist of lights needing the same change
+    HueMembershipIndex index;
+    QHash<int, HueGroup*> groupOfID;
+    for (HueGroup* group : groups) {
+        index.updateGroup(group);
+        groupOfID.insert(group->ID(), group);
+    }
+
+    HueBitset remaining;
+
+    for (size_t i = 0; i < changes.size(); i++) {
+        HueBitset uncovered;
+        for (const int groupID : index.cover(lightsOfChange[i], &uncovered)) {
+            const HueBitset members = index.lightsOf(groupID);
+
+            // A single light is faster to set directly
+            if (members.count() < 2 || !groupOfID.value(groupID)->setState(changes[i])) {
+                uncovered |= members;
+                continue;
+            }
+
+            commands++;
+        }
+
+        remaining |= uncovered;
+    }
+
+    std::vector<HueLight*> remainingLights;
+    for (const int lightID : remaining.toVector())
+        remainingLights.push_back(lightOfID.value(lightID));
+
+    if (remainingLights.empty())
+        return commands;
+
+    // One scene for the lights left, with their full captured state
+    if (m_sceneThreshold > 0 && static_cast<int>(remainingLights.size()) >= m_sceneThreshold) {
+        HueScene scene;
+        for (HueLight* light : remainingLights) {
+            HueStateChange state = targetState(light);
+            if (transitionTime >= 0)
+                state.setTransitionTime(transitionTime);
+            scene.setLightState(light->ID(), state);
+        }
+
+        if (scene.recall(remainingLights.front()->getBridge(), 0)) {
+            for (HueLight* light : remainingLights) {
+                const HueStateChange change = light->constrainState(scene.getLightState(light->ID()));
+                light->applyStateChange(change);
+            }
+
+            return commands + 1;
+        }
+    }
+
+    for (HueLight* light : remainingLights) {
+        for (size_t i = 0; i < changes.size(); i++) {
+            if (lightsOfChange[i].test(light->ID())) {
+                light->setState(changes[i]);
+                commands++;
+                break;
+            }
+        }
+    }
+
+    return commands;
+}
+
+HueStateChange HueSnapshot::stateOf(const Light::State& state)
+{
+    HueStateChange change;
+    change.setOn(state.isOn());
+
+    if (!state.isOn())
+        return change;
+
+    change.setBrightness(state.getBrightness());
+
+    switch (state.colorMode()) {
+    case Light::State::HueSatColorMode:
+        change.setHue(state.getHue());
+        change.setSaturation(state.getSaturation());
+        break;
+    case Light::State::XYColorMode:
+        change.setXY(state.getXValue(), state.getYValue());
+        break;
+    case Light::State::ColorTempColorMode:
+        change.setColorTemp(state.getColorTemp());
+        break;
+    case Light::State::UnknownColorMode:
+        break;
+    }
+
+    return change;
+}
@@ -0,0 +1,53 @@
+#ifndef HUESNAPSHOT_H
+#define HUESNAPSHOT_H
+
+#include <vector>
+
+#include "huetypes.h"
+#include "hueobjectlist.h"
+#include "huestatechange.h"
+
+class HueSnapshot
+{
+public:
+    HueSnapshot();
+    explicit HueSnapshot(const HueLightList& lights);
+    HueSnapshot(const HueGroupList& groups, const HueLightList& lights);
+
+    void capture(const HueLightList& lights);
+    void capture(const HueGroupList& groups, const HueLightList& lights);
+    void clear();
+
+    int lightCount() const;
+    bool isEmpty() const;
+    bool contains(const HueLight* light) const;
+    HueStateChange targetState(const HueLight* light) const;
+    HueStateChange difference(const HueLight* light) const;
+
+    int getSceneThreshold() const;
+    void setSceneThreshold(const int lights);
+
+    int restore(const HueLightList& lights,
+                const HueGroupList& groups = HueGroupList(),
+                const int transitionTime = -1) const;
+
+private:
+    struct Entry {
+        HueBridge* bridge;
+        int ID;
+        Light::State state;
+    };
+
+    void addEntry(HueLight* light);
+    void sortEntries();
+    const Entry* findEntry(const HueLight* light) const;
+    int restoreBridge(const std::vector<HueLight*>& lights, const std::vector<HueGroup*>& groups,
+                      const int transitionTime) const;
+    static HueStateChange stateOf(const Light::State& state);
+
+private:
+    std::vector<Entry> m_entries;
+    int m_sceneThreshold;
+};
+
+#endif // HUESNAPSHOT_H
@@ -0,0 +1,460 @@
+#include "huestatechange.h"
+
+#include <QJsonArray>
+
+/*!
+ * \class HueStateChange
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Describes a change of several attributes of a \l HueLight or \l HueGroup.
+ *
+ * HueStateChange collects any combination of \e on, brightness, hue, saturation,
+ * color temperature, \e xy, alert and effect, together with an optional
+ * \e transitiontime. Passing it to \l HueAbstractObject::setState() sends all
+ * attributes to the bridge in a single request, instead of one request per
+ * attribute.
+ *
+ * \code
+ *  HueStateChange change;
+ *  change.setOn(true);
+ *  change.setBrightness(200);
+ *  change.setXY(0.675, 0.322);
+ *  change.setTransitionTime(10);   // 1 second
+ *
+ *  lights.fetchRaw(1)->setState(change);
+ * \endcode
+ *
+ * \sa HueAbstractObject::setState()
+ */
+
+/*!
+ * \enum HueStateChange::Attribute
+ * This enum identifies the attributes that can be part of a HueStateChange.
+ *
+ * \value NoAttribute
+ *      No attribute.
+ * \value OnAttribute
+ *      Light on/off.
+ * \value BrightnessAttribute
+ *      Brightness (\e bri).
+ * \value HueAttribute
+ *      Hue.
+ * \value SaturationAttribute
+ *      Saturation (\e sat).
+ * \value ColorTempAttribute
+ *      Color temperature (\e ct).
+ * \value XYAttribute
+ *      CIE color coordinates (\e xy).
+ * \value AlertAttribute
+ *      Alert.
+ * \value EffectAttribute
+ *      Effect.
+ */
+
+/*!
+ * \fn HueStateChange::HueStateChange()
+ *
+ * Constructs an empty HueStateChange without any attributes.
+ *
+ */
+HueStateChange::HueStateChange()
+    : m_attributes(NoAttribute)
+    , m_on(false)
+    , m_brightness(0)
+    , m_hue(0)
+    , m_saturation(0)
+    , m_colorTemp(0)
+    , m_xValue(0)
+    , m_yValue(0)
+    , m_alert(HueAbstractObject::NoAlert)
+    , m_effect(HueAbstractObject::NoEffect)
+    , m_transitionTime(-1)
+{
+
+}
+
+/*!
+ * \fn int HueStateChange::attributes() const
+ *
+ * Returns the attributes that are set, as a combination of \l Attribute values.
+ *
+ */
+int HueStateChange::attributes() const
+{
+    return m_attributes;
+}
+
+/*!
+ * \fn bool HueStateChange::has(const Attribute attribute) const
+ *
+ * Returns \c true if \a attribute is set.
+ *
+ */
+bool HueStateChange::has(const Attribute attribute) const
+{
+    return (m_attributes & attribute) != 0;
+}
+
+/*!
+ * \fn bool HueStateChange::isEmpty() const
+ *
+ * Returns \c true if no attributes are set. The transition time is not an
+ * attribute on its own.
+ *
+ */
+bool HueStateChange::isEmpty() const
+{
+    return m_attributes == NoAttribute;
+}
+
+/*!
+ * \fn bool HueStateChange::isOn() const
+ *
+ * Returns the \e on value.
+ *
+ */
+bool HueStateChange::isOn() const
+{
+    return m_on;
+}
+
+/*!
+ * \fn int HueStateChange::getBrightness() const
+ *
+ * Returns the brightness.
+ *
+ */
+int HueStateChange::getBrightness() const
+{
+    return m_brightness;
+}
+
+/*!
+ * \fn int HueStateChange::getHue() const
+ *
+ * Returns the hue.
+ *
+ */
+int HueStateChange::getHue() const
+{
+    return m_hue;
+}
+
+/*!
+ * \fn int HueStateChange::getSaturation() const
+ *
+ * Returns the saturation.
+ *
+ */
+int HueStateChange::getSaturation() const
+{
+    return m_saturation;
+}
+
+/*!
+ * \fn int HueStateChange::getColorTemp() const
+ *
+ * Returns the color temperature.
+ *
+ */
+int HueStateChange::getColorTemp() const
+{
+    return m_colorTemp;
+}
+
+/*!
+ * \fn double HueStateChange::getXValue() const
+ *
+ * Returns the X coordinate in CIE color space.
+ *
+ */
+double HueStateChange::getXValue() const
+{
+    return m_xValue;
+}
+
+/*!
+ * \fn double HueStateChange::getYValue() const
+ *
+ * Returns the Y coordinate in CIE color space.
+ *
+ */
+double HueStateChange::getYValue() const
+{
+    return m_yValue;
+}
+
+/*!
+ * \fn HueAbstractObject::HueAlert HueStateChange::getAlert() const
+ *
+ * Returns the alert.
+ *
+ */
+HueAbstractObject::HueAlert HueStateChange::getAlert() const
+{
+    return m_alert;
+}
+
+/*!
+ * \fn HueAbstractObject::HueEffect HueStateChange::getEffect() const
+ *
+ * Returns the effect.
+ *
+ */
+HueAbstractObject::HueEffect HueStateChange::getEffect() const
+{
+    return m_effect;
+}
+
+/*!
+ * \fn int HueStateChange::getTransitionTime() const
+ *
+ * Returns the transition time in multiples of 100 ms, or -1 if not set.
+ *
+ */
+int HueStateChange::getTransitionTime() const
+{
+    return m_transitionTime;
+}
+
+/*!
+ * \fn bool HueStateChange::hasTransitionTime() const
+ *
+ * Returns \c true if a transition time is set.
+ *
+ */
+bool HueStateChange::hasTransitionTime() const
+{
+    return m_transitionTime >= 0;
+}
+
+/*!
+ * \fn void HueStateChange::setOn(const bool on)
+ *
+ * Sets \e on as specified by \a on.
+ *
+ */
+void HueStateChange::setOn(const bool on)
+{
+    m_on = on;
+    m_attributes |= OnAttribute;
+}
+
+/*!
+ * \fn void HueStateChange::setBrightness(const int brightness)
+ *
+ * Sets the brightness as specified by \a brightness (1 - 254).
+ *
+ */
+void HueStateChange::setBrightness(const int brightness)
+{
+    m_brightness = brightness;
+    m_attributes |= BrightnessAttribute;
+}
+
+/*!
+ * \fn void HueStateChange::setHue(const int hue)
+ *
+ * Sets the hue as specified by \a hue (0 - 65535).
+ *
+ */
+void HueStateChange::setHue(const int hue)
+{
+    m_hue = hue;
+    m_attributes |= HueAttribute;
+}
+
+/*!
+ * \fn void HueStateChange::setSaturation(const int saturation)
+ *
+ * Sets the saturation as specified by \a saturation (0 - 254).
+ *
+ */
+void HueStateChange::setSaturation(const int saturation)
+{
+    m_saturation = saturation;
+    m_attributes |= SaturationAttribute;
+}
+
+/*!
+ * \fn void HueStateChange::setColorTemp(const int colorTemp)
+ *
+ * Sets the color temperature as specified by \a colorTemp (150 - 500).
+ *
+ */
+void HueStateChange::setColorTemp(const int colorTemp)
+{
+    m_colorTemp = colorTemp;
+    m_attributes |= ColorTempAttribute;
+}
+
+/*!
+ * \fn void HueStateChange::setXY(const double x, const double y)
+ *
+ * Sets the CIE color coordinates as specified by \a x and \a y (0.0 - 1.0).
+ *
+ */
+void HueStateChange::setXY(const double x, const double y)
+{
+    m_xValue = x;
+    m_yValue = y;
+    m_attributes |= XYAttribute;
+}
+
+/*!
+ * \fn void HueStateChange::setAlert(const HueAbstractObject::HueAlert alert)
+ *
+ * Sets the alert as specified by \a alert.
+ *
+ */
+void HueStateChange::setAlert(const HueAbstractObject::HueAlert alert)
+{
+    m_alert = alert;
+    m_attributes |= AlertAttribute;
+}
+
+/*!
+ * \fn void HueStateChange::setEffect(const HueAbstractObject::HueEffect effect)
+ *
+ * Sets the effect as specified by \a effect.
+ *
+ */
+void HueStateChange::setEffect(const HueAbstractObject::HueEffect effect)
+{
+    m_effect = effect;
+    m_attributes |= EffectAttribute;
+}
+
+/*!
+ * \fn void HueStateChange::setTransitionTime(const int deciseconds)
+ *
+ * Sets the time the bridge uses to transition to the new state, in multiples
+ * of 100 ms, as specified by \a deciseconds. Values above 65535 are clamped.
+ * A negative value clears the transition time, and the bridge default (400 ms) is used.
+ *
+ */
+void HueStateChange::setTransitionTime(const int deciseconds)
+{
+    m_transitionTime = deciseconds > 65535 ? 65535 : deciseconds;
+
+    if (m_transitionTime < 0)
+        m_transitionTime = -1;
+}
+
+/*!
+ * \fn void HueStateChange::clear(const Attribute attribute)
+ *
+ * Removes \a attribute from the change.
+ *
+ */
+void HueStateChange::clear(const Attribute attribute)
+{
+    m_attributes &= ~attribute;
+}
+
+/*!
+ * \fn void HueStateChange::clearTransitionTime()
+ *
+ * Removes the transition time from the change.
+ *
+ */
+void HueStateChange::clearTransitionTime()
+{
+    m_transitionTime = -1;
+}
+
+/*!
+ * \fn QJsonObject HueStateChange::toJson() const
+ *
+ * Returns the change as a JSON object suitable for the body of a \e PUT
+ * request to a light \e state or group \e action.
+ *
+ */
+QJsonObject HueStateChange::toJson() const
+{
+    QJsonObject json;
+
+    if (has(OnAttribute))
+        json.insert("on", m_on);
+
+    if (has(BrightnessAttribute))
+        json.insert("bri", m_brightness);
+
+    if (has(HueAttribute))
+        json.insert("hue", m_hue);
+
+    if (has(SaturationAttribute))
+        json.insert("sat", m_saturation);
+
+    if (has(ColorTempAttribute))
+        json.insert("ct", m_colorTemp);
+
+    if (has(XYAttribute))
+        json.insert("xy", QJsonArray{m_xValue, m_yValue});
+
+    if (has(AlertAttribute)) {
+        switch (m_alert) {
+        case HueAbstractObject::NoAlert:
+            json.insert("alert", "none");
+            break;
+        case HueAbstractObject::BreatheSingle:
+            json.insert("alert", "select");
+            break;
+        case HueAbstractObject::Breathe15Sec:
+            json.insert("alert", "lselect");
+            break;
+        }
+    }
+
+    if (has(EffectAttribute)) {
+        switch (m_effect) {
+        case HueAbstractObject::NoEffect:
+            json.insert("effect", "none");
+            break;
+        case HueAbstractObject::ColorLoop:
+            json.insert("effect", "colorloop");
+            break;
+        }
+    }
+
+    if (hasTransitionTime())
+        json.insert("transitiontime", m_transitionTime);
+
+    return json;
+}
+
+/*!
+ * \fn bool HueStateChange::operator==(const HueStateChange& rhs) const
+ *
+ * Returns \c true if \a rhs has the same attributes with the same values, and the
+ * same transition time. Values of attributes that are not set are ignored.
+ *
+ */
+bool HueStateChange::operator==(const HueStateChange& rhs) const
+{
+    if (m_attributes != rhs.m_attributes || m_transitionTime != rhs.m_transitionTime)
+        return false;
+
+    return (!has(OnAttribute) || m_on == rhs.m_on)
+            && (!has(BrightnessAttribute) || m_brightness == rhs.m_brightness)
+            && (!has(HueAttribute) || m_hue == rhs.m_hue)
+            && (!has(SaturationAttribute) || m_saturation == rhs.m_saturation)
+            && (!has(ColorTempAttribute) || m_colorTemp == rhs.m_colorTemp)
+            && (!has(XYAttribute) || (qFuzzyCompare(m_xValue + 1.0, rhs.m_xValue + 1.0)
+                                      && qFuzzyCompare(m_yValue + 1.0, rhs.m_yValue + 1.0)))
+            && (!has(AlertAttribute) || m_alert == rhs.m_alert)
+            && (!has(EffectAttribute) || m_effect == rhs.m_effect);
+}
+
+/*!
+ * \fn bool HueStateChange::operator!=(const HueStateChange& rhs) const
+ *
+ * Returns \c true if \a rhs differs from this change.
+ *
+ * \sa operator==()
+ *
+ */
+bool HueStateChange::operator!=(const HueStateChange& rhs) const
+{
+    return !(*this == rhs);
+}
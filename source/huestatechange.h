@@ -0,0 +1,73 @@
+#ifndef HUESTATECHANGE_H
+#define HUESTATECHANGE_H
+
+#include <QJsonObject>
+
+#include "hueabstractobject.h"
+
+class HueStateChange
+{
+public:
+    enum Attribute {
+        NoAttribute         = 0x000,
+        OnAttribute         = 0x001,
+        BrightnessAttribute = 0x002,
+        HueAttribute        = 0x004,
+        SaturationAttribute = 0x008,
+        ColorTempAttribute  = 0x010,
+        XYAttribute         = 0x020,
+        AlertAttribute      = 0x040,
+        EffectAttribute     = 0x080
+    };
+
+    HueStateChange();
+
+    int attributes() const;
+    bool has(const Attribute attribute) const;
+    bool isEmpty() const;
+
+    bool isOn() const;
+    int getBrightness() const;
+    int getHue() const;
+    int getSaturation() const;
+    int getColorTemp() const;
+    double getXValue() const;
+    double getYValue() const;
+    HueAbstractObject::HueAlert getAlert() const;
+    HueAbstractObject::HueEffect getEffect() const;
+    int getTransitionTime() const;
+    bool hasTransitionTime() const;
+
+    void setOn(const bool on);
+    void setBrightness(const int brightness);
+    void setHue(const int hue);
+    void setSaturation(const int saturation);
+    void setColorTemp(const int colorTemp);
+    void setXY(const double x, const double y);
+    void setAlert(const HueAbstractObject::HueAlert alert);
+    void setEffect(const HueAbstractObject::HueEffect effect);
+    void setTransitionTime(const int deciseconds);
+
+    void clear(const Attribute attribute);
+    void clearTransitionTime();
+
+    QJsonObject toJson() const;
+
+    bool operator==(const HueStateChange& rhs) const;
+    bool operator!=(const HueStateChange& rhs) const;
+
+private:
+    int m_attributes;
+    bool m_on;
+    int m_brightness;
+    int m_hue;
+    int m_saturation;
+    int m_colorTemp;
+    double m_xValue;
+    double m_yValue;
+    HueAbstractObject::HueAlert m_alert;
+    HueAbstractObject::HueEffect m_effect;
+    int m_transitionTime;
+};
+
+#endif // HUESTATECHANGE_H
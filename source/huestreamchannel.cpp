@@ -0,0 +1,484 @@
+#include "huestreamchannel.h"
+
+#include "huestreamtransport.h"
+
+#include <algorithm>
+
+/*!
+ * \class HueStreamChannel
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Streams per-light colors of an entertainment group as compact datagrams.
+ *
+ * Commands sent through \l HueBridge are limited to roughly ten light updates per
+ * second, which is too slow for lighting synchronized to music or video. HueStreamChannel
+ * instead sends the color of every light in the channel as one binary frame, 25 - 50
+ * times per second, through a \l HueStreamTransport.
+ *
+ * Frames use the HueStream v1 layout: a 16 byte header with the protocol name, version,
+ * a sequence number and the color space, followed by 9 bytes per light (type, 16 bit ID
+ * and three 16 bit color values, big endian). A frame with more than 10 lights is split
+ * into several datagrams sharing the same sequence number.
+ *
+ * Frames are paced by a precise timer. Every tick sends the latest colors, whether they
+ * changed or not, since the bridge leaves streaming mode when it stops receiving frames.
+ * Ticks that are missed because the event loop was busy are counted by
+ * \l framesDropped(); they are not caught up.
+ *
+ * \code
+ *  HueUdpStreamTransport* transport = new HueUdpStreamTransport(bridgeAddress, 2100, this);
+ *  HueStreamChannel* channel = new HueStreamChannel(transport, HueStreamChannel::RGB, this);
+ *
+ *  channel->addLight(1);
+ *  channel->addLight(2);
+ *  channel->setFrameRate(50);
+ *  channel->start();
+ *
+ *  // From an audio or video callback
+ *  channel->setLightRGB(1, 1.0, 0.2, 0.0);
+ * \endcode
+ *
+ * \note The entertainment group must be set to streaming through the regular API
+ * (\e stream \e active on the group) before the bridge accepts frames.
+ *
+ * \sa HueStreamTransport, HueStreamReceiver
+ */
+
+/*!
+ * \enum HueStreamChannel::ColorSpace
+ * This enum defines how the three color values of each light are interpreted.
+ *
+ * \value RGB
+ *      Red, green and blue.
+ *
+ * \value XYBrightness
+ *      CIE x and y coordinates and brightness.
+ */
+
+namespace {
+
+const char protocolName[] = "HueStream";
+const int protocolNameSize = 9;
+const int headerSize = 16;
+const int lightSize = 9;
+const quint8 versionMajor = 0x01;
+const quint8 versionMinor = 0x00;
+const quint8 deviceTypeLight = 0x00;
+
+quint16 toWord(const double value)
+{
+    if (value <= 0.0)
+        return 0;
+    if (value >= 1.0)
+        return 0xffff;
+
+    return static_cast<quint16>(value * 0xffff + 0.5);
+}
+
+void appendWord(QByteArray& datagram, const quint16 word)
+{
+    datagram.append(static_cast<char>(word >> 8));
+    datagram.append(static_cast<char>(word & 0xff));
+}
+
+quint16 readWord(const QByteArray& datagram, const int position)
+{
+    return static_cast<quint16>((static_cast<quint8>(datagram.at(position)) << 8)
+                                | static_cast<quint8>(datagram.at(position + 1)));
+}
+
+}
+
+/*!
+ * \fn HueStreamChannel::HueStreamChannel(HueStreamTransport* transport, const ColorSpace colorSpace, QObject* parent)
+ *
+ * Constructs a HueStreamChannel without lights that sends frames in \a colorSpace
+ * through \a transport. A \e QObject parent can be set by \a parent.
+ *
+ */
+HueStreamChannel::HueStreamChannel(HueStreamTransport* transport, const ColorSpace colorSpace,
+                                   QObject* parent)
+    : QObject(parent)
+    , m_transport(transport)
+    , m_colorSpace(colorSpace)
+    , m_lights()
+    , m_timer(new QTimer(this))
+    , m_clock()
+    , m_lastFrameTime(-1)
+    , m_sequence(0)
+    , m_framesSent(0)
+    , m_framesDropped(0)
+    , m_datagramsSent(0)
+{
+    m_timer->setSingleShot(false);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(1000 / m_defaultFrameRate);
+
+    connect(m_timer, &QTimer::timeout,
+            this, &HueStreamChannel::tick);
+}
+
+/*!
+ * \fn HueStreamTransport* HueStreamChannel::getTransport() const
+ *
+ * Returns the transport used by the channel.
+ *
+ */
+HueStreamTransport* HueStreamChannel::getTransport() const
+{
+    return m_transport;
+}
+
+/*!
+ * \fn HueStreamChannel::ColorSpace HueStreamChannel::getColorSpace() const
+ *
+ * Returns the color space of the frames.
+ *
+ */
+HueStreamChannel::ColorSpace HueStreamChannel::getColorSpace() const
+{
+    return m_colorSpace;
+}
+
+/*!
+ * \fn bool HueStreamChannel::addLight(const int lightID)
+ *
+ * Adds the light with ID \a lightID to the channel. The light starts out black.
+ *
+ * Returns false if the light is already part of the channel.
+ *
+ */
+bool HueStreamChannel::addLight(const int lightID)
+{
+    if (findLight(lightID) != nullptr)
+        return false;
+
+    m_lights.push_back(LightColor{lightID, {0, 0, 0}});
+    return true;
+}
+
+/*!
+ * \fn bool HueStreamChannel::removeLight(const int lightID)
+ *
+ * Removes the light with ID \a lightID from the channel.
+ *
+ * Returns false if the light is not part of the channel.
+ *
+ */
+bool HueStreamChannel::removeLight(const int lightID)
+{
+    for (auto it = m_lights.begin(); it != m_lights.end(); ++it) {
+        if (it->ID == lightID) {
+            m_lights.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * \fn int HueStreamChannel::lightCount() const
+ *
+ * Returns the number of lights in the channel.
+ *
+ */
+int HueStreamChannel::lightCount() const
+{
+    return static_cast<int>(m_lights.size());
+}
+
+/*!
+ * \fn bool HueStreamChannel::setLightRGB(const int lightID, const double red, const double green, const double blue)
+ *
+ * Sets the color of the light with ID \a lightID to \a red, \a green and \a blue (0.0 - 1.0).
+ * The color is sent with the next frame.
+ *
+ * Returns false if the light is not part of the channel or the channel does not use \l RGB.
+ *
+ */
+bool HueStreamChannel::setLightRGB(const int lightID, const double red, const double green,
+                                   const double blue)
+{
+    LightColor* light = findLight(lightID);
+
+    if (light == nullptr || m_colorSpace != RGB)
+        return false;
+
+    light->values[0] = toWord(red);
+    light->values[1] = toWord(green);
+    light->values[2] = toWord(blue);
+    return true;
+}
+
+/*!
+ * \fn bool HueStreamChannel::setLightXY(const int lightID, const double x, const double y, const double brightness)
+ *
+ * Sets the color of the light with ID \a lightID to the CIE coordinates \a x and \a y
+ * and \a brightness (0.0 - 1.0). The color is sent with the next frame.
+ *
+ * Returns false if the light is not part of the channel or the channel does not use \l XYBrightness.
+ *
+ */
+bool HueStreamChannel::setLightXY(const int lightID, const double x, const double y,
+                                  const double brightness)
+{
+    LightColor* light = findLight(lightID);
+
+    if (light == nullptr || m_colorSpace != XYBrightness)
+        return false;
+
+    light->values[0] = toWord(x);
+    light->values[1] = toWord(y);
+    light->values[2] = toWord(brightness);
+    return true;
+}
+
+/*!
+ * \fn int HueStreamChannel::getFrameRate() const
+ *
+ * Returns the number of frames sent per second.
+ *
+ */
+int HueStreamChannel::getFrameRate() const
+{
+    return 1000 / m_timer->interval();
+}
+
+/*!
+ * \fn void HueStreamChannel::setFrameRate(const int framesPerSecond)
+ *
+ * Sets the number of frames sent per second to \a framesPerSecond, limited to 25 - 50.
+ *
+ */
+void HueStreamChannel::setFrameRate(const int framesPerSecond)
+{
+    int frameRate = framesPerSecond;
+
+    if (frameRate < m_minFrameRate)
+        frameRate = m_minFrameRate;
+    else if (frameRate > m_maxFrameRate)
+        frameRate = m_maxFrameRate;
+
+    m_timer->setInterval(1000 / frameRate);
+}
+
+/*!
+ * \fn bool HueStreamChannel::start()
+ *
+ * Opens the transport and starts streaming. Returns false if the transport could not be opened.
+ *
+ */
+bool HueStreamChannel::start()
+{
+    if (m_transport == nullptr)
+        return false;
+
+    if (!m_transport->isOpen() && !m_transport->open())
+        return false;
+
+    m_lastFrameTime = -1;
+    m_clock.start();
+    m_timer->start();
+    return true;
+}
+
+/*!
+ * \fn void HueStreamChannel::stop()
+ *
+ * Stops streaming. The transport is left open.
+ *
+ */
+void HueStreamChannel::stop()
+{
+    m_timer->stop();
+}
+
+/*!
+ * \fn bool HueStreamChannel::isActive() const
+ *
+ * Returns true if the channel is streaming.
+ *
+ */
+bool HueStreamChannel::isActive() const
+{
+    return m_timer->isActive();
+}
+
+/*!
+ * \fn quint8 HueStreamChannel::sequenceNumber() const
+ *
+ * Returns the sequence number of the next frame. It wraps around after 255.
+ *
+ */
+quint8 HueStreamChannel::sequenceNumber() const
+{
+    return m_sequence;
+}
+
+/*!
+ * \fn int HueStreamChannel::framesSent() const
+ *
+ * Returns the number of frames sent.
+ *
+ */
+int HueStreamChannel::framesSent() const
+{
+    return m_framesSent;
+}
+
+/*!
+ * \fn int HueStreamChannel::framesDropped() const
+ *
+ * Returns the number of frames that were not sent, either because a tick was
+ * missed or because the transport failed to send. Ticks without lights or a
+ * transport send nothing and are not counted.
+ *
+ */
+int HueStreamChannel::framesDropped() const
+{
+    return m_framesDropped;
+}
+
+/*!
+ * \fn int HueStreamChannel::datagramsSent() const
+ *
+ * Returns the number of datagrams sent. A frame with more than 10 lights is sent
+ * as several datagrams.
+ *
+ */
+int HueStreamChannel::datagramsSent() const
+{
+    return m_datagramsSent;
+}
+
+/*!
+ * \fn QByteArray HueStreamChannel::encodeDatagram(const quint8 sequence, const ColorSpace colorSpace, const std::vector<LightColor>& lights)
+ *
+ * Returns a datagram with sequence number \a sequence containing \a lights in \a colorSpace.
+ *
+ */
+QByteArray HueStreamChannel::encodeDatagram(const quint8 sequence, const ColorSpace colorSpace,
+                                            const std::vector<LightColor>& lights)
+{
+    QByteArray datagram;
+    datagram.reserve(headerSize + lightSize * static_cast<int>(lights.size()));
+
+    datagram.append(protocolName, protocolNameSize);
+    datagram.append(static_cast<char>(versionMajor));
+    datagram.append(static_cast<char>(versionMinor));
+    datagram.append(static_cast<char>(sequence));
+    datagram.append('\0');
+    datagram.append('\0');
+    datagram.append(static_cast<char>(colorSpace == RGB ? 0x00 : 0x01));
+    datagram.append('\0');
+
+    for (const LightColor& light : lights) {
+        datagram.append(static_cast<char>(deviceTypeLight));
+        appendWord(datagram, static_cast<quint16>(light.ID));
+        appendWord(datagram, light.values[0]);
+        appendWord(datagram, light.values[1]);
+        appendWord(datagram, light.values[2]);
+    }
+
+    return datagram;
+}
+
+/*!
+ * \fn bool HueStreamChannel::decodeDatagram(const QByteArray& datagram, quint8& sequence, ColorSpace& colorSpace, std::vector<LightColor>& lights)
+ *
+ * Decodes \a datagram into \a sequence, \a colorSpace and \a lights.
+ *
+ * Returns false if \a datagram is not a valid HueStream v1 datagram.
+ *
+ */
+bool HueStreamChannel::decodeDatagram(const QByteArray& datagram, quint8& sequence,
+                                      ColorSpace& colorSpace, std::vector<LightColor>& lights)
+{
+    if (datagram.size() < headerSize || (datagram.size() - headerSize) % lightSize != 0)
+        return false;
+
+    if (datagram.left(protocolNameSize) != QByteArray(protocolName, protocolNameSize))
+        return false;
+
+    if (static_cast<quint8>(datagram.at(9)) != versionMajor)
+        return false;
+
+    const quint8 colorSpaceByte = static_cast<quint8>(datagram.at(14));
+    if (colorSpaceByte > 0x01)
+        return false;
+
+    sequence = static_cast<quint8>(datagram.at(11));
+    colorSpace = colorSpaceByte == 0x00 ? RGB : XYBrightness;
+
+    lights.clear();
+    lights.reserve(static_cast<size_t>((datagram.size() - headerSize) / lightSize));
+
+    for (int position = headerSize; position < datagram.size(); position += lightSize) {
+        if (static_cast<quint8>(datagram.at(position)) != deviceTypeLight)
+            return false;
+
+        lights.push_back(LightColor{readWord(datagram, position + 1),
+                                    {readWord(datagram, position + 3),
+                                     readWord(datagram, position + 5),
+                                     readWord(datagram, position + 7)}});
+    }
+
+    return true;
+}
+
+void HueStreamChannel::tick()
+{
+    const qint64 now = m_clock.elapsed();
+    const qint64 interval = m_timer->interval();
+
+    // Ticks the event loop could not deliver in time are lost, not caught up
+    if (m_lastFrameTime >= 0) {
+        const qint64 missedTicks = (now - m_lastFrameTime - interval / 2) / interval;
+        if (missedTicks > 0)
+            m_framesDropped += static_cast<int>(missedTicks);
+    }
+
+    m_lastFrameTime = now;
+
+    // Nothing to send is not a dropped frame
+    if (m_transport == nullptr || m_lights.empty())
+        return;
+
+    if (sendFrame())
+        m_framesSent++;
+    else
+        m_framesDropped++;
+}
+
+bool HueStreamChannel::sendFrame()
+{
+    if (m_transport == nullptr || m_lights.empty())
+        return false;
+
+    const quint8 sequence = m_sequence++;
+    bool frameWasSent = true;
+
+    for (size_t first = 0; first < m_lights.size(); first += m_maxLightsPerDatagram) {
+        const size_t last = std::min(first + m_maxLightsPerDatagram, m_lights.size());
+        const std::vector<LightColor> lights(m_lights.begin() + static_cast<long>(first),
+                                             m_lights.begin() + static_cast<long>(last));
+
+        if (m_transport->sendDatagram(encodeDatagram(sequence, m_colorSpace, lights)))
+            m_datagramsSent++;
+        else
+            frameWasSent = false;
+    }
+
+    return frameWasSent;
+}
+
+HueStreamChannel::LightColor* HueStreamChannel::findLight(const int lightID)
+{
+    for (LightColor& light : m_lights) {
+        if (light.ID == lightID)
+            return &light;
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,81 @@
+#ifndef HUESTREAMCHANNEL_H
+#define HUESTREAMCHANNEL_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <vector>
+
+class HueStreamTransport;
+
+class HueStreamChannel : public QObject
+{
+    Q_OBJECT
+public:
+    enum ColorSpace {
+        RGB,
+        XYBrightness
+    };
+
+    struct LightColor {
+        int ID;
+        quint16 values[3];
+    };
+
+    explicit HueStreamChannel(HueStreamTransport* transport, const ColorSpace colorSpace = RGB,
+                              QObject* parent = nullptr);
+
+    HueStreamTransport* getTransport() const;
+    ColorSpace getColorSpace() const;
+
+    bool addLight(const int lightID);
+    bool removeLight(const int lightID);
+    int lightCount() const;
+
+    bool setLightRGB(const int lightID, const double red, const double green, const double blue);
+    bool setLightXY(const int lightID, const double x, const double y, const double brightness);
+
+    int getFrameRate() const;
+    void setFrameRate(const int framesPerSecond);
+
+    bool start();
+    void stop();
+    bool isActive() const;
+
+    quint8 sequenceNumber() const;
+    int framesSent() const;
+    int framesDropped() const;
+    int datagramsSent() const;
+
+    static QByteArray encodeDatagram(const quint8 sequence, const ColorSpace colorSpace,
+                                     const std::vector<LightColor>& lights);
+    static bool decodeDatagram(const QByteArray& datagram, quint8& sequence,
+                               ColorSpace& colorSpace, std::vector<LightColor>& lights);
+
+private slots:
+    void tick();
+
+private:
+    bool sendFrame();
+    LightColor* findLight(const int lightID);
+
+private:
+    const int m_defaultFrameRate = 25;
+    const int m_minFrameRate = 25;
+    const int m_maxFrameRate = 50;
+    const int m_maxLightsPerDatagram = 10;
+
+    HueStreamTransport* m_transport;
+    ColorSpace m_colorSpace;
+    std::vector<LightColor> m_lights;
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastFrameTime;
+    quint8 m_sequence;
+    int m_framesSent;
+    int m_framesDropped;
+    int m_datagramsSent;
+};
+
+#endif // HUESTREAMCHANNEL_H
@@ -0,0 +1,317 @@
+#include "huestreamreceiver.h"
+
+/*!
+ * \class HueStreamReceiver
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Receives HueStream datagrams over UDP, standing in for the bridge.
+ *
+ * HueStreamReceiver listens on a local UDP port and decodes the datagrams sent by a
+ * \l HueStreamChannel through a \l HueUdpStreamTransport. It keeps the last received
+ * color of every light and counts frames and gaps in the sequence numbers, which makes
+ * it possible to develop and test streaming without a bridge.
+ *
+ * \code
+ *  HueStreamReceiver* receiver = new HueStreamReceiver(this);
+ *  receiver->listen();
+ *
+ *  HueUdpStreamTransport* transport =
+ *          new HueUdpStreamTransport(QHostAddress(QHostAddress::LocalHost), receiver->getPort(), this);
+ *  HueStreamChannel* channel = new HueStreamChannel(transport, HueStreamChannel::RGB, this);
+ * \endcode
+ *
+ * \sa HueStreamChannel, HueUdpStreamTransport
+ */
+
+/*!
+ * \fn HueStreamReceiver::HueStreamReceiver(QObject* parent)
+ *
+ * Constructs a HueStreamReceiver that is not listening. A \e QObject parent
+ * can be set by \a parent.
+ *
+ */
+HueStreamReceiver::HueStreamReceiver(QObject* parent)
+    : QObject(parent)
+    , m_socket(new QUdpSocket(this))
+    , m_listening(false)
+    , m_lights()
+    , m_colorSpace(HueStreamChannel::RGB)
+    , m_lastSequence(0)
+    , m_sequencesLost()
+    , m_lateRun(0)
+    , m_framePending(false)
+    , m_datagramsReceived(0)
+    , m_datagramsInvalid(0)
+    , m_framesReceived(0)
+    , m_framesLost(0)
+    , m_datagramsLate(0)
+{
+    connect(m_socket, &QUdpSocket::readyRead,
+            this, &HueStreamReceiver::readPendingDatagrams);
+}
+
+/*!
+ * \fn bool HueStreamReceiver::listen(const QHostAddress& address, const quint16 port)
+ *
+ * Starts listening on \a address and \a port. If \a port is 0, a free port is
+ * chosen; see \l getPort(). Returns true on success.
+ *
+ */
+bool HueStreamReceiver::listen(const QHostAddress& address, const quint16 port)
+{
+    if (m_listening)
+        close();
+
+    m_listening = m_socket->bind(address, port);
+    return m_listening;
+}
+
+/*!
+ * \fn void HueStreamReceiver::close()
+ *
+ * Stops listening.
+ *
+ */
+void HueStreamReceiver::close()
+{
+    m_socket->close();
+    m_listening = false;
+}
+
+/*!
+ * \fn bool HueStreamReceiver::isListening() const
+ *
+ * Returns true if the receiver is listening.
+ *
+ */
+bool HueStreamReceiver::isListening() const
+{
+    return m_listening;
+}
+
+/*!
+ * \fn quint16 HueStreamReceiver::getPort() const
+ *
+ * Returns the local port the receiver listens on.
+ *
+ */
+quint16 HueStreamReceiver::getPort() const
+{
+    return m_socket->localPort();
+}
+
+/*!
+ * \fn int HueStreamReceiver::datagramsReceived() const
+ *
+ * Returns the number of valid datagrams received.
+ *
+ */
+int HueStreamReceiver::datagramsReceived() const
+{
+    return m_datagramsReceived;
+}
+
+/*!
+ * \fn int HueStreamReceiver::datagramsInvalid() const
+ *
+ * Returns the number of datagrams that could not be decoded.
+ *
+ */
+int HueStreamReceiver::datagramsInvalid() const
+{
+    return m_datagramsInvalid;
+}
+
+/*!
+ * \fn int HueStreamReceiver::framesReceived() const
+ *
+ * Returns the number of frames received. Datagrams with the same sequence number
+ * count as one frame.
+ *
+ */
+int HueStreamReceiver::framesReceived() const
+{
+    return m_framesReceived;
+}
+
+/*!
+ * \fn int HueStreamReceiver::framesLost() const
+ *
+ * Returns the number of frames missing from the sequence numbers received.
+ * A frame that arrives late is no longer counted as lost.
+ *
+ */
+int HueStreamReceiver::framesLost() const
+{
+    return m_framesLost;
+}
+
+/*!
+ * \fn int HueStreamReceiver::datagramsLate() const
+ *
+ * Returns the number of datagrams that arrived after a datagram of a later frame.
+ * Their colors are older than the ones received, and are not applied.
+ *
+ * Eight late datagrams in a row are taken as a restart of the sender, or as a jump
+ * ahead by 128 frames or more. The last of them is then received as a new first
+ * frame, without counting the frames in between as lost.
+ *
+ */
+int HueStreamReceiver::datagramsLate() const
+{
+    return m_datagramsLate;
+}
+
+/*!
+ * \fn quint8 HueStreamReceiver::lastSequenceNumber() const
+ *
+ * Returns the sequence number of the last frame received.
+ *
+ */
+quint8 HueStreamReceiver::lastSequenceNumber() const
+{
+    return m_lastSequence;
+}
+
+/*!
+ * \fn HueStreamChannel::ColorSpace HueStreamReceiver::lastColorSpace() const
+ *
+ * Returns the color space of the last frame received.
+ *
+ */
+HueStreamChannel::ColorSpace HueStreamReceiver::lastColorSpace() const
+{
+    return m_colorSpace;
+}
+
+/*!
+ * \fn bool HueStreamReceiver::lightColor(const int lightID, HueStreamChannel::LightColor& color) const
+ *
+ * Sets \a color to the last color received for the light with ID \a lightID.
+ *
+ * Returns false if no color has been received for the light.
+ *
+ */
+bool HueStreamReceiver::lightColor(const int lightID, HueStreamChannel::LightColor& color) const
+{
+    auto it = m_lights.constFind(lightID);
+
+    if (it == m_lights.constEnd())
+        return false;
+
+    color = it.value();
+    return true;
+}
+
+/*!
+ * \fn void HueStreamReceiver::reset()
+ *
+ * Clears the received colors and counters.
+ *
+ */
+void HueStreamReceiver::reset()
+{
+    m_lights.clear();
+    m_colorSpace = HueStreamChannel::RGB;
+    m_lastSequence = 0;
+    m_sequencesLost.reset();
+    m_lateRun = 0;
+    m_framePending = false;
+    m_datagramsReceived = 0;
+    m_datagramsInvalid = 0;
+    m_framesReceived = 0;
+    m_framesLost = 0;
+    m_datagramsLate = 0;
+}
+
+/*!
+ * \fn void HueStreamReceiver::frameReceived(int sequenceNumber)
+ *
+ * This signal is emitted once for every frame received, with its \a sequenceNumber,
+ * after the colors of all of its datagrams that are available have been applied.
+ *
+ */
+
+void HueStreamReceiver::readPendingDatagrams()
+{
+    while (m_socket->hasPendingDatagrams()) {
+        QByteArray datagram;
+        datagram.resize(static_cast<int>(m_socket->pendingDatagramSize()));
+        m_socket->readDatagram(datagram.data(), datagram.size());
+
+        quint8 sequence = 0;
+        HueStreamChannel::ColorSpace colorSpace = HueStreamChannel::RGB;
+        std::vector<HueStreamChannel::LightColor> lights;
+
+        if (!HueStreamChannel::decodeDatagram(datagram, sequence, colorSpace, lights)) {
+            m_datagramsInvalid++;
+            continue;
+        }
+
+        m_datagramsReceived++;
+
+        if (!receiveSequence(sequence)) {
+            m_datagramsLate++;
+            continue;
+        }
+
+        m_colorSpace = colorSpace;
+
+        for (const auto& light : lights)
+            m_lights.insert(light.ID, light);
+    }
+
+    // A frame may span several datagrams, which are sent back to back
+    if (m_framePending) {
+        m_framePending = false;
+        emit frameReceived(m_lastSequence);
+    }
+}
+
+bool HueStreamReceiver::receiveSequence(const quint8 sequence)
+{
+    // Sequence numbers wrap at 256; a step of more than half of that is backwards
+    const quint8 step = static_cast<quint8>(sequence - m_lastSequence);
+    bool restarted = m_framesReceived == 0;
+
+    if (!restarted && step == 0)
+        return true;
+
+    if (!restarted && step >= 128) {
+        // Several late datagrams in a row mean that the sender restarted, or
+        // skipped ahead by half of the sequence numbers or more
+        restarted = ++m_lateRun >= m_resyncLateRun;
+
+        if (!restarted) {
+            // A frame that was counted as lost arrived after all
+            if (m_sequencesLost.test(sequence)) {
+                m_sequencesLost.reset(sequence);
+                m_framesLost = qMax(m_framesLost - 1, 0);
+                m_framesReceived++;
+            }
+
+            return false;
+        }
+    }
+
+    if (m_framePending)
+        emit frameReceived(m_lastSequence);
+
+    if (restarted) {
+        m_sequencesLost.reset();
+    }
+    else {
+        for (quint8 skipped = static_cast<quint8>(m_lastSequence + 1); skipped != sequence; skipped++)
+            m_sequencesLost.set(skipped);
+
+        m_framesLost += step - 1;
+    }
+
+    m_sequencesLost.reset(sequence);
+    m_lateRun = 0;
+    m_framesReceived++;
+    m_lastSequence = sequence;
+    m_framePending = true;
+
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef HUESTREAMRECEIVER_H
+#define HUESTREAMRECEIVER_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <QMap>
+#include <QUdpSocket>
+#include <bitset>
+
+#include "huestreamchannel.h"
+
+class HueStreamReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HueStreamReceiver(QObject* parent = nullptr);
+
+    bool listen(const QHostAddress& address = QHostAddress(QHostAddress::LocalHost),
+                const quint16 port = 0);
+    void close();
+    bool isListening() const;
+    quint16 getPort() const;
+
+    int datagramsReceived() const;
+    int datagramsInvalid() const;
+    int framesReceived() const;
+    int framesLost() const;
+    int datagramsLate() const;
+    quint8 lastSequenceNumber() const;
+    HueStreamChannel::ColorSpace lastColorSpace() const;
+
+    bool lightColor(const int lightID, HueStreamChannel::LightColor& color) const;
+    void reset();
+
+signals:
+    void frameReceived(int sequenceNumber);
+
+private slots:
+    void readPendingDatagrams();
+
+private:
+    bool receiveSequence(const quint8 sequence);
+
+private:
+    const int m_resyncLateRun = 8;
+
+    QUdpSocket* m_socket;
+    bool m_listening;
+    QMap<int, HueStreamChannel::LightColor> m_lights;
+    HueStreamChannel::ColorSpace m_colorSpace;
+    quint8 m_lastSequence;
+    std::bitset<256> m_sequencesLost;
+    int m_lateRun;
+    bool m_framePending;
+    int m_datagramsReceived;
+    int m_datagramsInvalid;
+    int m_framesReceived;
+    int m_framesLost;
+    int m_datagramsLate;
+};
+
+#endif // HUESTREAMRECEIVER_H
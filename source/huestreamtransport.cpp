@@ -0,0 +1,167 @@
+#include "huestreamtransport.h"
+
+/*!
+ * \class HueStreamTransport
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Abstract transport for the datagrams of a \l HueStreamChannel.
+ *
+ * HueStreamTransport decouples \l HueStreamChannel from the network. The channel only
+ * encodes frames and hands each datagram to \l sendDatagram(). \l HueUdpStreamTransport
+ * sends plain UDP datagrams, which is enough for a local \l HueStreamReceiver standing
+ * in for the bridge.
+ *
+ * \note A bridge only accepts streaming over DTLS (PSK, port 2100), with the client key
+ * obtained during registration. A DTLS transport can be added by implementing this class.
+ *
+ * \sa HueStreamChannel, HueUdpStreamTransport
+ */
+
+/*!
+ * \fn HueStreamTransport::HueStreamTransport(QObject* parent)
+ *
+ * Constructs a HueStreamTransport. A \e QObject parent can be set by \a parent.
+ *
+ */
+HueStreamTransport::HueStreamTransport(QObject* parent)
+    : QObject(parent)
+{
+
+}
+
+/*!
+ * \fn virtual bool HueStreamTransport::open()
+ *
+ * Pure virtual function. Must be overloaded.
+ *
+ * Should prepare the transport for sending and return true on success.
+ *
+ */
+
+/*!
+ * \fn virtual void HueStreamTransport::close()
+ *
+ * Pure virtual function. Must be overloaded.
+ *
+ * Should close the transport.
+ *
+ */
+
+/*!
+ * \fn virtual bool HueStreamTransport::isOpen() const
+ *
+ * Pure virtual function. Must be overloaded.
+ *
+ * Should return true if the transport is open.
+ *
+ */
+
+/*!
+ * \fn virtual bool HueStreamTransport::sendDatagram(const QByteArray& datagram)
+ *
+ * Pure virtual function. Must be overloaded.
+ *
+ * Should send \a datagram without blocking and return true if it was handed to the network.
+ *
+ */
+
+/*!
+ * \class HueUdpStreamTransport
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Sends the datagrams of a \l HueStreamChannel over plain UDP.
+ *
+ * \sa HueStreamTransport, HueStreamReceiver
+ */
+
+/*!
+ * \fn HueUdpStreamTransport::HueUdpStreamTransport(const QHostAddress& address, const quint16 port, QObject* parent)
+ *
+ * Constructs a HueUdpStreamTransport that sends to \a address and \a port.
+ * A \e QObject parent can be set by \a parent.
+ *
+ */
+HueUdpStreamTransport::HueUdpStreamTransport(const QHostAddress& address, const quint16 port,
+                                             QObject* parent)
+    : HueStreamTransport(parent)
+    , m_address(address)
+    , m_port(port)
+    , m_socket(new QUdpSocket(this))
+    , m_open(false)
+{
+
+}
+
+/*!
+ * \fn QHostAddress HueUdpStreamTransport::getAddress() const
+ *
+ * Returns the address datagrams are sent to.
+ *
+ */
+QHostAddress HueUdpStreamTransport::getAddress() const
+{
+    return m_address;
+}
+
+/*!
+ * \fn quint16 HueUdpStreamTransport::getPort() const
+ *
+ * Returns the port datagrams are sent to.
+ *
+ */
+quint16 HueUdpStreamTransport::getPort() const
+{
+    return m_port;
+}
+
+/*!
+ * \fn bool HueUdpStreamTransport::open()
+ *
+ * Binds the socket to an ephemeral local port. Returns true on success.
+ *
+ */
+bool HueUdpStreamTransport::open()
+{
+    if (!m_open)
+        m_open = m_socket->bind(QHostAddress(QHostAddress::AnyIPv4), 0);
+
+    return m_open;
+}
+
+/*!
+ * \fn void HueUdpStreamTransport::close()
+ *
+ * Closes the socket.
+ *
+ */
+void HueUdpStreamTransport::close()
+{
+    m_socket->close();
+    m_open = false;
+}
+
+/*!
+ * \fn bool HueUdpStreamTransport::isOpen() const
+ *
+ * Returns true if the socket is bound.
+ *
+ */
+bool HueUdpStreamTransport::isOpen() const
+{
+    return m_open;
+}
+
+/*!
+ * \fn bool HueUdpStreamTransport::sendDatagram(const QByteArray& datagram)
+ *
+ * Sends \a datagram. Returns false if the transport is not open or the datagram
+ * could not be written.
+ *
+ */
+bool HueUdpStreamTransport::sendDatagram(const QByteArray& datagram)
+{
+    if (!m_open)
+        return false;
+
+    return m_socket->writeDatagram(datagram, m_address, m_port) == datagram.size();
+}
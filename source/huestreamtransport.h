@@ -0,0 +1,44 @@
+#ifndef HUESTREAMTRANSPORT_H
+#define HUESTREAMTRANSPORT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QUdpSocket>
+
+class HueStreamTransport : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HueStreamTransport(QObject* parent = nullptr);
+    virtual ~HueStreamTransport() {}
+
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+    virtual bool sendDatagram(const QByteArray& datagram) = 0;
+};
+
+class HueUdpStreamTransport : public HueStreamTransport
+{
+    Q_OBJECT
+public:
+    explicit HueUdpStreamTransport(const QHostAddress& address, const quint16 port = 2100,
+                                   QObject* parent = nullptr);
+
+    QHostAddress getAddress() const;
+    quint16 getPort() const;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override;
+    bool sendDatagram(const QByteArray& datagram) override;
+
+private:
+    QHostAddress m_address;
+    quint16 m_port;
+    QUdpSocket* m_socket;
+    bool m_open;
+};
+
+#endif // HUESTREAMTRANSPORT_H
@@ -1,22 +1,39 @@
 #include "huesynchronizer.h"
 
 #include "hueabstractobject.h"
-#include "huelight.h"
-#include "huegroup.h"
+#include "huebridge.h"
+#include "huechangenotifier.h"
 
+#include <QRandomGenerator>
 #include <QtDebug>
+#include <algorithm>
 
-HueSynchronizer::HueSynchronizer()
-    : m_hueObjects()
+HueSynchronizer::HueSynchronizer(HueBridge* bridge, QObject* parent)
+    : QObject(parent)
+    , m_bridge(bridge)
+    , m_lights()
+    , m_groups()
     , m_timer(new QTimer(this))
+    , m_clock()
     , m_isActive(false)
+    , m_isSynchronizing(false)
+    , m_baseInterval(defaultBaseInterval())
+    , m_fastInterval(defaultFastIntervalMilliSec)
+    , m_maxInterval(defaultMaxIntervalMilliSec)
+    , m_requestBudget(defaultRequestBudget)
+    , m_jitter(defaultJitter)
 {
+    // The timer only checks which objects are due; each object has its own interval
     m_timer->setSingleShot(false);
-    m_timer->setInterval(defaultSyncIntervalMilliSec);
+    m_timer->setInterval(defaultTickIntervalMilliSec);
+
+    // Keeps the fast and maximum intervals consistent with a changed default
+    setBaseInterval(m_baseInterval);
 
     connect(m_timer, &QTimer::timeout,
             this, &HueSynchronizer::synchronize);
 
+    m_clock.start();
 }
 
 HueSynchronizer& HueSynchronizer::instance()
@@ -25,24 +42,65 @@ HueSynchronizer& HueSynchronizer::instance()
     return singleton;
 }
 
+HueSynchronizer& HueSynchronizer::forBridge(HueBridge* bridge)
+{
+    if (bridge == nullptr)
+        return instance();
+
+    QMap<HueBridge*, HueSynchronizer*>& synchronizers = bridgeSynchronizers();
+    auto it = synchronizers.find(bridge);
+
+    if (it != synchronizers.end())
+        return *it.value();
+
+    // Owned by the bridge, so the synchronizer and its objects go away with it
+    HueSynchronizer* synchronizer = new HueSynchronizer(bridge, bridge);
+    synchronizers.insert(bridge, synchronizer);
+
+    connect(bridge, &QObject::destroyed,
+            [bridge]() { bridgeSynchronizers().remove(bridge); });
+
+    return *synchronizer;
+}
+
 void HueSynchronizer::setSyncInterval(int intervalMilliSec)
 {
-    instance().m_timer->setInterval(intervalMilliSec);
+    // Synchronizers created later for other bridges start with the same interval
+    if (intervalMilliSec > 0)
+        defaultBaseInterval() = intervalMilliSec;
+
+    for (HueSynchronizer* synchronizer : allSynchronizers())
+        synchronizer->setBaseInterval(intervalMilliSec);
 }
 
 int HueSynchronizer::clearAll()
 {
-    return instance().clear(HueSynchronizer::ClearAll);
+    int objectsRemoved = 0;
+
+    for (HueSynchronizer* synchronizer : allSynchronizers())
+        objectsRemoved += synchronizer->clear(HueSynchronizer::ClearAll);
+
+    return objectsRemoved;
 }
 
 int HueSynchronizer::clearGroups()
 {
-    return instance().clear(HueSynchronizer::ClearGroups);
+    int objectsRemoved = 0;
+
+    for (HueSynchronizer* synchronizer : allSynchronizers())
+        objectsRemoved += synchronizer->clear(HueSynchronizer::ClearGroups);
+
+    return objectsRemoved;
 }
 
 int HueSynchronizer::clearLights()
 {
-    return instance().clear(HueSynchronizer::ClearLights);
+    int objectsRemoved = 0;
+
+    for (HueSynchronizer* synchronizer : allSynchronizers())
+        objectsRemoved += synchronizer->clear(HueSynchronizer::ClearLights);
+
+    return objectsRemoved;
 }
 
 void HueSynchronizer::start()
@@ -59,7 +117,7 @@ void HueSynchronizer::stop()
 
 int HueSynchronizer::listSize()
 {
-    return static_cast<int>(m_hueObjects.size());
+    return static_cast<int>(m_lights.entries.size() + m_groups.entries.size());
 }
 
 bool HueSynchronizer::isActive()
@@ -70,10 +128,14 @@ bool HueSynchronizer::isActive()
 bool HueSynchronizer::addHueObject(std::shared_ptr<HueAbstractObject> object)
 {
     bool objectWasAdded = false;
-    auto objectPosition = std::find(m_hueObjects.begin(), m_hueObjects.end(), object);
 
-    if (objectPosition == m_hueObjects.end()) {
-        m_hueObjects.push_back(object);
+    if (object != nullptr && findEntry(object) == nullptr) {
+        Partition& objects = partition(object->objectKind());
+
+        objects.index.insert(object.get(), static_cast<int>(objects.entries.size()));
+        objects.entries.push_back(SyncEntry{object, object->currentState(), object->isReachable(),
+                                            false, 0, m_baseInterval,
+                                            m_clock.elapsed() + jittered(m_baseInterval)});
         objectWasAdded = true;
     }
 
@@ -86,57 +148,315 @@ bool HueSynchronizer::addHueObject(std::shared_ptr<HueAbstractObject> object)
 bool HueSynchronizer::removeHueObject(std::shared_ptr<HueAbstractObject> object)
 {
     bool objectWasRemoved = false;
-    auto objectPosition = std::find(m_hueObjects.begin(), m_hueObjects.end(), object);
 
-    if (objectPosition != m_hueObjects.end()) {
-        m_hueObjects.erase(objectPosition);
-        objectWasRemoved = true;
+    if (object != nullptr) {
+        Partition& objects = partition(object->objectKind());
+        const int position = objects.index.value(object.get(), -1);
+
+        if (position >= 0) {
+            objects.index.remove(object.get());
+
+            // Fill the gap with the last entry instead of shifting the rest
+            const size_t last = objects.entries.size() - 1;
+            if (static_cast<size_t>(position) != last) {
+                objects.entries[static_cast<size_t>(position)] = std::move(objects.entries[last]);
+                objects.index.insert(objects.entries[static_cast<size_t>(position)].object.get(), position);
+            }
+
+            objects.entries.pop_back();
+            objectWasRemoved = true;
+        }
     }
 
-    if (m_hueObjects.empty())
+    if (listSize() == 0)
         stop();
 
     return objectWasRemoved;
 }
 
-void HueSynchronizer::synchronize()
+bool HueSynchronizer::contains(std::shared_ptr<HueAbstractObject> object) const
+{
+    return findEntry(object) != nullptr;
+}
+
+bool HueSynchronizer::setWatched(std::shared_ptr<HueAbstractObject> object, const bool watched)
+{
+    SyncEntry* objectPosition = findEntry(object);
+
+    if (objectPosition == nullptr)
+        return false;
+
+    objectPosition->watched = watched;
+
+    // A newly watched object should not wait out a long idle interval
+    if (watched && objectPosition->fixedInterval <= 0) {
+        objectPosition->interval = m_fastInterval;
+        objectPosition->nextSync = std::min(objectPosition->nextSync,
+                                            m_clock.elapsed() + jittered(m_fastInterval));
+    }
+
+    return true;
+}
+
+bool HueSynchronizer::setFixedInterval(std::shared_ptr<HueAbstractObject> object, const int intervalMilliSec)
 {
-    for (auto hueObject : m_hueObjects) {
-        hueObject->synchronize();
+    SyncEntry* objectPosition = findEntry(object);
+
+    if (objectPosition == nullptr)
+        return false;
+
+    objectPosition->fixedInterval = intervalMilliSec > 0 ? intervalMilliSec : 0;
+
+    if (objectPosition->fixedInterval > 0) {
+        objectPosition->interval = objectPosition->fixedInterval;
+        objectPosition->nextSync = std::min(objectPosition->nextSync,
+                                            m_clock.elapsed() + jittered(objectPosition->interval));
     }
+
+    return true;
 }
 
+int HueSynchronizer::objectInterval(std::shared_ptr<HueAbstractObject> object) const
+{
+    const SyncEntry* objectPosition = findEntry(object);
 
-int HueSynchronizer::clear(HueSynchronizer::ClearCondition condition)
+    if (objectPosition == nullptr)
+        return -1;
+
+    return objectPosition->interval;
+}
+
+HueBridge* HueSynchronizer::bridge() const
 {
-    int objectsRemoved = 0;
+    return m_bridge;
+}
 
-    for (auto object : m_hueObjects) {
-        bool conditionIsMatched = false;
+int HueSynchronizer::getBaseInterval() const
+{
+    return m_baseInterval;
+}
 
-        switch (condition) {
-        case ClearAll:
-            conditionIsMatched = true;
-            break;
+void HueSynchronizer::setBaseInterval(const int intervalMilliSec)
+{
+    if (intervalMilliSec > 0)
+        m_baseInterval = intervalMilliSec;
 
-        case ClearGroups:
-        {
-            HueGroup* groupPointer = dynamic_cast<HueGroup*>(object.get());
-            conditionIsMatched = groupPointer != nullptr;
-            break;
-        }
-        case ClearLights:
-        {
-            HueLight* lightPointer = dynamic_cast<HueLight*>(object.get());
-            conditionIsMatched = lightPointer != nullptr;
-            break;
+    if (m_maxInterval < m_baseInterval)
+        m_maxInterval = m_baseInterval;
+    if (m_fastInterval > m_baseInterval)
+        m_fastInterval = m_baseInterval;
+}
+
+int HueSynchronizer::getFastInterval() const
+{
+    return m_fastInterval;
+}
+
+void HueSynchronizer::setFastInterval(const int intervalMilliSec)
+{
+    if (intervalMilliSec > 0)
+        m_fastInterval = std::min(intervalMilliSec, m_baseInterval);
+}
+
+int HueSynchronizer::getMaxInterval() const
+{
+    return m_maxInterval;
+}
+
+void HueSynchronizer::setMaxInterval(const int intervalMilliSec)
+{
+    if (intervalMilliSec > 0)
+        m_maxInterval = std::max(intervalMilliSec, m_baseInterval);
+}
+
+int HueSynchronizer::getRequestBudget() const
+{
+    return m_requestBudget;
+}
+
+void HueSynchronizer::setRequestBudget(const int requestsPerTick)
+{
+    m_requestBudget = requestsPerTick > 0 ? requestsPerTick : defaultRequestBudget;
+}
+
+double HueSynchronizer::getJitter() const
+{
+    return m_jitter;
+}
+
+void HueSynchronizer::setJitter(const double fraction)
+{
+    m_jitter = qBound(0.0, fraction, 0.5);
+}
+
+void HueSynchronizer::synchronize()
+{
+    // synchronize() on the objects blocks in a local event loop, so the timer
+    // can fire again before this tick is done
+    if (m_isSynchronizing)
+        return;
+
+    m_isSynchronizing = true;
+
+    const qint64 now = m_clock.elapsed();
+
+    // Pick the most overdue objects, limited by the request budget
+    std::vector<const SyncEntry*> dueEntries;
+    for (const Partition* objects : {&m_lights, &m_groups}) {
+        for (const auto& entry : objects->entries) {
+            if (entry.nextSync <= now)
+                dueEntries.push_back(&entry);
         }
+    }
+
+    const size_t budget = static_cast<size_t>(m_requestBudget);
+    if (dueEntries.size() > budget) {
+        std::partial_sort(dueEntries.begin(), dueEntries.begin() + static_cast<long>(budget), dueEntries.end(),
+                          [](const SyncEntry* lhs, const SyncEntry* rhs) { return lhs->nextSync < rhs->nextSync; });
+        dueEntries.resize(budget);
+    }
+
+    // Entries may move while synchronizing, so only the objects are kept
+    std::vector<std::shared_ptr<HueAbstractObject>> dueObjects;
+    for (const SyncEntry* entry : dueEntries)
+        dueObjects.push_back(entry->object);
+
+    // Objects synchronized in this pass are reported as one batch
+    HueChangeNotifier::instance().beginBatch();
+
+    for (auto& hueObject : dueObjects) {
+        // Synchronizing would replace optimistic values the bridge has not confirmed yet
+        if (hueObject->hasPendingUpdates()) {
+            SyncEntry* objectPosition = findEntry(hueObject);
+            if (objectPosition != nullptr)
+                schedule(*objectPosition, true, true);
+            continue;
         }
 
-        if (conditionIsMatched)
-            if (removeHueObject(object))
-                objectsRemoved++;
+        const bool synchronized = hueObject->synchronize();
+
+        SyncEntry* objectPosition = findEntry(hueObject);
+        if (objectPosition == nullptr)
+            continue;
+
+        const HueStateChange state = hueObject->currentState();
+        const bool reachable = synchronized && hueObject->isReachable();
+        const bool changed = state != objectPosition->lastState || reachable != objectPosition->lastReachable;
+
+        objectPosition->lastState = state;
+        objectPosition->lastReachable = reachable;
+        schedule(*objectPosition, changed, reachable);
+    }
+
+    HueChangeNotifier::instance().endBatch();
+    m_isSynchronizing = false;
+}
+
+void HueSynchronizer::schedule(SyncEntry& entry, const bool changed, const bool reachable)
+{
+    if (entry.fixedInterval > 0)
+        entry.interval = entry.fixedInterval;
+    // Unreachable objects back off, even if the UI is watching them
+    else if (!reachable)
+        entry.interval = std::min(std::max(entry.interval, m_baseInterval) * 2, m_maxInterval);
+    else if (entry.watched || changed)
+        entry.interval = m_fastInterval;
+    // Idle objects back off exponentially
+    else
+        entry.interval = std::min(entry.interval * 2, m_maxInterval);
+
+    entry.nextSync = m_clock.elapsed() + jittered(entry.interval);
+}
+
+qint64 HueSynchronizer::jittered(const int intervalMilliSec)
+{
+    // Spread polls over time so objects added together are not polled together
+    const double offset = (2.0 * QRandomGenerator::global()->generateDouble() - 1.0) * m_jitter;
+    return static_cast<qint64>(intervalMilliSec * (1.0 + offset));
+}
+
+HueSynchronizer::Partition& HueSynchronizer::partition(const HueAbstractObject::HueObjectKind kind)
+{
+    return kind == HueAbstractObject::LightKind ? m_lights : m_groups;
+}
+
+const HueSynchronizer::Partition& HueSynchronizer::partition(const HueAbstractObject::HueObjectKind kind) const
+{
+    return kind == HueAbstractObject::LightKind ? m_lights : m_groups;
+}
+
+HueSynchronizer::SyncEntry* HueSynchronizer::findEntry(const std::shared_ptr<HueAbstractObject>& object)
+{
+    if (object == nullptr)
+        return nullptr;
+
+    Partition& objects = partition(object->objectKind());
+    const int position = objects.index.value(object.get(), -1);
+
+    return position >= 0 ? &objects.entries[static_cast<size_t>(position)] : nullptr;
+}
+
+const HueSynchronizer::SyncEntry* HueSynchronizer::findEntry(const std::shared_ptr<HueAbstractObject>& object) const
+{
+    if (object == nullptr)
+        return nullptr;
+
+    const Partition& objects = partition(object->objectKind());
+    const int position = objects.index.value(object.get(), -1);
+
+    return position >= 0 ? &objects.entries[static_cast<size_t>(position)] : nullptr;
+}
+
+QMap<HueBridge*, HueSynchronizer*>& HueSynchronizer::bridgeSynchronizers()
+{
+    static QMap<HueBridge*, HueSynchronizer*> synchronizers;
+    return synchronizers;
+}
+
+int& HueSynchronizer::defaultBaseInterval()
+{
+    static int intervalMilliSec = 5000;
+    return intervalMilliSec;
+}
+
+std::vector<HueSynchronizer*> HueSynchronizer::allSynchronizers()
+{
+    std::vector<HueSynchronizer*> synchronizers = {&instance()};
+
+    for (HueSynchronizer* synchronizer : bridgeSynchronizers())
+        synchronizers.push_back(synchronizer);
+
+    return synchronizers;
+}
+
+int HueSynchronizer::clear(HueSynchronizer::ClearCondition condition)
+{
+    int objectsRemoved = 0;
+
+    switch (condition) {
+    case ClearAll:
+        objectsRemoved = clearPartition(m_lights) + clearPartition(m_groups);
+        break;
+    case ClearGroups:
+        objectsRemoved = clearPartition(m_groups);
+        break;
+    case ClearLights:
+        objectsRemoved = clearPartition(m_lights);
+        break;
     }
 
+    if (listSize() == 0)
+        stop();
+
+    return objectsRemoved;
+}
+
+int HueSynchronizer::clearPartition(Partition& partition)
+{
+    const int objectsRemoved = static_cast<int>(partition.entries.size());
+
+    partition.entries.clear();
+    partition.index.clear();
+
     return objectsRemoved;
 }
@@ -3,9 +3,16 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
 #include <memory>
+#include <vector>
 
-class HueAbstractObject;
+#include "hueabstractobject.h"
+#include "huestatechange.h"
+
+class HueBridge;
 
 class HueSynchronizer : public QObject
 {
@@ -19,6 +26,7 @@ private:
 
 public:
     static HueSynchronizer& instance();
+    static HueSynchronizer& forBridge(HueBridge* bridge);
     static void setSyncInterval(int intervalMilliSec);
     static int clearAll();
     static int clearGroups();
@@ -32,22 +40,80 @@ public:
 
     bool addHueObject(std::shared_ptr<HueAbstractObject> object);
     bool removeHueObject(std::shared_ptr<HueAbstractObject> object);
+    bool contains(std::shared_ptr<HueAbstractObject> object) const;
+
+    bool setWatched(std::shared_ptr<HueAbstractObject> object, const bool watched = true);
+    bool setFixedInterval(std::shared_ptr<HueAbstractObject> object, const int intervalMilliSec);
+    int objectInterval(std::shared_ptr<HueAbstractObject> object) const;
+
+    HueBridge* bridge() const;
+    int getBaseInterval() const;
+    void setBaseInterval(const int intervalMilliSec);
+    int getFastInterval() const;
+    void setFastInterval(const int intervalMilliSec);
+    int getMaxInterval() const;
+    void setMaxInterval(const int intervalMilliSec);
+    int getRequestBudget() const;
+    void setRequestBudget(const int requestsPerTick);
+    double getJitter() const;
+    void setJitter(const double fraction);
 
 private:
-    explicit HueSynchronizer();
+    struct SyncEntry {
+        std::shared_ptr<HueAbstractObject> object;
+        HueStateChange lastState;
+        bool lastReachable;
+        bool watched;
+        int fixedInterval;
+        int interval;
+        qint64 nextSync;
+    };
+
+    // Entries are kept dense for iteration; the index maps an object to its
+    // position, so add and remove (swap with the last entry) are O(1).
+    struct Partition {
+        std::vector<SyncEntry> entries;
+        QHash<HueAbstractObject*, int> index;
+    };
+
+    explicit HueSynchronizer(HueBridge* bridge = nullptr, QObject* parent = nullptr);
     HueSynchronizer(const HueSynchronizer& rhs) = delete;
     HueSynchronizer& operator=(HueSynchronizer& rhs) = delete;
     int clear(ClearCondition condition);
+    Partition& partition(const HueAbstractObject::HueObjectKind kind);
+    const Partition& partition(const HueAbstractObject::HueObjectKind kind) const;
+    SyncEntry* findEntry(const std::shared_ptr<HueAbstractObject>& object);
+    const SyncEntry* findEntry(const std::shared_ptr<HueAbstractObject>& object) const;
+    int clearPartition(Partition& partition);
+    void schedule(SyncEntry& entry, const bool changed, const bool reachable);
+    qint64 jittered(const int intervalMilliSec);
+
+    static QMap<HueBridge*, HueSynchronizer*>& bridgeSynchronizers();
+    static int& defaultBaseInterval();
+    static std::vector<HueSynchronizer*> allSynchronizers();
 
 private slots:
     void synchronize();
 
 private:
-    const int defaultSyncIntervalMilliSec = 5000;
+    const int defaultFastIntervalMilliSec = 1000;
+    const int defaultMaxIntervalMilliSec = 60000;
+    const int defaultTickIntervalMilliSec = 250;
+    const int defaultRequestBudget = 4;
+    const double defaultJitter = 0.1;
 
-    std::vector<std::shared_ptr<HueAbstractObject>> m_hueObjects;
+    HueBridge* m_bridge;
+    Partition m_lights;
+    Partition m_groups;
     QTimer* m_timer;
+    QElapsedTimer m_clock;
     bool m_isActive;
+    bool m_isSynchronizing;
+    int m_baseInterval;
+    int m_fastInterval;
+    int m_maxInterval;
+    int m_requestBudget;
+    double m_jitter;
 };
 
 #endif // HUESYNCHRONIZER_H
@@ -1,6 +1,25 @@
 #include "huetypes.h"
+#include "huejsonreader.h"
 
 #include <QJsonArray>
+#include <cstring>
+#include <type_traits>
+
+// Reads an [x, y] array; further elements are ignored
+static void readXY(HueJsonReader& reader, double& x, double& y)
+{
+    if (!reader.beginArray())
+        return;
+
+    if (reader.readNextElement())
+        x = reader.readDouble();
+
+    if (reader.readNextElement())
+        y = reader.readDouble();
+
+    while (reader.readNextElement())
+        reader.skipValue();
+}
 
 /* =====================================
  * =============== LIGHT ===============
@@ -18,12 +37,105 @@
 
 // ---------- STATE ----------
 
+// The order of the names follows the enums in Light::State; index 0 is the unknown value
+static const char* const lightEffectNames[] = {"", "none", "colorloop"};
+static const char* const lightAlertNames[] = {"", "none", "select", "lselect"};
+static const char* const lightColorModeNames[] = {"", "hs", "xy", "ct"};
+static const char* const lightModeNames[] = {"", "homeautomation", "streaming"};
+
+template<int N>
+static quint8 indexOfName(const char* const (&names)[N], const QString& name)
+{
+    for (int i = 1; i < N; i++) {
+        if (name == names[i])
+            return static_cast<quint8>(i);
+    }
+
+    return 0;
+}
+
+static quint16 quantizeCoordinate(const double value)
+{
+    return static_cast<quint16>(qRound(qBound(0.0, value, 1.0) * 65535.0));
+}
+
+static_assert(std::is_trivially_copyable<Light::State>::value,
+              "Light::State must stay trivially copyable");
+static_assert(sizeof(Light::State) == 16,
+              "Light::State must not contain padding, it is compared with memcmp");
+
 /*!
  * \class Light::State
  * \ingroup HueLib
  * \inmodule HueLib
  * \brief Describes the state of a \l HueLight.
  *
+ * State is a trivially copyable 16 byte value. Values are stored in fixed-width
+ * integers, \e effect, \e alert, \e colormode and \e mode are stored as enums, and
+ * the CIE coordinates are stored as 16-bit fixed point (a resolution of about
+ * 0.000015). Copying a State does not allocate, and two states are compared with a
+ * single \c memcmp.
+ *
+ * The \e QString accessors convert to and from the strings used by the Hue API.
+ * Strings that are not known are stored as the \e Unknown value of the enum and
+ * read back as an empty string.
+ *
+ */
+
+/*!
+ * \enum Light::State::Effect
+ * This enum describes the dynamic effect of the light.
+ *
+ * \value UnknownEffect
+ *      Not set, or not known (\e "").
+ * \value NoEffect
+ *      No effect (\e "none").
+ * \value ColorLoopEffect
+ *      Color loop (\e "colorloop").
+ *
+ */
+
+/*!
+ * \enum Light::State::Alert
+ * This enum describes the alert effect of the light.
+ *
+ * \value UnknownAlert
+ *      Not set, or not known (\e "").
+ * \value NoAlert
+ *      No alert (\e "none").
+ * \value SelectAlert
+ *      A single breathe cycle (\e "select").
+ * \value LSelectAlert
+ *      Breathe cycles for 15 seconds (\e "lselect").
+ *
+ */
+
+/*!
+ * \enum Light::State::ColorMode
+ * This enum describes which values the color of the light was last set by.
+ *
+ * \value UnknownColorMode
+ *      Not set, or not known (\e "").
+ * \value HueSatColorMode
+ *      Hue and saturation (\e "hs").
+ * \value XYColorMode
+ *      CIE coordinates (\e "xy").
+ * \value ColorTempColorMode
+ *      Color temperature (\e "ct").
+ *
+ */
+
+/*!
+ * \enum Light::State::Mode
+ * This enum describes the mode of the light.
+ *
+ * \value UnknownMode
+ *      Not set, or not known (\e "").
+ * \value HomeAutomationMode
+ *      Normal operation (\e "homeautomation").
+ * \value StreamingMode
+ *      The light is part of an entertainment stream (\e "streaming").
+ *
  */
 
 /*!
@@ -33,18 +145,18 @@
  *
  */
 Light::State::State()
-    : m_on(false)
-    , m_reachable(false)
-    , m_brightness(0)
-    , m_hue(0)
-    , m_saturation(0)
+    : m_hue(0)
     , m_colorTemp(0)
     , m_xValue(0)
     , m_yValue(0)
-    , m_effect("")
-    , m_alert("")
-    , m_colorMode("")
-    , m_mode("")
+    , m_brightness(0)
+    , m_saturation(0)
+    , m_effect(UnknownEffect)
+    , m_alert(UnknownAlert)
+    , m_colorMode(UnknownColorMode)
+    , m_mode(UnknownMode)
+    , m_on(false)
+    , m_reachable(false)
 {
 
 }
@@ -57,6 +169,7 @@ Light::State::State()
  *
  */
 Light::State::State(const QJsonValue json)
+    : State()
 {
     QJsonObject stateJson = json.toObject();
 
@@ -74,22 +187,60 @@ Light::State::State(const QJsonValue json)
             stateJson.contains("mode")      ;
 
     if (jsonIsValid) {
-        m_on            = stateJson["on"].toBool();
-        m_reachable     = stateJson["reachable"].toBool();
-        m_brightness    = stateJson["bri"].toInt();
-        m_hue           = stateJson["hue"].toInt();
-        m_saturation    = stateJson["sat"].toInt();
-        m_colorTemp     = stateJson["ct"].toInt();
-        m_xValue        = stateJson["xy"].toArray()[0].toDouble();
-        m_yValue        = stateJson["xy"].toArray()[1].toDouble();
-        m_effect        = stateJson["effect"].toString();
-        m_alert         = stateJson["alert"].toString();
-        m_colorMode     = stateJson["colormode"].toString();
-        m_mode          = stateJson["mode"].toString();
+        setOn(stateJson["on"].toBool());
+        setReachable(stateJson["reachable"].toBool());
+        setBrightness(stateJson["bri"].toInt());
+        setHue(stateJson["hue"].toInt());
+        setSaturation(stateJson["sat"].toInt());
+        setColorTemp(stateJson["ct"].toInt());
+        setXValue(stateJson["xy"].toArray()[0].toDouble());
+        setYValue(stateJson["xy"].toArray()[1].toDouble());
+        setEffect(stateJson["effect"].toString());
+        setAlert(stateJson["alert"].toString());
+        setColorMode(stateJson["colormode"].toString());
+        setMode(stateJson["mode"].toString());
     }
-    else {
-        Light::State();
+}
+
+/*!
+ * \fn Light::State::State(HueJsonReader& reader)
+ *
+ * Constructs a State object by reading the next JSON value
+ * from \a reader.
+ *
+ */
+Light::State::State(HueJsonReader& reader)
+    : State()
+{
+    int keys = 0;
+    double x = 0;
+    double y = 0;
+
+    if (!reader.beginObject())
+        return;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("on"))             { setOn(reader.readBool());                 keys |= 1 << 0; }
+        else if (reader.keyEquals("reachable")) { setReachable(reader.readBool());          keys |= 1 << 1; }
+        else if (reader.keyEquals("bri"))       { setBrightness(reader.readInt());          keys |= 1 << 2; }
+        else if (reader.keyEquals("hue"))       { setHue(reader.readInt());                 keys |= 1 << 3; }
+        else if (reader.keyEquals("sat"))       { setSaturation(reader.readInt());          keys |= 1 << 4; }
+        else if (reader.keyEquals("ct"))        { setColorTemp(reader.readInt());           keys |= 1 << 5; }
+        else if (reader.keyEquals("xy"))        { readXY(reader, x, y);                     keys |= 1 << 6; }
+        else if (reader.keyEquals("effect"))    { setEffect(reader.readString());           keys |= 1 << 7; }
+        else if (reader.keyEquals("alert"))     { setAlert(reader.readString());            keys |= 1 << 8; }
+        else if (reader.keyEquals("colormode")) { setColorMode(reader.readString());        keys |= 1 << 9; }
+        else if (reader.keyEquals("mode"))      { setMode(reader.readString());             keys |= 1 << 10; }
+        else
+            reader.skipValue();
     }
+
+    setXValue(x);
+    setYValue(y);
+
+    // Same as the JSON constructor: all keys must be present
+    if (keys != (1 << 11) - 1)
+        *this = Light::State();
 }
 
 /*!
@@ -167,7 +318,7 @@ int Light::State::getColorTemp() const
  */
 double Light::State::getXValue() const
 {
-    return m_xValue;
+    return m_xValue / 65535.0;
 }
 
 /*!
@@ -179,7 +330,7 @@ double Light::State::getXValue() const
  */
 double Light::State::getYValue() const
 {
-    return m_yValue;
+    return m_yValue / 65535.0;
 }
 
 /*!
@@ -187,10 +338,12 @@ double Light::State::getYValue() const
  *
  * Returns effect as a \e QString.
  *
+ * \sa effect()
+ *
  */
 QString Light::State::getEffect() const
 {
-    return m_effect;
+    return QString(lightEffectNames[m_effect]);
 }
 
 /*!
@@ -198,10 +351,12 @@ QString Light::State::getEffect() const
  *
  * Returns alert as a \e QString.
  *
+ * \sa alert()
+ *
  */
 QString Light::State::getAlert() const
 {
-    return m_alert;
+    return QString(lightAlertNames[m_alert]);
 }
 
 /*!
@@ -209,10 +364,12 @@ QString Light::State::getAlert() const
  *
  * Returns color mode as a \e QString.
  *
+ * \sa colorMode()
+ *
  */
 QString Light::State::getColorMode() const
 {
-    return m_colorMode;
+    return QString(lightColorModeNames[m_colorMode]);
 }
 
 /*!
@@ -220,8 +377,54 @@ QString Light::State::getColorMode() const
  *
  * Returns mode as a \e QString.
  *
+ * \sa mode()
+ *
  */
 QString Light::State::getMode() const
+{
+    return QString(lightModeNames[m_mode]);
+}
+
+/*!
+ * \fn Light::State::Effect Light::State::effect() const
+ *
+ * Returns effect as an \l Effect.
+ *
+ */
+Light::State::Effect Light::State::effect() const
+{
+    return m_effect;
+}
+
+/*!
+ * \fn Light::State::Alert Light::State::alert() const
+ *
+ * Returns alert as an \l Alert.
+ *
+ */
+Light::State::Alert Light::State::alert() const
+{
+    return m_alert;
+}
+
+/*!
+ * \fn Light::State::ColorMode Light::State::colorMode() const
+ *
+ * Returns color mode as a \l ColorMode.
+ *
+ */
+Light::State::ColorMode Light::State::colorMode() const
+{
+    return m_colorMode;
+}
+
+/*!
+ * \fn Light::State::Mode Light::State::mode() const
+ *
+ * Returns mode as a \l Mode.
+ *
+ */
+Light::State::Mode Light::State::mode() const
 {
     return m_mode;
 }
@@ -251,69 +454,69 @@ void Light::State::setReachable(const bool reachable)
 /*!
  * \fn void Light::State::setBrightness(const int brightness)
  *
- * Sets brightness as specified by \a brightness.
+ * Sets brightness as specified by \a brightness, clamped to 0 - 255.
  *
  */
 void Light::State::setBrightness(const int brightness)
 {
-    m_brightness = brightness;
+    m_brightness = static_cast<quint8>(qBound(0, brightness, 255));
 }
 
 /*!
  * \fn void Light::State::setHue(const int hue)
  *
- * Sets hue as specified by \a hue.
+ * Sets hue as specified by \a hue, clamped to 0 - 65535.
  *
  */
 void Light::State::setHue(const int hue)
 {
-    m_hue = hue;
+    m_hue = static_cast<quint16>(qBound(0, hue, 65535));
 }
 
 /*!
  * \fn void Light::State::setSaturation(const int saturation)
  *
- * Sets saturation as specified by \a saturation.
+ * Sets saturation as specified by \a saturation, clamped to 0 - 255.
  *
  */
 void Light::State::setSaturation(const int saturation)
 {
-    m_saturation = saturation;
+    m_saturation = static_cast<quint8>(qBound(0, saturation, 255));
 }
 
 /*!
  * \fn void Light::State::setColorTemp(const int colorTemp)
  *
- * Sets color temperature as specified by \a colorTemp.
+ * Sets color temperature as specified by \a colorTemp, clamped to 0 - 65535.
  *
  */
 void Light::State::setColorTemp(const int colorTemp)
 {
-    m_colorTemp = colorTemp;
+    m_colorTemp = static_cast<quint16>(qBound(0, colorTemp, 65535));
 }
 
 /*!
  * \fn void Light::State::setXValue(const double xValue)
  *
  * Sets X coordinate in CIE color space
- * as specified by \a xValue.
+ * as specified by \a xValue, clamped to 0.0 - 1.0.
  *
  */
 void Light::State::setXValue(const double xValue)
 {
-    m_xValue = xValue;
+    m_xValue = quantizeCoordinate(xValue);
 }
 
 /*!
  * \fn void Light::State::setYValue(const double yValue)
  *
  * Sets Y coordinate in CIE color space
- * as specified by \a yValue.
+ * as specified by \a yValue, clamped to 0.0 - 1.0.
  *
  */
 void Light::State::setYValue(const double yValue)
 {
-    m_yValue = yValue;
+    m_yValue = quantizeCoordinate(yValue);
 }
 
 /*!
@@ -324,7 +527,7 @@ void Light::State::setYValue(const double yValue)
  */
 void Light::State::setEffect(const QString effect)
 {
-    m_effect = effect;
+    m_effect = static_cast<Effect>(indexOfName(lightEffectNames, effect));
 }
 
 /*!
@@ -335,7 +538,7 @@ void Light::State::setEffect(const QString effect)
  */
 void Light::State::setAlert(const QString alert)
 {
-    m_alert = alert;
+    m_alert = static_cast<Alert>(indexOfName(lightAlertNames, alert));
 }
 
 /*!
@@ -346,7 +549,7 @@ void Light::State::setAlert(const QString alert)
  */
 void Light::State::setColorMode(const QString colorMode)
 {
-    m_colorMode = colorMode;
+    m_colorMode = static_cast<ColorMode>(indexOfName(lightColorModeNames, colorMode));
 }
 
 /*!
@@ -356,10 +559,76 @@ void Light::State::setColorMode(const QString colorMode)
  *
  */
 void Light::State::setMode(const QString mode)
+{
+    m_mode = static_cast<Mode>(indexOfName(lightModeNames, mode));
+}
+
+/*!
+ * \fn void Light::State::setEffect(const Effect effect)
+ *
+ * Sets effect as specified by \a effect.
+ *
+ */
+void Light::State::setEffect(const Effect effect)
+{
+    m_effect = effect;
+}
+
+/*!
+ * \fn void Light::State::setAlert(const Alert alert)
+ *
+ * Sets alert as specified by \a alert.
+ *
+ */
+void Light::State::setAlert(const Alert alert)
+{
+    m_alert = alert;
+}
+
+/*!
+ * \fn void Light::State::setColorMode(const ColorMode colorMode)
+ *
+ * Sets color mode as specified by \a colorMode.
+ *
+ */
+void Light::State::setColorMode(const ColorMode colorMode)
+{
+    m_colorMode = colorMode;
+}
+
+/*!
+ * \fn void Light::State::setMode(const Mode mode)
+ *
+ * Sets mode as specified by \a mode.
+ *
+ */
+void Light::State::setMode(const Mode mode)
 {
     m_mode = mode;
 }
 
+/*!
+ * \fn bool Light::State::operator==(const State& rhs) const
+ *
+ * Returns \c true if \a rhs has the same values as this state.
+ *
+ */
+bool Light::State::operator==(const State& rhs) const
+{
+    return std::memcmp(this, &rhs, sizeof(State)) == 0;
+}
+
+/*!
+ * \fn bool Light::State::operator!=(const State& rhs) const
+ *
+ * Returns \c true if \a rhs differs from this state.
+ *
+ */
+bool Light::State::operator!=(const State& rhs) const
+{
+    return !(*this == rhs);
+}
+
 // ---------- TYPE ----------
 
 /*!
@@ -631,6 +900,32 @@ Light::SoftwareUpdate::SoftwareUpdate(const QJsonValue json)
     }
 }
 
+/*!
+ * \fn Light::SoftwareUpdate::SoftwareUpdate(HueJsonReader& reader)
+ *
+ * Constructs a SoftwareUpdate object by reading the next JSON value
+ * from \a reader.
+ *
+ */
+Light::SoftwareUpdate::SoftwareUpdate(HueJsonReader& reader)
+    : SoftwareUpdate()
+{
+    int keys = 0;
+
+    if (!reader.beginObject())
+        return;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("state"))              { m_state       = reader.readString();  keys |= 1 << 0; }
+        else if (reader.keyEquals("lastinstall"))   { m_lastInstall = reader.readString();  keys |= 1 << 1; }
+        else
+            reader.skipValue();
+    }
+
+    if (keys != (1 << 2) - 1)
+        *this = Light::SoftwareUpdate();
+}
+
 /*!
  * \fn QString Light::SoftwareUpdate::getState() const
  *
@@ -953,6 +1248,32 @@ Light::Config::Startup::Startup(const QJsonValue json)
     }
 }
 
+/*!
+ * \fn Light::Config::Startup::Startup(HueJsonReader& reader)
+ *
+ * Constructs a Startup object by reading the next JSON value
+ * from \a reader.
+ *
+ */
+Light::Config::Startup::Startup(HueJsonReader& reader)
+    : Startup()
+{
+    int keys = 0;
+
+    if (!reader.beginObject())
+        return;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("mode"))               { m_mode        = reader.readString();  keys |= 1 << 0; }
+        else if (reader.keyEquals("configured"))    { m_configured  = reader.readBool();    keys |= 1 << 1; }
+        else
+            reader.skipValue();
+    }
+
+    if (keys != (1 << 2) - 1)
+        *this = Light::Config::Startup();
+}
+
 /*!
  * \fn QString Light::Config::Startup::getMode() const
  *
@@ -1040,6 +1361,34 @@ Light::Config::Config(const QJsonValue json)
     }
 }
 
+/*!
+ * \fn Light::Config::Config(HueJsonReader& reader)
+ *
+ * Constructs a Config object by reading the next JSON value
+ * from \a reader.
+ *
+ */
+Light::Config::Config(HueJsonReader& reader)
+    : Config()
+{
+    int keys = 0;
+
+    if (!reader.beginObject())
+        return;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("archetype"))          { m_archetype   = reader.readString();                  keys |= 1 << 0; }
+        else if (reader.keyEquals("function"))      { m_function    = reader.readString();                  keys |= 1 << 1; }
+        else if (reader.keyEquals("direction"))     { m_direction   = reader.readString();                  keys |= 1 << 2; }
+        else if (reader.keyEquals("startup"))       { m_startup     = Light::Config::Startup(reader);       keys |= 1 << 3; }
+        else
+            reader.skipValue();
+    }
+
+    if (keys != (1 << 4) - 1)
+        *this = Light::Config();
+}
+
 /*!
  * \fn QString Light::Config::getArchetype() const
  *
@@ -1128,88 +1477,634 @@ void Light::Config::setStartup(const Startup startup)
     m_startup = startup;
 }
 
-/* =====================================
- * =============== GROUP ===============
- * =====================================
- *
- */
+// ---------- CAPABILITIES ----------
 
 /*!
- * \namespace Group
+ * \class Light::Capabilities
  * \ingroup HueLib
  * \inmodule HueLib
- * \brief Contains data classes for \l HueGroup.
+ * \brief Describes what a \l HueLight can do.
+ *
+ * Capabilities holds the color gamut, color temperature range and streaming support
+ * reported by the bridge, and the control type given by the type of the light.
+ * \l HueLight uses it to clamp or convert changes before they are sent, so that a
+ * change the light cannot show does not cost a round trip to the bridge.
+ *
+ * Which keys the bridge reports depends on the light; e.g. an on/off plug has an
+ * empty \e control object. Missing keys leave their defaults, so the parsing is more
+ * lenient than for the other types.
  *
  */
 
-// ---------- ACTION ----------
-
 /*!
- * \class Group::Action
- * \ingroup HueLib
- * \inmodule HueLib
- * \brief Describes the action of a \l HueGroup.
+ * \enum Light::Capabilities::ControlType
+ * This enum describes which attributes a light can be controlled by.
+ *
+ * \value UnknownControl
+ *      The type of the light is not known. No attributes are removed from changes.
+ * \value OnOffControl
+ *      The light can only be turned on and off.
+ * \value DimmableControl
+ *      The light can be turned on and off and dimmed.
+ * \value ColorTempControl
+ *      As \c DimmableControl, and the color temperature can be set.
+ * \value ColorControl
+ *      As \c DimmableControl, and the color can be set.
+ * \value ExtendedColorControl
+ *      Both the color and the color temperature can be set.
  *
  */
 
 /*!
- * \fn Group::Action::Action()
+ * \fn Light::Capabilities::Capabilities()
  *
- * Constructs an empty Action object.
+ * Constructs an empty Capabilities object with an unknown control type.
  *
  */
-Group::Action::Action()
-    : m_on(false)
-    , m_brightness(0)
-    , m_hue(0)
-    , m_saturation(0)
-    , m_colorTemp(0)
-    , m_xValue(0)
-    , m_yValue(0)
-    , m_effect("")
-    , m_alert("")
-    , m_colorMode("")
+Light::Capabilities::Capabilities()
+    : m_certified(false)
+    , m_controlType(UnknownControl)
+    , m_hasColorGamut(false)
+    , m_colorGamutType("")
+    , m_colorGamut(HueColor::gamutTriangle(HueColor::GamutC))
+    , m_colorTempMin(153)
+    , m_colorTempMax(500)
+    , m_maxLumen(0)
+    , m_minDimLevel(0)
+    , m_streamingRenderer(false)
+    , m_streamingProxy(false)
 {
 
 }
 
 /*!
- * \fn Group::Action::Action(const QJsonValue json)
+ * \fn Light::Capabilities::Capabilities(const QJsonValue json)
  *
- * Constructs an Action object by parsing JSON specified
+ * Constructs a Capabilities object by parsing JSON specified
  * by \a json.
  *
  */
-Group::Action::Action(const QJsonValue json)
+Light::Capabilities::Capabilities(const QJsonValue json)
+    : Capabilities()
 {
-    QJsonObject actionJson = json.toObject();
+    QJsonObject capabilitiesJson = json.toObject();
+    QJsonObject controlJson = capabilitiesJson["control"].toObject();
+    QJsonObject streamingJson = capabilitiesJson["streaming"].toObject();
 
-    bool jsonIsValid =
-            actionJson.contains("on")        &
-            actionJson.contains("bri")       &
-            actionJson.contains("hue")       &
-            actionJson.contains("sat")       &
-            actionJson.contains("ct")        &
-            actionJson.contains("xy")        &
-            actionJson.contains("effect")    &
-            actionJson.contains("alert")     &
-            actionJson.contains("colormode") ;
+    m_certified = capabilitiesJson["certified"].toBool();
 
-    if (jsonIsValid) {
-        m_on            = actionJson["on"].toBool();
-        m_brightness    = actionJson["bri"].toInt();
-        m_hue           = actionJson["hue"].toInt();
-        m_saturation    = actionJson["sat"].toInt();
-        m_colorTemp     = actionJson["ct"].toInt();
-        m_xValue        = actionJson["xy"].toArray()[0].toDouble();
-        m_yValue        = actionJson["xy"].toArray()[1].toDouble();
-        m_effect        = actionJson["effect"].toString();
-        m_alert         = actionJson["alert"].toString();
-        m_colorMode     = actionJson["colormode"].toString();
+    if (controlJson.contains("colorgamuttype"))
+        setColorGamutType(controlJson["colorgamuttype"].toString());
+
+    QJsonArray gamutJson = controlJson["colorgamut"].toArray();
+    if (gamutJson.size() == 3) {
+        float corners[6];
+        for (int i = 0; i < 3; i++) {
+            QJsonArray cornerJson = gamutJson[i].toArray();
+            corners[2 * i] = static_cast<float>(cornerJson[0].toDouble());
+            corners[2 * i + 1] = static_cast<float>(cornerJson[1].toDouble());
+        }
+        setColorGamut({corners[0], corners[1], corners[2], corners[3], corners[4], corners[5]});
     }
-    else {
-        Group::Action();
+
+    if (controlJson.contains("ct")) {
+        QJsonObject ctJson = controlJson["ct"].toObject();
+        setColorTempRange(ctJson["min"].toInt(m_colorTempMin), ctJson["max"].toInt(m_colorTempMax));
     }
+
+    m_maxLumen = controlJson["maxlumen"].toInt();
+    m_minDimLevel = controlJson["mindimlevel"].toInt();
+    m_streamingRenderer = streamingJson["renderer"].toBool();
+    m_streamingProxy = streamingJson["proxy"].toBool();
+}
+
+/*!
+ * \fn Light::Capabilities::Capabilities(HueJsonReader& reader)
+ *
+ * Constructs a Capabilities object by reading the next JSON value
+ * from \a reader.
+ *
+ */
+Light::Capabilities::Capabilities(HueJsonReader& reader)
+    : Capabilities()
+{
+    if (!reader.beginObject())
+        return;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("certified"))          m_certified = reader.readBool();
+        else if (reader.keyEquals("control"))       readControl(reader);
+        else if (reader.keyEquals("streaming"))     readStreaming(reader);
+        else
+            reader.skipValue();
+    }
+}
+
+/*!
+ * \fn Light::Capabilities::ControlType Light::Capabilities::controlTypeFromType(const QString type)
+ *
+ * Returns the control type of a light with the type specified by \a type,
+ * e.g. \e {"Extended color light"}.
+ *
+ * \sa Light::Type
+ *
+ */
+Light::Capabilities::ControlType Light::Capabilities::controlTypeFromType(const QString type)
+{
+    const QString lowerType = type.toLower();
+
+    if (lowerType == "extended color light")
+        return ExtendedColorControl;
+    if (lowerType == "color light")
+        return ColorControl;
+    if (lowerType == "color temperature light")
+        return ColorTempControl;
+    if (lowerType == "dimmable light" || lowerType == "dimmable plug-in unit")
+        return DimmableControl;
+    if (lowerType == "on/off light" || lowerType == "on/off plug-in unit")
+        return OnOffControl;
+
+    return UnknownControl;
+}
+
+/*!
+ * \fn bool Light::Capabilities::getCertified() const
+ *
+ * Returns \c true if the light is certified by Philips.
+ *
+ */
+bool Light::Capabilities::getCertified() const
+{
+    return m_certified;
+}
+
+/*!
+ * \fn Light::Capabilities::ControlType Light::Capabilities::getControlType() const
+ *
+ * Returns the control type as a \l ControlType.
+ *
+ */
+Light::Capabilities::ControlType Light::Capabilities::getControlType() const
+{
+    return m_controlType;
+}
+
+/*!
+ * \fn bool Light::Capabilities::hasColorGamut() const
+ *
+ * Returns \c true if the bridge reported the color gamut of the light.
+ *
+ */
+bool Light::Capabilities::hasColorGamut() const
+{
+    return m_hasColorGamut;
+}
+
+/*!
+ * \fn QString Light::Capabilities::getColorGamutType() const
+ *
+ * Returns the color gamut type (\e A, \e B, \e C or \e other) as a \e QString.
+ *
+ */
+QString Light::Capabilities::getColorGamutType() const
+{
+    return m_colorGamutType;
+}
+
+/*!
+ * \fn HueColor::Triangle Light::Capabilities::getColorGamut() const
+ *
+ * Returns the color gamut as a \l HueColor::Triangle. Only meaningful if
+ * \l hasColorGamut() returns \c true.
+ *
+ */
+HueColor::Triangle Light::Capabilities::getColorGamut() const
+{
+    return m_colorGamut;
+}
+
+/*!
+ * \fn int Light::Capabilities::getColorTempMin() const
+ *
+ * Returns the lowest color temperature in mired (i.e. the coldest color).
+ *
+ */
+int Light::Capabilities::getColorTempMin() const
+{
+    return m_colorTempMin;
+}
+
+/*!
+ * \fn int Light::Capabilities::getColorTempMax() const
+ *
+ * Returns the highest color temperature in mired (i.e. the warmest color).
+ *
+ */
+int Light::Capabilities::getColorTempMax() const
+{
+    return m_colorTempMax;
+}
+
+/*!
+ * \fn int Light::Capabilities::getMaxLumen() const
+ *
+ * Returns the maximum luminous flux in lumen, or 0 if unknown.
+ *
+ */
+int Light::Capabilities::getMaxLumen() const
+{
+    return m_maxLumen;
+}
+
+/*!
+ * \fn int Light::Capabilities::getMinDimLevel() const
+ *
+ * Returns the minimum dim level, or 0 if unknown.
+ *
+ */
+int Light::Capabilities::getMinDimLevel() const
+{
+    return m_minDimLevel;
+}
+
+/*!
+ * \fn bool Light::Capabilities::getStreamingRenderer() const
+ *
+ * Returns \c true if the light can render colors streamed by entertainment.
+ *
+ */
+bool Light::Capabilities::getStreamingRenderer() const
+{
+    return m_streamingRenderer;
+}
+
+/*!
+ * \fn bool Light::Capabilities::getStreamingProxy() const
+ *
+ * Returns \c true if the light can act as a streaming proxy.
+ *
+ */
+bool Light::Capabilities::getStreamingProxy() const
+{
+    return m_streamingProxy;
+}
+
+/*!
+ * \fn bool Light::Capabilities::supportsDimming() const
+ *
+ * Returns \c true if the brightness of the light can be set.
+ *
+ */
+bool Light::Capabilities::supportsDimming() const
+{
+    return m_controlType != OnOffControl;
+}
+
+/*!
+ * \fn bool Light::Capabilities::supportsColorTemp() const
+ *
+ * Returns \c true if the color temperature of the light can be set.
+ *
+ */
+bool Light::Capabilities::supportsColorTemp() const
+{
+    return m_controlType == UnknownControl
+            || m_controlType == ColorTempControl
+            || m_controlType == ExtendedColorControl;
+}
+
+/*!
+ * \fn bool Light::Capabilities::supportsColor() const
+ *
+ * Returns \c true if the color (hue, saturation and \e xy) of the light can be set.
+ *
+ */
+bool Light::Capabilities::supportsColor() const
+{
+    return m_controlType == UnknownControl
+            || m_controlType == ColorControl
+            || m_controlType == ExtendedColorControl;
+}
+
+/*!
+ * \fn void Light::Capabilities::setCertified(const bool certified)
+ *
+ * Sets certified as specified by \a certified.
+ *
+ */
+void Light::Capabilities::setCertified(const bool certified)
+{
+    m_certified = certified;
+}
+
+/*!
+ * \fn void Light::Capabilities::setControlType(const ControlType controlType)
+ *
+ * Sets the control type as specified by \a controlType.
+ *
+ */
+void Light::Capabilities::setControlType(const ControlType controlType)
+{
+    m_controlType = controlType;
+}
+
+/*!
+ * \fn void Light::Capabilities::setColorGamutType(const QString colorGamutType)
+ *
+ * Sets the color gamut type as specified by \a colorGamutType. For \e A, \e B and
+ * \e C, the color gamut is set to the corresponding \l HueColor::Gamut unless
+ * it has been set by \l setColorGamut().
+ *
+ */
+void Light::Capabilities::setColorGamutType(const QString colorGamutType)
+{
+    m_colorGamutType = colorGamutType;
+
+    if (m_hasColorGamut)
+        return;
+
+    if (colorGamutType == "A")
+        m_colorGamut = HueColor::gamutTriangle(HueColor::GamutA);
+    else if (colorGamutType == "B")
+        m_colorGamut = HueColor::gamutTriangle(HueColor::GamutB);
+    else if (colorGamutType == "C")
+        m_colorGamut = HueColor::gamutTriangle(HueColor::GamutC);
+    else
+        return;
+
+    m_hasColorGamut = true;
+}
+
+/*!
+ * \fn void Light::Capabilities::setColorGamut(const HueColor::Triangle colorGamut)
+ *
+ * Sets the color gamut as specified by \a colorGamut.
+ *
+ */
+void Light::Capabilities::setColorGamut(const HueColor::Triangle colorGamut)
+{
+    m_colorGamut = colorGamut;
+    m_hasColorGamut = true;
+}
+
+/*!
+ * \fn void Light::Capabilities::setColorTempRange(const int colorTempMin, const int colorTempMax)
+ *
+ * Sets the color temperature range as specified by \a colorTempMin and \a colorTempMax,
+ * in mired.
+ *
+ */
+void Light::Capabilities::setColorTempRange(const int colorTempMin, const int colorTempMax)
+{
+    m_colorTempMin = colorTempMin;
+    m_colorTempMax = colorTempMax;
+}
+
+/*!
+ * \fn void Light::Capabilities::setMaxLumen(const int maxLumen)
+ *
+ * Sets the maximum luminous flux as specified by \a maxLumen.
+ *
+ */
+void Light::Capabilities::setMaxLumen(const int maxLumen)
+{
+    m_maxLumen = maxLumen;
+}
+
+/*!
+ * \fn void Light::Capabilities::setMinDimLevel(const int minDimLevel)
+ *
+ * Sets the minimum dim level as specified by \a minDimLevel.
+ *
+ */
+void Light::Capabilities::setMinDimLevel(const int minDimLevel)
+{
+    m_minDimLevel = minDimLevel;
+}
+
+/*!
+ * \fn void Light::Capabilities::setStreamingRenderer(const bool streamingRenderer)
+ *
+ * Sets streaming renderer support as specified by \a streamingRenderer.
+ *
+ */
+void Light::Capabilities::setStreamingRenderer(const bool streamingRenderer)
+{
+    m_streamingRenderer = streamingRenderer;
+}
+
+/*!
+ * \fn void Light::Capabilities::setStreamingProxy(const bool streamingProxy)
+ *
+ * Sets streaming proxy support as specified by \a streamingProxy.
+ *
+ */
+void Light::Capabilities::setStreamingProxy(const bool streamingProxy)
+{
+    m_streamingProxy = streamingProxy;
+}
+
+void Light::Capabilities::readControl(HueJsonReader& reader)
+{
+    if (!reader.beginObject())
+        return;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("colorgamuttype")) {
+            setColorGamutType(reader.readString());
+        }
+        else if (reader.keyEquals("colorgamut")) {
+            double corners[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+            int count = 0;
+
+            if (reader.beginArray()) {
+                while (reader.readNextElement()) {
+                    if (count < 3)
+                        readXY(reader, corners[2 * count], corners[2 * count + 1]);
+                    else
+                        reader.skipValue();
+                    count++;
+                }
+            }
+
+            if (count == 3) {
+                setColorGamut({static_cast<float>(corners[0]), static_cast<float>(corners[1]),
+                               static_cast<float>(corners[2]), static_cast<float>(corners[3]),
+                               static_cast<float>(corners[4]), static_cast<float>(corners[5])});
+            }
+        }
+        else if (reader.keyEquals("ct")) {
+            if (!reader.beginObject())
+                continue;
+
+            while (reader.readNextKey()) {
+                if (reader.keyEquals("min"))        m_colorTempMin = reader.readInt();
+                else if (reader.keyEquals("max"))   m_colorTempMax = reader.readInt();
+                else
+                    reader.skipValue();
+            }
+        }
+        else if (reader.keyEquals("maxlumen"))      m_maxLumen = reader.readInt();
+        else if (reader.keyEquals("mindimlevel"))   m_minDimLevel = reader.readInt();
+        else
+            reader.skipValue();
+    }
+}
+
+void Light::Capabilities::readStreaming(HueJsonReader& reader)
+{
+    if (!reader.beginObject())
+        return;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("renderer"))           m_streamingRenderer = reader.readBool();
+        else if (reader.keyEquals("proxy"))         m_streamingProxy = reader.readBool();
+        else
+            reader.skipValue();
+    }
+}
+
+// ---------- RECORD ----------
+
+/*!
+ * \class Light::Record
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Holds all data of a \l HueLight parsed from JSON.
+ *
+ * Record is a plain value without a \e QObject, so it can be parsed on a worker
+ * thread and handed to the thread that constructs the \l HueLight.
+ *
+ */
+
+/*!
+ * \fn Light::Record::Record()
+ *
+ * Constructs an empty Record with ID 0.
+ *
+ */
+Light::Record::Record()
+    : ID(0)
+{
+
+}
+
+/* =====================================
+ * =============== GROUP ===============
+ * =====================================
+ *
+ */
+
+/*!
+ * \namespace Group
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Contains data classes for \l HueGroup.
+ *
+ */
+
+// ---------- ACTION ----------
+
+/*!
+ * \class Group::Action
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Describes the action of a \l HueGroup.
+ *
+ */
+
+/*!
+ * \fn Group::Action::Action()
+ *
+ * Constructs an empty Action object.
+ *
+ */
+Group::Action::Action()
+    : m_on(false)
+    , m_brightness(0)
+    , m_hue(0)
+    , m_saturation(0)
+    , m_colorTemp(0)
+    , m_xValue(0)
+    , m_yValue(0)
+    , m_effect("")
+    , m_alert("")
+    , m_colorMode("")
+{
+
+}
+
+/*!
+ * \fn Group::Action::Action(const QJsonValue json)
+ *
+ * Constructs an Action object by parsing JSON specified
+ * by \a json.
+ *
+ */
+Group::Action::Action(const QJsonValue json)
+{
+    QJsonObject actionJson = json.toObject();
+
+    bool jsonIsValid =
+            actionJson.contains("on")        &
+            actionJson.contains("bri")       &
+            actionJson.contains("hue")       &
+            actionJson.contains("sat")       &
+            actionJson.contains("ct")        &
+            actionJson.contains("xy")        &
+            actionJson.contains("effect")    &
+            actionJson.contains("alert")     &
+            actionJson.contains("colormode") ;
+
+    if (jsonIsValid) {
+        m_on            = actionJson["on"].toBool();
+        m_brightness    = actionJson["bri"].toInt();
+        m_hue           = actionJson["hue"].toInt();
+        m_saturation    = actionJson["sat"].toInt();
+        m_colorTemp     = actionJson["ct"].toInt();
+        m_xValue        = actionJson["xy"].toArray()[0].toDouble();
+        m_yValue        = actionJson["xy"].toArray()[1].toDouble();
+        m_effect        = actionJson["effect"].toString();
+        m_alert         = actionJson["alert"].toString();
+        m_colorMode     = actionJson["colormode"].toString();
+    }
+    else {
+        Group::Action();
+    }
+}
+
+/*!
+ * \fn Group::Action::Action(HueJsonReader& reader)
+ *
+ * Constructs an Action object by reading the next JSON value
+ * from \a reader.
+ *
+ */
+Group::Action::Action(HueJsonReader& reader)
+    : Action()
+{
+    int keys = 0;
+
+    if (!reader.beginObject())
+        return;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("on"))             { m_on          = reader.readBool();    keys |= 1 << 0; }
+        else if (reader.keyEquals("bri"))       { m_brightness  = reader.readInt();     keys |= 1 << 1; }
+        else if (reader.keyEquals("hue"))       { m_hue         = reader.readInt();     keys |= 1 << 2; }
+        else if (reader.keyEquals("sat"))       { m_saturation  = reader.readInt();     keys |= 1 << 3; }
+        else if (reader.keyEquals("ct"))        { m_colorTemp   = reader.readInt();     keys |= 1 << 4; }
+        else if (reader.keyEquals("xy"))        { readXY(reader, m_xValue, m_yValue);   keys |= 1 << 5; }
+        else if (reader.keyEquals("effect"))    { m_effect      = reader.readString();  keys |= 1 << 6; }
+        else if (reader.keyEquals("alert"))     { m_alert       = reader.readString();  keys |= 1 << 7; }
+        else if (reader.keyEquals("colormode")) { m_colorMode   = reader.readString();  keys |= 1 << 8; }
+        else
+            reader.skipValue();
+    }
+
+    // Same as the JSON constructor: all keys must be present
+    if (keys != (1 << 9) - 1)
+        *this = Group::Action();
 }
 
 /*!
@@ -1454,6 +2349,7 @@ void Group::Action::setColorMode(const QString colorMode)
  */
 Group::Lights::Lights()
     : m_lights()
+    , m_members()
 {
 
 }
@@ -1467,11 +2363,29 @@ Group::Lights::Lights()
  */
 Group::Lights::Lights(const QJsonValue json)
     : m_lights()
+    , m_members()
 {
+    QList<QString> lights;
     QJsonArray lightsJson = json.toArray();
     for (auto iter = lightsJson.begin(); iter != lightsJson.end(); ++iter) {
-        m_lights.append(iter->toString());
+        lights.append(iter->toString());
     }
+
+    setLights(lights);
+}
+
+/*!
+ * \fn Group::Lights::Lights(HueJsonReader& reader)
+ *
+ * Constructs a Lights object by reading the next JSON value
+ * from \a reader.
+ *
+ */
+Group::Lights::Lights(HueJsonReader& reader)
+    : m_lights()
+    , m_members()
+{
+    setLights(reader.readStringArray());
 }
 
 /*!
@@ -1485,6 +2399,39 @@ QList<QString> Group::Lights::getLights() const
     return m_lights;
 }
 
+/*!
+ * \fn HueBitset Group::Lights::getMembers() const
+ *
+ * Returns the IDs of the lights as a \l HueBitset.
+ *
+ */
+HueBitset Group::Lights::getMembers() const
+{
+    return m_members;
+}
+
+/*!
+ * \fn bool Group::Lights::contains(const int lightID) const
+ *
+ * Returns \c true if the light with ID \a lightID is in the group.
+ *
+ */
+bool Group::Lights::contains(const int lightID) const
+{
+    return m_members.test(lightID);
+}
+
+/*!
+ * \fn int Group::Lights::count() const
+ *
+ * Returns the number of lights in the group.
+ *
+ */
+int Group::Lights::count() const
+{
+    return m_members.count();
+}
+
 /*!
  * \fn void Group::Lights::setLights(const QList<QString> lights)
  *
@@ -1494,6 +2441,14 @@ QList<QString> Group::Lights::getLights() const
 void Group::Lights::setLights(const QList<QString> lights)
 {
     m_lights = lights;
+    m_members.clear();
+
+    for (const QString& lightID : lights) {
+        bool ok = false;
+        const int ID = lightID.toInt(&ok);
+        if (ok)
+            m_members.set(ID);
+    }
 }
 
 // ---------- SENSORS ----------
@@ -1534,6 +2489,19 @@ Group::Sensors::Sensors(const QJsonValue json)
     }
 }
 
+/*!
+ * \fn Group::Sensors::Sensors(HueJsonReader& reader)
+ *
+ * Constructs a Sensors object by reading the next JSON value
+ * from \a reader.
+ *
+ */
+Group::Sensors::Sensors(HueJsonReader& reader)
+    : m_sensors(reader.readStringArray())
+{
+
+}
+
 /*!
  * \fn QList<QString> Group::Sensors::getSensors() const
  *
@@ -1599,6 +2567,32 @@ Group::State::State(const QJsonValue json)
     }
 }
 
+/*!
+ * \fn Group::State::State(HueJsonReader& reader)
+ *
+ * Constructs a State object by reading the next JSON value
+ * from \a reader.
+ *
+ */
+Group::State::State(HueJsonReader& reader)
+    : State()
+{
+    int keys = 0;
+
+    if (!reader.beginObject())
+        return;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("all_on"))         { m_allOn = reader.readBool();  keys |= 1 << 0; }
+        else if (reader.keyEquals("any_on"))    { m_anyOn = reader.readBool();  keys |= 1 << 1; }
+        else
+            reader.skipValue();
+    }
+
+    if (keys != (1 << 2) - 1)
+        *this = Group::State();
+}
+
 /*!
  * \fn bool Group::State::getAllOn() const
  *
@@ -1866,3 +2860,28 @@ void Group::Recycle::setRecycle(const bool recycle)
     m_recycle = recycle;
 }
 
+
+// ---------- RECORD ----------
+
+/*!
+ * \class Group::Record
+ * \ingroup HueLib
+ * \inmodule HueLib
+ * \brief Holds all data of a \l HueGroup parsed from JSON.
+ *
+ * Record is a plain value without a \e QObject, so it can be parsed on a worker
+ * thread and handed to the thread that constructs the \l HueGroup.
+ *
+ */
+
+/*!
+ * \fn Group::Record::Record()
+ *
+ * Constructs an empty Record with ID 0.
+ *
+ */
+Group::Record::Record()
+    : ID(0)
+{
+
+}
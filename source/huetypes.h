@@ -5,6 +5,11 @@
 #include <QJsonObject>
 #include <QList>
 
+#include "huebitset.h"
+#include "huecolor.h"
+
+class HueJsonReader;
+
 /* =====================================
  * =============== LIGHT ===============
  * =====================================
@@ -16,8 +21,32 @@ namespace Light {
 class State
 {
 public:
+    enum Effect : quint8 {
+        UnknownEffect,
+        NoEffect,
+        ColorLoopEffect
+    };
+    enum Alert : quint8 {
+        UnknownAlert,
+        NoAlert,
+        SelectAlert,
+        LSelectAlert
+    };
+    enum ColorMode : quint8 {
+        UnknownColorMode,
+        HueSatColorMode,
+        XYColorMode,
+        ColorTempColorMode
+    };
+    enum Mode : quint8 {
+        UnknownMode,
+        HomeAutomationMode,
+        StreamingMode
+    };
+
     State();
     State(const QJsonValue json);
+    State(HueJsonReader& reader);
 
     bool isOn() const;
     bool isReachable() const;
@@ -31,6 +60,10 @@ public:
     QString getAlert() const;
     QString getColorMode() const;
     QString getMode() const;
+    Effect effect() const;
+    Alert alert() const;
+    ColorMode colorMode() const;
+    Mode mode() const;
 
     void setOn(const bool on);
     void setReachable(const bool reachable);
@@ -44,20 +77,28 @@ public:
     void setAlert(const QString alert);
     void setColorMode(const QString colorMode);
     void setMode(const QString mode);
+    void setEffect(const Effect effect);
+    void setAlert(const Alert alert);
+    void setColorMode(const ColorMode colorMode);
+    void setMode(const Mode mode);
+
+    bool operator==(const State& rhs) const;
+    bool operator!=(const State& rhs) const;
 
 private:
+    // Ordered by size so the object has no padding and can be compared with memcmp
+    quint16 m_hue;
+    quint16 m_colorTemp;
+    quint16 m_xValue;
+    quint16 m_yValue;
+    quint8 m_brightness;
+    quint8 m_saturation;
+    Effect m_effect;
+    Alert m_alert;
+    ColorMode m_colorMode;
+    Mode m_mode;
     bool m_on;
     bool m_reachable;
-    int m_brightness;
-    int m_hue;
-    int m_saturation;
-    int m_colorTemp;
-    double m_xValue;
-    double m_yValue;
-    QString m_effect;
-    QString m_alert;
-    QString m_colorMode;
-    QString m_mode;
 };
 
 class Name {
@@ -118,6 +159,7 @@ class SoftwareUpdate
 public:
     SoftwareUpdate();
     SoftwareUpdate(const QJsonValue json);
+    SoftwareUpdate(HueJsonReader& reader);
 
     QString getState() const;
     QString getLastInstall() const;
@@ -195,6 +237,7 @@ public:
     public:
         Startup();
         Startup(const QJsonValue json);
+        Startup(HueJsonReader& reader);
 
         QString getMode() const;
         bool getConfigured() const;
@@ -210,6 +253,7 @@ public:
 public:
     Config();
     Config(const QJsonValue json);
+    Config(HueJsonReader& reader);
 
     QString getArchetype() const;
     QString getFunction() const;
@@ -228,6 +272,87 @@ private:
     Startup m_startup;
 };
 
+class Capabilities
+{
+public:
+    enum ControlType {
+        UnknownControl,
+        OnOffControl,
+        DimmableControl,
+        ColorTempControl,
+        ColorControl,
+        ExtendedColorControl
+    };
+
+    Capabilities();
+    Capabilities(const QJsonValue json);
+    Capabilities(HueJsonReader& reader);
+
+    static ControlType controlTypeFromType(const QString type);
+
+    bool getCertified() const;
+    ControlType getControlType() const;
+    bool hasColorGamut() const;
+    QString getColorGamutType() const;
+    HueColor::Triangle getColorGamut() const;
+    int getColorTempMin() const;
+    int getColorTempMax() const;
+    int getMaxLumen() const;
+    int getMinDimLevel() const;
+    bool getStreamingRenderer() const;
+    bool getStreamingProxy() const;
+
+    bool supportsDimming() const;
+    bool supportsColorTemp() const;
+    bool supportsColor() const;
+
+    void setCertified(const bool certified);
+    void setControlType(const ControlType controlType);
+    void setColorGamutType(const QString colorGamutType);
+    void setColorGamut(const HueColor::Triangle colorGamut);
+    void setColorTempRange(const int colorTempMin, const int colorTempMax);
+    void setMaxLumen(const int maxLumen);
+    void setMinDimLevel(const int minDimLevel);
+    void setStreamingRenderer(const bool streamingRenderer);
+    void setStreamingProxy(const bool streamingProxy);
+
+private:
+    void readControl(HueJsonReader& reader);
+    void readStreaming(HueJsonReader& reader);
+
+private:
+    bool m_certified;
+    ControlType m_controlType;
+    bool m_hasColorGamut;
+    QString m_colorGamutType;
+    HueColor::Triangle m_colorGamut;
+    int m_colorTempMin;
+    int m_colorTempMax;
+    int m_maxLumen;
+    int m_minDimLevel;
+    bool m_streamingRenderer;
+    bool m_streamingProxy;
+};
+
+struct Record
+{
+    Record();
+
+    int ID;
+    State state;
+    Name name;
+    Type type;
+    UniqueID uniqueID;
+    SoftwareVersion softwareVersion;
+    SoftwareUpdate softwareUpdate;
+    SoftwareConfigID softwareConfigID;
+    ProductName productName;
+    Manufacturer manufacturer;
+    ProductID productID;
+    Config config;
+    Capabilities capabilities;
+};
+
 }
 
 
@@ -244,6 +369,7 @@ class Action
 public:
     Action();
     Action(const QJsonValue json);
+    Action(HueJsonReader& reader);
 
     bool isOn() const;
     int getBrightness() const;
@@ -285,13 +411,18 @@ class Lights
 public:
     Lights();
     Lights(const QJsonValue json);
+    Lights(HueJsonReader& reader);
 
     QList<QString> getLights() const;
+    HueBitset getMembers() const;
+    bool contains(const int lightID) const;
+    int count() const;
 
     void setLights(const QList<QString> lights);
 
 private:
     QList<QString> m_lights;
+    HueBitset m_members;
 };
 
 class Sensors
@@ -299,6 +430,7 @@ class Sensors
 public:
     Sensors();
     Sensors(const QJsonValue json);
+    Sensors(HueJsonReader& reader);
 
     QList<QString> getSensors() const;
 
@@ -313,6 +445,7 @@ class State
 public:
     State();
     State(const QJsonValue json);
+    State(HueJsonReader& reader);
 
     bool getAllOn() const;
     bool getAnyOn() const;
@@ -381,6 +514,21 @@ private:
     bool m_recycle;
 };
 
+struct Record
+{
+    Record();
+
+    int ID;
+    Action action;
+    Lights lights;
+    Sensors sensors;
+    State state;
+    Name name;
+    Type type;
+    GroupClass groupClass;
+    Recycle recycle;
+};
+
 }
 
 
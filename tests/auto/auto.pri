@@ -0,0 +1,5 @@
+# Settings for the autotests. "make check" runs every program that includes this file.
+
+include(../tests.pri)
+
+CONFIG += testcase
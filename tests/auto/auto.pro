@@ -0,0 +1,16 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+        hueanimation \
+        hueanimator \
+        huebitset \
+        hueeventstream \
+        hueinventorytreemodel \
+        huelightconstraints \
+        huelightstatetable \
+        huemembershipindex \
+        hueperceptualfilter \
+        huereply \
+        huescene \
+        huesnapshot \
+        huestreamchannel
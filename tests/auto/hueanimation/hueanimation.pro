@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_hueanimation
+
+SOURCES += tst_hueanimation.cpp
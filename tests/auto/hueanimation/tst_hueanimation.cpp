@@ -0,0 +1,204 @@
+#include <QtTest>
+#include <cmath>
+#include <memory>
+
+#include "hueanimation.h"
+#include "huestatechange.h"
+#include "testobject.h"
+
+class TestHueAnimation : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void linearFadeIsOneCommand();
+    void longFadeIsSplitAtTransitionTimeLimit();
+    void curvedFadeStaysWithinError_data();
+    void curvedFadeStaysWithinError();
+    void fadeStartsFromCurrentState();
+    void turnOffOnlyAtEnd();
+    void turnOnEveryKeyframe();
+    void stateAtHoldsAndInterpolates();
+    void stateAtLoops();
+
+private:
+    static std::shared_ptr<TestObject> makeTarget(const int brightness);
+};
+
+std::shared_ptr<TestObject> TestHueAnimation::makeTarget(const int brightness)
+{
+    HueStateChange state;
+    state.setOn(true);
+    state.setBrightness(brightness);
+    state.setColorTemp(300);
+
+    auto target = std::make_shared<TestObject>();
+    target->setCurrentState(state);
+    return target;
+}
+
+void TestHueAnimation::linearFadeIsOneCommand()
+{
+    HueStateChange to;
+    to.setBrightness(254);
+
+    const HueAnimation fade = HueAnimation::fade(makeTarget(1), to, 10000);
+
+    QCOMPARE(fade.playback(), HueAnimation::KeyframePlayback);
+    QCOMPARE(fade.keyframeCount(), 1);
+    QCOMPARE(fade.keyframeTime(0), 10000);
+    QCOMPARE(fade.keyframeState(0).getBrightness(), 254);
+}
+
+void TestHueAnimation::longFadeIsSplitAtTransitionTimeLimit()
+{
+    // transitiontime is a 16-bit count of 100 ms steps, so two hours need two commands
+    HueStateChange to;
+    to.setBrightness(254);
+
+    const HueAnimation fade = HueAnimation::fade(makeTarget(1), to, 2 * 60 * 60 * 1000);
+
+    QCOMPARE(fade.keyframeCount(), 2);
+    QCOMPARE(fade.keyframeTime(0), 65535 * 100);
+    QCOMPARE(fade.keyframeTime(1), 2 * 60 * 60 * 1000);
+}
+
+void TestHueAnimation::curvedFadeStaysWithinError_data()
+{
+    QTest::addColumn<int>("curve");
+
+    QTest::newRow("EaseIn") << static_cast<int>(HueAnimation::EaseIn);
+    QTest::newRow("EaseOut") << static_cast<int>(HueAnimation::EaseOut);
+    QTest::newRow("EaseInOut") << static_cast<int>(HueAnimation::EaseInOut);
+}
+
+void TestHueAnimation::curvedFadeStaysWithinError()
+{
+    QFETCH(int, curve);
+
+    const HueAnimation::Curve fadeCurve = static_cast<HueAnimation::Curve>(curve);
+    const int duration = 60000;
+    const double maxError = 0.02;
+
+    HueStateChange to;
+    to.setBrightness(254);
+
+    const HueAnimation fade = HueAnimation::fade(makeTarget(0), to, duration, fadeCurve, maxError);
+
+    QVERIFY(fade.keyframeCount() > 1);
+    QVERIFY(fade.keyframeCount() < duration / 100);
+    QCOMPARE(fade.keyframeTime(fade.keyframeCount() - 1), duration);
+
+    int previousTime = 0;
+    for (int i = 0; i < fade.keyframeCount(); i++) {
+        const int time = fade.keyframeTime(i);
+        QVERIFY(time > previousTime);
+        QCOMPARE(time % 100, 0);
+        previousTime = time;
+    }
+
+    // The bridge interpolates linearly from the start state through each keyframe,
+    // which is what stateAt() does once the start state is added as a keyframe
+    HueStateChange start;
+    start.setBrightness(0);
+
+    HueAnimation bridgeView;
+    bridgeView.addKeyframe(0, start);
+    for (int i = 0; i < fade.keyframeCount(); i++)
+        bridgeView.addKeyframe(fade.keyframeTime(i), fade.keyframeState(i));
+
+    for (int time = 0; time <= duration; time += 100) {
+        const double expected = 254.0 * HueAnimation::curveValue(fadeCurve, static_cast<double>(time) / duration);
+        const int brightness = bridgeView.stateAt(time).getBrightness();
+
+        QVERIFY2(std::abs(brightness - expected) <= 254.0 * maxError + 1.0,
+                 qPrintable(QString("%1 ms: %2, expected %3").arg(time).arg(brightness).arg(expected)));
+    }
+}
+
+void TestHueAnimation::fadeStartsFromCurrentState()
+{
+    HueStateChange to;
+    to.setBrightness(254);
+    to.setColorTemp(200);
+
+    const HueAnimation fade = HueAnimation::fade(makeTarget(100), to, 1000, HueAnimation::EaseIn);
+
+    QVERIFY(fade.keyframeCount() > 1);
+
+    const HueStateChange first = fade.keyframeState(0);
+    QVERIFY(first.getBrightness() >= 100);
+    QVERIFY(first.getBrightness() < 254);
+    QVERIFY(first.getColorTemp() <= 300);
+    QVERIFY(first.getColorTemp() > 200);
+    QVERIFY(!first.has(HueStateChange::OnAttribute));
+}
+
+void TestHueAnimation::turnOffOnlyAtEnd()
+{
+    HueStateChange to;
+    to.setOn(false);
+    to.setBrightness(1);
+
+    const HueAnimation fade = HueAnimation::fade(makeTarget(254), to, 5000, HueAnimation::EaseOut);
+    const int last = fade.keyframeCount() - 1;
+
+    QVERIFY(last > 0);
+    for (int i = 0; i < last; i++)
+        QVERIFY(!fade.keyframeState(i).has(HueStateChange::OnAttribute));
+
+    QVERIFY(fade.keyframeState(last).has(HueStateChange::OnAttribute));
+    QVERIFY(!fade.keyframeState(last).isOn());
+}
+
+void TestHueAnimation::turnOnEveryKeyframe()
+{
+    HueStateChange to;
+    to.setOn(true);
+    to.setBrightness(254);
+
+    const HueAnimation fade = HueAnimation::fade(makeTarget(1), to, 5000, HueAnimation::EaseIn);
+
+    QVERIFY(fade.keyframeCount() > 1);
+    for (int i = 0; i < fade.keyframeCount(); i++) {
+        QVERIFY(fade.keyframeState(i).has(HueStateChange::OnAttribute));
+        QVERIFY(fade.keyframeState(i).isOn());
+    }
+}
+
+void TestHueAnimation::stateAtHoldsAndInterpolates()
+{
+    HueStateChange dim;
+    dim.setBrightness(0);
+    HueStateChange bright;
+    bright.setBrightness(200);
+
+    HueAnimation animation;
+    animation.addKeyframe(1000, dim);
+    animation.addKeyframe(2000, bright);
+
+    QCOMPARE(animation.duration(), 2000);
+    QCOMPARE(animation.stateAt(0).getBrightness(), 0);
+    QCOMPARE(animation.stateAt(1500).getBrightness(), 100);
+    QCOMPARE(animation.stateAt(5000).getBrightness(), 200);
+}
+
+void TestHueAnimation::stateAtLoops()
+{
+    HueStateChange dim;
+    dim.setBrightness(0);
+    HueStateChange bright;
+    bright.setBrightness(200);
+
+    HueAnimation animation;
+    animation.addKeyframe(0, dim);
+    animation.addKeyframe(1000, bright);
+    animation.setLooping(true);
+
+    QCOMPARE(animation.stateAt(500).getBrightness(), 100);
+    QCOMPARE(animation.stateAt(1500).getBrightness(), 100);
+}
+
+QTEST_GUILESS_MAIN(TestHueAnimation)
+
+#include "tst_hueanimation.moc"
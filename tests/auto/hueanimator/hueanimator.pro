@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_hueanimator
+
+SOURCES += tst_hueanimator.cpp
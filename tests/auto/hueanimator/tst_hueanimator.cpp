@@ -0,0 +1,208 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <memory>
+
+#include "fakebridge.h"
+#include "hueanimation.h"
+#include "hueanimator.h"
+#include "huebridge.h"
+#include "huestatechange.h"
+#include "testobject.h"
+
+namespace {
+
+HueStateChange colorTemp(const int ct)
+{
+    HueStateChange state;
+    state.setColorTemp(ct);
+    return state;
+}
+
+HueStateChange brightness(const int bri)
+{
+    HueStateChange state;
+    state.setBrightness(bri);
+    return state;
+}
+
+}
+
+// Keyframes are played on a TestObject whose commands go to the bridge stand-in,
+// which accepts every state change until its reply is removed.
+class TestHueAnimator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void keyframesPlayInOrder();
+    void loopStartsWithFirstKeyframe();
+    void rejectedKeyframeIsSentAgain();
+    void stopKeepsState();
+    void invalidAnimation();
+
+private:
+    QJsonObject sentBody(const int index) const;
+    void acceptChanges();
+
+private:
+    FakeBridge* m_fakeBridge;
+    HueBridge* m_bridge;
+    std::shared_ptr<TestObject> m_target;
+};
+
+void TestHueAnimator::init()
+{
+    m_fakeBridge = new FakeBridge(this);
+    QVERIFY(m_fakeBridge->listen());
+    acceptChanges();
+
+    m_bridge = new HueBridge(m_fakeBridge->getAddress(), m_fakeBridge->getUsername());
+    m_target = std::make_shared<TestObject>(1, HueAbstractObject::LightKind, m_bridge);
+    m_target->setCurrentState(colorTemp(300));
+}
+
+void TestHueAnimator::cleanup()
+{
+    m_target.reset();
+    delete m_bridge;
+    delete m_fakeBridge;
+}
+
+QJsonObject TestHueAnimator::sentBody(const int index) const
+{
+    return QJsonDocument::fromJson(m_fakeBridge->requests("PUT").at(index).body).object();
+}
+
+void TestHueAnimator::acceptChanges()
+{
+    const QJsonArray reply {QJsonObject{{"success", QJsonObject{{"/lights/1/state", true}}}}};
+    m_fakeBridge->setReply("PUT", m_fakeBridge->apiPath("lights/1/state"), QJsonDocument(reply).toJson());
+}
+
+void TestHueAnimator::keyframesPlayInOrder()
+{
+    HueAnimation animation(m_target);
+    animation.setPlayback(HueAnimation::KeyframePlayback);
+    animation.addKeyframe(0, brightness(10));
+    animation.addKeyframe(300, brightness(100));
+    animation.addKeyframe(600, brightness(200));
+
+    HueAnimator animator;
+    QSignalSpy finished(&animator, &HueAnimator::finished);
+
+    const int ID = animator.play(animation);
+    QVERIFY(ID >= 0);
+    QVERIFY(animator.isActive());
+
+    QVERIFY(finished.wait(5000));
+    QCOMPARE(finished.first().at(0).toInt(), ID);
+    QVERIFY(!animator.isActive());
+
+    // The keyframe at 0 is sent first, as a jump
+    QCOMPARE(m_fakeBridge->requests("PUT").size(), 3);
+    QCOMPARE(sentBody(0).value("bri").toInt(), 10);
+    QCOMPARE(sentBody(0).value("transitiontime").toInt(), 0);
+    QCOMPARE(sentBody(1).value("bri").toInt(), 100);
+    QCOMPARE(sentBody(2).value("bri").toInt(), 200);
+
+    QCOMPARE(animator.framesSent(), 3);
+    QCOMPARE(animator.framesDropped(), 0);
+    QCOMPARE(m_target->currentState().getBrightness(), 200);
+}
+
+void TestHueAnimator::loopStartsWithFirstKeyframe()
+{
+    HueAnimation animation(m_target);
+    animation.setPlayback(HueAnimation::KeyframePlayback);
+    animation.setLooping(true);
+    animation.addKeyframe(0, colorTemp(153));
+    animation.addKeyframe(400, colorTemp(500));
+
+    HueAnimator animator;
+    const int ID = animator.play(animation);
+
+    QTRY_VERIFY_WITH_TIMEOUT(m_fakeBridge->requests("PUT").size() >= 5, 5000);
+    QVERIFY(animator.stop(ID));
+    QVERIFY(!animator.isActive());
+
+    // Every loop starts again from its first keyframe
+    for (int i = 0; i < 5; i++)
+        QCOMPARE(sentBody(i).value("ct").toInt(), i % 2 == 0 ? 153 : 500);
+
+    QCOMPARE(sentBody(2).value("transitiontime").toInt(), 0);
+}
+
+void TestHueAnimator::rejectedKeyframeIsSentAgain()
+{
+    HueAnimation animation(m_target);
+    animation.setPlayback(HueAnimation::KeyframePlayback);
+    animation.addKeyframe(0, brightness(10));
+    animation.addKeyframe(3000, brightness(100));
+    animation.addKeyframe(6000, brightness(200));
+
+    HueAnimator animator;
+    animator.setTickInterval(300);
+    QSignalSpy finished(&animator, &HueAnimator::finished);
+
+    animator.play(animation);
+    QTRY_COMPARE(m_fakeBridge->requests("PUT").size(), 1);
+
+    // The next keyframe fails once and is sent again on the following tick
+    m_fakeBridge->removeReply("PUT", m_fakeBridge->apiPath("lights/1/state"));
+    QTRY_COMPARE(m_fakeBridge->requests("PUT").size(), 2);
+    acceptChanges();
+
+    QVERIFY(finished.wait(10000));
+
+    QCOMPARE(m_fakeBridge->requests("PUT").size(), 4);
+    QCOMPARE(sentBody(1).value("bri").toInt(), 100);
+    QCOMPARE(sentBody(2).value("bri").toInt(), 100);
+    QCOMPARE(sentBody(3).value("bri").toInt(), 200);
+
+    QCOMPARE(animator.framesSent(), 3);
+    QCOMPARE(animator.framesDropped(), 1);
+    QCOMPARE(m_target->currentState().getBrightness(), 200);
+}
+
+void TestHueAnimator::stopKeepsState()
+{
+    HueAnimation animation(m_target);
+    animation.setPlayback(HueAnimation::KeyframePlayback);
+    animation.addKeyframe(0, brightness(10));
+    animation.addKeyframe(10000, brightness(200));
+
+    HueAnimator animator;
+    QSignalSpy finished(&animator, &HueAnimator::finished);
+
+    const int ID = animator.play(animation);
+    QCOMPARE(animator.animationCount(), 1);
+    QTRY_COMPARE(m_fakeBridge->requests("PUT").size(), 2);
+
+    QVERIFY(animator.stop(ID));
+    QVERIFY(!animator.stop(ID));
+    QCOMPARE(animator.animationCount(), 0);
+    QVERIFY(!animator.isActive());
+    QCOMPARE(finished.count(), 0);
+
+    // The light keeps the transition it was sent
+    QCOMPARE(m_target->currentState().getBrightness(), 200);
+}
+
+void TestHueAnimator::invalidAnimation()
+{
+    HueAnimator animator;
+
+    QCOMPARE(animator.play(HueAnimation()), -1);
+    QVERIFY(!animator.isActive());
+    QCOMPARE(animator.animationCount(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestHueAnimator)
+
+#include "tst_hueanimator.moc"
@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_huebitset
+
+SOURCES += tst_huebitset.cpp
@@ -0,0 +1,141 @@
+#include <QtTest>
+#include <vector>
+
+#include "huebitset.h"
+
+class TestHueBitset : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptySet();
+    void setAndReset();
+    void negativeIDsAreIgnored();
+    void spansWords();
+    void resetTrimsWords();
+    void toVectorIsSorted();
+    void intersection();
+    void unionAndDifference();
+    void subsets();
+};
+
+void TestHueBitset::emptySet()
+{
+    const HueBitset set;
+
+    QVERIFY(set.isEmpty());
+    QCOMPARE(set.count(), 0);
+    QCOMPARE(set.wordCount(), 0);
+    QVERIFY(set.toVector().empty());
+    QVERIFY(!set.test(0));
+}
+
+void TestHueBitset::setAndReset()
+{
+    HueBitset set;
+    set.set(3);
+    set.set(3);
+    set.set(7);
+
+    QVERIFY(set.test(3));
+    QVERIFY(set.test(7));
+    QVERIFY(!set.test(4));
+    QCOMPARE(set.count(), 2);
+
+    set.reset(3);
+    set.reset(5);
+
+    QVERIFY(!set.test(3));
+    QCOMPARE(set.count(), 1);
+
+    set.clear();
+    QVERIFY(set.isEmpty());
+}
+
+void TestHueBitset::negativeIDsAreIgnored()
+{
+    HueBitset set;
+    set.set(-1);
+    set.reset(-1);
+
+    QVERIFY(set.isEmpty());
+    QVERIFY(!set.test(-1));
+}
+
+void TestHueBitset::spansWords()
+{
+    const HueBitset set {0, 63, 64, 200};
+
+    QCOMPARE(set.count(), 4);
+    QCOMPARE(set.wordCount(), 4);
+    QVERIFY(set.test(63));
+    QVERIFY(set.test(64));
+    QVERIFY(!set.test(65));
+    QVERIFY(!set.test(1000));
+}
+
+void TestHueBitset::resetTrimsWords()
+{
+    // Equal sets must compare equal however they were built
+    HueBitset set {1, 200};
+    set.reset(200);
+
+    QCOMPARE(set.wordCount(), 1);
+    QVERIFY(set == HueBitset({1}));
+
+    set.reset(1);
+    QVERIFY(set.isEmpty());
+    QVERIFY(set == HueBitset());
+}
+
+void TestHueBitset::toVectorIsSorted()
+{
+    const HueBitset set(std::vector<int>{130, 5, 64, 1, 5});
+
+    QCOMPARE(set.toVector(), std::vector<int>({1, 5, 64, 130}));
+}
+
+void TestHueBitset::intersection()
+{
+    const HueBitset lhs {1, 2, 3, 100};
+    const HueBitset rhs {2, 3, 4};
+
+    QVERIFY(lhs.intersects(rhs));
+    QCOMPARE(lhs.intersectionCount(rhs), 2);
+    QVERIFY((lhs & rhs) == HueBitset({2, 3}));
+
+    // The words beyond the shorter set are dropped
+    QCOMPARE((lhs & rhs).wordCount(), 1);
+
+    QVERIFY(!lhs.intersects(HueBitset({4, 5})));
+    QVERIFY((lhs & HueBitset({4, 5})).isEmpty());
+}
+
+void TestHueBitset::unionAndDifference()
+{
+    const HueBitset lhs {1, 2, 100};
+    const HueBitset rhs {2, 3};
+
+    QVERIFY((lhs | rhs) == HueBitset({1, 2, 3, 100}));
+    QVERIFY((rhs | lhs) == HueBitset({1, 2, 3, 100}));
+    QVERIFY((lhs - rhs) == HueBitset({1, 100}));
+    QVERIFY((rhs - lhs) == HueBitset({3}));
+    QVERIFY((lhs - HueBitset({100})) == HueBitset({1, 2}));
+    QCOMPARE((lhs - HueBitset({100})).wordCount(), 1);
+}
+
+void TestHueBitset::subsets()
+{
+    const HueBitset room {1, 2, 3, 4};
+
+    QVERIFY(HueBitset({2, 3}).isSubsetOf(room));
+    QVERIFY(room.isSubsetOf(room));
+    QVERIFY(HueBitset().isSubsetOf(room));
+    QVERIFY(!HueBitset({2, 5}).isSubsetOf(room));
+    QVERIFY(!HueBitset({2, 100}).isSubsetOf(room));
+    QVERIFY(!room.isSubsetOf(HueBitset()));
+}
+
+QTEST_APPLESS_MAIN(TestHueBitset)
+
+#include "tst_huebitset.moc"
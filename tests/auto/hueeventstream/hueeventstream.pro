@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_hueeventstream
+
+SOURCES += tst_hueeventstream.cpp
@@ -0,0 +1,205 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include <memory>
+
+#include "fakebridge.h"
+#include "huebridge.h"
+#include "hueeventstream.h"
+#include "huestatechange.h"
+#include "testobject.h"
+
+namespace {
+
+const char streamPath[] = "/eventstream/clip/v2";
+
+QByteArray lightUpdate(const int ID, const QByteArray& fields)
+{
+    return "[{\"type\":\"update\",\"data\":[{\"id_v1\":\"/lights/" + QByteArray::number(ID)
+            + "\"," + fields + "}]}]";
+}
+
+}
+
+class TestHueEventStream : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void defaults();
+    void appliesPushedUpdates();
+    void ignoresUnregisteredObjects();
+    void eventSplitAcrossWrites();
+    void commentsAndCarriageReturns();
+    void multiLineData();
+    void reconnectsWithLastEventID();
+    void pollsWhileStreamIsUnavailable();
+
+private:
+    void connectStream();
+
+private:
+    FakeBridge* m_fakeBridge;
+    HueBridge* m_bridge;
+    HueEventStream* m_stream;
+    std::shared_ptr<TestObject> m_light;
+};
+
+void TestHueEventStream::init()
+{
+    m_fakeBridge = new FakeBridge(this);
+    QVERIFY(m_fakeBridge->listen());
+    m_fakeBridge->setEventStreamPath(streamPath);
+
+    m_bridge = new HueBridge(m_fakeBridge->getAddress(), m_fakeBridge->getUsername());
+    m_stream = new HueEventStream(m_bridge);
+    m_stream->setUrl(QUrl("http://" + m_fakeBridge->getAddress() + streamPath));
+
+    m_light = std::make_shared<TestObject>(3);
+    QVERIFY(m_stream->addHueObject(m_light));
+}
+
+void TestHueEventStream::cleanup()
+{
+    m_stream->stop();
+    delete m_stream;
+    delete m_bridge;
+    delete m_fakeBridge;
+    m_light.reset();
+}
+
+void TestHueEventStream::connectStream()
+{
+    QSignalSpy connected(m_stream, &HueEventStream::connected);
+
+    m_stream->start();
+    QTRY_COMPARE(connected.count(), 1);
+    QVERIFY(m_stream->isConnected());
+    QTRY_COMPARE(m_fakeBridge->eventStreamCount(), 1);
+}
+
+void TestHueEventStream::defaults()
+{
+    HueBridge bridge("10.0.1.14", "user");
+    HueEventStream stream(&bridge);
+
+    QCOMPARE(stream.getUrl(), QUrl("https://10.0.1.14/eventstream/clip/v2"));
+    QVERIFY(!stream.isInsecureConnectionAllowed());
+    QVERIFY(stream.getPinnedCertificate().isNull());
+    QVERIFY(!stream.isActive());
+    QVERIFY(!stream.isConnected());
+}
+
+void TestHueEventStream::appliesPushedUpdates()
+{
+    connectStream();
+
+    const auto requests = m_fakeBridge->requests("GET");
+    QCOMPARE(requests.size(), 1);
+    QCOMPARE(requests.first().headers.value("accept"), QByteArray("text/event-stream"));
+    QCOMPARE(requests.first().headers.value("hue-application-key"), QByteArray("testuser"));
+
+    m_fakeBridge->pushEvent(lightUpdate(3, "\"on\":{\"on\":false},"
+                                           "\"dimming\":{\"brightness\":50.0},"
+                                           "\"color_temperature\":{\"mirek\":250}"));
+
+    QTRY_COMPARE(m_stream->eventsApplied(), 1);
+    QCOMPARE(m_stream->eventsReceived(), 1);
+
+    const HueStateChange state = m_light->currentState();
+    QVERIFY(state.has(HueStateChange::OnAttribute));
+    QVERIFY(!state.isOn());
+    QCOMPARE(state.getBrightness(), 127);
+    QCOMPARE(state.getColorTemp(), 250);
+}
+
+void TestHueEventStream::ignoresUnregisteredObjects()
+{
+    connectStream();
+
+    m_fakeBridge->pushEvent(lightUpdate(4, "\"on\":{\"on\":true}"));
+    m_fakeBridge->pushEvent(lightUpdate(3, "\"on\":{\"on\":true}"));
+
+    QTRY_COMPARE(m_stream->eventsReceived(), 2);
+    QCOMPARE(m_stream->eventsApplied(), 1);
+}
+
+void TestHueEventStream::eventSplitAcrossWrites()
+{
+    connectStream();
+
+    const QByteArray event = "data: " + lightUpdate(3, "\"color\":{\"xy\":{\"x\":0.25,\"y\":0.5}}") + "\n\n";
+    const int half = event.size() / 2;
+
+    m_fakeBridge->pushRaw(event.left(half));
+    QTest::qWait(50);
+    QCOMPARE(m_stream->eventsReceived(), 0);
+
+    m_fakeBridge->pushRaw(event.mid(half));
+    QTRY_COMPARE(m_stream->eventsApplied(), 1);
+    QCOMPARE(m_light->currentState().getXValue(), 0.25);
+    QCOMPARE(m_light->currentState().getYValue(), 0.5);
+}
+
+void TestHueEventStream::commentsAndCarriageReturns()
+{
+    connectStream();
+
+    m_fakeBridge->pushRaw(": keep-alive\r\n\r\n");
+    m_fakeBridge->pushRaw("data: " + lightUpdate(3, "\"on\":{\"on\":true}") + "\r\n\r\n");
+
+    QTRY_COMPARE(m_stream->eventsApplied(), 1);
+    QCOMPARE(m_stream->eventsReceived(), 1);
+}
+
+void TestHueEventStream::multiLineData()
+{
+    connectStream();
+
+    // Data lines of one event are joined with newlines, which JSON allows between tokens
+    m_fakeBridge->pushRaw("data: [{\"type\":\"update\",\n"
+                          "data: \"data\":[{\"id_v1\":\"/lights/3\",\"on\":{\"on\":true}}]}]\n\n");
+
+    QTRY_COMPARE(m_stream->eventsApplied(), 1);
+}
+
+void TestHueEventStream::reconnectsWithLastEventID()
+{
+    connectStream();
+    QSignalSpy disconnected(m_stream, &HueEventStream::disconnected);
+    const int synchronized = m_light->synchronizeCount();
+
+    m_fakeBridge->pushEvent(lightUpdate(3, "\"on\":{\"on\":true}"), "1700000000:0");
+    QTRY_COMPARE(m_stream->eventsApplied(), 1);
+
+    m_fakeBridge->clearRequests();
+    m_fakeBridge->closeEventStreams();
+    QTRY_COMPARE(disconnected.count(), 1);
+    QVERIFY(!m_stream->isConnected());
+
+    // The first reconnect is attempted after one second
+    QTRY_VERIFY_WITH_TIMEOUT(m_stream->isConnected(), 5000);
+
+    const auto requests = m_fakeBridge->requests("GET");
+    QCOMPARE(requests.size(), 1);
+    QCOMPARE(requests.first().headers.value("last-event-id"), QByteArray("1700000000:0"));
+
+    // Events may have been missed, so everything is synchronized once
+    QTRY_VERIFY(m_light->synchronizeCount() > synchronized);
+}
+
+void TestHueEventStream::pollsWhileStreamIsUnavailable()
+{
+    m_fakeBridge->setEventStreamPath(QString());
+    m_stream->setFallbackPollInterval(50);
+    m_stream->start();
+
+    QTRY_VERIFY(m_light->synchronizeCount() >= 2);
+    QVERIFY(!m_stream->isConnected());
+}
+
+QTEST_GUILESS_MAIN(TestHueEventStream)
+
+#include "tst_hueeventstream.moc"
@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_hueinventorytreemodel
+
+SOURCES += tst_hueinventorytreemodel.cpp
@@ -0,0 +1,285 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSignalSpy>
+#include <memory>
+
+#include "fakebridge.h"
+#include "fixtures.h"
+#include "huebridge.h"
+#include "huechangenotifier.h"
+#include "huegroup.h"
+#include "huelight.h"
+#include "Models/hueinventorytreemodel.h"
+
+namespace {
+
+const int BrightnessRow = 3;
+
+}
+
+// The stand-in reports lights 1 - 5 and rooms of lights 1 - 2 and 3 - 4, so
+// light 5 is listed under "Other lights".
+class TestHueInventoryTreeModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void bridgeRowsOnly();
+    void fetchGroups();
+    void fetchLightsAndAttributes();
+    void fetchInsertsOnce();
+    void release();
+    void getObject();
+    void followsLightChanges();
+    void followsGroupMembers();
+    void removeBridge();
+
+private:
+    QModelIndex bridgeIndex() const;
+    QModelIndex fetched(const int row, const QModelIndex& parent);
+
+private:
+    FakeBridge* m_fakeBridge;
+    HueBridge* m_bridge;
+    std::shared_ptr<HueLightList> m_lights;
+    std::shared_ptr<HueGroupList> m_groups;
+    HueInventoryTreeModel* m_model;
+};
+
+void TestHueInventoryTreeModel::init()
+{
+    m_fakeBridge = new FakeBridge(this);
+    QVERIFY(m_fakeBridge->listen());
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("lights"), Fixtures::lights(5));
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("groups"), Fixtures::groups(2, 2));
+
+    m_bridge = new HueBridge(m_fakeBridge->getAddress(), m_fakeBridge->getUsername());
+    m_lights = std::make_shared<HueLightList>(HueLight::discoverLights(m_bridge));
+    m_groups = std::make_shared<HueGroupList>(HueGroup::discoverGroups(m_bridge));
+    QCOMPARE(m_lights->size(), 5);
+    QCOMPARE(m_groups->size(), 2);
+
+    m_model = new HueInventoryTreeModel;
+    m_model->addBridge(m_bridge, m_groups, m_lights);
+    HueChangeNotifier::instance().flush();
+}
+
+void TestHueInventoryTreeModel::cleanup()
+{
+    delete m_model;
+    m_groups.reset();
+    m_lights.reset();
+    delete m_bridge;
+    delete m_fakeBridge;
+}
+
+QModelIndex TestHueInventoryTreeModel::bridgeIndex() const
+{
+    return m_model->index(0, 0, QModelIndex());
+}
+
+// Fetches the children of a row, the way a view does when it is expanded
+QModelIndex TestHueInventoryTreeModel::fetched(const int row, const QModelIndex& parent)
+{
+    const QModelIndex index = m_model->index(row, 0, parent);
+
+    if (m_model->canFetchMore(index))
+        m_model->fetchMore(index);
+
+    return index;
+}
+
+void TestHueInventoryTreeModel::bridgeRowsOnly()
+{
+    QCOMPARE(m_model->bridgeCount(), 1);
+    QCOMPARE(m_model->rowCount(), 1);
+    QVERIFY(m_model->hasChildren());
+    QVERIFY(!m_model->canFetchMore(QModelIndex()));
+
+    const QModelIndex bridge = bridgeIndex();
+    QCOMPARE(m_model->data(bridge).toString(), m_bridge->getIP());
+    QCOMPARE(m_model->data(m_model->index(0, 1, QModelIndex())).toString(), QString("2 groups, 5 lights"));
+
+    // Nothing below the bridge exists until it is expanded
+    QCOMPARE(m_model->rowCount(bridge), 0);
+    QVERIFY(m_model->hasChildren(bridge));
+    QVERIFY(m_model->canFetchMore(bridge));
+}
+
+void TestHueInventoryTreeModel::fetchGroups()
+{
+    const QModelIndex bridge = fetched(0, QModelIndex());
+
+    QVERIFY(!m_model->canFetchMore(bridge));
+    QCOMPARE(m_model->rowCount(bridge), 3);
+    QCOMPARE(m_model->data(m_model->index(0, 0, bridge)).toString(), QString("Room 1"));
+    QCOMPARE(m_model->data(m_model->index(1, 0, bridge)).toString(), QString("Room 2"));
+    QCOMPARE(m_model->data(m_model->index(2, 0, bridge)).toString(), QString("Other lights"));
+    QCOMPARE(m_model->data(m_model->index(2, 1, bridge)).toInt(), 1);
+
+    // The rooms are still collapsed
+    const QModelIndex room = m_model->index(0, 0, bridge);
+    QCOMPARE(m_model->rowCount(room), 0);
+    QVERIFY(m_model->hasChildren(room));
+    QVERIFY(m_model->canFetchMore(room));
+}
+
+void TestHueInventoryTreeModel::fetchLightsAndAttributes()
+{
+    const QModelIndex bridge = fetched(0, QModelIndex());
+    const QModelIndex room = fetched(1, bridge);
+    const QModelIndex other = fetched(2, bridge);
+
+    QCOMPARE(m_model->rowCount(room), 2);
+    QCOMPARE(m_model->data(m_model->index(0, 0, room)).toString(), QString("Hue color lamp 3"));
+    QCOMPARE(m_model->data(m_model->index(1, 0, room)).toString(), QString("Hue color lamp 4"));
+    QVERIFY(m_model->data(m_model->index(0, 1, room)).toBool());
+
+    QCOMPARE(m_model->rowCount(other), 1);
+    QCOMPARE(m_model->data(m_model->index(0, 0, other)).toString(), QString("Hue color lamp 5"));
+
+    const QModelIndex light = fetched(0, room);
+    QCOMPARE(m_model->rowCount(light), 9);
+    QCOMPARE(m_model->data(m_model->index(0, 1, light)).toInt(), 3);
+    QCOMPARE(m_model->data(m_model->index(BrightnessRow, 0, light)).toString(), QString("Brightness"));
+    QCOMPARE(m_model->data(m_model->index(BrightnessRow, 1, light)).toInt(), 4);
+
+    // Attribute rows are leaves
+    const QModelIndex attribute = m_model->index(BrightnessRow, 0, light);
+    QVERIFY(!m_model->hasChildren(attribute));
+    QVERIFY(!m_model->canFetchMore(attribute));
+}
+
+void TestHueInventoryTreeModel::fetchInsertsOnce()
+{
+    QSignalSpy inserted(m_model, &QAbstractItemModel::rowsInserted);
+    const QModelIndex bridge = bridgeIndex();
+
+    m_model->fetchMore(bridge);
+
+    // One insertion for the groups, one for the "Other lights" row
+    QCOMPARE(inserted.count(), 2);
+    QCOMPARE(inserted.first().at(1).toInt(), 0);
+    QCOMPARE(inserted.first().at(2).toInt(), 1);
+
+    m_model->fetchMore(bridge);
+    QCOMPARE(inserted.count(), 2);
+    QCOMPARE(m_model->rowCount(bridge), 3);
+}
+
+void TestHueInventoryTreeModel::release()
+{
+    const QModelIndex bridge = fetched(0, QModelIndex());
+    const QModelIndex room = fetched(0, bridge);
+    fetched(0, room);
+
+    QSignalSpy removed(m_model, &QAbstractItemModel::rowsRemoved);
+
+    // Releasing a group drops its lights and their attributes
+    m_model->release(room);
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(m_model->rowCount(room), 0);
+    QVERIFY(m_model->canFetchMore(room));
+    QVERIFY(m_model->hasChildren(room));
+
+    m_model->release(room);
+    QCOMPARE(removed.count(), 1);
+
+    // It can be expanded again
+    m_model->fetchMore(room);
+    QCOMPARE(m_model->rowCount(room), 2);
+
+    m_model->release(bridge);
+    QCOMPARE(m_model->rowCount(bridge), 0);
+    QVERIFY(m_model->canFetchMore(bridge));
+}
+
+void TestHueInventoryTreeModel::getObject()
+{
+    const QModelIndex bridge = fetched(0, QModelIndex());
+    const QModelIndex room = fetched(0, bridge);
+
+    QVERIFY(m_model->getObject(bridge) == nullptr);
+    QVERIFY(m_model->getObject(m_model->index(2, 0, bridge)) == nullptr);
+    QVERIFY(m_model->getObject(room) == m_groups->fetch(1));
+    QVERIFY(m_model->getObject(m_model->index(1, 0, room)) == m_lights->fetch(2));
+    QVERIFY(m_model->getObject(QModelIndex()) == nullptr);
+}
+
+void TestHueInventoryTreeModel::followsLightChanges()
+{
+    const QJsonArray accepted {QJsonObject{{"success", QJsonObject{{"/lights/1/state/bri", 200}}}}};
+    m_fakeBridge->setReply("PUT", m_fakeBridge->apiPath("lights/1/state"), QJsonDocument(accepted).toJson());
+
+    const QModelIndex bridge = fetched(0, QModelIndex());
+    const QModelIndex room = fetched(0, bridge);
+    const QModelIndex light = fetched(0, room);
+
+    QSignalSpy changed(m_model, &QAbstractItemModel::dataChanged);
+
+    QVERIFY(m_lights->fetch(1)->setBrightness(200));
+    HueChangeNotifier::instance().flush();
+
+    QVERIFY(changed.count() > 0);
+    QCOMPARE(m_model->data(m_model->index(BrightnessRow, 1, light)).toInt(), 200);
+
+    // A released light is no longer updated
+    m_model->release(room);
+    changed.clear();
+
+    QVERIFY(m_lights->fetch(1)->setBrightness(200));
+    HueChangeNotifier::instance().flush();
+    QCOMPARE(changed.count(), 0);
+}
+
+void TestHueInventoryTreeModel::followsGroupMembers()
+{
+    const QModelIndex bridge = fetched(0, QModelIndex());
+    const QModelIndex room = fetched(0, bridge);
+    QCOMPARE(m_model->rowCount(room), 2);
+
+    // Light 5 joins room 1
+    QJsonObject json = Fixtures::groupJson(1, 1, 2);
+    json["lights"] = QJsonArray{"1", "2", "5"};
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("groups/1"), QJsonDocument(json).toJson());
+
+    QVERIFY(m_groups->fetch(1)->synchronize());
+    HueChangeNotifier::instance().flush();
+
+    QCOMPARE(m_model->rowCount(room), 3);
+    QCOMPARE(m_model->data(m_model->index(2, 0, room)).toString(), QString("Hue color lamp 5"));
+    QVERIFY(m_model->getObject(m_model->index(2, 0, room)) == m_lights->fetch(5));
+}
+
+void TestHueInventoryTreeModel::removeBridge()
+{
+    const QModelIndex bridge = fetched(0, QModelIndex());
+    fetched(0, bridge);
+
+    QVERIFY(m_model->removeBridge(m_bridge));
+    QCOMPARE(m_model->bridgeCount(), 0);
+    QCOMPARE(m_model->rowCount(), 0);
+    QVERIFY(!m_model->hasChildren());
+    QVERIFY(!m_model->removeBridge(m_bridge));
+
+    // Changes of objects that are no longer shown are ignored
+    const QJsonArray accepted {QJsonObject{{"success", QJsonObject{{"/lights/1/state/bri", 200}}}}};
+    m_fakeBridge->setReply("PUT", m_fakeBridge->apiPath("lights/1/state"), QJsonDocument(accepted).toJson());
+
+    QSignalSpy changed(m_model, &QAbstractItemModel::dataChanged);
+    QVERIFY(m_lights->fetch(1)->setBrightness(200));
+    HueChangeNotifier::instance().flush();
+    QCOMPARE(changed.count(), 0);
+
+    m_model->addBridge(m_bridge, m_groups, m_lights);
+    QCOMPARE(m_model->rowCount(), 1);
+    QVERIFY(m_model->canFetchMore(bridgeIndex()));
+}
+
+QTEST_GUILESS_MAIN(TestHueInventoryTreeModel)
+
+#include "tst_hueinventorytreemodel.moc"
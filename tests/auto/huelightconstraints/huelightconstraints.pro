@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_huelightconstraints
+
+SOURCES += tst_huelightconstraints.cpp
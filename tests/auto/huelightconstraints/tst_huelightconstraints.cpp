@@ -0,0 +1,242 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <memory>
+
+#include "fakebridge.h"
+#include "fixtures.h"
+#include "huebridge.h"
+#include "huecolor.h"
+#include "huelight.h"
+#include "huestatechange.h"
+
+namespace {
+
+enum LightID {
+    OnOffLight = 1,
+    DimmableLight,
+    ColorTempLight,
+    ColorLight,
+    ExtendedColorLight,
+    UnknownLight
+};
+
+// A fixture light with another type. Lights without color report no gamut, and the
+// color temperature light has a narrower range than the default 153 - 500 mired.
+QJsonObject lightOfType(const int ID, const QString& type)
+{
+    QJsonObject light = Fixtures::lightJson(ID, 100);
+    light.insert("type", type);
+
+    if (ID == OnOffLight || ID == DimmableLight || ID == ColorTempLight) {
+        QJsonObject capabilities = light.value("capabilities").toObject();
+        QJsonObject control = capabilities.value("control").toObject();
+
+        control.remove("colorgamuttype");
+        control.remove("colorgamut");
+        control.insert("ct", QJsonObject{{"min", 153}, {"max", 454}});
+
+        capabilities.insert("control", control);
+        light.insert("capabilities", capabilities);
+    }
+
+    return light;
+}
+
+// Every attribute, with values that no light shows unchanged
+HueStateChange everything()
+{
+    HueStateChange change;
+    change.setOn(false);
+    change.setBrightness(300);
+    change.setHue(70000);
+    change.setSaturation(200);
+    change.setColorTemp(480);
+    change.setXY(0.1, 0.8);
+    change.setAlert(HueAbstractObject::BreatheSingle);
+    change.setEffect(HueAbstractObject::ColorLoop);
+
+    return change;
+}
+
+}
+
+// The stand-in reports one light per control type, IDs as in LightID. Each test
+// sends a change through HueAbstractObject::setState() and checks what reached
+// the bridge after HueLight::constrainState().
+class TestHueLightConstraints : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void onOffLight();
+    void dimmableLight();
+    void colorTempLight();
+    void colorLight();
+    void extendedColorLight();
+    void unknownLightPassesEverything();
+
+private:
+    QJsonObject sent(const int ID, const HueStateChange& change);
+
+private:
+    FakeBridge* m_fakeBridge;
+    HueBridge* m_bridge;
+    HueLightList m_lights;
+};
+
+void TestHueLightConstraints::initTestCase()
+{
+    const QJsonObject lights {
+        {"1", lightOfType(OnOffLight, "On/Off plug-in unit")},
+        {"2", lightOfType(DimmableLight, "Dimmable light")},
+        {"3", lightOfType(ColorTempLight, "Color temperature light")},
+        {"4", lightOfType(ColorLight, "Color light")},
+        {"5", lightOfType(ExtendedColorLight, "Extended color light")},
+        {"6", lightOfType(UnknownLight, "Prototype light")}
+    };
+
+    m_fakeBridge = new FakeBridge(this);
+    QVERIFY(m_fakeBridge->listen());
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("lights"), QJsonDocument(lights).toJson());
+
+    for (int ID = OnOffLight; ID <= UnknownLight; ID++) {
+        const QString resource = "lights/" + QString::number(ID) + "/state";
+        const QJsonArray reply {QJsonObject{{"success", QJsonObject{{"/" + resource, true}}}}};
+        m_fakeBridge->setReply("PUT", m_fakeBridge->apiPath(resource), QJsonDocument(reply).toJson());
+    }
+
+    m_bridge = new HueBridge(m_fakeBridge->getAddress(), m_fakeBridge->getUsername());
+    m_lights = HueLight::discoverLights(m_bridge);
+    QCOMPARE(m_lights.size(), 6);
+
+    QCOMPARE(m_lights.fetch(OnOffLight)->capabilities().getControlType(), Light::Capabilities::OnOffControl);
+    QCOMPARE(m_lights.fetch(UnknownLight)->capabilities().getControlType(), Light::Capabilities::UnknownControl);
+}
+
+void TestHueLightConstraints::cleanupTestCase()
+{
+    m_lights = HueLightList();
+    delete m_bridge;
+    delete m_fakeBridge;
+}
+
+void TestHueLightConstraints::init()
+{
+    m_fakeBridge->clearRequests();
+}
+
+QJsonObject TestHueLightConstraints::sent(const int ID, const HueStateChange& change)
+{
+    if (!m_lights.fetch(ID)->setState(change))
+        return QJsonObject();
+
+    const auto requests = m_fakeBridge->requests("PUT");
+    if (requests.size() != 1)
+        return QJsonObject();
+
+    return QJsonDocument::fromJson(requests.first().body).object();
+}
+
+void TestHueLightConstraints::onOffLight()
+{
+    const QJsonObject body = sent(OnOffLight, everything());
+    QCOMPARE(body, (QJsonObject{{"on", false}, {"alert", "select"}}));
+
+    // Nothing left to send
+    m_fakeBridge->clearRequests();
+    HueStateChange brightness;
+    brightness.setBrightness(100);
+
+    QVERIFY(!m_lights.fetch(OnOffLight)->setState(brightness));
+    QVERIFY(m_fakeBridge->requests("PUT").isEmpty());
+}
+
+void TestHueLightConstraints::dimmableLight()
+{
+    const QJsonObject body = sent(DimmableLight, everything());
+    QCOMPARE(body, (QJsonObject{{"on", false}, {"bri", 254}, {"alert", "select"}}));
+}
+
+void TestHueLightConstraints::colorTempLight()
+{
+    // Clamped to the range of the light rather than of the bridge
+    QJsonObject body = sent(ColorTempLight, everything());
+    QCOMPARE(body, (QJsonObject{{"on", false}, {"bri", 254}, {"ct", 454}, {"alert", "select"}}));
+
+    // xy alone is shown as the closest color temperature
+    m_fakeBridge->clearRequests();
+    HueStateChange xy;
+    xy.setXY(0.4573, 0.41);
+
+    const float x = 0.4573f;
+    const float y = 0.41f;
+    float mired = 0.0f;
+    HueColor::xyToMired(&x, &y, &mired, 1);
+
+    body = sent(ColorTempLight, xy);
+    QCOMPARE(body, (QJsonObject{{"ct", qBound(153, qRound(mired), 454)}}));
+}
+
+void TestHueLightConstraints::colorLight()
+{
+    const HueColor::Triangle gamut = m_lights.fetch(ColorLight)->capabilities().getColorGamut();
+    float x = 0.1f;
+    float y = 0.8f;
+    HueColor::clampToTriangle(gamut, &x, &y, 1);
+
+    // xy is sent and wins over the color temperature, clamped into the gamut
+    QJsonObject body = sent(ColorLight, everything());
+    QCOMPARE(body.keys(), (QStringList{"alert", "bri", "effect", "hue", "on", "sat", "xy"}));
+    QCOMPARE(body.value("hue").toInt(), 65535);
+    QCOMPARE(body.value("xy").toArray().at(0).toDouble(), static_cast<double>(x));
+    QCOMPARE(body.value("xy").toArray().at(1).toDouble(), static_cast<double>(y));
+
+    // A color temperature alone is shown as the matching xy
+    m_fakeBridge->clearRequests();
+    HueStateChange colorTemp;
+    colorTemp.setColorTemp(366);
+
+    const float mired = 366.0f;
+    HueColor::miredToXY(&mired, &x, &y, 1);
+
+    body = sent(ColorLight, colorTemp);
+    QCOMPARE(body.keys(), QStringList{"xy"});
+    QCOMPARE(body.value("xy").toArray().at(0).toDouble(), static_cast<double>(x));
+    QCOMPARE(body.value("xy").toArray().at(1).toDouble(), static_cast<double>(y));
+}
+
+void TestHueLightConstraints::extendedColorLight()
+{
+    const HueColor::Triangle gamut = m_lights.fetch(ExtendedColorLight)->capabilities().getColorGamut();
+    float x = 0.1f;
+    float y = 0.8f;
+    HueColor::clampToTriangle(gamut, &x, &y, 1);
+
+    const QJsonObject body = sent(ExtendedColorLight, everything());
+    QCOMPARE(body.keys(), (QStringList{"alert", "bri", "ct", "effect", "hue", "on", "sat", "xy"}));
+    QCOMPARE(body.value("ct").toInt(), 480);
+    QCOMPARE(body.value("xy").toArray().at(0).toDouble(), static_cast<double>(x));
+    QCOMPARE(body.value("xy").toArray().at(1).toDouble(), static_cast<double>(y));
+}
+
+void TestHueLightConstraints::unknownLightPassesEverything()
+{
+    // Only the range of the bridge applies; no attribute is removed or converted
+    HueStateChange change = everything();
+    change.setXY(0.4573, 0.41);
+
+    const QJsonObject body = sent(UnknownLight, change);
+    QCOMPARE(body, (QJsonObject{{"on", false}, {"bri", 254}, {"hue", 65535}, {"sat", 200},
+                                {"ct", 480}, {"xy", QJsonArray{0.4573, 0.41}},
+                                {"alert", "select"}, {"effect", "colorloop"}}));
+}
+
+QTEST_GUILESS_MAIN(TestHueLightConstraints)
+
+#include "tst_huelightconstraints.moc"
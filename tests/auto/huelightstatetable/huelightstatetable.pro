@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_huelightstatetable
+
+SOURCES += tst_huelightstatetable.cpp
@@ -0,0 +1,173 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <vector>
+
+#include "fakebridge.h"
+#include "fixtures.h"
+#include "huebridge.h"
+#include "huelight.h"
+#include "huelightstatetable.h"
+
+namespace {
+
+const int firstID = 60;
+const int lightCount = 11;
+
+std::vector<int> rowsOf(const HueLightStateTable& table, const std::vector<int>& lightIDs)
+{
+    std::vector<int> rows;
+
+    for (const int ID : lightIDs)
+        rows.push_back(table.rowOf(ID));
+
+    return rows;
+}
+
+}
+
+// The stand-in reports lights 60 - 70, all on, with brightness 61 - 71 and hues
+// of 1000 times the ID, so lights 66 - 70 have wrapped around to 464 - 4464.
+class TestHueLightStateTable : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void rowOf();
+    void selectRange();
+    void selectRangeWrapsAround();
+    void selectWithFilter();
+    void unchangedRowsAreLeftOut();
+    void applySendsOnlyChanges();
+
+private:
+    FakeBridge* m_fakeBridge;
+    HueBridge* m_bridge;
+    HueLightList m_lights;
+};
+
+void TestHueLightStateTable::init()
+{
+    m_fakeBridge = new FakeBridge(this);
+    QVERIFY(m_fakeBridge->listen());
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("lights"), Fixtures::lights(lightCount, firstID));
+
+    for (int ID = firstID; ID < firstID + lightCount; ID++) {
+        const QString resource = "lights/" + QString::number(ID) + "/state";
+        const QJsonArray reply {QJsonObject{{"success", QJsonObject{{"/" + resource, true}}}}};
+        m_fakeBridge->setReply("PUT", m_fakeBridge->apiPath(resource), QJsonDocument(reply).toJson());
+    }
+
+    m_bridge = new HueBridge(m_fakeBridge->getAddress(), m_fakeBridge->getUsername());
+    m_lights = HueLight::discoverLights(m_bridge);
+    QCOMPARE(m_lights.size(), lightCount);
+}
+
+void TestHueLightStateTable::cleanup()
+{
+    m_lights = HueLightList();
+    delete m_bridge;
+    delete m_fakeBridge;
+}
+
+void TestHueLightStateTable::rowOf()
+{
+    HueLightStateTable table(m_lights);
+    QCOMPARE(table.rowCount(), lightCount);
+
+    for (int row = 0; row < table.rowCount(); row++)
+        QCOMPARE(table.rowOf(table.light(row)->ID()), row);
+
+    QCOMPARE(table.rowOf(1), -1);
+
+    table.setLights(HueLightList());
+    QCOMPARE(table.rowOf(firstID), -1);
+}
+
+void TestHueLightStateTable::selectRange()
+{
+    const HueLightStateTable table(m_lights);
+
+    QCOMPARE(table.select(HueLightStateTable::BrightnessColumn, 62, 64), rowsOf(table, {61, 62, 63}));
+    QCOMPARE(table.select(HueLightStateTable::HueColumn, 64000, 65000), rowsOf(table, {64, 65}));
+    QVERIFY(table.select(HueLightStateTable::ColorTempColumn, 153, 365).empty());
+    QCOMPARE(table.select(HueLightStateTable::ColorTempColumn, 366, 366).size(), size_t(lightCount));
+}
+
+void TestHueLightStateTable::selectRangeWrapsAround()
+{
+    const HueLightStateTable table(m_lights);
+
+    // Hues on both sides of red
+    QCOMPARE(table.select(HueLightStateTable::HueColumn, 63000, 2500),
+             rowsOf(table, {63, 64, 65, 66, 67, 68}));
+
+    // The bounds are inclusive on both sides
+    QCOMPARE(table.select(HueLightStateTable::HueColumn, 65000, 464), rowsOf(table, {65, 66}));
+}
+
+void TestHueLightStateTable::selectWithFilter()
+{
+    const HueLightStateTable table(m_lights);
+    QVERIFY(m_lights.fetch(64)->turnOff());
+    QVERIFY(!table.isOn(table.rowOf(64)));
+
+    QCOMPARE(table.select(HueLightStateTable::HueColumn, 63000, 2500, HueLightStateTable::OnFilter),
+             rowsOf(table, {63, 65, 66, 67, 68}));
+    QCOMPARE(table.select(HueLightStateTable::OffFilter), rowsOf(table, {64}));
+    QCOMPARE(table.select(HueLightStateTable::OnFilter | HueLightStateTable::OffFilter).size(), size_t(0));
+}
+
+void TestHueLightStateTable::unchangedRowsAreLeftOut()
+{
+    const HueLightStateTable table(m_lights);
+    const std::vector<int> all = table.select(HueLightStateTable::NoFilter);
+
+    QVERIFY(table.setOn(all, true).empty());
+    QVERIFY(table.scaleBrightness(all, 1.0).empty());
+    QVERIFY(table.setColorTemp(all, 366).empty());
+    QVERIFY(table.shiftHue(all, 65536).empty());
+
+    QCOMPARE(table.setOn(all, false).size(), size_t(lightCount));
+
+    // Only the light whose brightness moves by at least one step
+    const HueLightStateTable::ChangeSet scaled = table.scaleBrightness(rowsOf(table, {60, 70}), 1.008);
+    QCOMPARE(scaled.size(), size_t(1));
+    QCOMPARE(scaled.front().first, table.rowOf(70));
+    QCOMPARE(scaled.front().second.getBrightness(), 72);
+}
+
+void TestHueLightStateTable::applySendsOnlyChanges()
+{
+    const HueLightStateTable table(m_lights);
+    QVERIFY(m_lights.fetch(61)->setColorTemp(300));
+    m_fakeBridge->clearRequests();
+
+    const std::vector<int> all = table.select(HueLightStateTable::NoFilter);
+    QCOMPARE(table.apply(table.setColorTemp(all, 300), 5), lightCount - 1);
+
+    const auto requests = m_fakeBridge->requests("PUT");
+    QCOMPARE(requests.size(), lightCount - 1);
+
+    for (const auto& request : requests) {
+        QVERIFY(request.path != m_fakeBridge->apiPath("lights/61/state"));
+        QCOMPARE(QJsonDocument::fromJson(request.body).object(),
+                 (QJsonObject{{"ct", 300}, {"transitiontime", 5}}));
+    }
+
+    // The table follows the lights, so there is nothing left to change
+    QCOMPARE(table.select(HueLightStateTable::ColorTempColumn, 300, 300).size(), size_t(lightCount));
+    QVERIFY(table.setColorTemp(all, 300).empty());
+
+    m_fakeBridge->clearRequests();
+    QCOMPARE(table.apply(HueLightStateTable::ChangeSet()), 0);
+    QVERIFY(m_fakeBridge->requests("PUT").isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestHueLightStateTable)
+
+#include "tst_huelightstatetable.moc"
@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_huemembershipindex
+
+SOURCES += tst_huemembershipindex.cpp
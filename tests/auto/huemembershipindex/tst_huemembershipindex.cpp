@@ -0,0 +1,198 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSignalSpy>
+#include <vector>
+
+#include "fakebridge.h"
+#include "fixtures.h"
+#include "huebridge.h"
+#include "huechangenotifier.h"
+#include "huegroup.h"
+#include "huemembershipindex.h"
+
+namespace {
+
+QJsonObject groupJson(const int ID, const std::vector<int>& lights)
+{
+    QJsonArray members;
+    for (const int light : lights)
+        members.append(QString::number(light));
+
+    QJsonObject json = Fixtures::groupJson(ID, 1, 0);
+    json["lights"] = members;
+    return json;
+}
+
+}
+
+// Groups 1 - 5 as a bridge would report them: a room of four lights, two zones
+// inside and across it, a pair elsewhere, and one group of nine lights.
+class TestHueMembershipIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void lookups();
+    void groupsContainingAndWithin();
+    void exactGroup();
+    void coverWithExactGroup();
+    void coverGreedily();
+    void coverReportsUncoveredLights();
+    void removeGroup();
+    void followsSynchronizedGroups();
+
+private:
+    FakeBridge* m_fakeBridge;
+    HueBridge* m_bridge;
+    HueGroupList m_groups;
+};
+
+void TestHueMembershipIndex::init()
+{
+    m_fakeBridge = new FakeBridge(this);
+    QVERIFY(m_fakeBridge->listen());
+
+    const QJsonObject reply {
+        {"1", groupJson(1, {1, 2, 3, 4})},
+        {"2", groupJson(2, {1, 2})},
+        {"3", groupJson(3, {3, 4, 5})},
+        {"4", groupJson(4, {6, 7})},
+        {"5", groupJson(5, {1, 2, 3, 4, 5, 6, 7, 8, 9})}
+    };
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("groups"), QJsonDocument(reply).toJson());
+
+    m_bridge = new HueBridge(m_fakeBridge->getAddress(), m_fakeBridge->getUsername());
+    m_groups = HueGroup::discoverGroups(m_bridge);
+    QCOMPARE(m_groups.size(), 5);
+}
+
+void TestHueMembershipIndex::cleanup()
+{
+    m_groups = HueGroupList();
+    delete m_bridge;
+    delete m_fakeBridge;
+}
+
+void TestHueMembershipIndex::lookups()
+{
+    const HueMembershipIndex index(m_groups);
+
+    QVERIFY(index.getGroups() == HueBitset({1, 2, 3, 4, 5}));
+    QVERIFY(index.lightsOf(3) == HueBitset({3, 4, 5}));
+    QVERIFY(index.groupsOf(1) == HueBitset({1, 2, 5}));
+    QVERIFY(index.groupsOf(10).isEmpty());
+    QVERIFY(index.contains(4, 7));
+    QVERIFY(!index.contains(4, 5));
+    QVERIFY(!index.contains(6, 1));
+}
+
+void TestHueMembershipIndex::groupsContainingAndWithin()
+{
+    const HueMembershipIndex index(m_groups);
+
+    QVERIFY(index.groupsContaining({1, 2}) == HueBitset({1, 2, 5}));
+    QVERIFY(index.groupsContaining({4, 5}) == HueBitset({3, 5}));
+    QVERIFY(index.groupsContaining({1, 10}).isEmpty());
+
+    QVERIFY(index.groupsWithin({1, 2, 3, 4}) == HueBitset({1, 2}));
+    QVERIFY(index.groupsWithin({6, 7, 8}) == HueBitset({4}));
+    QVERIFY(index.groupsWithin({1}).isEmpty());
+}
+
+void TestHueMembershipIndex::exactGroup()
+{
+    const HueMembershipIndex index(m_groups);
+
+    QCOMPARE(index.exactGroup({1, 2}), 2);
+    QCOMPARE(index.exactGroup({3, 4, 5}), 3);
+    QCOMPARE(index.exactGroup({1, 3}), -1);
+    QCOMPARE(index.exactGroup(HueBitset()), -1);
+}
+
+void TestHueMembershipIndex::coverWithExactGroup()
+{
+    const HueMembershipIndex index(m_groups);
+    HueBitset uncovered {42};
+
+    QCOMPARE(index.cover({1, 2, 3, 4}, &uncovered), std::vector<int>({1}));
+    QVERIFY(uncovered.isEmpty());
+}
+
+void TestHueMembershipIndex::coverGreedily()
+{
+    // Largest group first: 1 takes four lights, 4 two of the rest, 3 the last one
+    const HueMembershipIndex index(m_groups);
+    HueBitset uncovered;
+
+    QCOMPARE(index.cover({1, 2, 3, 4, 5, 6, 7}, &uncovered), std::vector<int>({1, 4, 3}));
+    QVERIFY(uncovered.isEmpty());
+}
+
+void TestHueMembershipIndex::coverReportsUncoveredLights()
+{
+    // Group 5 reaches past the selection, so it must not be used for light 8
+    const HueMembershipIndex index(m_groups);
+    HueBitset uncovered;
+
+    QCOMPARE(index.cover({1, 2, 8}, &uncovered), std::vector<int>({2}));
+    QVERIFY(uncovered == HueBitset({8}));
+
+    QVERIFY(index.cover({10}, &uncovered).empty());
+    QVERIFY(uncovered == HueBitset({10}));
+}
+
+void TestHueMembershipIndex::removeGroup()
+{
+    HueMembershipIndex index(m_groups);
+    QSignalSpy changed(&index, &HueMembershipIndex::membershipChanged);
+
+    index.removeGroup(2);
+
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(changed.first().at(0).toInt(), 2);
+    QVERIFY(index.getGroups() == HueBitset({1, 3, 4, 5}));
+    QVERIFY(index.lightsOf(2).isEmpty());
+    QVERIFY(index.groupsOf(1) == HueBitset({1, 5}));
+    QCOMPARE(index.exactGroup({1, 2}), -1);
+
+    index.removeGroup(2);
+    QCOMPARE(changed.count(), 1);
+}
+
+void TestHueMembershipIndex::followsSynchronizedGroups()
+{
+    HueMembershipIndex index(m_groups);
+    QSignalSpy changed(&index, &HueMembershipIndex::membershipChanged);
+    HueChangeNotifier::instance().flush();
+
+    // Light 5 moves from zone 3 into zone 2
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("groups/2"),
+                           QJsonDocument(groupJson(2, {1, 2, 5})).toJson());
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("groups/3"),
+                           QJsonDocument(groupJson(3, {3, 4})).toJson());
+
+    QVERIFY(m_groups.fetch(2)->synchronize());
+    QVERIFY(m_groups.fetch(3)->synchronize());
+    HueChangeNotifier::instance().flush();
+
+    QCOMPARE(changed.count(), 2);
+    QVERIFY(index.groupsOf(5) == HueBitset({2, 5}));
+    QVERIFY(index.lightsOf(3) == HueBitset({3, 4}));
+    QCOMPARE(index.exactGroup({1, 2, 5}), 2);
+
+    // Synchronizing without a change in members is not reported
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("groups/4"),
+                           QJsonDocument(groupJson(4, {6, 7})).toJson());
+
+    QVERIFY(m_groups.fetch(4)->synchronize());
+    HueChangeNotifier::instance().flush();
+    QCOMPARE(changed.count(), 2);
+}
+
+QTEST_GUILESS_MAIN(TestHueMembershipIndex)
+
+#include "tst_huemembershipindex.moc"
@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_hueperceptualfilter
+
+SOURCES += tst_hueperceptualfilter.cpp
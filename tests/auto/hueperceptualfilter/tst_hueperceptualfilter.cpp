@@ -0,0 +1,141 @@
+#include <QtTest>
+
+#include "hueperceptualfilter.h"
+
+class TestHuePerceptualFilter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void disabledAcceptsEverything();
+    void firstValueIsAccepted();
+    void brightnessThreshold();
+    void colorTempThreshold();
+    void xyThreshold();
+    void colorTempForgetsXY();
+    void xyForgetsColorTemp();
+    void hueSaturationForgetsColors();
+    void resetForgetsEverything();
+    void deltaEIsSymmetric();
+};
+
+void TestHuePerceptualFilter::disabledAcceptsEverything()
+{
+    HuePerceptualFilter filter;
+    QVERIFY(!filter.isEnabled());
+
+    filter.commitBrightness(200);
+    filter.commitXY(0.3, 0.3);
+
+    QVERIFY(filter.acceptBrightness(200));
+    QVERIFY(filter.acceptXY(0.3, 0.3));
+}
+
+void TestHuePerceptualFilter::firstValueIsAccepted()
+{
+    HuePerceptualFilter filter;
+    filter.setEnabled(true);
+
+    QVERIFY(filter.acceptBrightness(200));
+    QVERIFY(filter.acceptColorTemp(300));
+    QVERIFY(filter.acceptXY(0.3, 0.3));
+}
+
+void TestHuePerceptualFilter::brightnessThreshold()
+{
+    HuePerceptualFilter filter;
+    filter.setEnabled(true);
+    filter.setColorThreshold(2.0);
+    filter.commitBrightness(200);
+
+    QVERIFY(!filter.acceptBrightness(200));
+    QVERIFY(!filter.acceptBrightness(201));
+    QVERIFY(filter.acceptBrightness(150));
+}
+
+void TestHuePerceptualFilter::colorTempThreshold()
+{
+    HuePerceptualFilter filter;
+    filter.setEnabled(true);
+    filter.setColorTempThreshold(5);
+    filter.commitColorTemp(300);
+
+    QVERIFY(!filter.acceptColorTemp(304));
+    QVERIFY(!filter.acceptColorTemp(296));
+    QVERIFY(filter.acceptColorTemp(305));
+    QVERIFY(filter.acceptColorTemp(295));
+}
+
+void TestHuePerceptualFilter::xyThreshold()
+{
+    HuePerceptualFilter filter;
+    filter.setEnabled(true);
+    filter.commitXY(0.3, 0.3);
+
+    QVERIFY(!filter.acceptXY(0.3, 0.3));
+    QVERIFY(!filter.acceptXY(0.3001, 0.3));
+    QVERIFY(filter.acceptXY(0.6, 0.3));
+}
+
+void TestHuePerceptualFilter::colorTempForgetsXY()
+{
+    // xy -> ct -> the same xy must be sent again, since the light left xy mode
+    HuePerceptualFilter filter;
+    filter.setEnabled(true);
+    filter.commitXY(0.3, 0.3);
+    filter.commitColorTemp(300);
+
+    QVERIFY(filter.acceptXY(0.3, 0.3));
+    QVERIFY(!filter.acceptColorTemp(300));
+}
+
+void TestHuePerceptualFilter::xyForgetsColorTemp()
+{
+    HuePerceptualFilter filter;
+    filter.setEnabled(true);
+    filter.commitColorTemp(300);
+    filter.commitXY(0.3, 0.3);
+
+    QVERIFY(filter.acceptColorTemp(300));
+    QVERIFY(!filter.acceptXY(0.3, 0.3));
+}
+
+void TestHuePerceptualFilter::hueSaturationForgetsColors()
+{
+    HuePerceptualFilter filter;
+    filter.setEnabled(true);
+    filter.commitBrightness(200);
+    filter.commitColorTemp(300);
+    filter.commitXY(0.3, 0.3);
+    filter.commitHueSaturation();
+
+    QVERIFY(filter.acceptColorTemp(300));
+    QVERIFY(filter.acceptXY(0.3, 0.3));
+    QVERIFY(!filter.acceptBrightness(200));
+}
+
+void TestHuePerceptualFilter::resetForgetsEverything()
+{
+    HuePerceptualFilter filter;
+    filter.setEnabled(true);
+    filter.commitBrightness(200);
+    filter.commitXY(0.3, 0.3);
+    filter.reset();
+
+    QVERIFY(filter.acceptBrightness(200));
+    QVERIFY(filter.acceptXY(0.3, 0.3));
+}
+
+void TestHuePerceptualFilter::deltaEIsSymmetric()
+{
+    const double forward = HuePerceptualFilter::deltaE(0.3, 0.3, 200, 0.5, 0.4, 100);
+    const double backward = HuePerceptualFilter::deltaE(0.5, 0.4, 100, 0.3, 0.3, 200);
+
+    QVERIFY(forward > 0.0);
+    QCOMPARE(forward, backward);
+    QCOMPARE(HuePerceptualFilter::deltaE(0.3, 0.3, 200, 0.3, 0.3, 200), 0.0);
+}
+
+QTEST_APPLESS_MAIN(TestHuePerceptualFilter)
+
+#include "tst_hueperceptualfilter.moc"
@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_huereply
+
+SOURCES += tst_huereply.cpp
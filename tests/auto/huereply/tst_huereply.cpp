@@ -0,0 +1,230 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <memory>
+
+#include "fakebridge.h"
+#include "huebridge.h"
+#include "huereply.h"
+#include "huestatechange.h"
+#include "testobject.h"
+
+namespace {
+
+QJsonObject success(const QString& address, const QJsonValue& value)
+{
+    return QJsonObject{{"success", QJsonObject{{address, value}}}};
+}
+
+QJsonObject error(const int type, const QString& address, const QString& description)
+{
+    return QJsonObject{{"error", QJsonObject{{"type", type},
+                                             {"address", address},
+                                             {"description", description}}}};
+}
+
+HueStateChange brightnessAndColorTemp(const int brightness, const int colorTemp)
+{
+    HueStateChange change;
+    change.setBrightness(brightness);
+    change.setColorTemp(colorTemp);
+    return change;
+}
+
+}
+
+class TestHueReply : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void allSucceeded();
+    void partlyRejected();
+    void allRejected();
+    void errorWithoutAttributeRejectsEverything();
+    void errorsOnlyRejectEverything();
+    void noSuccessIsInvalid();
+    void transitionTimeErrorsAreIgnored();
+    void onlyChangedAttributesAreRejected();
+    void failedRequestRejectsEverything();
+
+    void setStateAppliesAcceptedValues();
+    void optimisticUpdateRollsBackRejectedValues();
+};
+
+void TestHueReply::allSucceeded()
+{
+    HueReply reply;
+    reply.setResults(QJsonArray{success("/lights/1/state/bri", 200),
+                                success("/lights/1/state/ct", 300)});
+
+    QVERIFY(reply.isValid());
+    QVERIFY(!reply.containsError());
+    QVERIFY(reply.getErrors().isEmpty());
+    QCOMPARE(reply.getJson().value("/lights/1/state/bri").toInt(), 200);
+    QCOMPARE(reply.rejectedAttributes(brightnessAndColorTemp(200, 300)), 0);
+}
+
+void TestHueReply::partlyRejected()
+{
+    // The bridge applied the brightness; the reply is still valid
+    HueReply reply;
+    reply.setResults(QJsonArray{success("/lights/1/state/bri", 200),
+                                error(7, "/lights/1/state/ct", "invalid value, 600, for parameter, ct")});
+
+    QVERIFY(reply.isValid());
+    QVERIFY(!reply.containsError());
+    QCOMPARE(reply.getErrors().size(), 1);
+    QCOMPARE(reply.getErrors().first().getType(), 7);
+    QCOMPARE(reply.rejectedAttributes(brightnessAndColorTemp(200, 600)),
+             int(HueStateChange::ColorTempAttribute));
+}
+
+void TestHueReply::allRejected()
+{
+    HueReply reply;
+    reply.setResults(QJsonArray{error(201, "/lights/1/state/bri", "parameter, bri, is not modifiable. Device is set to off."),
+                                error(201, "/lights/1/state/ct", "parameter, ct, is not modifiable. Device is set to off.")});
+
+    QVERIFY(!reply.isValid());
+    QVERIFY(reply.containsError());
+    QCOMPARE(reply.getError().getType(), 201);
+    QCOMPARE(reply.getError().getAddress(), QString("/lights/1/state/bri"));
+    QCOMPARE(reply.getErrors().size(), 2);
+    QCOMPARE(reply.rejectedAttributes(brightnessAndColorTemp(200, 300)),
+             HueStateChange::BrightnessAttribute | HueStateChange::ColorTempAttribute);
+}
+
+void TestHueReply::errorWithoutAttributeRejectsEverything()
+{
+    HueReply reply;
+    reply.setResults(QJsonArray{error(3, "/lights/1", "resource, /lights/1, not available")});
+
+    const HueStateChange change = brightnessAndColorTemp(200, 300);
+    QCOMPARE(reply.rejectedAttributes(change), change.attributes());
+}
+
+void TestHueReply::errorsOnlyRejectEverything()
+{
+    // Nothing was applied, including the color temperature that has no result
+    HueReply reply;
+    reply.setResults(QJsonArray{error(201, "/lights/1/state/bri", "parameter, bri, is not modifiable. Device is set to off.")});
+
+    const HueStateChange change = brightnessAndColorTemp(200, 300);
+    QCOMPARE(reply.rejectedAttributes(change), change.attributes());
+}
+
+void TestHueReply::noSuccessIsInvalid()
+{
+    const HueStateChange change = brightnessAndColorTemp(200, 300);
+
+    HueReply empty;
+    empty.setResults(QJsonArray());
+    QVERIFY(!empty.isValid());
+    QVERIFY(!empty.containsError());
+    QCOMPARE(empty.rejectedAttributes(change), change.attributes());
+
+    HueReply unknown;
+    unknown.setResults(QJsonArray{QJsonObject{{"unknown", true}}});
+    QVERIFY(!unknown.isValid());
+    QCOMPARE(unknown.rejectedAttributes(change), change.attributes());
+}
+
+void TestHueReply::transitionTimeErrorsAreIgnored()
+{
+    HueReply reply;
+    reply.setResults(QJsonArray{success("/lights/1/state/bri", 200),
+                                error(7, "/lights/1/state/transitiontime", "invalid value, 70000, for parameter, transitiontime")});
+
+    HueStateChange change;
+    change.setBrightness(200);
+    change.setTransitionTime(70000);
+
+    QCOMPARE(reply.rejectedAttributes(change), 0);
+}
+
+void TestHueReply::onlyChangedAttributesAreRejected()
+{
+    HueReply reply;
+    reply.setResults(QJsonArray{error(7, "/lights/1/state/xy", "invalid value, for parameter, xy")});
+
+    QCOMPARE(reply.rejectedAttributes(brightnessAndColorTemp(200, 300)), 0);
+}
+
+void TestHueReply::failedRequestRejectsEverything()
+{
+    const HueStateChange change = brightnessAndColorTemp(200, 300);
+
+    HueReply invalid;
+    QCOMPARE(invalid.rejectedAttributes(change), change.attributes());
+
+    HueReply timedOut;
+    timedOut.isValid(true);
+    timedOut.timedOut(true);
+    QCOMPARE(timedOut.rejectedAttributes(change), change.attributes());
+}
+
+void TestHueReply::setStateAppliesAcceptedValues()
+{
+    FakeBridge fakeBridge;
+    QVERIFY(fakeBridge.listen());
+    fakeBridge.setReply("PUT", fakeBridge.apiPath("lights/1/state"),
+                        QJsonDocument(QJsonArray{success("/lights/1/state/bri", 200),
+                                                 error(7, "/lights/1/state/ct", "invalid value, 400, for parameter, ct")})
+                        .toJson());
+
+    HueBridge bridge(fakeBridge.getAddress(), fakeBridge.getUsername());
+    TestObject light(1, HueAbstractObject::LightKind, &bridge);
+    light.setCurrentState(brightnessAndColorTemp(100, 300));
+
+    int failures = 0;
+    connect(&light, &HueAbstractObject::updateFailed, this, [&failures]() { failures++; });
+
+    QVERIFY(light.setState(brightnessAndColorTemp(200, 400)));
+
+    const auto requests = fakeBridge.requests("PUT");
+    QCOMPARE(requests.size(), 1);
+    const QJsonObject sent = QJsonDocument::fromJson(requests.first().body).object();
+    QCOMPARE(sent.value("bri").toInt(), 200);
+    QCOMPARE(sent.value("ct").toInt(), 400);
+
+    QCOMPARE(light.currentState().getBrightness(), 200);
+    QCOMPARE(light.currentState().getColorTemp(), 300);
+    QCOMPARE(failures, 1);
+}
+
+void TestHueReply::optimisticUpdateRollsBackRejectedValues()
+{
+    FakeBridge fakeBridge;
+    QVERIFY(fakeBridge.listen());
+    fakeBridge.setReply("PUT", fakeBridge.apiPath("lights/1/state"),
+                        QJsonDocument(QJsonArray{success("/lights/1/state/bri", 200),
+                                                 error(7, "/lights/1/state/ct", "invalid value, 400, for parameter, ct")})
+                        .toJson());
+
+    HueBridge bridge(fakeBridge.getAddress(), fakeBridge.getUsername());
+    auto light = std::make_shared<TestObject>(1, HueAbstractObject::LightKind, &bridge);
+    light->setCurrentState(brightnessAndColorTemp(100, 300));
+    light->enableOptimisticUpdates(true);
+
+    int failures = 0;
+    connect(light.get(), &HueAbstractObject::updateFailed, this, [&failures]() { failures++; });
+
+    // Both values show right away, before the bridge has answered
+    QVERIFY(light->setState(brightnessAndColorTemp(200, 400)));
+    QCOMPARE(light->currentState().getBrightness(), 200);
+    QCOMPARE(light->currentState().getColorTemp(), 400);
+    QVERIFY(light->hasPendingUpdates());
+
+    QTRY_VERIFY(!light->hasPendingUpdates());
+
+    QCOMPARE(fakeBridge.requests("PUT").size(), 1);
+    QCOMPARE(light->currentState().getBrightness(), 200);
+    QCOMPARE(light->currentState().getColorTemp(), 300);
+    QCOMPARE(failures, 1);
+}
+
+QTEST_GUILESS_MAIN(TestHueReply)
+
+#include "tst_huereply.moc"
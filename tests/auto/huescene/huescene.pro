@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_huescene
+
+SOURCES += tst_huescene.cpp
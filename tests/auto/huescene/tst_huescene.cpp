@@ -0,0 +1,247 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "fakebridge.h"
+#include "huebridge.h"
+#include "huescene.h"
+#include "huestatechange.h"
+
+namespace {
+
+HueStateChange warmWhite(const int brightness)
+{
+    HueStateChange state;
+    state.setOn(true);
+    state.setBrightness(brightness);
+    state.setColorTemp(366);
+    return state;
+}
+
+QByteArray storedReply(const QString& sceneID)
+{
+    return QJsonDocument(QJsonArray{QJsonObject{{"success", QJsonObject{{"id", sceneID}}}}}).toJson();
+}
+
+QByteArray errorReply(const int type, const QString& address, const QString& description)
+{
+    const QJsonObject error {{"type", type}, {"address", address}, {"description", description}};
+    return QJsonDocument(QJsonArray{QJsonObject{{"error", error}}}).toJson();
+}
+
+}
+
+class TestHueScene : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void contentHashIgnoresOrderAndName();
+    void contentHashIgnoresAlert();
+    void toJson();
+    void toJsonNames();
+    void storeCachesByContent();
+    void cacheIsPerBridge();
+    void forgetAndClearCache();
+    void recallStoresRecycledSceneAgain();
+
+private:
+    FakeBridge* m_fakeBridge;
+    HueBridge* m_bridge;
+};
+
+void TestHueScene::init()
+{
+    // The cache is keyed by HueBridge pointer, which a new bridge may reuse
+    HueScene::clearCache();
+
+    m_fakeBridge = new FakeBridge(this);
+    QVERIFY(m_fakeBridge->listen());
+    m_fakeBridge->setReply("POST", m_fakeBridge->apiPath("scenes"), storedReply("AbC123"));
+
+    m_bridge = new HueBridge(m_fakeBridge->getAddress(), m_fakeBridge->getUsername());
+}
+
+void TestHueScene::cleanup()
+{
+    HueScene::clearCache();
+    delete m_bridge;
+    delete m_fakeBridge;
+}
+
+void TestHueScene::contentHashIgnoresOrderAndName()
+{
+    HueScene evening("Evening");
+    evening.setLightState(1, warmWhite(200));
+    evening.setLightState(2, warmWhite(100));
+
+    HueScene reading("Reading");
+    reading.setLightState(2, warmWhite(100));
+    reading.setLightState(1, warmWhite(200));
+
+    QCOMPARE(evening.contentHash(), reading.contentHash());
+    QCOMPARE(evening.contentHash().size(), 20);
+
+    reading.setLightState(2, warmWhite(101));
+    QVERIFY(evening.contentHash() != reading.contentHash());
+
+    reading.setLightState(2, warmWhite(100));
+    reading.setLightState(3, warmWhite(100));
+    QVERIFY(evening.contentHash() != reading.contentHash());
+}
+
+void TestHueScene::contentHashIgnoresAlert()
+{
+    // Scenes do not store alerts, so a flash must not make a new scene
+    HueScene plain;
+    plain.setLightState(1, warmWhite(200));
+
+    HueStateChange flashing = warmWhite(200);
+    flashing.setAlert(HueAbstractObject::BreatheSingle);
+
+    HueScene alerted;
+    alerted.setLightState(1, flashing);
+
+    QCOMPARE(plain.contentHash(), alerted.contentHash());
+}
+
+void TestHueScene::toJson()
+{
+    HueStateChange flashing = warmWhite(200);
+    flashing.setAlert(HueAbstractObject::BreatheSingle);
+
+    HueScene scene("Evening");
+    scene.setLightState(3, warmWhite(100));
+    scene.setLightState(1, flashing);
+
+    const QJsonObject json = scene.toJson();
+
+    QCOMPARE(json.value("name").toString(), QString("Evening"));
+    QCOMPARE(json.value("lights").toArray(), (QJsonArray{"1", "3"}));
+    QVERIFY(json.value("recycle").toBool());
+
+    const QJsonObject lightStates = json.value("lightstates").toObject();
+    QCOMPARE(lightStates.keys(), QStringList({"1", "3"}));
+
+    const QJsonObject first = lightStates.value("1").toObject();
+    QVERIFY(!first.contains("alert"));
+    QCOMPARE(first.value("bri").toInt(), 200);
+    QCOMPARE(first.value("ct").toInt(), 366);
+    QVERIFY(first.value("on").toBool());
+}
+
+void TestHueScene::toJsonNames()
+{
+    HueScene unnamed;
+    unnamed.setLightState(1, warmWhite(200));
+
+    const QString name = unnamed.toJson().value("name").toString();
+    QCOMPARE(name, "HueLib " + QString::fromLatin1(unnamed.contentHash().toHex().left(8)));
+
+    // The bridge accepts names of up to 32 characters
+    HueScene named(QString(40, QChar('x')));
+    named.setLightState(1, warmWhite(200));
+
+    QCOMPARE(named.toJson().value("name").toString(), QString(32, QChar('x')));
+}
+
+void TestHueScene::storeCachesByContent()
+{
+    HueScene evening("Evening");
+    evening.setLightState(1, warmWhite(200));
+
+    QCOMPARE(evening.store(m_bridge), QString("AbC123"));
+    QCOMPARE(evening.store(m_bridge), QString("AbC123"));
+    QCOMPARE(m_fakeBridge->requests("POST").size(), 1);
+
+    const QJsonObject sent = QJsonDocument::fromJson(m_fakeBridge->requests("POST").first().body).object();
+    QCOMPARE(sent, evening.toJson());
+
+    // Same content under another name is the same scene on the bridge
+    HueScene copy("Copy");
+    copy.setLightState(1, warmWhite(200));
+    QCOMPARE(copy.store(m_bridge), QString("AbC123"));
+    QCOMPARE(m_fakeBridge->requests("POST").size(), 1);
+
+    HueScene other;
+    other.setLightState(1, warmWhite(100));
+    m_fakeBridge->setReply("POST", m_fakeBridge->apiPath("scenes"), storedReply("XyZ789"));
+    QCOMPARE(other.store(m_bridge), QString("XyZ789"));
+    QCOMPARE(m_fakeBridge->requests("POST").size(), 2);
+
+    QVERIFY(HueScene().store(m_bridge).isEmpty());
+    QCOMPARE(m_fakeBridge->requests("POST").size(), 2);
+}
+
+void TestHueScene::cacheIsPerBridge()
+{
+    FakeBridge otherFake;
+    QVERIFY(otherFake.listen());
+    otherFake.setReply("POST", otherFake.apiPath("scenes"), storedReply("Other1"));
+    HueBridge other(otherFake.getAddress(), otherFake.getUsername());
+
+    HueScene scene;
+    scene.setLightState(1, warmWhite(200));
+
+    QCOMPARE(scene.store(m_bridge), QString("AbC123"));
+    QCOMPARE(scene.store(&other), QString("Other1"));
+    QCOMPARE(otherFake.requests("POST").size(), 1);
+
+    HueScene::clearCache(&other);
+    QCOMPARE(scene.store(m_bridge), QString("AbC123"));
+    QCOMPARE(m_fakeBridge->requests("POST").size(), 1);
+    QCOMPARE(scene.store(&other), QString("Other1"));
+    QCOMPARE(otherFake.requests("POST").size(), 2);
+}
+
+void TestHueScene::forgetAndClearCache()
+{
+    HueScene scene;
+    scene.setLightState(1, warmWhite(200));
+
+    QCOMPARE(scene.store(m_bridge), QString("AbC123"));
+
+    HueScene::forget(m_bridge, "AbC123");
+    QCOMPARE(scene.store(m_bridge), QString("AbC123"));
+    QCOMPARE(m_fakeBridge->requests("POST").size(), 2);
+
+    HueScene::clearCache();
+    QCOMPARE(scene.store(m_bridge), QString("AbC123"));
+    QCOMPARE(m_fakeBridge->requests("POST").size(), 3);
+}
+
+void TestHueScene::recallStoresRecycledSceneAgain()
+{
+    const QString actionPath = m_fakeBridge->apiPath("groups/0/action");
+    m_fakeBridge->setReply("PUT", actionPath,
+                           errorReply(3, "/groups/0/action/scene", "resource, scene AbC123, not available"));
+
+    HueScene scene;
+    scene.setLightState(1, warmWhite(200));
+
+    // Stored, recalled, found recycled, stored again and recalled once more
+    QVERIFY(!scene.recall(m_bridge));
+    QCOMPARE(m_fakeBridge->requests("POST").size(), 2);
+    QCOMPARE(m_fakeBridge->requests("PUT").size(), 2);
+
+    m_fakeBridge->setReply("PUT", actionPath,
+                           QJsonDocument(QJsonArray{QJsonObject{{"success", QJsonObject{{"/groups/0/action/scene", "AbC123"}}}}}).toJson());
+
+    QVERIFY(scene.recall(m_bridge));
+    QCOMPARE(m_fakeBridge->requests("POST").size(), 3);
+    QCOMPARE(QJsonDocument::fromJson(m_fakeBridge->requests("PUT").last().body).object(),
+             (QJsonObject{{"scene", "AbC123"}}));
+
+    // The scene is cached again, so the next recall only sends the PUT
+    QVERIFY(scene.recall(m_bridge));
+    QCOMPARE(m_fakeBridge->requests("POST").size(), 3);
+    QCOMPARE(m_fakeBridge->requests("PUT").size(), 4);
+}
+
+QTEST_GUILESS_MAIN(TestHueScene)
+
+#include "tst_huescene.moc"
@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_huesnapshot
+
+SOURCES += tst_huesnapshot.cpp
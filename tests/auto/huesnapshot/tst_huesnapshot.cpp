@@ -0,0 +1,268 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <memory>
+
+#include "fakebridge.h"
+#include "fixtures.h"
+#include "huebridge.h"
+#include "huegroup.h"
+#include "huelight.h"
+#include "huescene.h"
+#include "huesnapshot.h"
+#include "huestatechange.h"
+
+namespace {
+
+// The bridge answers every state change with one success entry; the values are not checked
+void acceptChanges(FakeBridge& fakeBridge, const QString& resource)
+{
+    const QJsonArray reply {QJsonObject{{"success", QJsonObject{{"/" + resource, true}}}}};
+    fakeBridge.setReply("PUT", fakeBridge.apiPath(resource), QJsonDocument(reply).toJson());
+}
+
+QJsonObject bodyOf(const FakeBridge::Request& request)
+{
+    return QJsonDocument::fromJson(request.body).object();
+}
+
+}
+
+// The stand-in reports lights 1 - 4, all on in color temperature mode (366 mired)
+// with brightness 2 - 5, and rooms of lights 1 - 2 and 3 - 4.
+class TestHueSnapshot : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void capture();
+    void differenceAfterXYFlash();
+    void differenceOfLightThatWasOff();
+    void restoreSendsOnlyTheDifference();
+    void restoreUsesGroups();
+    void restoreUsesScene();
+    void collidingIDsOnTwoBridges();
+
+private:
+    std::shared_ptr<HueLight> light(const int ID) const;
+
+private:
+    FakeBridge* m_fakeBridge;
+    HueBridge* m_bridge;
+    HueLightList m_lights;
+    HueGroupList m_groups;
+};
+
+void TestHueSnapshot::init()
+{
+    HueScene::clearCache();
+
+    m_fakeBridge = new FakeBridge(this);
+    QVERIFY(m_fakeBridge->listen());
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("lights"), Fixtures::lights(4));
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("groups"), Fixtures::groups(2, 2));
+
+    for (int ID = 1; ID <= 4; ID++)
+        acceptChanges(*m_fakeBridge, "lights/" + QString::number(ID) + "/state");
+
+    for (int ID = 0; ID <= 2; ID++)
+        acceptChanges(*m_fakeBridge, "groups/" + QString::number(ID) + "/action");
+
+    m_bridge = new HueBridge(m_fakeBridge->getAddress(), m_fakeBridge->getUsername());
+    m_lights = HueLight::discoverLights(m_bridge);
+    m_groups = HueGroup::discoverGroups(m_bridge);
+    QCOMPARE(m_lights.size(), 4);
+    QCOMPARE(m_groups.size(), 2);
+}
+
+void TestHueSnapshot::cleanup()
+{
+    m_groups = HueGroupList();
+    m_lights = HueLightList();
+    delete m_bridge;
+    delete m_fakeBridge;
+    HueScene::clearCache();
+}
+
+std::shared_ptr<HueLight> TestHueSnapshot::light(const int ID) const
+{
+    return m_lights.fetch(ID);
+}
+
+void TestHueSnapshot::capture()
+{
+    HueSnapshot snapshot(m_lights);
+
+    QCOMPARE(snapshot.lightCount(), 4);
+    QVERIFY(snapshot.contains(light(3).get()));
+
+    // Only the color of the current mode is captured
+    const HueStateChange target = snapshot.targetState(light(1).get());
+    QVERIFY(target.isOn());
+    QCOMPARE(target.getBrightness(), 2);
+    QCOMPARE(target.getColorTemp(), 366);
+    QVERIFY(!target.has(HueStateChange::XYAttribute));
+    QVERIFY(!target.has(HueStateChange::HueAttribute));
+
+    for (HueLight* captured : m_lights)
+        QVERIFY(snapshot.difference(captured).isEmpty());
+
+    HueSnapshot rooms(m_groups, m_lights);
+    QCOMPARE(rooms.lightCount(), 4);
+
+    snapshot.clear();
+    QVERIFY(snapshot.isEmpty());
+    QVERIFY(!snapshot.contains(light(3).get()));
+    QVERIFY(snapshot.difference(light(3).get()).isEmpty());
+}
+
+void TestHueSnapshot::differenceAfterXYFlash()
+{
+    const HueSnapshot snapshot(m_lights);
+
+    QVERIFY(light(1)->setXY(0.45, 0.35));
+
+    // The light left ct mode, so the color temperature is sent even though it is unchanged
+    HueStateChange difference = snapshot.difference(light(1).get());
+    QCOMPARE(difference.attributes(), int(HueStateChange::ColorTempAttribute));
+    QCOMPARE(difference.getColorTemp(), 366);
+
+    QVERIFY(light(1)->setBrightness(200));
+
+    difference = snapshot.difference(light(1).get());
+    QCOMPARE(difference.attributes(), HueStateChange::BrightnessAttribute | HueStateChange::ColorTempAttribute);
+    QCOMPARE(difference.getBrightness(), 2);
+
+    QVERIFY(snapshot.difference(light(2).get()).isEmpty());
+}
+
+void TestHueSnapshot::differenceOfLightThatWasOff()
+{
+    QVERIFY(light(1)->turnOff());
+    const HueSnapshot snapshot(m_lights);
+
+    QVERIFY(light(1)->turnOn());
+    QVERIFY(light(1)->setXY(0.45, 0.35));
+    QVERIFY(light(1)->setBrightness(200));
+
+    // Turning it off is enough; the other values are not visible
+    const HueStateChange difference = snapshot.difference(light(1).get());
+    QCOMPARE(difference.attributes(), int(HueStateChange::OnAttribute));
+    QVERIFY(!difference.isOn());
+}
+
+void TestHueSnapshot::restoreSendsOnlyTheDifference()
+{
+    const HueSnapshot snapshot(m_lights);
+    QVERIFY(light(1)->setXY(0.45, 0.35));
+    m_fakeBridge->clearRequests();
+
+    QCOMPARE(snapshot.restore(m_lights), 1);
+
+    const auto requests = m_fakeBridge->requests("PUT");
+    QCOMPARE(requests.size(), 1);
+    QCOMPARE(requests.first().path, m_fakeBridge->apiPath("lights/1/state"));
+    QCOMPARE(bodyOf(requests.first()), (QJsonObject{{"ct", 366}}));
+    QVERIFY(snapshot.difference(light(1).get()).isEmpty());
+
+    // Nothing left to send
+    m_fakeBridge->clearRequests();
+    QCOMPARE(snapshot.restore(m_lights), 0);
+    QVERIFY(m_fakeBridge->requests("PUT").isEmpty());
+}
+
+void TestHueSnapshot::restoreUsesGroups()
+{
+    HueSnapshot snapshot(m_lights);
+    snapshot.setSceneThreshold(0);
+
+    QVERIFY(light(1)->setXY(0.45, 0.35));
+    QVERIFY(light(2)->setXY(0.45, 0.35));
+    m_fakeBridge->clearRequests();
+
+    // Lights 1 and 2 need the same change and make up room 1
+    QCOMPARE(snapshot.restore(m_lights, m_groups, 4), 1);
+
+    const auto requests = m_fakeBridge->requests("PUT");
+    QCOMPARE(requests.size(), 1);
+    QCOMPARE(requests.first().path, m_fakeBridge->apiPath("groups/1/action"));
+    QCOMPARE(bodyOf(requests.first()), (QJsonObject{{"ct", 366}, {"transitiontime", 4}}));
+
+    QVERIFY(snapshot.difference(light(1).get()).isEmpty());
+    QVERIFY(snapshot.difference(light(2).get()).isEmpty());
+}
+
+void TestHueSnapshot::restoreUsesScene()
+{
+    const QJsonArray stored {QJsonObject{{"success", QJsonObject{{"id", "Snap01"}}}}};
+    m_fakeBridge->setReply("POST", m_fakeBridge->apiPath("scenes"), QJsonDocument(stored).toJson());
+
+    HueSnapshot snapshot(m_lights);
+    snapshot.setSceneThreshold(2);
+
+    // Different changes, so no group applies
+    QVERIFY(light(1)->setXY(0.45, 0.35));
+    QVERIFY(light(3)->setBrightness(200));
+    m_fakeBridge->clearRequests();
+
+    QCOMPARE(snapshot.restore(m_lights, m_groups), 1);
+
+    const auto posts = m_fakeBridge->requests("POST");
+    QCOMPARE(posts.size(), 1);
+    const QJsonObject lightStates = bodyOf(posts.first()).value("lightstates").toObject();
+    QCOMPARE(lightStates.keys(), QStringList({"1", "3"}));
+    QCOMPARE(lightStates.value("3").toObject().value("bri").toInt(), 4);
+
+    const auto puts = m_fakeBridge->requests("PUT");
+    QCOMPARE(puts.size(), 1);
+    QCOMPARE(puts.first().path, m_fakeBridge->apiPath("groups/0/action"));
+    QCOMPARE(bodyOf(puts.first()), (QJsonObject{{"scene", "Snap01"}}));
+
+    QVERIFY(snapshot.difference(light(1).get()).isEmpty());
+    QVERIFY(snapshot.difference(light(3).get()).isEmpty());
+}
+
+void TestHueSnapshot::collidingIDsOnTwoBridges()
+{
+    FakeBridge otherFake;
+    QVERIFY(otherFake.listen());
+    otherFake.setReply("GET", otherFake.apiPath("lights"), Fixtures::lights(2));
+    acceptChanges(otherFake, "lights/1/state");
+    acceptChanges(otherFake, "lights/2/state");
+
+    HueBridge other(otherFake.getAddress(), otherFake.getUsername());
+    const HueLightList otherLights = HueLight::discoverLights(&other);
+    QCOMPARE(otherLights.size(), 2);
+
+    auto all = std::make_shared<HueLightList::ObjectList>();
+    for (int i = 0; i < m_lights.size(); i++)
+        all->push_back(m_lights.at(i));
+    for (int i = 0; i < otherLights.size(); i++)
+        all->push_back(otherLights.at(i));
+    const HueLightList lights(all);
+
+    const HueSnapshot snapshot(lights);
+    QCOMPARE(snapshot.lightCount(), 6);
+
+    // Light 1 of the other bridge has its own entry
+    QVERIFY(otherLights.fetch(1)->setBrightness(100));
+    QVERIFY(snapshot.difference(light(1).get()).isEmpty());
+    QCOMPARE(snapshot.difference(otherLights.fetch(1).get()).getBrightness(), 2);
+
+    m_fakeBridge->clearRequests();
+    otherFake.clearRequests();
+
+    QCOMPARE(snapshot.restore(lights), 1);
+    QVERIFY(m_fakeBridge->requests("PUT").isEmpty());
+    QCOMPARE(otherFake.requests("PUT").size(), 1);
+    QCOMPARE(otherFake.requests("PUT").first().path, otherFake.apiPath("lights/1/state"));
+    QCOMPARE(bodyOf(otherFake.requests("PUT").first()), (QJsonObject{{"bri", 2}}));
+}
+
+QTEST_GUILESS_MAIN(TestHueSnapshot)
+
+#include "tst_huesnapshot.moc"
@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+TARGET = tst_huestreamchannel
+
+SOURCES += tst_huestreamchannel.cpp
@@ -0,0 +1,358 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include <QUdpSocket>
+#include <vector>
+
+#include "huestreamchannel.h"
+#include "huestreamreceiver.h"
+#include "huestreamtransport.h"
+
+// Keeps every datagram instead of sending it
+class RecordingTransport : public HueStreamTransport
+{
+    Q_OBJECT
+
+public:
+    bool open() override { m_open = true; return true; }
+    void close() override { m_open = false; }
+    bool isOpen() const override { return m_open; }
+    bool sendDatagram(const QByteArray& datagram) override
+    {
+        datagrams.push_back(datagram);
+        return true;
+    }
+
+    std::vector<QByteArray> datagrams;
+
+private:
+    bool m_open = false;
+};
+
+class TestHueStreamChannel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void encodeDecodeRoundTrip_data();
+    void encodeDecodeRoundTrip();
+    void encodeHeader();
+    void decodeRejectsInvalidDatagrams_data();
+    void decodeRejectsInvalidDatagrams();
+    void setColorChecksLightAndColorSpace();
+    void largeFrameIsSplitWithOneSequence();
+    void emptyChannelDropsNothing();
+    void receiverLoopback();
+    void receiverCountsReorderedFrames();
+    void receiverCountsLostFramesAcrossWrap();
+    void receiverFrameFromBeforeFirstIsNotLost();
+    void receiverResyncsAfterSenderRestart();
+    void receiverCountsInvalidDatagrams();
+
+private:
+    static QByteArray frame(const quint8 sequence, const int lightID);
+    static void sendTo(const HueStreamReceiver& receiver, const QByteArray& datagram);
+};
+
+QByteArray TestHueStreamChannel::frame(const quint8 sequence, const int lightID)
+{
+    const HueStreamChannel::LightColor light{lightID, {quint16(sequence), 0, 0xffff}};
+    return HueStreamChannel::encodeDatagram(sequence, HueStreamChannel::RGB, {light});
+}
+
+void TestHueStreamChannel::sendTo(const HueStreamReceiver& receiver, const QByteArray& datagram)
+{
+    QUdpSocket socket;
+    socket.writeDatagram(datagram, QHostAddress(QHostAddress::LocalHost), receiver.getPort());
+}
+
+void TestHueStreamChannel::encodeDecodeRoundTrip_data()
+{
+    QTest::addColumn<int>("colorSpace");
+    QTest::addColumn<int>("lightCount");
+
+    QTest::newRow("RGB, no lights") << static_cast<int>(HueStreamChannel::RGB) << 0;
+    QTest::newRow("RGB, one light") << static_cast<int>(HueStreamChannel::RGB) << 1;
+    QTest::newRow("XY, ten lights") << static_cast<int>(HueStreamChannel::XYBrightness) << 10;
+}
+
+void TestHueStreamChannel::encodeDecodeRoundTrip()
+{
+    QFETCH(int, colorSpace);
+    QFETCH(int, lightCount);
+
+    std::vector<HueStreamChannel::LightColor> lights;
+    for (int i = 0; i < lightCount; i++) {
+        const quint16 value = static_cast<quint16>(i * 6553);
+        lights.push_back(HueStreamChannel::LightColor{i + 1, {value, quint16(0xffff - value), 0x0102}});
+    }
+
+    const QByteArray datagram = HueStreamChannel::encodeDatagram(
+                200, static_cast<HueStreamChannel::ColorSpace>(colorSpace), lights);
+    QCOMPARE(datagram.size(), 16 + 9 * lightCount);
+
+    quint8 sequence = 0;
+    HueStreamChannel::ColorSpace decodedColorSpace = HueStreamChannel::RGB;
+    std::vector<HueStreamChannel::LightColor> decoded;
+
+    QVERIFY(HueStreamChannel::decodeDatagram(datagram, sequence, decodedColorSpace, decoded));
+    QCOMPARE(static_cast<int>(sequence), 200);
+    QCOMPARE(static_cast<int>(decodedColorSpace), colorSpace);
+    QCOMPARE(static_cast<int>(decoded.size()), lightCount);
+
+    for (int i = 0; i < lightCount; i++) {
+        QCOMPARE(decoded[i].ID, lights[i].ID);
+        QCOMPARE(decoded[i].values[0], lights[i].values[0]);
+        QCOMPARE(decoded[i].values[1], lights[i].values[1]);
+        QCOMPARE(decoded[i].values[2], lights[i].values[2]);
+    }
+}
+
+void TestHueStreamChannel::encodeHeader()
+{
+    const HueStreamChannel::LightColor light{0x0203, {0x0405, 0x0607, 0x0809}};
+    const QByteArray datagram = HueStreamChannel::encodeDatagram(7, HueStreamChannel::XYBrightness, {light});
+
+    QCOMPARE(datagram.left(9), QByteArray("HueStream"));
+    QCOMPARE(static_cast<int>(datagram.at(9)), 1);      // Version 1.0
+    QCOMPARE(static_cast<int>(datagram.at(10)), 0);
+    QCOMPARE(static_cast<int>(datagram.at(11)), 7);     // Sequence number
+    QCOMPARE(static_cast<int>(datagram.at(14)), 1);     // xy + brightness
+
+    // Light entries are big endian
+    QCOMPARE(datagram.mid(16), QByteArray("\x00\x02\x03\x04\x05\x06\x07\x08\x09", 9));
+}
+
+void TestHueStreamChannel::decodeRejectsInvalidDatagrams_data()
+{
+    QTest::addColumn<QByteArray>("datagram");
+
+    const QByteArray valid = frame(1, 1);
+
+    QByteArray wrongName = valid;
+    wrongName[0] = 'X';
+    QByteArray wrongVersion = valid;
+    wrongVersion[9] = 2;
+    QByteArray wrongColorSpace = valid;
+    wrongColorSpace[14] = 2;
+    QByteArray wrongDeviceType = valid;
+    wrongDeviceType[16] = 1;
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("short header") << valid.left(15);
+    QTest::newRow("partial light") << valid.left(valid.size() - 1);
+    QTest::newRow("protocol name") << wrongName;
+    QTest::newRow("version") << wrongVersion;
+    QTest::newRow("color space") << wrongColorSpace;
+    QTest::newRow("device type") << wrongDeviceType;
+}
+
+void TestHueStreamChannel::decodeRejectsInvalidDatagrams()
+{
+    QFETCH(QByteArray, datagram);
+
+    quint8 sequence = 0;
+    HueStreamChannel::ColorSpace colorSpace = HueStreamChannel::RGB;
+    std::vector<HueStreamChannel::LightColor> lights;
+
+    QVERIFY(!HueStreamChannel::decodeDatagram(datagram, sequence, colorSpace, lights));
+}
+
+void TestHueStreamChannel::setColorChecksLightAndColorSpace()
+{
+    RecordingTransport transport;
+    HueStreamChannel channel(&transport, HueStreamChannel::RGB);
+
+    QVERIFY(channel.addLight(1));
+    QVERIFY(!channel.addLight(1));
+    QCOMPARE(channel.lightCount(), 1);
+
+    QVERIFY(channel.setLightRGB(1, 1.0, 0.5, 0.0));
+    QVERIFY(!channel.setLightRGB(2, 1.0, 0.5, 0.0));
+    QVERIFY(!channel.setLightXY(1, 0.3, 0.3, 1.0));
+}
+
+void TestHueStreamChannel::largeFrameIsSplitWithOneSequence()
+{
+    RecordingTransport transport;
+    HueStreamChannel channel(&transport);
+
+    for (int ID = 1; ID <= 12; ID++)
+        channel.addLight(ID);
+
+    QVERIFY(channel.start());
+    QTRY_VERIFY(channel.framesSent() >= 1);
+    channel.stop();
+
+    QCOMPARE(channel.datagramsSent(), 2 * channel.framesSent());
+    QVERIFY(transport.datagrams.size() >= 2);
+
+    quint8 firstSequence = 0;
+    quint8 secondSequence = 0;
+    HueStreamChannel::ColorSpace colorSpace = HueStreamChannel::RGB;
+    std::vector<HueStreamChannel::LightColor> first;
+    std::vector<HueStreamChannel::LightColor> second;
+
+    QVERIFY(HueStreamChannel::decodeDatagram(transport.datagrams[0], firstSequence, colorSpace, first));
+    QVERIFY(HueStreamChannel::decodeDatagram(transport.datagrams[1], secondSequence, colorSpace, second));
+    QCOMPARE(firstSequence, secondSequence);
+    QCOMPARE(static_cast<int>(first.size()), 10);
+    QCOMPARE(static_cast<int>(second.size()), 2);
+}
+
+void TestHueStreamChannel::emptyChannelDropsNothing()
+{
+    RecordingTransport transport;
+    HueStreamChannel channel(&transport);
+
+    QVERIFY(channel.start());
+    QTest::qWait(200);
+    channel.stop();
+
+    QCOMPARE(channel.framesSent(), 0);
+    QCOMPARE(channel.framesDropped(), 0);
+    QVERIFY(transport.datagrams.empty());
+}
+
+void TestHueStreamChannel::receiverLoopback()
+{
+    HueStreamReceiver receiver;
+    QVERIFY(receiver.listen());
+
+    HueUdpStreamTransport transport(QHostAddress(QHostAddress::LocalHost), receiver.getPort());
+    HueStreamChannel channel(&transport);
+    QSignalSpy frames(&receiver, &HueStreamReceiver::frameReceived);
+
+    for (int ID = 1; ID <= 12; ID++)
+        channel.addLight(ID);
+    channel.setLightRGB(12, 1.0, 0.0, 0.5);
+
+    QVERIFY(channel.start());
+    QTRY_VERIFY(receiver.framesReceived() >= 3);
+    channel.stop();
+    QTest::qWait(100);
+
+    // One signal per frame, although every frame is two datagrams
+    QCOMPARE(frames.count(), receiver.framesReceived());
+    QCOMPARE(receiver.datagramsReceived(), 2 * receiver.framesReceived());
+    QCOMPARE(receiver.framesLost(), 0);
+    QCOMPARE(receiver.datagramsInvalid(), 0);
+
+    HueStreamChannel::LightColor color;
+    QVERIFY(receiver.lightColor(12, color));
+    QCOMPARE(color.values[0], quint16(0xffff));
+    QCOMPARE(color.values[1], quint16(0));
+    QCOMPARE(color.values[2], quint16(0x8000));
+}
+
+void TestHueStreamChannel::receiverCountsReorderedFrames()
+{
+    HueStreamReceiver receiver;
+    QVERIFY(receiver.listen());
+
+    sendTo(receiver, frame(5, 1));
+    QTRY_COMPARE(receiver.framesReceived(), 1);
+
+    sendTo(receiver, frame(7, 1));
+    QTRY_COMPARE(receiver.framesReceived(), 2);
+    QCOMPARE(receiver.framesLost(), 1);
+
+    // Frame 6 arrives late: it is no longer lost, but its colors are not applied
+    sendTo(receiver, frame(6, 1));
+    QTRY_COMPARE(receiver.datagramsLate(), 1);
+    QCOMPARE(receiver.framesReceived(), 3);
+    QCOMPARE(receiver.framesLost(), 0);
+    QCOMPARE(static_cast<int>(receiver.lastSequenceNumber()), 7);
+
+    HueStreamChannel::LightColor color;
+    QVERIFY(receiver.lightColor(1, color));
+    QCOMPARE(color.values[0], quint16(7));
+
+    // A duplicate of the late frame is not counted twice
+    sendTo(receiver, frame(6, 1));
+    QTRY_COMPARE(receiver.datagramsLate(), 2);
+    QCOMPARE(receiver.framesReceived(), 3);
+    QCOMPARE(receiver.framesLost(), 0);
+}
+
+void TestHueStreamChannel::receiverCountsLostFramesAcrossWrap()
+{
+    HueStreamReceiver receiver;
+    QVERIFY(receiver.listen());
+
+    sendTo(receiver, frame(254, 1));
+    QTRY_COMPARE(receiver.framesReceived(), 1);
+
+    sendTo(receiver, frame(1, 1));
+    QTRY_COMPARE(receiver.framesReceived(), 2);
+    QCOMPARE(receiver.framesLost(), 2);
+    QCOMPARE(receiver.datagramsLate(), 0);
+
+    sendTo(receiver, frame(0, 1));
+    QTRY_COMPARE(receiver.framesReceived(), 3);
+    QCOMPARE(receiver.framesLost(), 1);
+    QCOMPARE(receiver.datagramsLate(), 1);
+}
+
+void TestHueStreamChannel::receiverFrameFromBeforeFirstIsNotLost()
+{
+    HueStreamReceiver receiver;
+    QVERIFY(receiver.listen());
+
+    sendTo(receiver, frame(10, 1));
+    QTRY_COMPARE(receiver.framesReceived(), 1);
+
+    // Frame 9 was never counted as lost, so it does not make up for one
+    sendTo(receiver, frame(9, 1));
+    QTRY_COMPARE(receiver.datagramsLate(), 1);
+    QCOMPARE(receiver.framesReceived(), 1);
+    QCOMPARE(receiver.framesLost(), 0);
+
+    sendTo(receiver, frame(12, 1));
+    QTRY_COMPARE(receiver.framesReceived(), 2);
+    QCOMPARE(receiver.framesLost(), 1);
+}
+
+void TestHueStreamChannel::receiverResyncsAfterSenderRestart()
+{
+    HueStreamReceiver receiver;
+    QVERIFY(receiver.listen());
+
+    for (int sequence = 100; sequence < 104; sequence++)
+        sendTo(receiver, frame(static_cast<quint8>(sequence), 1));
+    QTRY_COMPARE(receiver.framesReceived(), 4);
+
+    // The sender starts over at 0. Its first datagrams look late, until
+    // eight of them in a row make the receiver follow the new sequence
+    for (int sequence = 0; sequence < 8; sequence++)
+        sendTo(receiver, frame(static_cast<quint8>(sequence), 1));
+    QTRY_COMPARE(receiver.datagramsReceived(), 12);
+
+    QCOMPARE(receiver.datagramsLate(), 7);
+    QCOMPARE(receiver.framesReceived(), 5);
+    QCOMPARE(receiver.framesLost(), 0);
+    QCOMPARE(static_cast<int>(receiver.lastSequenceNumber()), 7);
+
+    sendTo(receiver, frame(9, 1));
+    QTRY_COMPARE(receiver.framesReceived(), 6);
+    QCOMPARE(receiver.framesLost(), 1);
+    QCOMPARE(receiver.datagramsLate(), 7);
+
+    HueStreamChannel::LightColor color;
+    QVERIFY(receiver.lightColor(1, color));
+    QCOMPARE(color.values[0], quint16(9));
+}
+
+void TestHueStreamChannel::receiverCountsInvalidDatagrams()
+{
+    HueStreamReceiver receiver;
+    QVERIFY(receiver.listen());
+
+    sendTo(receiver, QByteArray("not a frame"));
+    QTRY_COMPARE(receiver.datagramsInvalid(), 1);
+    QCOMPARE(receiver.datagramsReceived(), 0);
+    QCOMPARE(receiver.framesReceived(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestHueStreamChannel)
+
+#include "tst_huestreamchannel.moc"
@@ -0,0 +1,4 @@
+# Settings for the benchmarks. They are not part of "make check"; build in release
+# mode and run a benchmark program directly, e.g. "./tst_bench_discovery -median 5".
+
+include(../tests.pri)
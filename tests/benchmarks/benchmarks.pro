@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+        colorconversion \
+        discovery \
+        infotreemodel \
+        jsonparse \
+        lightlistmodel
@@ -0,0 +1,5 @@
+include(../benchmarks.pri)
+
+TARGET = tst_bench_colorconversion
+
+SOURCES += tst_bench_colorconversion.cpp
@@ -0,0 +1,358 @@
+#include <QtTest>
+#include <cmath>
+#include <vector>
+
+#include "huecolor.h"
+
+// HueColor's batch conversions against the per-color code an application would
+// otherwise write: one color at a time, in double precision, with std::pow for the
+// sRGB transfer function.
+//
+// The inputs are the same pseudo-random colors for both sides. The gamut benchmarks
+// copy the coordinates before clamping, since HueColor clamps in place; the
+// reference pays the same copy by writing to separate arrays.
+//
+// Which kernels ran (AVX, SSE2 or scalar) is printed at the start, as it depends on
+// the flags the library was built with.
+namespace Reference {
+
+double srgbToLinear(const double value)
+{
+    const double c = std::min(std::max(value, 0.0), 1.0);
+    return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+}
+
+void rgbToXY(const double r, const double g, const double b, double& x, double& y, double& luminance)
+{
+    const double red = srgbToLinear(r);
+    const double green = srgbToLinear(g);
+    const double blue = srgbToLinear(b);
+
+    const double X = red * 0.4124 + green * 0.3576 + blue * 0.1805;
+    const double Y = red * 0.2126 + green * 0.7152 + blue * 0.0722;
+    const double Z = red * 0.0193 + green * 0.1192 + blue * 0.9505;
+    const double sum = X + Y + Z;
+
+    if (sum <= 1e-6) {
+        x = 0.3127;
+        y = 0.3290;
+    } else {
+        x = X / sum;
+        y = Y / sum;
+    }
+    luminance = Y;
+}
+
+double cross(const double ax, const double ay, const double bx, const double by,
+             const double px, const double py)
+{
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+void closestOnEdge(const double px, const double py,
+                   const double ax, const double ay, const double bx, const double by,
+                   double& cx, double& cy)
+{
+    const double dx = bx - ax;
+    const double dy = by - ay;
+    double t = ((px - ax) * dx + (py - ay) * dy) / (dx * dx + dy * dy);
+    t = std::min(std::max(t, 0.0), 1.0);
+
+    cx = ax + t * dx;
+    cy = ay + t * dy;
+}
+
+void clampToTriangle(const HueColor::Triangle& t, double& x, double& y)
+{
+    // Gamut triangles are given counter-clockwise, red to green to blue
+    if (cross(t.redX, t.redY, t.greenX, t.greenY, x, y) >= 0.0
+            && cross(t.greenX, t.greenY, t.blueX, t.blueY, x, y) >= 0.0
+            && cross(t.blueX, t.blueY, t.redX, t.redY, x, y) >= 0.0)
+        return;
+
+    const double corners[][4] = {
+        {t.redX, t.redY, t.greenX, t.greenY},
+        {t.greenX, t.greenY, t.blueX, t.blueY},
+        {t.blueX, t.blueY, t.redX, t.redY}
+    };
+
+    double bestX = x;
+    double bestY = y;
+    double bestDistance = -1.0;
+
+    for (const auto& edge : corners) {
+        double cx, cy;
+        closestOnEdge(x, y, edge[0], edge[1], edge[2], edge[3], cx, cy);
+
+        const double distance = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+        if (bestDistance < 0.0 || distance < bestDistance) {
+            bestX = cx;
+            bestY = cy;
+            bestDistance = distance;
+        }
+    }
+
+    x = bestX;
+    y = bestY;
+}
+
+void miredToXY(const double mired, double& x, double& y)
+{
+    // Kim et al. cubic spline of the Planckian locus
+    const double m = std::min(std::max(mired, 40.0), 600.0);
+    const double u = m * 1e-6;
+
+    if (m >= 250.0)
+        x = -0.2661239e9 * u * u * u - 0.2343589e6 * u * u + 0.8776956e3 * u + 0.179910;
+    else
+        x = -3.0258469e9 * u * u * u + 2.1070379e6 * u * u + 0.2226347e3 * u + 0.240390;
+
+    if (m >= 450.0)
+        y = -1.1063814 * x * x * x - 1.34811020 * x * x + 2.18555832 * x - 0.20219683;
+    else if (m >= 250.0)
+        y = -0.9549476 * x * x * x - 1.37418593 * x * x + 2.09137015 * x - 0.16748867;
+    else
+        y = 3.0817580 * x * x * x - 5.87338670 * x * x + 3.75112997 * x - 0.37001483;
+}
+
+} // namespace Reference
+
+class TestBenchColorConversion : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void resultsAgree();
+    void referenceRgbToXY_data();
+    void referenceRgbToXY();
+    void rgbToXY_data();
+    void rgbToXY();
+    void rgb8ToXY_data();
+    void rgb8ToXY();
+    void referenceClampToGamut_data();
+    void referenceClampToGamut();
+    void clampToGamut_data();
+    void clampToGamut();
+    void referenceMiredToXY_data();
+    void referenceMiredToXY();
+    void miredToXY_data();
+    void miredToXY();
+
+private:
+    static void addColorCounts();
+    static std::vector<float> randomValues(const int count, const float low, const float high,
+                                           const unsigned seed);
+};
+
+void TestBenchColorConversion::addColorCounts()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("1k colors") << 1024;
+    QTest::newRow("64k colors") << 65536;
+}
+
+std::vector<float> TestBenchColorConversion::randomValues(const int count, const float low,
+                                                          const float high, const unsigned seed)
+{
+    // A fixed generator, so that every run converts the same colors
+    std::vector<float> values(static_cast<size_t>(count));
+    unsigned state = seed;
+
+    for (float& value : values) {
+        state = state * 1664525u + 1013904223u;
+        value = low + (high - low) * static_cast<float>(state >> 8) / 16777216.0f;
+    }
+
+    return values;
+}
+
+void TestBenchColorConversion::initTestCase()
+{
+    qDebug("HueColor kernels: %s", HueColor::instructionSet());
+}
+
+void TestBenchColorConversion::resultsAgree()
+{
+    // The benchmarks only compare speed if both sides compute the same colors
+    const int count = 1000;
+    const std::vector<float> r = randomValues(count, 0.0f, 1.0f, 1);
+    const std::vector<float> g = randomValues(count, 0.0f, 1.0f, 2);
+    const std::vector<float> b = randomValues(count, 0.0f, 1.0f, 3);
+    std::vector<float> x(count), y(count), luminance(count);
+
+    HueColor::rgbToXY(r.data(), g.data(), b.data(), x.data(), y.data(), luminance.data(), count);
+
+    for (int i = 0; i < count; i++) {
+        double rx, ry, rl;
+        Reference::rgbToXY(r[i], g[i], b[i], rx, ry, rl);
+        QVERIFY(std::abs(x[i] - rx) < 1e-4);
+        QVERIFY(std::abs(y[i] - ry) < 1e-4);
+        QVERIFY(std::abs(luminance[i] - rl) < 1e-4);
+    }
+
+    const HueColor::Triangle gamut = HueColor::gamutTriangle(HueColor::GamutC);
+    HueColor::clampToGamut(HueColor::GamutC, x.data(), y.data(), count);
+
+    for (int i = 0; i < count; i++) {
+        double rx, ry, rl;
+        Reference::rgbToXY(r[i], g[i], b[i], rx, ry, rl);
+        Reference::clampToTriangle(gamut, rx, ry);
+        QVERIFY(std::abs(x[i] - rx) < 1e-4);
+        QVERIFY(std::abs(y[i] - ry) < 1e-4);
+    }
+
+    const std::vector<float> mired = randomValues(count, 153.0f, 500.0f, 4);
+    HueColor::miredToXY(mired.data(), x.data(), y.data(), count);
+
+    for (int i = 0; i < count; i++) {
+        double rx, ry;
+        Reference::miredToXY(mired[i], rx, ry);
+        QVERIFY(std::abs(x[i] - rx) < 1e-4);
+        QVERIFY(std::abs(y[i] - ry) < 1e-4);
+    }
+}
+
+void TestBenchColorConversion::referenceRgbToXY_data()
+{
+    addColorCounts();
+}
+
+void TestBenchColorConversion::referenceRgbToXY()
+{
+    QFETCH(int, count);
+
+    const std::vector<float> r = randomValues(count, 0.0f, 1.0f, 1);
+    const std::vector<float> g = randomValues(count, 0.0f, 1.0f, 2);
+    const std::vector<float> b = randomValues(count, 0.0f, 1.0f, 3);
+    std::vector<double> x(count), y(count), luminance(count);
+
+    QBENCHMARK {
+        for (int i = 0; i < count; i++)
+            Reference::rgbToXY(r[i], g[i], b[i], x[i], y[i], luminance[i]);
+    }
+}
+
+void TestBenchColorConversion::rgbToXY_data()
+{
+    addColorCounts();
+}
+
+void TestBenchColorConversion::rgbToXY()
+{
+    QFETCH(int, count);
+
+    const std::vector<float> r = randomValues(count, 0.0f, 1.0f, 1);
+    const std::vector<float> g = randomValues(count, 0.0f, 1.0f, 2);
+    const std::vector<float> b = randomValues(count, 0.0f, 1.0f, 3);
+    std::vector<float> x(count), y(count), luminance(count);
+
+    QBENCHMARK {
+        HueColor::rgbToXY(r.data(), g.data(), b.data(), x.data(), y.data(), luminance.data(), count);
+    }
+}
+
+void TestBenchColorConversion::rgb8ToXY_data()
+{
+    addColorCounts();
+}
+
+void TestBenchColorConversion::rgb8ToXY()
+{
+    QFETCH(int, count);
+
+    const std::vector<float> values = randomValues(3 * count, 0.0f, 256.0f, 5);
+    std::vector<unsigned char> rgb(values.size());
+    for (size_t i = 0; i < values.size(); i++)
+        rgb[i] = static_cast<unsigned char>(values[i]);
+
+    std::vector<float> x(count), y(count), luminance(count);
+
+    QBENCHMARK {
+        HueColor::rgb8ToXY(rgb.data(), x.data(), y.data(), luminance.data(), count);
+    }
+}
+
+void TestBenchColorConversion::referenceClampToGamut_data()
+{
+    addColorCounts();
+}
+
+void TestBenchColorConversion::referenceClampToGamut()
+{
+    QFETCH(int, count);
+
+    // Spread over the whole diagram, so that most points lie outside of the gamut
+    const std::vector<float> inX = randomValues(count, 0.0f, 0.8f, 6);
+    const std::vector<float> inY = randomValues(count, 0.0f, 0.9f, 7);
+    const HueColor::Triangle gamut = HueColor::gamutTriangle(HueColor::GamutC);
+    std::vector<double> x(count), y(count);
+
+    QBENCHMARK {
+        for (int i = 0; i < count; i++) {
+            x[i] = inX[i];
+            y[i] = inY[i];
+            Reference::clampToTriangle(gamut, x[i], y[i]);
+        }
+    }
+}
+
+void TestBenchColorConversion::clampToGamut_data()
+{
+    addColorCounts();
+}
+
+void TestBenchColorConversion::clampToGamut()
+{
+    QFETCH(int, count);
+
+    const std::vector<float> inX = randomValues(count, 0.0f, 0.8f, 6);
+    const std::vector<float> inY = randomValues(count, 0.0f, 0.9f, 7);
+    std::vector<float> x(count), y(count);
+
+    QBENCHMARK {
+        x = inX;
+        y = inY;
+        HueColor::clampToGamut(HueColor::GamutC, x.data(), y.data(), count);
+    }
+}
+
+void TestBenchColorConversion::referenceMiredToXY_data()
+{
+    addColorCounts();
+}
+
+void TestBenchColorConversion::referenceMiredToXY()
+{
+    QFETCH(int, count);
+
+    const std::vector<float> mired = randomValues(count, 153.0f, 500.0f, 4);
+    std::vector<double> x(count), y(count);
+
+    QBENCHMARK {
+        for (int i = 0; i < count; i++)
+            Reference::miredToXY(mired[i], x[i], y[i]);
+    }
+}
+
+void TestBenchColorConversion::miredToXY_data()
+{
+    addColorCounts();
+}
+
+void TestBenchColorConversion::miredToXY()
+{
+    QFETCH(int, count);
+
+    const std::vector<float> mired = randomValues(count, 153.0f, 500.0f, 4);
+    std::vector<float> x(count), y(count);
+
+    QBENCHMARK {
+        HueColor::miredToXY(mired.data(), x.data(), y.data(), count);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestBenchColorConversion)
+
+#include "tst_bench_colorconversion.moc"
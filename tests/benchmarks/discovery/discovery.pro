@@ -0,0 +1,5 @@
+include(../benchmarks.pri)
+
+TARGET = tst_bench_discovery
+
+SOURCES += tst_bench_discovery.cpp
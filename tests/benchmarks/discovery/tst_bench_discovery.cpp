@@ -0,0 +1,121 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+
+#include "fakebridge.h"
+#include "fixtures.h"
+#include "huebridge.h"
+#include "huelight.h"
+#include "huetypes.h"
+
+// How long discovery keeps the calling thread from processing events.
+//
+// mainThreadStall discovers lights from a local bridge stand-in while a 1 ms timer
+// runs on the calling thread, and reports the longest gap between its ticks. The
+// reply is parsed on the thread pool, so the gap is bounded by creating the objects.
+//
+// inlineParse is the work the calling thread did before parsing moved off it:
+// building the JSON DOM and the light records from it. That time was one stall,
+// on top of creating the objects.
+class TestBenchDiscovery : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void mainThreadStall_data();
+    void mainThreadStall();
+    void inlineParse_data();
+    void inlineParse();
+};
+
+void TestBenchDiscovery::mainThreadStall_data()
+{
+    QTest::addColumn<int>("lightCount");
+
+    QTest::newRow("100 lights") << 100;
+    QTest::newRow("500 lights") << 500;
+}
+
+void TestBenchDiscovery::mainThreadStall()
+{
+    QFETCH(int, lightCount);
+
+    FakeBridge fakeBridge;
+    QVERIFY(fakeBridge.listen());
+    fakeBridge.setReply("GET", fakeBridge.apiPath("lights"), Fixtures::lights(lightCount));
+
+    HueBridge bridge(fakeBridge.getAddress(), fakeBridge.getUsername());
+    bridge.setNetworkRequestTimeout(10000);
+
+    QElapsedTimer clock;
+    qint64 lastTick = 0;
+    qint64 longestStall = 0;
+
+    QTimer ticker;
+    ticker.setTimerType(Qt::PreciseTimer);
+    ticker.setInterval(1);
+    connect(&ticker, &QTimer::timeout, this, [&clock, &lastTick, &longestStall]()
+    {
+        const qint64 now = clock.nsecsElapsed();
+        longestStall = qMax(longestStall, now - lastTick);
+        lastTick = now;
+    });
+
+    clock.start();
+    ticker.start();
+
+    const HueLightList lights = HueLight::discoverLights(&bridge);
+
+    // The objects are created after the last tick, before discoverLights() returns
+    longestStall = qMax(longestStall, clock.nsecsElapsed() - lastTick);
+    ticker.stop();
+
+    QCOMPARE(lights.size(), lightCount);
+    QTest::setBenchmarkResult(longestStall / 1000000.0, QTest::WalltimeMilliseconds);
+}
+
+void TestBenchDiscovery::inlineParse_data()
+{
+    mainThreadStall_data();
+}
+
+void TestBenchDiscovery::inlineParse()
+{
+    QFETCH(int, lightCount);
+
+    const QByteArray reply = Fixtures::lights(lightCount);
+    int parsed = 0;
+
+    QBENCHMARK {
+        const QJsonObject json = QJsonDocument::fromJson(reply).object();
+        parsed = 0;
+
+        for (auto it = json.constBegin(); it != json.constEnd(); ++it) {
+            const QJsonObject lightJson = it.value().toObject();
+
+            Light::Record record;
+            record.ID = it.key().toInt();
+            record.state = Light::State(lightJson["state"]);
+            record.name = Light::Name(lightJson["name"]);
+            record.type = Light::Type(lightJson["type"]);
+            record.uniqueID = Light::UniqueID(lightJson["uniqueid"]);
+            record.softwareVersion = Light::SoftwareVersion(lightJson["swversion"]);
+            record.softwareUpdate = Light::SoftwareUpdate(lightJson["swupdate"]);
+            record.softwareConfigID = Light::SoftwareConfigID(lightJson["swconfigid"]);
+            record.productName = Light::ProductName(lightJson["productname"]);
+            record.manufacturer = Light::Manufacturer(lightJson["manufacturername"]);
+            record.productID = Light::ProductID(lightJson["productid"]);
+            record.config = Light::Config(lightJson["config"]);
+            record.capabilities = Light::Capabilities(lightJson["capabilities"]);
+            parsed++;
+        }
+    }
+
+    QCOMPARE(parsed, lightCount);
+}
+
+QTEST_GUILESS_MAIN(TestBenchDiscovery)
+
+#include "tst_bench_discovery.moc"
@@ -0,0 +1,5 @@
+include(../benchmarks.pri)
+
+TARGET = tst_bench_infotreemodel
+
+SOURCES += tst_bench_infotreemodel.cpp
@@ -0,0 +1,205 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QSignalSpy>
+#include <memory>
+#include <vector>
+
+#include "fakebridge.h"
+#include "fixtures.h"
+#include "huebridge.h"
+#include "huechangenotifier.h"
+#include "hueeventstream.h"
+#include "huelight.h"
+#include "Models/huelightinfotreemodel.h"
+
+// Cost of keeping many HueLightInfoTreeModels up to date, e.g. one per open detail
+// view, with several views per light.
+//
+// unchangedUpdate synchronizes every light without anything having changed, as
+// periodic synchronization does, and includes the requests to a local bridge
+// stand-in. pushedChange changes the brightness of every light through the event
+// stream of the stand-in, and includes reading the event from the socket. Both
+// flush HueChangeNotifier, which the models follow.
+//
+// Both count the dataChanged() signals of all models per round and fail on any
+// modelReset(), so views keep their selection and expansion.
+namespace {
+
+const int lightCount = 20;
+const char streamPath[] = "/eventstream/clip/v2";
+
+QByteArray brightnessUpdate(const HueLightList& lights, const double brightness)
+{
+    QByteArray resources;
+
+    for (HueLight* light : lights) {
+        if (!resources.isEmpty())
+            resources += ',';
+
+        resources += "{\"id_v1\":\"/lights/" + QByteArray::number(light->ID())
+                + "\",\"dimming\":{\"brightness\":" + QByteArray::number(brightness) + "}}";
+    }
+
+    return "[{\"type\":\"update\",\"data\":[" + resources + "]}]";
+}
+
+}
+
+class TestBenchInfoTreeModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void unchangedUpdate_data();
+    void unchangedUpdate();
+    void pushedChange_data();
+    void pushedChange();
+
+private:
+    void openModels(const int modelsPerLight);
+    bool waitForEvents(const int eventsApplied);
+
+private:
+    FakeBridge* m_fakeBridge;
+    HueBridge* m_bridge;
+    HueEventStream* m_stream;
+    HueLightList m_lights;
+    std::vector<std::unique_ptr<HueLightInfoTreeModel>> m_models;
+    int m_dataChanged;
+    int m_resets;
+    bool m_bright;
+};
+
+void TestBenchInfoTreeModel::initTestCase()
+{
+    m_bright = false;
+
+    m_fakeBridge = new FakeBridge(this);
+    QVERIFY(m_fakeBridge->listen());
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("lights"), Fixtures::lights(lightCount));
+
+    for (int ID = 1; ID <= lightCount; ID++) {
+        m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("lights/" + QString::number(ID)),
+                               QJsonDocument(Fixtures::lightJson(ID, 1 + ID % 254)).toJson(QJsonDocument::Compact));
+    }
+
+    m_fakeBridge->setEventStreamPath(streamPath);
+
+    m_bridge = new HueBridge(m_fakeBridge->getAddress(), m_fakeBridge->getUsername());
+    m_lights = HueLight::discoverLights(m_bridge);
+    QCOMPARE(m_lights.size(), lightCount);
+
+    m_stream = new HueEventStream(m_bridge);
+    m_stream->setUrl(QUrl("http://" + m_fakeBridge->getAddress() + streamPath));
+
+    for (int i = 0; i < m_lights.size(); i++)
+        QVERIFY(m_stream->addHueObject(m_lights.at(i)));
+
+    QSignalSpy connected(m_stream, &HueEventStream::connected);
+    m_stream->start();
+    QTRY_COMPARE(connected.count(), 1);
+    QTRY_COMPARE(m_fakeBridge->eventStreamCount(), 1);
+}
+
+void TestBenchInfoTreeModel::cleanupTestCase()
+{
+    m_models.clear();
+    m_stream->stop();
+    delete m_stream;
+    m_lights = HueLightList();
+    delete m_bridge;
+    delete m_fakeBridge;
+}
+
+void TestBenchInfoTreeModel::openModels(const int modelsPerLight)
+{
+    m_models.clear();
+    m_dataChanged = 0;
+    m_resets = 0;
+
+    for (int i = 0; i < m_lights.size(); i++) {
+        for (int j = 0; j < modelsPerLight; j++) {
+            m_models.emplace_back(new HueLightInfoTreeModel(m_lights.at(i)));
+
+            connect(m_models.back().get(), &QAbstractItemModel::dataChanged, this, [this]()
+            {
+                m_dataChanged++;
+            });
+            connect(m_models.back().get(), &QAbstractItemModel::modelReset, this, [this]()
+            {
+                m_resets++;
+            });
+        }
+    }
+}
+
+bool TestBenchInfoTreeModel::waitForEvents(const int eventsApplied)
+{
+    QElapsedTimer deadline;
+    deadline.start();
+
+    while (m_stream->eventsApplied() < eventsApplied && deadline.elapsed() < 5000)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+
+    return m_stream->eventsApplied() >= eventsApplied;
+}
+
+void TestBenchInfoTreeModel::unchangedUpdate_data()
+{
+    QTest::addColumn<int>("modelsPerLight");
+
+    QTest::newRow("1 model per light") << 1;
+    QTest::newRow("10 models per light") << 10;
+    QTest::newRow("50 models per light") << 50;
+}
+
+void TestBenchInfoTreeModel::unchangedUpdate()
+{
+    QFETCH(int, modelsPerLight);
+
+    openModels(modelsPerLight);
+
+    QBENCHMARK {
+        for (HueLight* light : m_lights)
+            QVERIFY(light->synchronize());
+
+        HueChangeNotifier::instance().flush();
+    }
+
+    QCOMPARE(m_dataChanged, 0);
+    QCOMPARE(m_resets, 0);
+}
+
+void TestBenchInfoTreeModel::pushedChange_data()
+{
+    unchangedUpdate_data();
+}
+
+void TestBenchInfoTreeModel::pushedChange()
+{
+    QFETCH(int, modelsPerLight);
+
+    openModels(modelsPerLight);
+
+    QBENCHMARK {
+        const int eventsApplied = m_stream->eventsApplied() + lightCount;
+        m_bright = !m_bright;
+        m_dataChanged = 0;
+
+        m_fakeBridge->pushEvent(brightnessUpdate(m_lights, m_bright ? 80.0 : 20.0));
+        QVERIFY(waitForEvents(eventsApplied));
+        HueChangeNotifier::instance().flush();
+
+        // Only the brightness cell of each model changed
+        QCOMPARE(m_dataChanged, lightCount * modelsPerLight);
+    }
+
+    QCOMPARE(m_resets, 0);
+}
+
+QTEST_GUILESS_MAIN(TestBenchInfoTreeModel)
+
+#include "tst_bench_infotreemodel.moc"
@@ -0,0 +1,233 @@
+#include <QtTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "fixtures.h"
+#include "huejsonreader.h"
+#include "huetypes.h"
+
+// Parse time and memory of a /lights reply, read through a QJsonDocument DOM (as
+// discovery did before) and with HueJsonReader straight from the reply bytes.
+//
+// Both paths fill the same Light::Record values, the way parseHueLight() and
+// readHueLight() do, but on one thread so that the parsers are compared rather
+// than the thread pool.
+//
+// The memory functions report the heap in use at the point where each path holds
+// the most: the finished records plus the DOM, or plus nothing but the reader.
+// They need glibc for the heap statistics and are skipped elsewhere.
+class TestBenchJsonParse : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void domParse_data();
+    void domParse();
+    void streamingParse_data();
+    void streamingParse();
+    void domMemory_data();
+    void domMemory();
+    void streamingMemory_data();
+    void streamingMemory();
+
+private:
+    static std::vector<Light::Record> parseWithDom(const QByteArray& reply, qint64* heldBytes = nullptr);
+    static std::vector<Light::Record> parseWithReader(const QByteArray& reply, qint64* heldBytes = nullptr);
+    static bool readLight(HueJsonReader& reader, Light::Record& record);
+    static qint64 allocatedBytes();
+    static void addLightCounts();
+};
+
+qint64 TestBenchJsonParse::allocatedBytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    return static_cast<qint64>(info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+    const struct mallinfo info = mallinfo();
+    return static_cast<qint64>(info.uordblks) + info.hblkhd;
+#else
+    return -1;
+#endif
+}
+
+void TestBenchJsonParse::addLightCounts()
+{
+    QTest::addColumn<int>("lightCount");
+
+    QTest::newRow("100 lights") << 100;
+    QTest::newRow("500 lights") << 500;
+}
+
+std::vector<Light::Record> TestBenchJsonParse::parseWithDom(const QByteArray& reply, qint64* heldBytes)
+{
+    const QJsonObject json = QJsonDocument::fromJson(reply).object();
+
+    std::vector<Light::Record> records;
+    records.reserve(static_cast<size_t>(json.size()));
+
+    for (auto it = json.constBegin(); it != json.constEnd(); ++it) {
+        const QJsonObject lightJson = it.value().toObject();
+
+        Light::Record record;
+        record.ID = it.key().toInt();
+        record.state = Light::State(lightJson["state"]);
+        record.name = Light::Name(lightJson["name"]);
+        record.type = Light::Type(lightJson["type"]);
+        record.uniqueID = Light::UniqueID(lightJson["uniqueid"]);
+        record.softwareVersion = Light::SoftwareVersion(lightJson["swversion"]);
+        record.softwareUpdate = Light::SoftwareUpdate(lightJson["swupdate"]);
+        record.softwareConfigID = Light::SoftwareConfigID(lightJson["swconfigid"]);
+        record.productName = Light::ProductName(lightJson["productname"]);
+        record.manufacturer = Light::Manufacturer(lightJson["manufacturername"]);
+        record.productID = Light::ProductID(lightJson["productid"]);
+        record.config = Light::Config(lightJson["config"]);
+        record.capabilities = Light::Capabilities(lightJson["capabilities"]);
+        record.capabilities.setControlType(Light::Capabilities::controlTypeFromType(record.type.getType()));
+        records.push_back(record);
+    }
+
+    if (heldBytes != nullptr)
+        *heldBytes = allocatedBytes();
+
+    return records;
+}
+
+std::vector<Light::Record> TestBenchJsonParse::parseWithReader(const QByteArray& reply, qint64* heldBytes)
+{
+    HueJsonReader reader(reply);
+    std::vector<Light::Record> records;
+
+    if (!reader.beginObject())
+        return records;
+
+    while (reader.readNextKey()) {
+        Light::Record record;
+        record.ID = reader.keyToInt();
+
+        if (readLight(reader, record))
+            records.push_back(std::move(record));
+    }
+
+    if (heldBytes != nullptr)
+        *heldBytes = allocatedBytes();
+
+    return records;
+}
+
+bool TestBenchJsonParse::readLight(HueJsonReader& reader, Light::Record& record)
+{
+    if (!reader.beginObject())
+        return false;
+
+    while (reader.readNextKey()) {
+        if (reader.keyEquals("state"))                  record.state = Light::State(reader);
+        else if (reader.keyEquals("swupdate"))          record.softwareUpdate = Light::SoftwareUpdate(reader);
+        else if (reader.keyEquals("type"))              record.type.setType(reader.readString());
+        else if (reader.keyEquals("name"))              record.name.setName(reader.readString());
+        else if (reader.keyEquals("manufacturername"))  record.manufacturer.setManufacturer(reader.readString());
+        else if (reader.keyEquals("productname"))       record.productName.setProductName(reader.readString());
+        else if (reader.keyEquals("capabilities"))      record.capabilities = Light::Capabilities(reader);
+        else if (reader.keyEquals("config"))            record.config = Light::Config(reader);
+        else if (reader.keyEquals("uniqueid"))          record.uniqueID.setUniqueID(reader.readString());
+        else if (reader.keyEquals("swversion"))         record.softwareVersion.setSoftwareVersion(reader.readString());
+        else if (reader.keyEquals("swconfigid"))        record.softwareConfigID.setSoftwareConfigID(reader.readString());
+        else if (reader.keyEquals("productid"))         record.productID.setProductID(reader.readString());
+        else
+            reader.skipValue();
+    }
+
+    record.capabilities.setControlType(Light::Capabilities::controlTypeFromType(record.type.getType()));
+    return !reader.hasError();
+}
+
+void TestBenchJsonParse::domParse_data()
+{
+    addLightCounts();
+}
+
+void TestBenchJsonParse::domParse()
+{
+    QFETCH(int, lightCount);
+
+    const QByteArray reply = Fixtures::lights(lightCount);
+    std::vector<Light::Record> records;
+
+    QBENCHMARK {
+        records = parseWithDom(reply);
+    }
+
+    QCOMPARE(static_cast<int>(records.size()), lightCount);
+}
+
+void TestBenchJsonParse::streamingParse_data()
+{
+    addLightCounts();
+}
+
+void TestBenchJsonParse::streamingParse()
+{
+    QFETCH(int, lightCount);
+
+    const QByteArray reply = Fixtures::lights(lightCount);
+    std::vector<Light::Record> records;
+
+    QBENCHMARK {
+        records = parseWithReader(reply);
+    }
+
+    QCOMPARE(static_cast<int>(records.size()), lightCount);
+}
+
+void TestBenchJsonParse::domMemory_data()
+{
+    addLightCounts();
+}
+
+void TestBenchJsonParse::domMemory()
+{
+    QFETCH(int, lightCount);
+
+    if (allocatedBytes() < 0)
+        QSKIP("Heap statistics are only available with glibc");
+
+    const QByteArray reply = Fixtures::lights(lightCount);
+    const qint64 before = allocatedBytes();
+    qint64 held = 0;
+
+    const std::vector<Light::Record> records = parseWithDom(reply, &held);
+
+    QCOMPARE(static_cast<int>(records.size()), lightCount);
+    QTest::setBenchmarkResult(static_cast<qreal>(held - before), QTest::BytesAllocated);
+}
+
+void TestBenchJsonParse::streamingMemory_data()
+{
+    addLightCounts();
+}
+
+void TestBenchJsonParse::streamingMemory()
+{
+    QFETCH(int, lightCount);
+
+    if (allocatedBytes() < 0)
+        QSKIP("Heap statistics are only available with glibc");
+
+    const QByteArray reply = Fixtures::lights(lightCount);
+    const qint64 before = allocatedBytes();
+    qint64 held = 0;
+
+    const std::vector<Light::Record> records = parseWithReader(reply, &held);
+
+    QCOMPARE(static_cast<int>(records.size()), lightCount);
+    QTest::setBenchmarkResult(static_cast<qreal>(held - before), QTest::BytesAllocated);
+}
+
+QTEST_GUILESS_MAIN(TestBenchJsonParse)
+
+#include "tst_bench_jsonparse.moc"
@@ -0,0 +1,5 @@
+include(../benchmarks.pri)
+
+TARGET = tst_bench_lightlistmodel
+
+SOURCES += tst_bench_lightlistmodel.cpp
@@ -0,0 +1,265 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <memory>
+#include <vector>
+
+#include "fakebridge.h"
+#include "fixtures.h"
+#include "huebridge.h"
+#include "huechangenotifier.h"
+#include "hueeventstream.h"
+#include "huelight.h"
+#include "Models/huelightlistmodel.h"
+
+// HueLightListModel with 10,000 lights, discovered from a local bridge stand-in.
+//
+// populate fills an empty model, resetSameList hands the model the list it already
+// shows (as rediscovery does when nothing was added or removed), and readAllRows
+// reads every role of every row, as a view does when it is first shown.
+//
+// reverseOrder, moveFewRows and interleave hand over the lights in another order or
+// with every other light missing. A full reversal is one layout change, a few moved
+// lights are moves of those rows only, and interleaving inserts and removes one
+// run per missing light.
+//
+// pushedChange changes the brightness of one light through the event stream and
+// flushes HueChangeNotifier. It requires a single dataChanged() for that row and
+// role, so a view repaints one row instead of 10,000.
+namespace {
+
+const int lightCount = 10000;
+const int changedLight = 5000;
+const char streamPath[] = "/eventstream/clip/v2";
+const int movedLights = 10;
+
+// The lights at rows of lights, in that order
+std::shared_ptr<HueLightList> listOf(const HueLightList& lights, const std::vector<int>& rows)
+{
+    auto objects = std::make_shared<HueLightList::ObjectList>();
+    objects->reserve(rows.size());
+
+    for (const int row : rows)
+        objects->push_back(lights.at(row));
+
+    return std::make_shared<HueLightList>(objects);
+}
+
+}
+
+class TestBenchLightListModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void populate();
+    void resetSameList();
+    void readAllRows();
+    void reverseOrder();
+    void moveFewRows();
+    void interleave();
+    void pushedChange();
+
+private:
+    FakeBridge* m_fakeBridge;
+    HueBridge* m_bridge;
+    std::shared_ptr<HueLightList> m_lights;
+};
+
+void TestBenchLightListModel::initTestCase()
+{
+    m_fakeBridge = new FakeBridge(this);
+    QVERIFY(m_fakeBridge->listen());
+    m_fakeBridge->setReply("GET", m_fakeBridge->apiPath("lights"), Fixtures::lights(lightCount));
+    m_fakeBridge->setEventStreamPath(streamPath);
+
+    m_bridge = new HueBridge(m_fakeBridge->getAddress(), m_fakeBridge->getUsername());
+    m_bridge->setNetworkRequestTimeout(60000);
+
+    m_lights = std::make_shared<HueLightList>(HueLight::discoverLights(m_bridge));
+    QCOMPARE(m_lights->size(), lightCount);
+
+    HueChangeNotifier::instance().flush();
+}
+
+void TestBenchLightListModel::cleanupTestCase()
+{
+    m_lights.reset();
+    delete m_bridge;
+    delete m_fakeBridge;
+}
+
+void TestBenchLightListModel::populate()
+{
+    QBENCHMARK {
+        HueLightListModel model(nullptr);
+        model.setLightList(m_lights);
+        QCOMPARE(model.rowCount(), lightCount);
+    }
+}
+
+void TestBenchLightListModel::resetSameList()
+{
+    HueLightListModel model(m_lights);
+
+    QSignalSpy dataChanged(&model, &QAbstractItemModel::dataChanged);
+    QSignalSpy rowsInserted(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy rowsRemoved(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy rowsMoved(&model, &QAbstractItemModel::rowsMoved);
+
+    QBENCHMARK {
+        model.setLightList(m_lights);
+    }
+
+    QCOMPARE(dataChanged.count(), 0);
+    QCOMPARE(rowsInserted.count(), 0);
+    QCOMPARE(rowsRemoved.count(), 0);
+    QCOMPARE(rowsMoved.count(), 0);
+}
+
+void TestBenchLightListModel::readAllRows()
+{
+    HueLightListModel model(m_lights);
+    int valid = 0;
+
+    QBENCHMARK {
+        valid = 0;
+
+        for (int row = 0; row < model.rowCount(); row++) {
+            const QModelIndex index = model.index(row);
+
+            if (model.data(index, Qt::DisplayRole).isValid())
+                valid++;
+
+            for (int role = HueLightListModel::IDRole; role <= HueLightListModel::XYRole; role++) {
+                if (model.data(index, role).isValid())
+                    valid++;
+            }
+        }
+    }
+
+    QCOMPARE(valid, lightCount * (HueLightListModel::XYRole - HueLightListModel::IDRole + 2));
+}
+
+void TestBenchLightListModel::reverseOrder()
+{
+    std::vector<int> rows;
+    for (int row = lightCount - 1; row >= 0; row--)
+        rows.push_back(row);
+
+    const std::shared_ptr<HueLightList> reversed = listOf(*m_lights, rows);
+    HueLightListModel model(m_lights);
+
+    QSignalSpy layoutChanged(&model, &QAbstractItemModel::layoutChanged);
+    QSignalSpy rowsMoved(&model, &QAbstractItemModel::rowsMoved);
+
+    QBENCHMARK {
+        model.setLightList(reversed);
+        model.setLightList(m_lights);
+    }
+
+    QVERIFY(layoutChanged.count() > 0);
+    QCOMPARE(layoutChanged.count() % 2, 0);
+    QCOMPARE(rowsMoved.count(), 0);
+    QCOMPARE(model.rowOf(1), 0);
+    QCOMPARE(model.rowOf(lightCount), lightCount - 1);
+}
+
+void TestBenchLightListModel::moveFewRows()
+{
+    // The first lights move to the end
+    std::vector<int> rows;
+    for (int row = movedLights; row < lightCount; row++)
+        rows.push_back(row);
+    for (int row = 0; row < movedLights; row++)
+        rows.push_back(row);
+
+    const std::shared_ptr<HueLightList> rotated = listOf(*m_lights, rows);
+    HueLightListModel model(m_lights);
+
+    QSignalSpy layoutChanged(&model, &QAbstractItemModel::layoutChanged);
+    QSignalSpy rowsMoved(&model, &QAbstractItemModel::rowsMoved);
+
+    QBENCHMARK {
+        model.setLightList(rotated);
+        model.setLightList(m_lights);
+    }
+
+    QVERIFY(rowsMoved.count() > 0);
+    QCOMPARE(rowsMoved.count() % (2 * movedLights), 0);
+    QCOMPARE(layoutChanged.count(), 0);
+    QCOMPARE(model.rowOf(1), 0);
+}
+
+void TestBenchLightListModel::interleave()
+{
+    std::vector<int> rows;
+    for (int row = 0; row < lightCount; row += 2)
+        rows.push_back(row);
+
+    const std::shared_ptr<HueLightList> everyOther = listOf(*m_lights, rows);
+    HueLightListModel model(everyOther);
+
+    QSignalSpy rowsInserted(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy rowsRemoved(&model, &QAbstractItemModel::rowsRemoved);
+
+    QBENCHMARK {
+        model.setLightList(m_lights);
+        QCOMPARE(model.rowCount(), lightCount);
+        model.setLightList(everyOther);
+    }
+
+    QCOMPARE(rowsInserted.count(), rowsRemoved.count());
+    QCOMPARE(model.rowCount(), lightCount / 2);
+    QCOMPARE(model.rowOf(3), 1);
+}
+
+void TestBenchLightListModel::pushedChange()
+{
+    HueLightListModel model(m_lights);
+    const std::shared_ptr<HueLight> light = m_lights->fetch(changedLight);
+    const int row = model.rowOf(changedLight);
+    QVERIFY(row >= 0);
+
+    HueEventStream stream(m_bridge);
+    stream.setUrl(QUrl("http://" + m_fakeBridge->getAddress() + streamPath));
+    QVERIFY(stream.addHueObject(light));
+
+    QSignalSpy connected(&stream, &HueEventStream::connected);
+    stream.start();
+    QTRY_COMPARE(connected.count(), 1);
+
+    QSignalSpy dataChanged(&model, &QAbstractItemModel::dataChanged);
+    bool bright = false;
+
+    QBENCHMARK {
+        const int eventsApplied = stream.eventsApplied() + 1;
+        bright = !bright;
+        dataChanged.clear();
+
+        m_fakeBridge->pushEvent("[{\"type\":\"update\",\"data\":[{\"id_v1\":\"/lights/"
+                                + QByteArray::number(changedLight) + "\",\"dimming\":{\"brightness\":"
+                                + (bright ? "80.0" : "20.0") + "}}]}]");
+
+        QElapsedTimer deadline;
+        deadline.start();
+        while (stream.eventsApplied() < eventsApplied && deadline.elapsed() < 5000)
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+
+        QCOMPARE(stream.eventsApplied(), eventsApplied);
+        HueChangeNotifier::instance().flush();
+
+        QCOMPARE(dataChanged.count(), 1);
+        QCOMPARE(dataChanged.first().at(0).toModelIndex().row(), row);
+        QCOMPARE(dataChanged.first().at(2).value<QVector<int>>(),
+                 QVector<int>({HueLightListModel::BrightnessRole}));
+    }
+
+    stream.stop();
+}
+
+QTEST_GUILESS_MAIN(TestBenchLightListModel)
+
+#include "tst_bench_lightlistmodel.moc"
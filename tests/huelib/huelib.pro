@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# Builds the HueLib sources into a static library
+# that the tests link against.
+#
+#-------------------------------------------------
+
+QT       += network concurrent
+QT       -= gui
+
+TARGET = HueLib
+TEMPLATE = lib
+CONFIG += staticlib
+CONFIG += c++14
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# Warnings that the review build uses; hidden virtuals are easy to miss otherwise
+CONFIG += warn_on
+gcc|clang: QMAKE_CXXFLAGS_WARN_ON += -Wextra -Woverloaded-virtual
+
+HUELIB_SOURCE = $$PWD/../../source
+
+SOURCES += \
+        $$files($$HUELIB_SOURCE/*.cpp) \
+        $$files($$HUELIB_SOURCE/Models/*.cpp)
+
+HEADERS += \
+        $$files($$HUELIB_SOURCE/*.h) \
+        $$files($$HUELIB_SOURCE/Models/*.h)
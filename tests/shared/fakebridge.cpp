@@ -0,0 +1,236 @@
+#include "fakebridge.h"
+
+#include <QHostAddress>
+
+namespace {
+
+const char username[] = "testuser";
+
+QString replyKey(const QByteArray& method, const QString& path)
+{
+    return QString::fromLatin1(method) + ' ' + path;
+}
+
+}
+
+FakeBridge::FakeBridge(QObject* parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+{
+    connect(m_server, &QTcpServer::newConnection,
+            this, &FakeBridge::acceptConnection);
+}
+
+bool FakeBridge::listen()
+{
+    return m_server->listen(QHostAddress(QHostAddress::LocalHost), 0);
+}
+
+quint16 FakeBridge::getPort() const
+{
+    return m_server->serverPort();
+}
+
+// The address to pass to HueBridge, which puts it straight into the URL
+QString FakeBridge::getAddress() const
+{
+    return "127.0.0.1:" + QString::number(getPort());
+}
+
+QString FakeBridge::getUsername() const
+{
+    return username;
+}
+
+QString FakeBridge::apiPath(const QString& resource) const
+{
+    return "/api/" + getUsername() + "/" + resource;
+}
+
+void FakeBridge::setReply(const QByteArray& method, const QString& path, const QByteArray& body,
+                          const int httpStatus)
+{
+    m_replies.insert(replyKey(method, path), Reply{body, httpStatus});
+}
+
+void FakeBridge::removeReply(const QByteArray& method, const QString& path)
+{
+    m_replies.remove(replyKey(method, path));
+}
+
+void FakeBridge::setEventStreamPath(const QString& path)
+{
+    m_eventStreamPath = path;
+}
+
+int FakeBridge::eventStreamCount() const
+{
+    int count = 0;
+
+    for (const auto& stream : m_eventStreams) {
+        if (stream && stream->state() == QAbstractSocket::ConnectedState)
+            count++;
+    }
+
+    return count;
+}
+
+void FakeBridge::pushEvent(const QByteArray& data, const QByteArray& ID)
+{
+    QByteArray event;
+
+    if (!ID.isEmpty())
+        event += "id: " + ID + "\n";
+
+    event += "data: " + data + "\n\n";
+    pushRaw(event);
+}
+
+void FakeBridge::pushRaw(const QByteArray& bytes)
+{
+    for (const auto& stream : m_eventStreams) {
+        if (stream) {
+            stream->write(bytes);
+            stream->flush();
+        }
+    }
+}
+
+void FakeBridge::closeEventStreams()
+{
+    for (const auto& stream : m_eventStreams) {
+        if (stream)
+            stream->disconnectFromHost();
+    }
+
+    m_eventStreams.clear();
+}
+
+QList<FakeBridge::Request> FakeBridge::requests() const
+{
+    return m_requests;
+}
+
+QList<FakeBridge::Request> FakeBridge::requests(const QByteArray& method) const
+{
+    QList<Request> matching;
+
+    for (const Request& request : m_requests) {
+        if (request.method == method)
+            matching.append(request);
+    }
+
+    return matching;
+}
+
+void FakeBridge::clearRequests()
+{
+    m_requests.clear();
+}
+
+void FakeBridge::acceptConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        QTcpSocket* socket = m_server->nextPendingConnection();
+        m_buffers.insert(socket, QByteArray());
+
+        connect(socket, &QTcpSocket::readyRead,
+                this, &FakeBridge::readRequest);
+        connect(socket, &QTcpSocket::disconnected,
+                this, [this, socket]()
+        {
+            m_buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void FakeBridge::readRequest()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+
+    if (socket == nullptr || !m_buffers.contains(socket))
+        return;
+
+    QByteArray& buffer = m_buffers[socket];
+    buffer.append(socket->readAll());
+
+    // Requests on a kept-alive connection follow each other
+    for (;;) {
+        const int headerEnd = buffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0)
+            return;
+
+        const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+        const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+        if (requestLine.size() < 2)
+            return;
+
+        // Header names are case-insensitive, so they are recorded in lower case
+        QMap<QByteArray, QByteArray> headers;
+        for (int i = 1; i < lines.size(); i++) {
+            const QByteArray line = lines.at(i).trimmed();
+            const int separator = line.indexOf(':');
+            if (separator > 0)
+                headers.insert(line.left(separator).trimmed().toLower(), line.mid(separator + 1).trimmed());
+        }
+
+        const int contentLength = headers.value("content-length").toInt();
+
+        const int requestSize = headerEnd + 4 + contentLength;
+        if (buffer.size() < requestSize)
+            return;
+
+        QByteArray path = requestLine.at(1);
+        const int queryStart = path.indexOf('?');
+        if (queryStart >= 0)
+            path.truncate(queryStart);
+
+        const Request request{requestLine.at(0), QString::fromUtf8(path), headers,
+                              buffer.mid(headerEnd + 4, contentLength)};
+        buffer.remove(0, requestSize);
+
+        m_requests.append(request);
+        handleRequest(socket, request);
+
+        if (!m_buffers.contains(socket))
+            return;
+    }
+}
+
+void FakeBridge::handleRequest(QTcpSocket* socket, const Request& request)
+{
+    if (request.method == "GET" && !m_eventStreamPath.isEmpty() && request.path == m_eventStreamPath) {
+        socket->write(statusLine(200)
+                      + "Content-Type: text/event-stream\r\n"
+                      + "Cache-Control: no-cache\r\n"
+                      + "Connection: close\r\n\r\n");
+        socket->flush();
+        m_eventStreams.append(socket);
+        return;
+    }
+
+    const auto reply = m_replies.constFind(replyKey(request.method, request.path));
+    const int httpStatus = reply == m_replies.constEnd() ? 404 : reply->httpStatus;
+    const QByteArray body = reply == m_replies.constEnd() ? QByteArray() : reply->body;
+
+    socket->write(statusLine(httpStatus)
+                  + "Content-Type: application/json\r\n"
+                  + "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                  + "Connection: close\r\n\r\n"
+                  + body);
+    socket->flush();
+    socket->disconnectFromHost();
+}
+
+QByteArray FakeBridge::statusLine(const int httpStatus)
+{
+    switch (httpStatus) {
+    case 200:
+        return "HTTP/1.1 200 OK\r\n";
+    case 404:
+        return "HTTP/1.1 404 Not Found\r\n";
+    default:
+        return "HTTP/1.1 " + QByteArray::number(httpStatus) + " Error\r\n";
+    }
+}
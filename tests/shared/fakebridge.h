@@ -0,0 +1,71 @@
+#ifndef FAKEBRIDGE_H
+#define FAKEBRIDGE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QPointer>
+#include <QString>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+// A local HTTP server that answers like a bridge. Replies are canned per method and
+// path, every request is recorded, and one path can be served as an event stream.
+class FakeBridge : public QObject
+{
+    Q_OBJECT
+public:
+    struct Request {
+        QByteArray method;
+        QString path;
+        QMap<QByteArray, QByteArray> headers;
+        QByteArray body;
+    };
+
+    explicit FakeBridge(QObject* parent = nullptr);
+
+    bool listen();
+    quint16 getPort() const;
+    QString getAddress() const;
+    QString getUsername() const;
+    QString apiPath(const QString& resource) const;
+
+    void setReply(const QByteArray& method, const QString& path, const QByteArray& body,
+                  const int httpStatus = 200);
+    void removeReply(const QByteArray& method, const QString& path);
+
+    void setEventStreamPath(const QString& path);
+    int eventStreamCount() const;
+    void pushEvent(const QByteArray& data, const QByteArray& ID = QByteArray());
+    void pushRaw(const QByteArray& bytes);
+    void closeEventStreams();
+
+    QList<Request> requests() const;
+    QList<Request> requests(const QByteArray& method) const;
+    void clearRequests();
+
+private slots:
+    void acceptConnection();
+    void readRequest();
+
+private:
+    struct Reply {
+        QByteArray body;
+        int httpStatus;
+    };
+
+    void handleRequest(QTcpSocket* socket, const Request& request);
+    static QByteArray statusLine(const int httpStatus);
+
+private:
+    QTcpServer* m_server;
+    QMap<QTcpSocket*, QByteArray> m_buffers;
+    QHash<QString, Reply> m_replies;
+    QString m_eventStreamPath;
+    QList<QPointer<QTcpSocket>> m_eventStreams;
+    QList<Request> m_requests;
+};
+
+#endif // FAKEBRIDGE_H
@@ -0,0 +1,115 @@
+#include "fixtures.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QString>
+
+namespace Fixtures {
+
+QJsonObject lightJson(const int ID, const int brightness)
+{
+    const QJsonObject state {
+        {"on", true},
+        {"bri", brightness},
+        {"hue", (ID * 1000) % 65536},
+        {"sat", 140},
+        {"effect", "none"},
+        {"xy", QJsonArray{0.4573, 0.41}},
+        {"ct", 366},
+        {"alert", "none"},
+        {"colormode", "ct"},
+        {"mode", "homeautomation"},
+        {"reachable", true}
+    };
+
+    const QJsonObject control {
+        {"mindimlevel", 1000},
+        {"maxlumen", 806},
+        {"colorgamuttype", "C"},
+        {"colorgamut", QJsonArray{QJsonArray{0.6915, 0.3083},
+                                  QJsonArray{0.17, 0.7},
+                                  QJsonArray{0.1532, 0.0475}}},
+        {"ct", QJsonObject{{"min", 153}, {"max", 500}}}
+    };
+
+    const QJsonObject capabilities {
+        {"certified", true},
+        {"control", control},
+        {"streaming", QJsonObject{{"renderer", true}, {"proxy", true}}}
+    };
+
+    const QJsonObject config {
+        {"archetype", "sultanbulb"},
+        {"function", "mixed"},
+        {"direction", "omnidirectional"},
+        {"startup", QJsonObject{{"mode", "safety"}, {"configured", true}}}
+    };
+
+    return QJsonObject {
+        {"state", state},
+        {"swupdate", QJsonObject{{"state", "noupdates"}, {"lastinstall", "2021-03-01T10:21:35"}}},
+        {"type", "Extended color light"},
+        {"name", "Hue color lamp " + QString::number(ID)},
+        {"modelid", "LCT015"},
+        {"manufacturername", "Signify Netherlands B.V."},
+        {"productname", "Hue color lamp"},
+        {"capabilities", capabilities},
+        {"config", config},
+        {"uniqueid", QString("00:17:88:01:%1-0b").arg(ID, 11, 16, QChar('0'))},
+        {"swversion", "1.76.6"},
+        {"swconfigid", "3416C2DD"},
+        {"productid", "Philips-LCT015-1-A19ECLv5"}
+    };
+}
+
+QJsonObject groupJson(const int ID, const int firstLight, const int lightCount)
+{
+    QJsonArray lights;
+    for (int light = firstLight; light < firstLight + lightCount; light++)
+        lights.append(QString::number(light));
+
+    const QJsonObject action {
+        {"on", true},
+        {"bri", 200},
+        {"hue", 8402},
+        {"sat", 140},
+        {"effect", "none"},
+        {"xy", QJsonArray{0.4573, 0.41}},
+        {"ct", 366},
+        {"alert", "none"},
+        {"colormode", "ct"}
+    };
+
+    return QJsonObject {
+        {"name", "Room " + QString::number(ID)},
+        {"lights", lights},
+        {"sensors", QJsonArray()},
+        {"type", "Room"},
+        {"state", QJsonObject{{"all_on", true}, {"any_on", true}}},
+        {"recycle", false},
+        {"class", "Living room"},
+        {"action", action}
+    };
+}
+
+QByteArray lights(const int count, const int firstID)
+{
+    QJsonObject reply;
+
+    for (int ID = firstID; ID < firstID + count; ID++)
+        reply.insert(QString::number(ID), lightJson(ID, 1 + ID % 254));
+
+    return QJsonDocument(reply).toJson(QJsonDocument::Compact);
+}
+
+QByteArray groups(const int count, const int lightsPerGroup)
+{
+    QJsonObject reply;
+
+    for (int ID = 1; ID <= count; ID++)
+        reply.insert(QString::number(ID), groupJson(ID, 1 + (ID - 1) * lightsPerGroup, lightsPerGroup));
+
+    return QJsonDocument(reply).toJson(QJsonDocument::Compact);
+}
+
+}
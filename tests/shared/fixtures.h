@@ -0,0 +1,21 @@
+#ifndef FIXTURES_H
+#define FIXTURES_H
+
+#include <QByteArray>
+#include <QJsonObject>
+
+// Replies shaped like those of a real bridge (extended color lights and rooms)
+namespace Fixtures {
+
+QJsonObject lightJson(const int ID, const int brightness);
+QJsonObject groupJson(const int ID, const int firstLight, const int lightCount);
+
+// A /lights reply with the lights firstID to firstID + count - 1
+QByteArray lights(const int count, const int firstID = 1);
+
+// A /groups reply with count rooms of lightsPerGroup consecutive lights each
+QByteArray groups(const int count, const int lightsPerGroup);
+
+}
+
+#endif // FIXTURES_H
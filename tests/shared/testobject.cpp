@@ -0,0 +1,110 @@
+#include "testobject.h"
+
+#include "huerequest.h"
+
+TestObject::TestObject(const int ID, const HueObjectKind kind, HueBridge* bridge)
+    : HueAbstractObject(bridge)
+    , m_ID(ID)
+    , m_kind(kind)
+    , m_state()
+    , m_synchronizeCount(0)
+{
+
+}
+
+void TestObject::setCurrentState(const HueStateChange& state)
+{
+    m_state = state;
+}
+
+int TestObject::synchronizeCount() const
+{
+    return m_synchronizeCount;
+}
+
+bool TestObject::hasValidConstructor() const
+{
+    return true;
+}
+
+bool TestObject::isValid() const
+{
+    return true;
+}
+
+int TestObject::ID() const
+{
+    return m_ID;
+}
+
+HueAbstractObject::HueObjectKind TestObject::objectKind() const
+{
+    return m_kind;
+}
+
+bool TestObject::synchronize()
+{
+    m_synchronizeCount++;
+    return true;
+}
+
+HueStateChange TestObject::currentState() const
+{
+    return m_state;
+}
+
+HueRequest TestObject::makePutRequest(QJsonObject json)
+{
+    const QString target = m_kind == LightKind ? "/state" : "/action";
+    return HueRequest(resourcePath() + target, json, HueRequest::Put);
+}
+
+HueRequest TestObject::makeGetRequest()
+{
+    return HueRequest(resourcePath(), QJsonObject(), HueRequest::Get);
+}
+
+void TestObject::updateOn(const bool on)
+{
+    m_state.setOn(on);
+}
+
+void TestObject::updateHue(const int hue)
+{
+    m_state.setHue(hue);
+}
+
+void TestObject::updateSaturation(const int saturation)
+{
+    m_state.setSaturation(saturation);
+}
+
+void TestObject::updateBrightness(const int brightness)
+{
+    m_state.setBrightness(brightness);
+}
+
+void TestObject::updateColorTemp(const int colorTemp)
+{
+    m_state.setColorTemp(colorTemp);
+}
+
+void TestObject::updateXY(const double x, const double y)
+{
+    m_state.setXY(x, y);
+}
+
+void TestObject::updateAlert(const HueAlert alert)
+{
+    m_state.setAlert(alert);
+}
+
+void TestObject::updateEffect(const HueEffect effect)
+{
+    m_state.setEffect(effect);
+}
+
+QString TestObject::resourcePath() const
+{
+    return (m_kind == LightKind ? "lights/" : "groups/") + QString::number(m_ID);
+}
@@ -0,0 +1,51 @@
+#ifndef TESTOBJECT_H
+#define TESTOBJECT_H
+
+#include "hueabstractobject.h"
+#include "huestatechange.h"
+
+// A HueAbstractObject that keeps its state in memory, for tests that need a target
+// without discovering it from a bridge
+class TestObject : public HueAbstractObject
+{
+    Q_OBJECT
+public:
+    explicit TestObject(const int ID = 1, const HueObjectKind kind = LightKind,
+                        HueBridge* bridge = nullptr);
+
+    void setCurrentState(const HueStateChange& state);
+    int synchronizeCount() const;
+
+    using HueAbstractObject::applyStateChange;
+
+    bool hasValidConstructor() const override;
+    bool isValid() const override;
+    int ID() const override;
+    HueObjectKind objectKind() const override;
+    bool synchronize() override;
+    HueStateChange currentState() const override;
+
+protected:
+    HueRequest makePutRequest(QJsonObject json) override;
+    HueRequest makeGetRequest() override;
+
+    void updateOn(const bool on) override;
+    void updateHue(const int hue) override;
+    void updateSaturation(const int saturation) override;
+    void updateBrightness(const int brightness) override;
+    void updateColorTemp(const int colorTemp) override;
+    void updateXY(const double x, const double y) override;
+    void updateAlert(const HueAlert alert) override;
+    void updateEffect(const HueEffect effect) override;
+
+private:
+    QString resourcePath() const;
+
+private:
+    int m_ID;
+    HueObjectKind m_kind;
+    HueStateChange m_state;
+    int m_synchronizeCount;
+};
+
+#endif // TESTOBJECT_H
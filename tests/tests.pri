@@ -0,0 +1,42 @@
+# Shared settings for every test and benchmark program
+
+QT       += testlib network concurrent
+QT       -= gui
+
+TEMPLATE = app
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# Warnings that the review build uses; hidden virtuals are easy to miss otherwise
+CONFIG += warn_on
+gcc|clang: QMAKE_CXXFLAGS_WARN_ON += -Wextra -Woverloaded-virtual
+
+INCLUDEPATH += $$PWD/../source
+DEPENDPATH += $$PWD/../source
+
+HUELIB_BUILD = $$OUT_PWD/../../huelib
+
+win32:CONFIG(release, debug|release): LIBS += -L$$HUELIB_BUILD/release/ -lHueLib
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$HUELIB_BUILD/debug/ -lHueLib
+else:unix: LIBS += -L$$HUELIB_BUILD/ -lHueLib
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$HUELIB_BUILD/release/libHueLib.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$HUELIB_BUILD/debug/libHueLib.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$HUELIB_BUILD/release/HueLib.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$HUELIB_BUILD/debug/HueLib.lib
+else:unix: PRE_TARGETDEPS += $$HUELIB_BUILD/libHueLib.a
+
+# Stand-ins shared by the tests
+INCLUDEPATH += $$PWD/shared
+
+SOURCES += \
+        $$PWD/shared/fakebridge.cpp \
+        $$PWD/shared/fixtures.cpp \
+        $$PWD/shared/testobject.cpp
+
+HEADERS += \
+        $$PWD/shared/fakebridge.h \
+        $$PWD/shared/fixtures.h \
+        $$PWD/shared/testobject.h
@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# HueLib tests
+#
+# Build this project and run "make check" to run the autotests.
+# The benchmarks under benchmarks/ are built as well, but are run by hand.
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+        huelib \
+        auto \
+        benchmarks
+
+auto.depends = huelib
+benchmarks.depends = huelib